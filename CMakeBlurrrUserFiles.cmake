@@ -130,14 +130,55 @@ endif()
 
 add_definitions(-DCIRCULAR_QUEUE_NAMESPACE_PREFIX=Flappy)
 
+# Headless builds run the simulation without a window, renderer or audio (same as passing --headless).
+option(FLAPPY_HEADLESS_BUILD "Build FlappyBlurrrC as a headless simulation runner" OFF)
+if(FLAPPY_HEADLESS_BUILD)
+	add_definitions(-DFLAPPY_HEADLESS_BUILD=1)
+endif()
+
+# The SIMD and scalar bird physics must round identically, so don't let the compiler fuse multiply-adds.
+# 32-bit x86 also defaults to x87 math with 80-bit intermediates, so use SSE registers there (FlappyBirdSoA.c refuses to build otherwise).
+if(CMAKE_C_COMPILER_ID MATCHES "GNU|Clang")
+	if(CMAKE_SIZEOF_VOID_P EQUAL 4 AND CMAKE_SYSTEM_PROCESSOR MATCHES "^(i.86|x86|X86|x86_64|AMD64|amd64)$")
+		set_source_files_properties(${PROJECT_SOURCE_DIR}/source/FlappyBirdSoA.c PROPERTIES COMPILE_FLAGS "-ffp-contract=off -msse2 -mfpmath=sse")
+	else()
+		set_source_files_properties(${PROJECT_SOURCE_DIR}/source/FlappyBirdSoA.c PROPERTIES COMPILE_FLAGS -ffp-contract=off)
+	endif()
+endif()
+
 # Add your C/C++/Obj-C files here
 set(BLURRR_USER_COMPILED_FILES
 	# This is main_c.c or main_lua.c or main_JavaScriptCore.c
 	${BLURRR_CORE_SOURCE_MAIN}
 	${PROJECT_SOURCE_DIR}/source/CircularQueue.c	
 	${PROJECT_SOURCE_DIR}/source/CircularQueue.h	
+	${PROJECT_SOURCE_DIR}/source/CircularQueueSPSC.h
+	${PROJECT_SOURCE_DIR}/source/CircularQueueSPSC.c
+	${PROJECT_SOURCE_DIR}/source/CircularQueueTyped.h
 	${PROJECT_SOURCE_DIR}/source/TimeTicker.h	
 	${PROJECT_SOURCE_DIR}/source/TimeTicker.c
+	${PROJECT_SOURCE_DIR}/source/FlappyWorld.h
+	${PROJECT_SOURCE_DIR}/source/FlappyWorld.c
+	${PROJECT_SOURCE_DIR}/source/FlappyTimerWheel.h
+	${PROJECT_SOURCE_DIR}/source/FlappyTimerWheel.c
+	${PROJECT_SOURCE_DIR}/source/FlappyBatch.h
+	${PROJECT_SOURCE_DIR}/source/FlappyBatch.c
+	${PROJECT_SOURCE_DIR}/source/FlappyEnvPool.h
+	${PROJECT_SOURCE_DIR}/source/FlappyEnvPool.c
+	${PROJECT_SOURCE_DIR}/source/FlappyBirdSoA.h
+	${PROJECT_SOURCE_DIR}/source/FlappyBirdSoA.c
+	${PROJECT_SOURCE_DIR}/source/FlappyReplay.h
+	${PROJECT_SOURCE_DIR}/source/FlappyReplay.c
+	${PROJECT_SOURCE_DIR}/source/FlappyReplayVerifier.h
+	${PROJECT_SOURCE_DIR}/source/FlappyReplayVerifier.c
+	${PROJECT_SOURCE_DIR}/source/FlappyPixelRenderer.h
+	${PROJECT_SOURCE_DIR}/source/FlappyPixelRenderer.c
+	${PROJECT_SOURCE_DIR}/source/FlappyExperienceRing.h
+	${PROJECT_SOURCE_DIR}/source/FlappyExperienceRing.c
+	${PROJECT_SOURCE_DIR}/source/FlappyCommandQueue.h
+	${PROJECT_SOURCE_DIR}/source/FlappyCommandQueue.c
+	${PROJECT_SOURCE_DIR}/source/FlappyFramePacer.h
+	${PROJECT_SOURCE_DIR}/source/FlappyFramePacer.c
 
 #	${PROJECT_SOURCE_DIR}/source/main_c.c	
 	# AUTOMATION_BEGIN:BLURRR_USER_COMPILED_FILES
@@ -145,6 +186,22 @@ set(BLURRR_USER_COMPILED_FILES
 )
 
 
+# The simulation without any rendering, fonts or audio. This is what the libflappy shared library (see CMakeLists.txt) is built from.
+set(FLAPPY_LIBRARY_SOURCE_FILES
+	${PROJECT_SOURCE_DIR}/source/LibFlappy.h
+	${PROJECT_SOURCE_DIR}/source/LibFlappy.c
+	${PROJECT_SOURCE_DIR}/source/CircularQueueTyped.h
+	${PROJECT_SOURCE_DIR}/source/TimeTicker.h
+	${PROJECT_SOURCE_DIR}/source/TimeTicker.c
+	${PROJECT_SOURCE_DIR}/source/FlappyWorld.h
+	${PROJECT_SOURCE_DIR}/source/FlappyWorld.c
+	${PROJECT_SOURCE_DIR}/source/FlappyTimerWheel.h
+	${PROJECT_SOURCE_DIR}/source/FlappyTimerWheel.c
+	${PROJECT_SOURCE_DIR}/source/FlappyReplay.h
+	${PROJECT_SOURCE_DIR}/source/FlappyReplay.c
+)
+
+
 # Add your C/C++/Obj-C include paths here
 set(BLURRR_USER_INCLUDE_PATHS
 	${PROJECT_SOURCE_DIR}/source
@@ -0,0 +1,275 @@
+/*
+	CircularQueueSPSC: single producer/single consumer version of CircularQueueVoid.
+	headIndex and tailIndex are free running counters (they are never wrapped, only masked),
+	so tail - head is the size even after they overflow 2^32, and the full and empty cases
+	don't need a spare slot or a shared counter.
+	The producer owns tailIndex and the consumer owns headIndex. Each side also keeps a private
+	copy of the other side's index and only reloads it when the copy says full/empty,
+	so in the common case neither thread reads the other's cache line.
+*/
+
+#include "CircularQueueSPSC.h"
+#include <stddef.h> /* for NULL */
+#include <stdlib.h> /* for malloc/free */
+
+/* C11 atomics when we have them. The fallbacks are for compilers that don't have <stdatomic.h> in C mode. */
+#if defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) && !defined(__STDC_NO_ATOMICS__)
+	#include <stdatomic.h>
+	typedef atomic_uint CircularQueueSPSCIndex;
+	#define CIRCULAR_QUEUE_SPSC_LOAD_RELAXED(index_ptr) atomic_load_explicit((index_ptr), memory_order_relaxed)
+	#define CIRCULAR_QUEUE_SPSC_LOAD_ACQUIRE(index_ptr) atomic_load_explicit((index_ptr), memory_order_acquire)
+	#define CIRCULAR_QUEUE_SPSC_STORE_RELAXED(index_ptr, value) atomic_store_explicit((index_ptr), (value), memory_order_relaxed)
+	#define CIRCULAR_QUEUE_SPSC_STORE_RELEASE(index_ptr, value) atomic_store_explicit((index_ptr), (value), memory_order_release)
+#elif defined(__GNUC__)
+	typedef unsigned int CircularQueueSPSCIndex;
+	#define CIRCULAR_QUEUE_SPSC_LOAD_RELAXED(index_ptr) __atomic_load_n((index_ptr), __ATOMIC_RELAXED)
+	#define CIRCULAR_QUEUE_SPSC_LOAD_ACQUIRE(index_ptr) __atomic_load_n((index_ptr), __ATOMIC_ACQUIRE)
+	#define CIRCULAR_QUEUE_SPSC_STORE_RELAXED(index_ptr, value) __atomic_store_n((index_ptr), (value), __ATOMIC_RELAXED)
+	#define CIRCULAR_QUEUE_SPSC_STORE_RELEASE(index_ptr, value) __atomic_store_n((index_ptr), (value), __ATOMIC_RELEASE)
+#elif defined(_MSC_VER)
+	/* The interlocked calls are full barriers, which is stronger than we need but correct on every architecture. */
+	#include <intrin.h>
+	typedef volatile long CircularQueueSPSCIndex;
+	#define CIRCULAR_QUEUE_SPSC_LOAD_RELAXED(index_ptr) ((unsigned int)*(index_ptr))
+	#define CIRCULAR_QUEUE_SPSC_LOAD_ACQUIRE(index_ptr) ((unsigned int)_InterlockedOr((index_ptr), 0))
+	#define CIRCULAR_QUEUE_SPSC_STORE_RELAXED(index_ptr, value) (*(index_ptr) = (long)(value))
+	#define CIRCULAR_QUEUE_SPSC_STORE_RELEASE(index_ptr, value) _InterlockedExchange((index_ptr), (long)(value))
+#else
+	#error "CircularQueueSPSC needs C11 atomics, GCC/Clang __atomic builtins or MSVC interlocked intrinsics"
+#endif
+
+/* Big enough for the x86 and most ARM cores we ship on. */
+#define CIRCULAR_QUEUE_SPSC_CACHE_LINE_SIZE 64
+
+/* The largest power of two an unsigned int can hold. */
+#define CIRCULAR_QUEUE_SPSC_MAX_CAPACITY 0x80000000u
+
+struct CircularQueueSPSC
+{
+	/* Written once in CreateQueue, then only read, so both threads can share this line. */
+	union
+	{
+		struct
+		{
+			void** internalQueue;
+			unsigned int maxSize;
+			unsigned int indexMask;
+		} values;
+		char padding[CIRCULAR_QUEUE_SPSC_CACHE_LINE_SIZE];
+	} shared;
+
+	/* Only the producer writes here. */
+	union
+	{
+		struct
+		{
+			CircularQueueSPSCIndex tailIndex;
+			unsigned int cachedHeadIndex;
+			CircularQueueSPSCIndex numberOfOverflows;
+		} values;
+		char padding[CIRCULAR_QUEUE_SPSC_CACHE_LINE_SIZE];
+	} producer;
+
+	/* Only the consumer writes here. */
+	union
+	{
+		struct
+		{
+			CircularQueueSPSCIndex headIndex;
+			unsigned int cachedTailIndex;
+		} values;
+		char padding[CIRCULAR_QUEUE_SPSC_CACHE_LINE_SIZE];
+	} consumer;
+};
+
+
+CircularQueueSPSC* CircularQueueSPSC_CreateQueue(unsigned int max_size)
+{
+	CircularQueueSPSC* ret_ptr;
+	unsigned int the_capacity = 1;
+
+	if((max_size < 1) || (max_size > CIRCULAR_QUEUE_SPSC_MAX_CAPACITY))
+	{
+		return NULL;
+	}
+	while(the_capacity < max_size)
+	{
+		the_capacity <<= 1;
+	}
+
+	ret_ptr = (CircularQueueSPSC*)calloc(1, sizeof(CircularQueueSPSC));
+	if(NULL == ret_ptr)
+	{
+		/* Out of memory */
+		return NULL;
+	}
+	ret_ptr->shared.values.internalQueue = (void**)malloc(sizeof(void*) * the_capacity);
+	if(NULL == ret_ptr->shared.values.internalQueue)
+	{
+		/* Out of memory */
+		free(ret_ptr);
+		return NULL;
+	}
+	ret_ptr->shared.values.maxSize = the_capacity;
+	ret_ptr->shared.values.indexMask = the_capacity - 1;
+	CIRCULAR_QUEUE_SPSC_STORE_RELAXED(&ret_ptr->producer.values.tailIndex, 0);
+	CIRCULAR_QUEUE_SPSC_STORE_RELAXED(&ret_ptr->producer.values.numberOfOverflows, 0);
+	ret_ptr->producer.values.cachedHeadIndex = 0;
+	CIRCULAR_QUEUE_SPSC_STORE_RELAXED(&ret_ptr->consumer.values.headIndex, 0);
+	ret_ptr->consumer.values.cachedTailIndex = 0;
+
+	return ret_ptr;
+}
+
+void CircularQueueSPSC_FreeQueue(CircularQueueSPSC* queue)
+{
+	if(NULL == queue)
+	{
+		return;
+	}
+	free(queue->shared.values.internalQueue);
+	free(queue);
+}
+
+unsigned int CircularQueueSPSC_PushBack(CircularQueueSPSC* queue, void* value)
+{
+	unsigned int tail_index;
+	if(NULL == queue)
+	{
+		return 0;
+	}
+	/* Our own index, so no ordering needed. */
+	tail_index = CIRCULAR_QUEUE_SPSC_LOAD_RELAXED(&queue->producer.values.tailIndex);
+	if(tail_index - queue->producer.values.cachedHeadIndex >= queue->shared.values.maxSize)
+	{
+		/* Looks full. Acquire pairs with the consumer's release so we don't overwrite a slot it is still reading. */
+		queue->producer.values.cachedHeadIndex = CIRCULAR_QUEUE_SPSC_LOAD_ACQUIRE(&queue->consumer.values.headIndex);
+		if(tail_index - queue->producer.values.cachedHeadIndex >= queue->shared.values.maxSize)
+		{
+			/* Only the producer writes this, so a load and store is enough. */
+			CIRCULAR_QUEUE_SPSC_STORE_RELAXED(&queue->producer.values.numberOfOverflows, CIRCULAR_QUEUE_SPSC_LOAD_RELAXED(&queue->producer.values.numberOfOverflows) + 1);
+			return 0;
+		}
+	}
+	queue->shared.values.internalQueue[tail_index & queue->shared.values.indexMask] = value;
+	/* Release publishes the slot write above before the consumer can see the new tail. */
+	CIRCULAR_QUEUE_SPSC_STORE_RELEASE(&queue->producer.values.tailIndex, tail_index + 1);
+	return 1;
+}
+
+/* Returns how many values the consumer can see, refreshing the cached tail only when the cache says there are none. */
+static unsigned int CircularQueueSPSC_ConsumerAvailable(CircularQueueSPSC* queue, unsigned int head_index)
+{
+	unsigned int number_available = queue->consumer.values.cachedTailIndex - head_index;
+	if(0 == number_available)
+	{
+		/* Acquire pairs with the producer's release so the slot contents are visible. */
+		queue->consumer.values.cachedTailIndex = CIRCULAR_QUEUE_SPSC_LOAD_ACQUIRE(&queue->producer.values.tailIndex);
+		number_available = queue->consumer.values.cachedTailIndex - head_index;
+	}
+	return number_available;
+}
+
+unsigned int CircularQueueSPSC_TryPopFront(CircularQueueSPSC* queue, void** out_value)
+{
+	unsigned int head_index;
+	if(NULL == queue)
+	{
+		return 0;
+	}
+	head_index = CIRCULAR_QUEUE_SPSC_LOAD_RELAXED(&queue->consumer.values.headIndex);
+	if(0 == CircularQueueSPSC_ConsumerAvailable(queue, head_index))
+	{
+		return 0;
+	}
+	if(NULL != out_value)
+	{
+		*out_value = queue->shared.values.internalQueue[head_index & queue->shared.values.indexMask];
+	}
+	/* Release so the read above is done before the producer may reuse the slot. */
+	CIRCULAR_QUEUE_SPSC_STORE_RELEASE(&queue->consumer.values.headIndex, head_index + 1);
+	return 1;
+}
+
+unsigned int CircularQueueSPSC_PopFront(CircularQueueSPSC* queue)
+{
+	return CircularQueueSPSC_TryPopFront(queue, NULL);
+}
+
+void* CircularQueueSPSC_Front(CircularQueueSPSC* queue)
+{
+	unsigned int head_index;
+	if(NULL == queue)
+	{
+		return NULL;
+	}
+	head_index = CIRCULAR_QUEUE_SPSC_LOAD_RELAXED(&queue->consumer.values.headIndex);
+	if(0 == CircularQueueSPSC_ConsumerAvailable(queue, head_index))
+	{
+		return NULL;
+	}
+	return queue->shared.values.internalQueue[head_index & queue->shared.values.indexMask];
+}
+
+unsigned int CircularQueueSPSC_Size(CircularQueueSPSC* queue)
+{
+	unsigned int head_index;
+	unsigned int tail_index;
+	if(NULL == queue)
+	{
+		return 0;
+	}
+	/* Head first: it only grows toward tail, so a later tail can't make the difference go negative. */
+	head_index = CIRCULAR_QUEUE_SPSC_LOAD_ACQUIRE(&queue->consumer.values.headIndex);
+	tail_index = CIRCULAR_QUEUE_SPSC_LOAD_ACQUIRE(&queue->producer.values.tailIndex);
+	return tail_index - head_index;
+}
+
+unsigned int CircularQueueSPSC_MaxSize(CircularQueueSPSC* queue)
+{
+	if(NULL == queue)
+	{
+		return 0;
+	}
+	return queue->shared.values.maxSize;
+}
+
+void CircularQueueSPSC_Clear(CircularQueueSPSC* queue)
+{
+	unsigned int tail_index;
+	if(NULL == queue)
+	{
+		return;
+	}
+	tail_index = CIRCULAR_QUEUE_SPSC_LOAD_ACQUIRE(&queue->producer.values.tailIndex);
+	queue->consumer.values.cachedTailIndex = tail_index;
+	CIRCULAR_QUEUE_SPSC_STORE_RELEASE(&queue->consumer.values.headIndex, tail_index);
+}
+
+void* CircularQueueSPSC_ValueAtIndex(CircularQueueSPSC* queue, unsigned int the_index)
+{
+	unsigned int head_index;
+	if(NULL == queue)
+	{
+		return NULL;
+	}
+	head_index = CIRCULAR_QUEUE_SPSC_LOAD_RELAXED(&queue->consumer.values.headIndex);
+	if(the_index >= queue->consumer.values.cachedTailIndex - head_index)
+	{
+		queue->consumer.values.cachedTailIndex = CIRCULAR_QUEUE_SPSC_LOAD_ACQUIRE(&queue->producer.values.tailIndex);
+		if(the_index >= queue->consumer.values.cachedTailIndex - head_index)
+		{
+			return NULL;
+		}
+	}
+	return queue->shared.values.internalQueue[(head_index + the_index) & queue->shared.values.indexMask];
+}
+
+unsigned int CircularQueueSPSC_GetNumberOfOverflows(CircularQueueSPSC* queue)
+{
+	if(NULL == queue)
+	{
+		return 0;
+	}
+	return CIRCULAR_QUEUE_SPSC_LOAD_RELAXED(&queue->producer.values.numberOfOverflows);
+}
@@ -0,0 +1,244 @@
+#ifndef C_CIRCULAR_QUEUE_SPSC_H
+#define C_CIRCULAR_QUEUE_SPSC_H
+
+/* Set up for C function definitions, even when using C++ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef DOXYGEN_SHOULD_IGNORE_THIS
+/** @cond DOXYGEN_SHOULD_IGNORE_THIS */
+
+/* Note: For Doxygen to produce clean output, you should set the 
+ * PREDEFINED option to remove C_CIRCULAR_QUEUE_SPSC_DECLSPEC, C_CIRCULAR_QUEUE_SPSC_CALL, and
+ * the DOXYGEN_SHOULD_IGNORE_THIS blocks.
+ * PREDEFINED = DOXYGEN_SHOULD_IGNORE_THIS=1 C_CIRCULAR_QUEUE_SPSC_DECLSPEC= C_CIRCULAR_QUEUE_SPSC_CALL=
+ */
+
+/** Windows needs to know explicitly which functions to export in a DLL. */
+#if defined(_WIN32)
+	#if defined(C_CIRCULAR_QUEUE_SPSC_BUILD_LIBRARY)
+		#define C_CIRCULAR_QUEUE_SPSC_DECLSPEC __declspec(dllexport)
+	#else
+		#define C_CIRCULAR_QUEUE_SPSC_DECLSPEC
+	#endif
+#else
+	#if defined(C_CIRCULAR_QUEUE_SPSC_BUILD_LIBRARY)
+		#if defined (__GNUC__) && __GNUC__ >= 4
+			#define C_CIRCULAR_QUEUE_SPSC_DECLSPEC __attribute__((visibility("default")))
+		#else
+			#define C_CIRCULAR_QUEUE_SPSC_DECLSPEC
+		#endif
+	#else
+		#define C_CIRCULAR_QUEUE_SPSC_DECLSPEC
+	#endif
+#endif
+
+/* For Windows, by default, use the C calling convention */
+#if defined(_WIN32)
+	#define C_CIRCULAR_QUEUE_SPSC_CALL __cdecl
+#else
+	#define C_CIRCULAR_QUEUE_SPSC_CALL
+#endif
+
+/** @endcond DOXYGEN_SHOULD_IGNORE_THIS */
+#endif /* DOXYGEN_SHOULD_IGNORE_THIS */
+
+
+
+/* Uses the same optional rename as CircularQueue.h, e.g. -DCIRCULAR_QUEUE_NAMESPACE_PREFIX=Flappy */
+#if defined(CIRCULAR_QUEUE_NAMESPACE_PREFIX)
+	#define CIRCULAR_QUEUE_SPSC_RENAME_PUBLIC_SYMBOL_WITH_NAMESPACE(namespace, symbol) namespace##symbol
+	#define CIRCULAR_QUEUE_SPSC_RENAME_PUBLIC_SYMBOL(symbol) CIRCULAR_QUEUE_SPSC_RENAME_PUBLIC_SYMBOL_WITH_NAMESPACE(CIRCULAR_QUEUE_NAMESPACE_PREFIX, symbol)
+
+	#define CircularQueueSPSC_CreateQueue			CIRCULAR_QUEUE_SPSC_RENAME_PUBLIC_SYMBOL(CircularQueueSPSC_CreateQueue)
+	#define CircularQueueSPSC_FreeQueue				CIRCULAR_QUEUE_SPSC_RENAME_PUBLIC_SYMBOL(CircularQueueSPSC_FreeQueue)
+	#define CircularQueueSPSC_PushBack				CIRCULAR_QUEUE_SPSC_RENAME_PUBLIC_SYMBOL(CircularQueueSPSC_PushBack)
+	#define CircularQueueSPSC_PopFront				CIRCULAR_QUEUE_SPSC_RENAME_PUBLIC_SYMBOL(CircularQueueSPSC_PopFront)
+	#define CircularQueueSPSC_TryPopFront			CIRCULAR_QUEUE_SPSC_RENAME_PUBLIC_SYMBOL(CircularQueueSPSC_TryPopFront)
+	#define CircularQueueSPSC_Front					CIRCULAR_QUEUE_SPSC_RENAME_PUBLIC_SYMBOL(CircularQueueSPSC_Front)
+	#define CircularQueueSPSC_Size					CIRCULAR_QUEUE_SPSC_RENAME_PUBLIC_SYMBOL(CircularQueueSPSC_Size)
+	#define CircularQueueSPSC_MaxSize				CIRCULAR_QUEUE_SPSC_RENAME_PUBLIC_SYMBOL(CircularQueueSPSC_MaxSize)
+	#define CircularQueueSPSC_Clear					CIRCULAR_QUEUE_SPSC_RENAME_PUBLIC_SYMBOL(CircularQueueSPSC_Clear)
+	#define CircularQueueSPSC_ValueAtIndex			CIRCULAR_QUEUE_SPSC_RENAME_PUBLIC_SYMBOL(CircularQueueSPSC_ValueAtIndex)
+	#define CircularQueueSPSC_GetNumberOfOverflows	CIRCULAR_QUEUE_SPSC_RENAME_PUBLIC_SYMBOL(CircularQueueSPSC_GetNumberOfOverflows)
+#endif /* defined(CIRCULAR_QUEUE_NAMESPACE_PREFIX) */
+
+
+/**
+ * @file
+ * CircularQueueSPSC is a lock-free version of CircularQueueVoid for handing void* values
+ * from exactly one producer thread to exactly one consumer thread (e.g. input -> simulation,
+ * or simulation -> audio) without a mutex.
+ *
+ * The differences from CircularQueueVoid:
+ * - The head and tail are free running C11 atomics (acquire/release) on separate cache lines,
+ *   and there is no shared currentSize counter for both threads to fight over.
+ * - The capacity is rounded up to a power of two so wrapping is a mask instead of a compare or modulo.
+ * - A full queue makes PushBack return 0 and bumps an overflow counter. It never prints.
+ * - Only the back can be pushed and only the front can be popped, so there is no
+ *   PushFront, PopBack, Back or Print.
+ *
+ * Which thread may call what:
+ * - Producer: PushBack.
+ * - Consumer: PopFront, TryPopFront, Front, ValueAtIndex, Clear.
+ * - Either thread: Size, MaxSize, GetNumberOfOverflows. (Size is a snapshot and may be stale
+ *   by the time you look at it.)
+ * - Neither thread may be using the queue during CreateQueue/FreeQueue.
+ *
+ * Example Usage:
+ * @code
+ *	// input thread
+ *	if(0 == CircularQueueSPSC_PushBack(input_queue, the_event))
+ *	{
+ *		// full: drop it (or retry next time)
+ *	}
+ *
+ *	// simulation thread
+ *	void* the_event;
+ *	while(CircularQueueSPSC_TryPopFront(input_queue, &the_event))
+ *	{
+ *		HandleEvent(the_event);
+ *	}
+ * @endcode
+ */
+
+/**
+ * The queue object. The layout lives in CircularQueueSPSC.c so this header
+ * does not need <stdatomic.h> (which C++ and older MSVC C compilers can't include).
+ */
+typedef struct CircularQueueSPSC CircularQueueSPSC;
+
+/**
+ * This creates a new CircularQueueSPSC instance.
+ *
+ * @note The queue cannot be resized.
+ *
+ * @param max_size The minimum number of elements the queue must hold.
+ * This is rounded up to the next power of two (and must be at most 2^31).
+ *
+ * @return Returns a pointer to the new queue, or NULL on failure.
+ *
+ * @see CircularQueueSPSC_FreeQueue
+ */
+extern C_CIRCULAR_QUEUE_SPSC_DECLSPEC CircularQueueSPSC* C_CIRCULAR_QUEUE_SPSC_CALL CircularQueueSPSC_CreateQueue(unsigned int max_size);
+
+/**
+ * This destroys a CircularQueueSPSC instance.
+ * Both threads must be done with the queue.
+ *
+ * @param queue The pointer to the queue. NULL is ignored.
+ *
+ * @see CircularQueueSPSC_CreateQueue
+ */
+extern C_CIRCULAR_QUEUE_SPSC_DECLSPEC void C_CIRCULAR_QUEUE_SPSC_CALL CircularQueueSPSC_FreeQueue(CircularQueueSPSC* queue);
+
+/**
+ * (Producer only.) This pushes a new value into the back of the queue.
+ * If the queue is full, the function fails, counts an overflow and returns 0.
+ *
+ * @param queue The pointer to the queue.
+ * @param value The value you want to push into the queue.
+ *
+ * @return Returns 1 on success, or 0 on failure.
+ *
+ * @see CircularQueueSPSC_GetNumberOfOverflows
+ */
+extern C_CIRCULAR_QUEUE_SPSC_DECLSPEC unsigned int C_CIRCULAR_QUEUE_SPSC_CALL CircularQueueSPSC_PushBack(CircularQueueSPSC* queue, void* value);
+
+/**
+ * (Consumer only.) This removes the value at the front of the queue.
+ * Like CircularQueueVoid_PopFront, this returns an error flag and not the value,
+ * so call Front() first if you need it (or use TryPopFront to do both at once).
+ *
+ * @param queue The pointer to the queue.
+ *
+ * @return Returns 1 on success, or 0 if the queue is empty.
+ *
+ * @see CircularQueueSPSC_Front
+ * @see CircularQueueSPSC_TryPopFront
+ */
+extern C_CIRCULAR_QUEUE_SPSC_DECLSPEC unsigned int C_CIRCULAR_QUEUE_SPSC_CALL CircularQueueSPSC_PopFront(CircularQueueSPSC* queue);
+
+/**
+ * (Consumer only.) This copies the value at the front of the queue into out_value and removes it.
+ * This only touches the producer's index once, so it is the one to use in drain loops.
+ *
+ * @param queue The pointer to the queue.
+ * @param out_value Where to put the value. Left untouched if the queue is empty.
+ *
+ * @return Returns 1 on success, or 0 if the queue is empty.
+ */
+extern C_CIRCULAR_QUEUE_SPSC_DECLSPEC unsigned int C_CIRCULAR_QUEUE_SPSC_CALL CircularQueueSPSC_TryPopFront(CircularQueueSPSC* queue, void** out_value);
+
+/**
+ * (Consumer only.) This gets the value at the front of the queue.
+ * If the queue is empty, the value returned will be NULL.
+ * As with CircularQueueVoid_Front, NULL is ambiguous if you push NULLs.
+ *
+ * @param queue The pointer to the queue.
+ *
+ * @return Returns the value at the front of the queue or NULL if the queue is empty.
+ */
+extern C_CIRCULAR_QUEUE_SPSC_DECLSPEC void* C_CIRCULAR_QUEUE_SPSC_CALL CircularQueueSPSC_Front(CircularQueueSPSC* queue);
+
+/**
+ * This gets the current number of entries that are in the queue.
+ * When called while the other thread is active, this is only a snapshot.
+ *
+ * @param queue The pointer to the queue.
+ *
+ * @return Returns the number of entries currently in queue, or 0 if there is an error.
+ */
+extern C_CIRCULAR_QUEUE_SPSC_DECLSPEC unsigned int C_CIRCULAR_QUEUE_SPSC_CALL CircularQueueSPSC_Size(CircularQueueSPSC* queue);
+
+/**
+ * This gets the maximum number of entries that are allowed in the queue at a given time.
+ * This is the max_size passed to CreateQueue rounded up to a power of two.
+ *
+ * @param queue The pointer to the queue.
+ *
+ * @return Returns the maximum number of entries allowed in the queue.
+ */
+extern C_CIRCULAR_QUEUE_SPSC_DECLSPEC unsigned int C_CIRCULAR_QUEUE_SPSC_CALL CircularQueueSPSC_MaxSize(CircularQueueSPSC* queue);
+
+/**
+ * (Consumer only.) This empties the queue by dropping everything the producer has pushed so far.
+ * Values pushed concurrently may or may not survive.
+ *
+ * @param queue The pointer to the queue.
+ */
+extern C_CIRCULAR_QUEUE_SPSC_DECLSPEC void C_CIRCULAR_QUEUE_SPSC_CALL CircularQueueSPSC_Clear(CircularQueueSPSC* queue);
+
+/**
+ * (Consumer only.) This returns the element located at the specified index,
+ * where index=0 represents the front of the queue.
+ * Unlike CircularQueueVoid_ValueAtIndex this is a mask, not a modulo.
+ *
+ * @param queue The pointer to the queue.
+ * @param the_index The index of the element you want, from 0 to Size-1.
+ *
+ * @return Returns the element on success, or NULL if the index is out of range.
+ */
+extern C_CIRCULAR_QUEUE_SPSC_DECLSPEC void* C_CIRCULAR_QUEUE_SPSC_CALL CircularQueueSPSC_ValueAtIndex(CircularQueueSPSC* queue, unsigned int the_index);
+
+/**
+ * This gets how many PushBack calls have failed because the queue was full.
+ * This is the quiet replacement for printing on overflow; poll it from a debug overlay or log it at shutdown.
+ *
+ * @param queue The pointer to the queue.
+ *
+ * @return Returns the number of failed pushes since the queue was created.
+ */
+extern C_CIRCULAR_QUEUE_SPSC_DECLSPEC unsigned int C_CIRCULAR_QUEUE_SPSC_CALL CircularQueueSPSC_GetNumberOfOverflows(CircularQueueSPSC* queue);
+
+
+
+/* Ends C function definitions when using C++ */
+#ifdef __cplusplus
+}
+#endif
+
+
+
+#endif /* C_CIRCULAR_QUEUE_SPSC_H */
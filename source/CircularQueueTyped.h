@@ -0,0 +1,414 @@
+#ifndef C_CIRCULAR_QUEUE_TYPED_H
+#define C_CIRCULAR_QUEUE_TYPED_H
+
+#include <stddef.h> /* for NULL */
+#include <stdlib.h> /* for malloc/free */
+#include <string.h> /* for memcpy */
+
+/* Set up for C function definitions, even when using C++ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef DOXYGEN_SHOULD_IGNORE_THIS
+/** @cond DOXYGEN_SHOULD_IGNORE_THIS */
+
+/* Older MSVC only knows inline as __inline in C mode. */
+#if defined(_MSC_VER) && !defined(__cplusplus)
+	#define CIRCULAR_QUEUE_TYPED_INLINE __inline
+#else
+	#define CIRCULAR_QUEUE_TYPED_INLINE inline
+#endif
+
+/* Keeps the rarely taken grow path out of the inlined push. It is marked unused since most queues never call it. */
+#if defined(__GNUC__)
+	#define CIRCULAR_QUEUE_TYPED_COLD_STATIC static __attribute__((noinline, cold, unused))
+	#define CIRCULAR_QUEUE_TYPED_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#elif defined(_MSC_VER)
+	#define CIRCULAR_QUEUE_TYPED_COLD_STATIC static __declspec(noinline)
+	#define CIRCULAR_QUEUE_TYPED_UNLIKELY(x) (x)
+#else
+	#define CIRCULAR_QUEUE_TYPED_COLD_STATIC static CIRCULAR_QUEUE_TYPED_INLINE
+	#define CIRCULAR_QUEUE_TYPED_UNLIKELY(x) (x)
+#endif
+
+/** @endcond DOXYGEN_SHOULD_IGNORE_THIS */
+#endif /* DOXYGEN_SHOULD_IGNORE_THIS */
+
+
+/**
+ * @file
+ * CircularQueueTyped is a header-only, type-generic version of CircularQueue.
+ * CIRCULAR_QUEUE_TYPED_DEFINE(queue_name, element_type) generates a struct named queue_name
+ * and a set of static inline queue_name_* functions that store element_type by value
+ * in one contiguous array.
+ *
+ * The differences from CircularQueueUnsignedInt/CircularQueueVoid:
+ * - Everything is inlined, so a loop over the queue compiles down to array indexing.
+ * - The capacity is rounded up to a power of two, and headIndex/tailIndex are free running
+ *   counters that are masked on access, so there is no modulo, no wrap compare and no currentSize.
+ * - The queue struct is meant to be embedded (e.g. in struct FlappyWorld) and set up with
+ *   _Init/_Destroy instead of being allocated by CreateQueue/FreeQueue.
+ * - Front, Back and AtIndex return a pointer to the element in place (NULL if empty)
+ *   instead of a copy, so a legitimate 0 can't be confused with an error.
+ * - A full queue makes PushBack/PushFront return 0. It never prints.
+ * - The queue can also grow: PushBackGrow and Reserve double the capacity as needed,
+ *   so a queue that has reached its working size never allocates again.
+ *
+ * Example Usage:
+ * @code
+ *	CIRCULAR_QUEUE_TYPED_DEFINE(PointQueue, SDL_Point)
+ *
+ *	PointQueue my_queue;
+ *	unsigned int i;
+ *	unsigned int number_of_points;
+ *
+ *	if(0 == PointQueue_Init(&my_queue, 16))
+ *	{
+ *		fprintf(stderr, "Error, could not create queue\n");
+ *		return 0;
+ *	}
+ *	PointQueue_PushBack(&my_queue, the_point);
+ *
+ *	number_of_points = PointQueue_Size(&my_queue);
+ *	for(i=0; i<number_of_points; i++)
+ *	{
+ *		SDL_Point* current_point = PointQueue_AtIndex(&my_queue, i);
+ *		...
+ *	}
+ *	PointQueue_Destroy(&my_queue);
+ * @endcode
+ */
+
+/**
+ * Generates the queue_name struct and its static inline functions for element_type.
+ * Use it once per element type, at file scope, where element_type is already defined.
+ *
+ * The generated functions are:
+ * - unsigned int queue_name_Init(queue_name* queue, unsigned int max_size):
+ *   Allocates room for at least max_size elements (rounded up to a power of two, at most 2^31).
+ *   Returns 1 on success, or 0 on failure.
+ * - void queue_name_Destroy(queue_name* queue): Frees the storage. Safe on a zeroed or already destroyed queue.
+ * - unsigned int queue_name_PushBack(queue_name* queue, element_type value): 1 on success, 0 if full.
+ * - unsigned int queue_name_PushFront(queue_name* queue, element_type value): 1 on success, 0 if full.
+ * - unsigned int queue_name_PopFront(queue_name* queue): 1 on success, 0 if empty.
+ * - unsigned int queue_name_PopBack(queue_name* queue): 1 on success, 0 if empty.
+ * - element_type* queue_name_Front(queue_name* queue): The front element in place, or NULL if empty.
+ * - element_type* queue_name_Back(queue_name* queue): The back element in place, or NULL if empty.
+ * - element_type* queue_name_AtIndex(queue_name* queue, unsigned int the_index):
+ *   The element the_index places from the front. This is not bounds checked:
+ *   the_index must be less than Size. This is the one to use in loops.
+ * - element_type* queue_name_ValueAtIndex(queue_name* queue, unsigned int the_index):
+ *   Same as AtIndex, but returns NULL if the_index is out of range.
+ * - unsigned int queue_name_Size(const queue_name* queue): The number of elements in the queue.
+ * - unsigned int queue_name_MaxSize(const queue_name* queue): The (rounded up) capacity.
+ * - void queue_name_Clear(queue_name* queue): Empties the queue without freeing anything.
+ * - unsigned int queue_name_GetSpans(queue_name* queue, element_type** out_first, unsigned int* out_first_count,
+ *   element_type** out_second, unsigned int* out_second_count):
+ *   Describes the live elements, front to back, as at most two contiguous arrays: the run from the front
+ *   to the end of the storage, then (if the queue wraps) the run from the start of the storage.
+ *   out_second_count is 0 when the queue doesn't wrap. Returns Size.
+ *   The spans stay valid until the next push or pop.
+ * - unsigned int queue_name_PushBackN(queue_name* queue, const element_type* values, unsigned int count):
+ *   Copies as many of values as fit onto the back (at most two memcpy's) and returns how many that was.
+ * - unsigned int queue_name_PopFrontN(queue_name* queue, element_type* out_values, unsigned int count):
+ *   Removes up to count elements from the front, copying them into out_values unless it is NULL,
+ *   and returns how many were removed.
+ * - unsigned int queue_name_Reserve(queue_name* queue, unsigned int min_capacity):
+ *   Grows the storage (doubling) until it holds at least min_capacity elements, keeping the contents.
+ *   Works on a zeroed queue that was never Init'ed. Returns 1 on success, or 0 on failure
+ *   (in which case the queue is unchanged).
+ * - unsigned int queue_name_PushBackGrow(queue_name* queue, element_type value):
+ *   PushBack, except a full queue is grown instead of failing. Returns 0 only if out of memory.
+ *
+ * Growing reallocs to the next power of two and "unwraps" in place: if the contents wrapped
+ * around the end of the old storage, the wrapped part is moved to just past the old end,
+ * which always fits because the new storage is at least twice as big.
+ * Element addresses (Front, AtIndex, GetSpans) are invalidated by a grow.
+ *
+ * A loop over the whole queue with GetSpans looks like:
+ * @code
+ *	SDL_Point* first_points;
+ *	SDL_Point* second_points;
+ *	unsigned int number_of_first;
+ *	unsigned int number_of_second;
+ *
+ *	PointQueue_GetSpans(&my_queue, &first_points, &number_of_first, &second_points, &number_of_second);
+ *	for(i=0; i<number_of_first; i++) { first_points[i].x -= scroll_x; }
+ *	for(i=0; i<number_of_second; i++) { second_points[i].x -= scroll_x; }
+ * @endcode
+ *
+ * @note There are no NULL checks on queue; these are meant for hot loops.
+ */
+#define CIRCULAR_QUEUE_TYPED_DEFINE(queue_name, element_type) \
+	typedef struct queue_name \
+	{ \
+		element_type* internalQueue; /* The array representing the queue. */ \
+		unsigned int maxSize; /* Capacity, always a power of two. */ \
+		unsigned int indexMask; /* maxSize-1 */ \
+		unsigned int headIndex; /* Free running index of the front, masked on access. */ \
+		unsigned int tailIndex; /* Free running index one past the back, masked on access. */ \
+	} queue_name; \
+	\
+	static CIRCULAR_QUEUE_TYPED_INLINE unsigned int queue_name##_Init(queue_name* queue, unsigned int max_size) \
+	{ \
+		unsigned int the_capacity = 1; \
+		queue->internalQueue = NULL; \
+		queue->maxSize = 0; \
+		queue->indexMask = 0; \
+		queue->headIndex = 0; \
+		queue->tailIndex = 0; \
+		if((max_size < 1) || (max_size > 0x80000000u)) \
+		{ \
+			return 0; \
+		} \
+		while(the_capacity < max_size) \
+		{ \
+			the_capacity <<= 1; \
+		} \
+		queue->internalQueue = (element_type*)malloc(sizeof(element_type) * the_capacity); \
+		if(NULL == queue->internalQueue) \
+		{ \
+			/* Out of memory */ \
+			return 0; \
+		} \
+		queue->maxSize = the_capacity; \
+		queue->indexMask = the_capacity - 1; \
+		return 1; \
+	} \
+	\
+	static CIRCULAR_QUEUE_TYPED_INLINE void queue_name##_Destroy(queue_name* queue) \
+	{ \
+		free(queue->internalQueue); \
+		queue->internalQueue = NULL; \
+		queue->maxSize = 0; \
+		queue->indexMask = 0; \
+		queue->headIndex = 0; \
+		queue->tailIndex = 0; \
+	} \
+	\
+	static CIRCULAR_QUEUE_TYPED_INLINE unsigned int queue_name##_Size(const queue_name* queue) \
+	{ \
+		return queue->tailIndex - queue->headIndex; \
+	} \
+	\
+	static CIRCULAR_QUEUE_TYPED_INLINE unsigned int queue_name##_MaxSize(const queue_name* queue) \
+	{ \
+		return queue->maxSize; \
+	} \
+	\
+	static CIRCULAR_QUEUE_TYPED_INLINE void queue_name##_Clear(queue_name* queue) \
+	{ \
+		queue->headIndex = queue->tailIndex; \
+	} \
+	\
+	static CIRCULAR_QUEUE_TYPED_INLINE unsigned int queue_name##_PushBack(queue_name* queue, element_type value) \
+	{ \
+		if(queue->tailIndex - queue->headIndex >= queue->maxSize) \
+		{ \
+			return 0; \
+		} \
+		queue->internalQueue[queue->tailIndex & queue->indexMask] = value; \
+		queue->tailIndex++; \
+		return 1; \
+	} \
+	\
+	static CIRCULAR_QUEUE_TYPED_INLINE unsigned int queue_name##_PushFront(queue_name* queue, element_type value) \
+	{ \
+		if(queue->tailIndex - queue->headIndex >= queue->maxSize) \
+		{ \
+			return 0; \
+		} \
+		queue->headIndex--; \
+		queue->internalQueue[queue->headIndex & queue->indexMask] = value; \
+		return 1; \
+	} \
+	\
+	static CIRCULAR_QUEUE_TYPED_INLINE unsigned int queue_name##_PopFront(queue_name* queue) \
+	{ \
+		if(queue->tailIndex == queue->headIndex) \
+		{ \
+			return 0; \
+		} \
+		queue->headIndex++; \
+		return 1; \
+	} \
+	\
+	static CIRCULAR_QUEUE_TYPED_INLINE unsigned int queue_name##_PopBack(queue_name* queue) \
+	{ \
+		if(queue->tailIndex == queue->headIndex) \
+		{ \
+			return 0; \
+		} \
+		queue->tailIndex--; \
+		return 1; \
+	} \
+	\
+	static CIRCULAR_QUEUE_TYPED_INLINE element_type* queue_name##_AtIndex(queue_name* queue, unsigned int the_index) \
+	{ \
+		return &queue->internalQueue[(queue->headIndex + the_index) & queue->indexMask]; \
+	} \
+	\
+	static CIRCULAR_QUEUE_TYPED_INLINE element_type* queue_name##_ValueAtIndex(queue_name* queue, unsigned int the_index) \
+	{ \
+		if(the_index >= queue->tailIndex - queue->headIndex) \
+		{ \
+			return NULL; \
+		} \
+		return queue_name##_AtIndex(queue, the_index); \
+	} \
+	\
+	static CIRCULAR_QUEUE_TYPED_INLINE element_type* queue_name##_Front(queue_name* queue) \
+	{ \
+		if(queue->tailIndex == queue->headIndex) \
+		{ \
+			return NULL; \
+		} \
+		return &queue->internalQueue[queue->headIndex & queue->indexMask]; \
+	} \
+	\
+	static CIRCULAR_QUEUE_TYPED_INLINE element_type* queue_name##_Back(queue_name* queue) \
+	{ \
+		if(queue->tailIndex == queue->headIndex) \
+		{ \
+			return NULL; \
+		} \
+		return &queue->internalQueue[(queue->tailIndex - 1) & queue->indexMask]; \
+	} \
+	\
+	CIRCULAR_QUEUE_TYPED_COLD_STATIC unsigned int queue_name##_Reserve(queue_name* queue, unsigned int min_capacity) \
+	{ \
+		unsigned int the_size = queue->tailIndex - queue->headIndex; \
+		unsigned int old_capacity = queue->maxSize; \
+		unsigned int new_capacity = (old_capacity > 0) ? old_capacity : 8; \
+		unsigned int head_offset; \
+		unsigned int first_count; \
+		element_type* new_queue; \
+		if(min_capacity <= old_capacity) \
+		{ \
+			return 1; \
+		} \
+		if(min_capacity > 0x80000000u) \
+		{ \
+			return 0; \
+		} \
+		while(new_capacity < min_capacity) \
+		{ \
+			new_capacity <<= 1; \
+		} \
+		new_queue = (element_type*)realloc(queue->internalQueue, sizeof(element_type) * new_capacity); \
+		if(NULL == new_queue) \
+		{ \
+			/* Out of memory. realloc left the old storage alone. */ \
+			return 0; \
+		} \
+		/* Unwrap: move the part that wrapped to the start of the old storage to just past its end. */ \
+		head_offset = (old_capacity > 0) ? (queue->headIndex & queue->indexMask) : 0; \
+		first_count = old_capacity - head_offset; \
+		if(the_size > first_count) \
+		{ \
+			memcpy(new_queue + old_capacity, new_queue, sizeof(element_type) * (the_size - first_count)); \
+		} \
+		queue->internalQueue = new_queue; \
+		queue->maxSize = new_capacity; \
+		queue->indexMask = new_capacity - 1; \
+		queue->headIndex = head_offset; \
+		queue->tailIndex = head_offset + the_size; \
+		return 1; \
+	} \
+	\
+	static CIRCULAR_QUEUE_TYPED_INLINE unsigned int queue_name##_PushBackGrow(queue_name* queue, element_type value) \
+	{ \
+		if(CIRCULAR_QUEUE_TYPED_UNLIKELY(queue->tailIndex - queue->headIndex >= queue->maxSize)) \
+		{ \
+			if(0 == queue_name##_Reserve(queue, queue->maxSize + 1)) \
+			{ \
+				return 0; \
+			} \
+		} \
+		queue->internalQueue[queue->tailIndex & queue->indexMask] = value; \
+		queue->tailIndex++; \
+		return 1; \
+	} \
+	\
+	static CIRCULAR_QUEUE_TYPED_INLINE unsigned int queue_name##_GetSpans(queue_name* queue, element_type** out_first, unsigned int* out_first_count, element_type** out_second, unsigned int* out_second_count) \
+	{ \
+		unsigned int the_size = queue->tailIndex - queue->headIndex; \
+		unsigned int head_offset = queue->headIndex & queue->indexMask; \
+		unsigned int first_count = queue->maxSize - head_offset; \
+		if(first_count > the_size) \
+		{ \
+			first_count = the_size; \
+		} \
+		*out_first = queue->internalQueue + head_offset; \
+		*out_first_count = first_count; \
+		*out_second = queue->internalQueue; \
+		*out_second_count = the_size - first_count; \
+		return the_size; \
+	} \
+	\
+	static CIRCULAR_QUEUE_TYPED_INLINE unsigned int queue_name##_PushBackN(queue_name* queue, const element_type* values, unsigned int count) \
+	{ \
+		unsigned int number_free = queue->maxSize - (queue->tailIndex - queue->headIndex); \
+		unsigned int tail_offset = queue->tailIndex & queue->indexMask; \
+		unsigned int first_count; \
+		if(count > number_free) \
+		{ \
+			count = number_free; \
+		} \
+		first_count = queue->maxSize - tail_offset; \
+		if(first_count > count) \
+		{ \
+			first_count = count; \
+		} \
+		if(first_count > 0) \
+		{ \
+			memcpy(queue->internalQueue + tail_offset, values, sizeof(element_type) * first_count); \
+		} \
+		if(count > first_count) \
+		{ \
+			memcpy(queue->internalQueue, values + first_count, sizeof(element_type) * (count - first_count)); \
+		} \
+		queue->tailIndex += count; \
+		return count; \
+	} \
+	\
+	static CIRCULAR_QUEUE_TYPED_INLINE unsigned int queue_name##_PopFrontN(queue_name* queue, element_type* out_values, unsigned int count) \
+	{ \
+		unsigned int the_size = queue->tailIndex - queue->headIndex; \
+		unsigned int head_offset = queue->headIndex & queue->indexMask; \
+		unsigned int first_count; \
+		if(count > the_size) \
+		{ \
+			count = the_size; \
+		} \
+		if(NULL != out_values) \
+		{ \
+			first_count = queue->maxSize - head_offset; \
+			if(first_count > count) \
+			{ \
+				first_count = count; \
+			} \
+			if(first_count > 0) \
+			{ \
+				memcpy(out_values, queue->internalQueue + head_offset, sizeof(element_type) * first_count); \
+			} \
+			if(count > first_count) \
+			{ \
+				memcpy(out_values + first_count, queue->internalQueue, sizeof(element_type) * (count - first_count)); \
+			} \
+		} \
+		queue->headIndex += count; \
+		return count; \
+	}
+
+
+
+/* Ends C function definitions when using C++ */
+#ifdef __cplusplus
+}
+#endif
+
+
+
+#endif /* C_CIRCULAR_QUEUE_TYPED_H */
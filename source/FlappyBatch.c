@@ -0,0 +1,379 @@
+/*
+	FlappyBatch steps many FlappyWorlds at once for training and evaluation.
+	The calling thread plus (number_of_threads-1) SDL threads share the work.
+	Worlds are split into one contiguous range per thread. A thread claims worlds from the
+	front of its own range with an atomic add, and when its range is empty it claims from
+	the other ranges the same way (work stealing). Since claiming is a single atomic add on the
+	range's counter, the owner and any thieves can never step the same world twice.
+	A world's tick only depends on that world and its action, so the result is independent
+	of the thread count and of who stole what.
+	With the native backend, a tick is split into three passes: the workers begin every world's
+	tick and load its bird into a FlappyBirdSoA, the calling thread steps all the birds at once,
+	and then the workers store the birds back and finish the ticks.
+*/
+
+#include "FlappyBatch.h"
+#include "FlappyBirdSoA.h"
+
+
+/* One per thread. nextIndex is hammered by the owner and thieves, so it gets its own cache line too. */
+struct FlappyBatchWorkRange
+{
+	union
+	{
+		struct
+		{
+			SDL_atomic_t nextIndex;
+			Uint32 endIndex;
+		} data;
+		char padding[FLAPPY_BATCH_CACHE_LINE_SIZE];
+	} u;
+};
+
+/* What the workers do with each world they claim. */
+enum FlappyBatchPass
+{
+	FLAPPY_BATCH_PASS_STEP_TICK = 0,
+	FLAPPY_BATCH_PASS_BEGIN_TICK,
+	FLAPPY_BATCH_PASS_FINISH_TICK
+};
+
+struct FlappyBatchWorker
+{
+	struct FlappyBatch* batch;
+	Uint32 workerIndex;
+	SDL_Thread* thread;
+	SDL_sem* startSemaphore;
+};
+
+struct FlappyBatch
+{
+	Uint32 numberOfWorlds;
+	Uint32 numberOfThreads;
+
+	/* Only ever read while stepping. The worlds themselves are cache-line aligned and padded by FlappyWorld_Create. */
+	struct FlappyWorld** worlds;
+	/* The aligned array is carved out of this allocation. */
+	void* rangeAllocation;
+	struct FlappyBatchWorkRange* workRanges;
+
+	struct FlappyBatchWorker* workers;
+	SDL_sem* doneSemaphore;
+	SDL_atomic_t isQuitting;
+
+	/* One lane per world. Only used once FlappyBatch_SetPhysicsBackend picks the native backend. */
+	FlappyBirdSoA* birds;
+	SDL_bool useBirdKernel;
+
+	/* Only valid during FlappyBatch_Step. */
+	const Uint8* currentActions;
+	float* currentObservations;
+	int currentPass;
+};
+
+
+static void* FlappyBatch_AllocateAligned(size_t the_size, void** out_allocation)
+{
+	char* the_allocation = (char*)SDL_calloc(1, the_size + FLAPPY_BATCH_CACHE_LINE_SIZE - 1);
+	*out_allocation = the_allocation;
+	if(NULL == the_allocation)
+	{
+		return NULL;
+	}
+	return (void*)(((uintptr_t)the_allocation + FLAPPY_BATCH_CACHE_LINE_SIZE - 1) & ~(uintptr_t)(FLAPPY_BATCH_CACHE_LINE_SIZE - 1));
+}
+
+/* Claims and steps worlds from one range until it is empty. */
+static void FlappyBatch_DrainWorkRange(struct FlappyBatch* the_batch, struct FlappyBatchWorkRange* the_range)
+{
+	const Uint8* the_actions = the_batch->currentActions;
+	float* the_observations = the_batch->currentObservations;
+	Uint32 end_index = the_range->u.data.endIndex;
+	for(;;)
+	{
+		/* SDL_AtomicAdd returns the value before the add. */
+		Uint32 which_world = (Uint32)SDL_AtomicAdd(&the_range->u.data.nextIndex, 1);
+		if(which_world >= end_index)
+		{
+			break;
+		}
+		switch(the_batch->currentPass)
+		{
+			case FLAPPY_BATCH_PASS_BEGIN_TICK:
+			{
+				FlappyWorld_BeginTick(the_batch->worlds[which_world], (NULL != the_actions) && (FLAPPY_BATCH_ACTION_PRIMARY == the_actions[which_world]));
+				FlappyBirdSoA_LoadFromWorld(the_batch->birds, which_world, the_batch->worlds[which_world]);
+				/* The observation waits for the finish pass. */
+				continue;
+			}
+			case FLAPPY_BATCH_PASS_FINISH_TICK:
+			{
+				FlappyBirdSoA_StoreToWorld(the_batch->birds, which_world, the_batch->worlds[which_world]);
+				FlappyWorld_FinishTick(the_batch->worlds[which_world]);
+				break;
+			}
+			default:
+			{
+				FlappyWorld_StepTick(the_batch->worlds[which_world], (NULL != the_actions) && (FLAPPY_BATCH_ACTION_PRIMARY == the_actions[which_world]));
+				break;
+			}
+		}
+		/* Rows are written by whoever stepped the world, and ranges are contiguous, so threads mostly write their own part of the buffer. */
+		if(NULL != the_observations)
+		{
+			FlappyWorld_WriteObservation(the_batch->worlds[which_world], the_observations + (size_t)which_world * FLAPPY_OBSERVATION_SIZE);
+		}
+	}
+}
+
+static void FlappyBatch_DoWork(struct FlappyBatch* the_batch, Uint32 worker_index)
+{
+	Uint32 i;
+	/* Our own range first, then try to steal from everybody else, starting with our neighbour. */
+	for(i=0; i<the_batch->numberOfThreads; i++)
+	{
+		Uint32 which_range = (worker_index + i) % the_batch->numberOfThreads;
+		FlappyBatch_DrainWorkRange(the_batch, &the_batch->workRanges[which_range]);
+	}
+}
+
+static int FlappyBatch_WorkerThread(void* user_data)
+{
+	struct FlappyBatchWorker* the_worker = (struct FlappyBatchWorker*)user_data;
+	struct FlappyBatch* the_batch = the_worker->batch;
+
+	for(;;)
+	{
+		SDL_SemWait(the_worker->startSemaphore);
+		if(SDL_AtomicGet(&the_batch->isQuitting))
+		{
+			break;
+		}
+		FlappyBatch_DoWork(the_batch, the_worker->workerIndex);
+		SDL_SemPost(the_batch->doneSemaphore);
+	}
+	return 0;
+}
+
+struct FlappyBatch* FlappyBatch_Create(Uint32 number_of_worlds, Uint32 number_of_threads, Uint64 base_seed)
+{
+	struct FlappyBatch* the_batch;
+	Uint32 i;
+
+	if(0 == number_of_worlds)
+	{
+		return NULL;
+	}
+	if(0 == number_of_threads)
+	{
+		number_of_threads = (Uint32)SDL_GetCPUCount();
+	}
+	if(number_of_threads > number_of_worlds)
+	{
+		number_of_threads = number_of_worlds;
+	}
+	if(0 == number_of_threads)
+	{
+		number_of_threads = 1;
+	}
+
+	the_batch = (struct FlappyBatch*)SDL_calloc(1, sizeof(struct FlappyBatch));
+	if(NULL == the_batch)
+	{
+		return NULL;
+	}
+	the_batch->numberOfWorlds = number_of_worlds;
+	the_batch->numberOfThreads = number_of_threads;
+	SDL_AtomicSet(&the_batch->isQuitting, 0);
+
+	the_batch->worlds = (struct FlappyWorld**)SDL_calloc(number_of_worlds, sizeof(struct FlappyWorld*));
+	the_batch->workRanges = (struct FlappyBatchWorkRange*)FlappyBatch_AllocateAligned(number_of_threads * sizeof(struct FlappyBatchWorkRange), &the_batch->rangeAllocation);
+	the_batch->workers = (struct FlappyBatchWorker*)SDL_calloc(number_of_threads, sizeof(struct FlappyBatchWorker));
+	the_batch->doneSemaphore = SDL_CreateSemaphore(0);
+	the_batch->birds = FlappyBirdSoA_Create(number_of_worlds);
+	if((NULL == the_batch->worlds) || (NULL == the_batch->workRanges) || (NULL == the_batch->workers) || (NULL == the_batch->doneSemaphore) || (NULL == the_batch->birds))
+	{
+		FlappyBatch_Free(the_batch);
+		return NULL;
+	}
+
+	for(i=0; i<number_of_worlds; i++)
+	{
+		struct FlappyWorld* the_world = FlappyWorld_Create(base_seed + i);
+		if(NULL == the_world)
+		{
+			FlappyBatch_Free(the_batch);
+			return NULL;
+		}
+		InitTitleScreen(the_world);
+		the_batch->worlds[i] = the_world;
+	}
+
+	/* Worker 0 is whoever calls FlappyBatch_Step, so it doesn't get a thread. */
+	for(i=0; i<number_of_threads; i++)
+	{
+		struct FlappyBatchWorker* the_worker = &the_batch->workers[i];
+		the_worker->batch = the_batch;
+		the_worker->workerIndex = i;
+		if(0 == i)
+		{
+			continue;
+		}
+		the_worker->startSemaphore = SDL_CreateSemaphore(0);
+		if(NULL == the_worker->startSemaphore)
+		{
+			FlappyBatch_Free(the_batch);
+			return NULL;
+		}
+		the_worker->thread = SDL_CreateThread(FlappyBatch_WorkerThread, "FlappyBatch", the_worker);
+		if(NULL == the_worker->thread)
+		{
+			FlappyBatch_Free(the_batch);
+			return NULL;
+		}
+	}
+
+	return the_batch;
+}
+
+void FlappyBatch_Free(struct FlappyBatch* the_batch)
+{
+	Uint32 i;
+	if(NULL == the_batch)
+	{
+		return;
+	}
+
+	if(NULL != the_batch->workers)
+	{
+		SDL_AtomicSet(&the_batch->isQuitting, 1);
+		for(i=1; i<the_batch->numberOfThreads; i++)
+		{
+			struct FlappyBatchWorker* the_worker = &the_batch->workers[i];
+			if(NULL != the_worker->thread)
+			{
+				SDL_SemPost(the_worker->startSemaphore);
+				SDL_WaitThread(the_worker->thread, NULL);
+			}
+			if(NULL != the_worker->startSemaphore)
+			{
+				SDL_DestroySemaphore(the_worker->startSemaphore);
+			}
+		}
+		SDL_free(the_batch->workers);
+	}
+
+	if(NULL != the_batch->worlds)
+	{
+		for(i=0; i<the_batch->numberOfWorlds; i++)
+		{
+			FlappyWorld_Free(the_batch->worlds[i]);
+		}
+		SDL_free(the_batch->worlds);
+	}
+
+	if(NULL != the_batch->doneSemaphore)
+	{
+		SDL_DestroySemaphore(the_batch->doneSemaphore);
+	}
+	FlappyBirdSoA_Free(the_batch->birds);
+	SDL_free(the_batch->rangeAllocation);
+	SDL_free(the_batch);
+}
+
+void FlappyBatch_Step(struct FlappyBatch* the_batch, const Uint8* actions)
+{
+	FlappyBatch_StepAndObserve(the_batch, actions, NULL);
+}
+
+static void FlappyBatch_RunPass(struct FlappyBatch* the_batch, int which_pass)
+{
+	Uint32 i;
+	Uint32 number_of_threads = the_batch->numberOfThreads;
+	Uint32 worlds_per_thread = the_batch->numberOfWorlds / number_of_threads;
+	Uint32 extra_worlds = the_batch->numberOfWorlds % number_of_threads;
+	Uint32 start_index = 0;
+
+	the_batch->currentPass = which_pass;
+
+	/* Split the worlds as evenly as possible. The first extra_worlds ranges get one more. */
+	for(i=0; i<number_of_threads; i++)
+	{
+		Uint32 range_size = worlds_per_thread + ((i < extra_worlds) ? 1 : 0);
+		SDL_AtomicSet(&the_batch->workRanges[i].u.data.nextIndex, (int)start_index);
+		the_batch->workRanges[i].u.data.endIndex = start_index + range_size;
+		start_index += range_size;
+	}
+
+	/* The semaphores give us the memory barriers we need for the ranges and actions. */
+	for(i=1; i<number_of_threads; i++)
+	{
+		SDL_SemPost(the_batch->workers[i].startSemaphore);
+	}
+
+	FlappyBatch_DoWork(the_batch, 0);
+
+	for(i=1; i<number_of_threads; i++)
+	{
+		SDL_SemWait(the_batch->doneSemaphore);
+	}
+}
+
+void FlappyBatch_StepAndObserve(struct FlappyBatch* the_batch, const Uint8* actions, float* out_observations)
+{
+	the_batch->currentActions = actions;
+	the_batch->currentObservations = out_observations;
+
+	if(the_batch->useBirdKernel)
+	{
+		FlappyBatch_RunPass(the_batch, FLAPPY_BATCH_PASS_BEGIN_TICK);
+		/* The begin pass already applied the flaps through Flappy_DoPrimaryAction. */
+		FlappyBirdSoA_Step(the_batch->birds, NULL, (float)(1.0 / FLAPPY_BATCH_TICKS_PER_SECOND), FLAPPY_BIRD_SOA_KERNEL_AUTO);
+		FlappyBatch_RunPass(the_batch, FLAPPY_BATCH_PASS_FINISH_TICK);
+	}
+	else
+	{
+		FlappyBatch_RunPass(the_batch, FLAPPY_BATCH_PASS_STEP_TICK);
+	}
+
+	the_batch->currentActions = NULL;
+	the_batch->currentObservations = NULL;
+}
+
+void FlappyBatch_WriteObservations(struct FlappyBatch* the_batch, float* out_observations)
+{
+	Uint32 i;
+	for(i=0; i<the_batch->numberOfWorlds; i++)
+	{
+		FlappyWorld_WriteObservation(the_batch->worlds[i], out_observations + (size_t)i * FLAPPY_OBSERVATION_SIZE);
+	}
+}
+
+void FlappyBatch_SetPhysicsBackend(struct FlappyBatch* the_batch, int which_backend)
+{
+	Uint32 i;
+	for(i=0; i<the_batch->numberOfWorlds; i++)
+	{
+		FlappyWorld_SetPhysicsBackend(the_batch->worlds[i], which_backend);
+	}
+	the_batch->useBirdKernel = (FLAPPY_PHYSICS_BACKEND_NATIVE == which_backend);
+}
+
+Uint32 FlappyBatch_GetNumberOfWorlds(struct FlappyBatch* the_batch)
+{
+	return the_batch->numberOfWorlds;
+}
+
+Uint32 FlappyBatch_GetNumberOfThreads(struct FlappyBatch* the_batch)
+{
+	return the_batch->numberOfThreads;
+}
+
+struct FlappyWorld* FlappyBatch_GetWorld(struct FlappyBatch* the_batch, Uint32 which_world)
+{
+	if(which_world >= the_batch->numberOfWorlds)
+	{
+		return NULL;
+	}
+	return the_batch->worlds[which_world];
+}
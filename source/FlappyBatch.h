@@ -0,0 +1,136 @@
+#ifndef C_FLAPPY_BATCH_H
+#define C_FLAPPY_BATCH_H
+
+/* Set up for C function definitions, even when using C++ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef DOXYGEN_SHOULD_IGNORE_THIS
+/** @cond DOXYGEN_SHOULD_IGNORE_THIS */
+
+/* Note: For Doxygen to produce clean output, you should set the
+ * PREDEFINED option to remove C_FLAPPY_BATCH_DECLSPEC, C_FLAPPY_BATCH_CALL, and
+ * the DOXYGEN_SHOULD_IGNORE_THIS blocks.
+ * PREDEFINED = DOXYGEN_SHOULD_IGNORE_THIS=1 C_FLAPPY_BATCH_DECLSPEC= C_FLAPPY_BATCH_CALL=
+ */
+
+/** Windows needs to know explicitly which functions to export in a DLL. */
+#if defined(_WIN32)
+	#if defined(C_FLAPPY_BATCH_BUILD_LIBRARY)
+		#define C_FLAPPY_BATCH_DECLSPEC __declspec(dllexport)
+	#else
+		#define C_FLAPPY_BATCH_DECLSPEC
+	#endif
+#else
+	#if defined(C_FLAPPY_BATCH_BUILD_LIBRARY)
+		#if defined (__GNUC__) && __GNUC__ >= 4
+			#define C_FLAPPY_BATCH_DECLSPEC __attribute__((visibility("default")))
+		#else
+			#define C_FLAPPY_BATCH_DECLSPEC
+		#endif
+	#else
+		#define C_FLAPPY_BATCH_DECLSPEC
+	#endif
+#endif
+
+/* For Windows, by default, use the C calling convention */
+#if defined(_WIN32)
+	#define C_FLAPPY_BATCH_CALL __cdecl
+#else
+	#define C_FLAPPY_BATCH_CALL
+#endif
+
+/** @endcond DOXYGEN_SHOULD_IGNORE_THIS */
+#endif /* DOXYGEN_SHOULD_IGNORE_THIS */
+
+#include "SDL.h"
+
+#include "FlappyWorld.h"
+
+/**
+ * @file
+ * FlappyBatch owns N independent FlappyWorlds and steps all of them by one tick per call
+ * on a small pool of worker threads.
+ * Each worker starts on its own contiguous range of worlds and steals from the other
+ * ranges when it runs out, so a few slow worlds (e.g. ones resetting) don't leave cores idle.
+ * Every world only ever reads its own state and its own action, so the results are the same
+ * regardless of how many threads are used or which thread happened to step which world.
+ */
+
+/** The number of FlappyBatch_Step calls per second of game time. Each one advances every world by one physics step. */
+#define FLAPPY_BATCH_TICKS_PER_SECOND FLAPPY_WORLD_TICKS_PER_SECOND
+
+/** State that different threads write is padded to this so it doesn't false-share. */
+#define FLAPPY_BATCH_CACHE_LINE_SIZE FLAPPY_WORLD_CACHE_LINE_SIZE
+
+/**
+ * Values for the actions array passed to FlappyBatch_Step.
+ */
+enum FlappyBatchAction
+{
+	FLAPPY_BATCH_ACTION_NONE = 0, /**< Do nothing this tick. */
+	FLAPPY_BATCH_ACTION_PRIMARY = 1 /**< Same as a tap: Flappy_DoPrimaryAction(). */
+};
+
+struct FlappyBatch;
+typedef struct FlappyBatch FlappyBatch;
+
+/**
+ * Creates number_of_worlds worlds (each put on the title screen) and the worker threads to step them.
+ * @param number_of_worlds The number of worlds. Must be at least 1.
+ * @param number_of_threads The number of threads to step with, including the calling thread.
+ * Pass 0 to use SDL_GetCPUCount(). This is clamped to number_of_worlds.
+ * @param base_seed World i is created with the seed base_seed+i.
+ * @return A new batch or NULL on failure. Free with FlappyBatch_Free.
+ */
+extern C_FLAPPY_BATCH_DECLSPEC struct FlappyBatch* C_FLAPPY_BATCH_CALL FlappyBatch_Create(Uint32 number_of_worlds, Uint32 number_of_threads, Uint64 base_seed);
+
+/**
+ * Stops the worker threads and frees the batch and all its worlds.
+ */
+extern C_FLAPPY_BATCH_DECLSPEC void C_FLAPPY_BATCH_CALL FlappyBatch_Free(struct FlappyBatch* the_batch);
+
+/**
+ * Applies actions[i] to world i and then advances every world by one physics step (1/FLAPPY_BATCH_TICKS_PER_SECOND seconds).
+ * This blocks until all worlds have been stepped. The calling thread does its share of the work.
+ * Any world event callbacks are invoked on the worker threads.
+ * @param actions An array of number_of_worlds FlappyBatchAction values, or NULL for no actions.
+ */
+extern C_FLAPPY_BATCH_DECLSPEC void C_FLAPPY_BATCH_CALL FlappyBatch_Step(struct FlappyBatch* the_batch, const Uint8* actions);
+
+/**
+ * Same as FlappyBatch_Step, but each worker also writes a world's observation into row i of out_observations
+ * right after stepping it, while that world is still in the worker's cache.
+ * @param out_observations A caller-owned array of number_of_worlds * FLAPPY_OBSERVATION_SIZE floats (row-major).
+ */
+extern C_FLAPPY_BATCH_DECLSPEC void C_FLAPPY_BATCH_CALL FlappyBatch_StepAndObserve(struct FlappyBatch* the_batch, const Uint8* actions, float* out_observations);
+
+/**
+ * Writes every world's current observation into out_observations without stepping, e.g. to get the first one after creation.
+ * @param out_observations A caller-owned array of number_of_worlds * FLAPPY_OBSERVATION_SIZE floats (row-major).
+ */
+extern C_FLAPPY_BATCH_DECLSPEC void C_FLAPPY_BATCH_CALL FlappyBatch_WriteObservations(struct FlappyBatch* the_batch, float* out_observations);
+
+/**
+ * Calls FlappyWorld_SetPhysicsBackend on every world.
+ * With FLAPPY_PHYSICS_BACKEND_NATIVE, FlappyBatch_Step moves all the birds together with FlappyBirdSoA
+ * instead of stepping each world's bird on its own. Worlds switched to another backend afterwards with
+ * FlappyWorld_SetPhysicsBackend are simply skipped by the kernel.
+ * @param which_backend One of the FlappyPhysicsBackend values.
+ */
+extern C_FLAPPY_BATCH_DECLSPEC void C_FLAPPY_BATCH_CALL FlappyBatch_SetPhysicsBackend(struct FlappyBatch* the_batch, int which_backend);
+extern C_FLAPPY_BATCH_DECLSPEC Uint32 C_FLAPPY_BATCH_CALL FlappyBatch_GetNumberOfWorlds(struct FlappyBatch* the_batch);
+extern C_FLAPPY_BATCH_DECLSPEC Uint32 C_FLAPPY_BATCH_CALL FlappyBatch_GetNumberOfThreads(struct FlappyBatch* the_batch);
+
+/**
+ * Returns world number which_world. The batch owns it, so don't free it.
+ * Don't touch any world while FlappyBatch_Step is running.
+ */
+extern C_FLAPPY_BATCH_DECLSPEC struct FlappyWorld* C_FLAPPY_BATCH_CALL FlappyBatch_GetWorld(struct FlappyBatch* the_batch, Uint32 which_world);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* C_FLAPPY_BATCH_H */
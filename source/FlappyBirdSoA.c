@@ -0,0 +1,526 @@
+/*
+	Structure-of-arrays bird physics for batches of worlds.
+	There are three implementations of the same step (scalar, SSE2 with 4 lanes, AVX2 with 8 lanes).
+	To keep them bit-identical:
+		- Everything is float and each operation is spelled out in the same order in every path.
+		- Branches in the scalar path become masks and blends in the SIMD paths. Since the masks
+		  select between already computed values, the blends don't change any bits.
+		- min/max are written as (a < b) ? a : b and (a > b) ? a : b, which is exactly what
+		  minps/maxps return.
+	The SIMD paths handle whole groups of lanes and the scalar path finishes the remainder.
+*/
+
+#include <float.h>
+#include <math.h>
+
+#include "FlappyBirdSoA.h"
+
+/* x87 keeps floats in 80-bit registers, so the scalar path would round differently from the SIMD ones. */
+#if defined(FLT_EVAL_METHOD) && (FLT_EVAL_METHOD > 0)
+	#error "FlappyBirdSoA.c must do float math in float precision. On 32-bit x86, build it with -msse2 -mfpmath=sse."
+#endif
+
+#if (defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)) && !defined(FLAPPY_BIRD_SOA_DISABLE_SIMD)
+	#define FLAPPY_BIRD_SOA_HAS_X86_SIMD 1
+	#include <immintrin.h>
+	/* GCC and Clang want to be told which functions may use the wider instructions. MSVC doesn't. */
+	#if defined(__GNUC__) || defined(__clang__)
+		#define FLAPPY_BIRD_SOA_TARGET_SSE2 __attribute__((target("sse2")))
+		#define FLAPPY_BIRD_SOA_TARGET_AVX2 __attribute__((target("avx2")))
+	#else
+		#define FLAPPY_BIRD_SOA_TARGET_SSE2
+		#define FLAPPY_BIRD_SOA_TARGET_AVX2
+	#endif
+#else
+	#define FLAPPY_BIRD_SOA_HAS_X86_SIMD 0
+#endif
+
+/* These mirror Flappy_DoFlap, Flappy_UpdateBirdPositionForGame and the physics shapes, in float. */
+#define SOA_FLAP_VELOCITY ((float)FLAPPY_FLAP_VELOCITY_Y)
+#define SOA_FLAP_ANGLE ((float)M_PI_4)
+#define SOA_FLAP_ANGULAR_VELOCITY (-2.0f)
+#define SOA_DIVE_START_ANGLE ((float)(-M_PI_2/4))
+#define SOA_DIVE_ANGLE ((float)(-M_PI_2))
+#define SOA_DIVE_ANGULAR_VELOCITY (-5.0f)
+#define SOA_BIRD_RADIUS ((float)(BIRD_HEIGHT/2))
+#define SOA_PIPE_HALF_WIDTH ((float)(PIPE_PHYSICS_WIDTH/2))
+#define SOA_SENSOR_OFFSET_X ((float)(PIPE_WIDTH/4))
+#define SOA_SENSOR_HALF_WIDTH ((float)(PIPE_PHYSICS_WIDTH/4.0))
+#define SOA_SCREEN_HEIGHT ((float)SCREEN_HEIGHT)
+#define SOA_GROUND_Y ((float)GROUND_HEIGHT)
+#define SOA_GROUND_REST_Y ((float)(GROUND_HEIGHT + (BIRD_HEIGHT/2)))
+/* Flappy_DoFlap ignores flaps once the top of the sprite is 2 bird heights above the screen.
+	In physics space that is Flappy_lroundf(positionY) <= SCREEN_HEIGHT + BIRD_HEIGHT/2 + 2*BIRD_HEIGHT.
+ */
+#define SOA_FLAP_CEILING_Y ((float)(SCREEN_HEIGHT + (BIRD_HEIGHT/2) + (2*BIRD_HEIGHT)) + 0.5f)
+
+#define SOA_TRUE 0xFFFFFFFFu
+#define SOA_NUMBER_OF_ARRAYS 13
+
+
+FlappyBirdSoA* FlappyBirdSoA_Create(Uint32 number_of_birds)
+{
+	FlappyBirdSoA* the_soa;
+	size_t padded_count = ((number_of_birds + FLAPPY_BIRD_SOA_LANE_PADDING - 1) / FLAPPY_BIRD_SOA_LANE_PADDING) * FLAPPY_BIRD_SOA_LANE_PADDING;
+	size_t array_size = padded_count * sizeof(float);
+	char* aligned_start;
+
+	/* Every entry is 4 bytes, so with padded_count a multiple of 8, every array starts 32-byte aligned. */
+	the_soa = (FlappyBirdSoA*)SDL_calloc(1, sizeof(FlappyBirdSoA));
+	if(NULL == the_soa)
+	{
+		return NULL;
+	}
+	the_soa->allocation = SDL_calloc(1, (SOA_NUMBER_OF_ARRAYS * array_size) + FLAPPY_BIRD_SOA_ALIGNMENT - 1);
+	if(NULL == the_soa->allocation)
+	{
+		SDL_free(the_soa);
+		return NULL;
+	}
+	aligned_start = (char*)(((uintptr_t)the_soa->allocation + FLAPPY_BIRD_SOA_ALIGNMENT - 1) & ~(uintptr_t)(FLAPPY_BIRD_SOA_ALIGNMENT - 1));
+
+	the_soa->numberOfBirds = number_of_birds;
+	the_soa->positionY = (float*)(aligned_start + 0*array_size);
+	the_soa->velocityY = (float*)(aligned_start + 1*array_size);
+	the_soa->angle = (float*)(aligned_start + 2*array_size);
+	the_soa->angularVelocity = (float*)(aligned_start + 3*array_size);
+	the_soa->pipeOffsetX = (float*)(aligned_start + 4*array_size);
+	the_soa->gapBottomY = (float*)(aligned_start + 5*array_size);
+	the_soa->gapTopY = (float*)(aligned_start + 6*array_size);
+	the_soa->isActive = (Uint32*)(aligned_start + 7*array_size);
+	the_soa->isAlive = (Uint32*)(aligned_start + 8*array_size);
+	the_soa->isTouchingPipe = (Uint32*)(aligned_start + 9*array_size);
+	the_soa->isTouchingGround = (Uint32*)(aligned_start + 10*array_size);
+	the_soa->isInScoreSensor = (Uint32*)(aligned_start + 11*array_size);
+	the_soa->score = (Uint32*)(aligned_start + 12*array_size);
+	return the_soa;
+}
+
+void FlappyBirdSoA_Free(FlappyBirdSoA* the_soa)
+{
+	if(NULL == the_soa)
+	{
+		return;
+	}
+	SDL_free(the_soa->allocation);
+	SDL_free(the_soa);
+}
+
+void FlappyBirdSoA_LoadFromWorld(FlappyBirdSoA* the_soa, Uint32 which_bird, struct FlappyWorld* the_world)
+{
+	cpBody* bird_body = the_world->birdModelData.birdBody;
+	cpVect bird_position = cpBodyGetPosition(bird_body);
+	struct PipeModelData* next_pipe;
+
+	the_soa->positionY[which_bird] = (float)bird_position.y;
+	the_soa->velocityY[which_bird] = (float)cpBodyGetVelocity(bird_body).y;
+	the_soa->angle[which_bird] = (float)cpBodyGetAngle(bird_body);
+	the_soa->angularVelocity[which_bird] = (float)cpBodyGetAngularVelocity(bird_body);
+	/* The same cases where Flappy_StepNativePhysics would leave the bird alone. */
+	the_soa->isActive[which_bird] = ((FLAPPY_PHYSICS_BACKEND_NATIVE == the_world->physicsBackend) && cpSpaceContainsBody(the_world->mainSpace, bird_body)) ? SOA_TRUE : 0;
+	the_soa->isAlive[which_bird] = the_world->birdModelData.isDead ? 0 : SOA_TRUE;
+	the_soa->isTouchingPipe[which_bird] = 0;
+	the_soa->isTouchingGround[which_bird] = the_world->isBirdTouchingGround ? SOA_TRUE : 0;
+	the_soa->score[which_bird] = the_world->gameInstanceData.currentScore;
+
+	next_pipe = FlappyWorld_FindNextPipe(the_world, bird_position.x);
+	if(NULL == next_pipe)
+	{
+		/* With no pipe coming up, use one that can never be hit. */
+		the_soa->pipeOffsetX[which_bird] = (float)SCREEN_WIDTH;
+		the_soa->gapBottomY[which_bird] = 0.0f;
+		the_soa->gapTopY[which_bird] = (float)(2*SCREEN_HEIGHT);
+		the_soa->isInScoreSensor[which_bird] = 0;
+	}
+	else
+	{
+		the_soa->pipeOffsetX[which_bird] = (float)(next_pipe->realPositionX - bird_position.x);
+		the_soa->gapBottomY[which_bird] = (float)(next_pipe->lowerRealPositionY + next_pipe->pipeHeight);
+		the_soa->gapTopY[which_bird] = (float)next_pipe->upperRealPositionY;
+		the_soa->isInScoreSensor[which_bird] = (0 != (next_pipe->nativeContactFlags & NATIVE_CONTACT_SCORE_SENSOR)) ? SOA_TRUE : 0;
+	}
+}
+
+void FlappyBirdSoA_StoreToWorld(FlappyBirdSoA* the_soa, Uint32 which_bird, struct FlappyWorld* the_world)
+{
+	FlappyWorldBirdStep the_step;
+
+	if(SOA_TRUE != the_soa->isActive[which_bird])
+	{
+		return;
+	}
+	the_step.positionY = the_soa->positionY[which_bird];
+	the_step.velocityY = the_soa->velocityY[which_bird];
+	the_step.angle = the_soa->angle[which_bird];
+	the_step.angularVelocity = the_soa->angularVelocity[which_bird];
+	the_step.isTouchingPipe = (SOA_TRUE == the_soa->isTouchingPipe[which_bird]) ? SDL_TRUE : SDL_FALSE;
+	the_step.isInScoreSensor = (SOA_TRUE == the_soa->isInScoreSensor[which_bird]) ? SDL_TRUE : SDL_FALSE;
+	the_step.isTouchingGround = (SOA_TRUE == the_soa->isTouchingGround[which_bird]) ? SDL_TRUE : SDL_FALSE;
+	FlappyWorld_SetPresteppedBird(the_world, &the_step);
+}
+
+static void FlappyBirdSoA_StepScalar(FlappyBirdSoA* the_soa, const Uint8* flaps, float delta_seconds, Uint32 start_index, Uint32 end_index)
+{
+	const float gravity_step = (float)FLAPPY_GRAVITY_Y * delta_seconds;
+	const float radius_squared = SOA_BIRD_RADIUS * SOA_BIRD_RADIUS;
+	Uint32 i;
+
+	for(i=start_index; i<end_index; i++)
+	{
+		float position_y;
+		float velocity_y;
+		float angle;
+		float angular_velocity;
+		float pipe_left;
+		float pipe_right;
+		float closest_x;
+		float closest_y;
+		float delta_y;
+		float distance_x_squared;
+		SDL_bool is_alive;
+		SDL_bool is_touching_pipe;
+		SDL_bool is_in_score_sensor;
+		SDL_bool is_touching_ground;
+
+		if(SOA_TRUE != the_soa->isActive[i])
+		{
+			continue;
+		}
+
+		is_alive = (SOA_TRUE == the_soa->isAlive[i]);
+		position_y = the_soa->positionY[i];
+		velocity_y = the_soa->velocityY[i];
+		angle = the_soa->angle[i];
+		angular_velocity = the_soa->angularVelocity[i];
+
+		if((NULL != flaps) && (0 != flaps[i]) && is_alive && (position_y < SOA_FLAP_CEILING_Y))
+		{
+			velocity_y = SOA_FLAP_VELOCITY;
+			angle = SOA_FLAP_ANGLE;
+			angular_velocity = SOA_FLAP_ANGULAR_VELOCITY;
+		}
+
+		/* Move with the old velocity, then collide, then apply gravity (like cpSpaceStep). */
+		position_y = position_y + velocity_y * delta_seconds;
+		angle = angle + angular_velocity * delta_seconds;
+
+		/* The bird is at x=0 in pipe offset space. Clamp that into the pipe's x range. */
+		pipe_left = the_soa->pipeOffsetX[i] - SOA_PIPE_HALF_WIDTH;
+		pipe_right = the_soa->pipeOffsetX[i] + SOA_PIPE_HALF_WIDTH;
+		closest_x = (0.0f < pipe_right) ? 0.0f : pipe_right;
+		closest_x = (pipe_left > closest_x) ? pipe_left : closest_x;
+		distance_x_squared = closest_x * closest_x;
+
+		/* Lower pipe: everything below gapBottomY. */
+		closest_y = (position_y < the_soa->gapBottomY[i]) ? position_y : the_soa->gapBottomY[i];
+		delta_y = position_y - closest_y;
+		is_touching_pipe = (distance_x_squared + delta_y * delta_y) < radius_squared;
+
+		/* Upper pipe: everything above gapTopY. */
+		closest_y = (position_y > the_soa->gapTopY[i]) ? position_y : the_soa->gapTopY[i];
+		delta_y = position_y - closest_y;
+		is_touching_pipe = is_touching_pipe || ((distance_x_squared + delta_y * delta_y) < radius_squared);
+
+		/* The score sensor is a screen-high box a little behind the pipe's center. */
+		pipe_left = (the_soa->pipeOffsetX[i] + SOA_SENSOR_OFFSET_X) - SOA_SENSOR_HALF_WIDTH;
+		pipe_right = (the_soa->pipeOffsetX[i] + SOA_SENSOR_OFFSET_X) + SOA_SENSOR_HALF_WIDTH;
+		closest_x = (0.0f < pipe_right) ? 0.0f : pipe_right;
+		closest_x = (pipe_left > closest_x) ? pipe_left : closest_x;
+		closest_y = (position_y < SOA_SCREEN_HEIGHT) ? position_y : SOA_SCREEN_HEIGHT;
+		closest_y = (0.0f > closest_y) ? 0.0f : closest_y;
+		delta_y = position_y - closest_y;
+		is_in_score_sensor = (closest_x * closest_x + delta_y * delta_y) < radius_squared;
+
+		is_touching_ground = (position_y - SOA_BIRD_RADIUS) < SOA_GROUND_Y;
+
+		velocity_y = velocity_y + gravity_step;
+
+		/* Stop on top of the ground, like the native backend's stand-in for Chipmunk's contact solver. */
+		if(is_touching_ground)
+		{
+			position_y = SOA_GROUND_REST_Y;
+			velocity_y = (velocity_y < 0.0f) ? 0.0f : velocity_y;
+		}
+
+		if((angle < SOA_DIVE_START_ANGLE) && (angle > SOA_DIVE_ANGLE))
+		{
+			angular_velocity = SOA_DIVE_ANGULAR_VELOCITY;
+		}
+		else if(angle <= SOA_DIVE_ANGLE)
+		{
+			angular_velocity = 0.0f;
+			angle = SOA_DIVE_ANGLE;
+		}
+
+		/* Points only count for a live bird entering the sensor. */
+		if(is_alive && is_in_score_sensor && (SOA_TRUE != the_soa->isInScoreSensor[i]))
+		{
+			the_soa->score[i] = the_soa->score[i] + 1;
+		}
+
+		the_soa->positionY[i] = position_y;
+		the_soa->velocityY[i] = velocity_y;
+		the_soa->angle[i] = angle;
+		the_soa->angularVelocity[i] = angular_velocity;
+		the_soa->isTouchingPipe[i] = is_touching_pipe ? SOA_TRUE : 0;
+		the_soa->isTouchingGround[i] = is_touching_ground ? SOA_TRUE : 0;
+		the_soa->isInScoreSensor[i] = is_in_score_sensor ? SOA_TRUE : 0;
+		if(is_touching_pipe || is_touching_ground)
+		{
+			the_soa->isAlive[i] = 0;
+		}
+	}
+}
+
+#if FLAPPY_BIRD_SOA_HAS_X86_SIMD
+
+FLAPPY_BIRD_SOA_TARGET_SSE2
+static __m128 FlappyBirdSoA_BlendSSE2(__m128 if_false, __m128 if_true, __m128 mask)
+{
+	return _mm_or_ps(_mm_and_ps(mask, if_true), _mm_andnot_ps(mask, if_false));
+}
+
+FLAPPY_BIRD_SOA_TARGET_SSE2
+static Uint32 FlappyBirdSoA_StepSSE2(FlappyBirdSoA* the_soa, const Uint8* flaps, float delta_seconds)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 dt = _mm_set1_ps(delta_seconds);
+	const __m128 gravity_step = _mm_set1_ps((float)FLAPPY_GRAVITY_Y * delta_seconds);
+	const __m128 radius = _mm_set1_ps(SOA_BIRD_RADIUS);
+	const __m128 radius_squared = _mm_set1_ps(SOA_BIRD_RADIUS * SOA_BIRD_RADIUS);
+	const __m128 pipe_half_width = _mm_set1_ps(SOA_PIPE_HALF_WIDTH);
+	const __m128 sensor_offset_x = _mm_set1_ps(SOA_SENSOR_OFFSET_X);
+	const __m128 sensor_half_width = _mm_set1_ps(SOA_SENSOR_HALF_WIDTH);
+	const __m128 screen_height = _mm_set1_ps(SOA_SCREEN_HEIGHT);
+	const __m128 ground_y = _mm_set1_ps(SOA_GROUND_Y);
+	const __m128 ground_rest_y = _mm_set1_ps(SOA_GROUND_REST_Y);
+	const __m128 flap_ceiling_y = _mm_set1_ps(SOA_FLAP_CEILING_Y);
+	const __m128 flap_velocity = _mm_set1_ps(SOA_FLAP_VELOCITY);
+	const __m128 flap_angle = _mm_set1_ps(SOA_FLAP_ANGLE);
+	const __m128 flap_angular_velocity = _mm_set1_ps(SOA_FLAP_ANGULAR_VELOCITY);
+	const __m128 dive_start_angle = _mm_set1_ps(SOA_DIVE_START_ANGLE);
+	const __m128 dive_angle = _mm_set1_ps(SOA_DIVE_ANGLE);
+	const __m128 dive_angular_velocity = _mm_set1_ps(SOA_DIVE_ANGULAR_VELOCITY);
+	const __m128i zero_int = _mm_setzero_si128();
+	Uint32 number_of_lanes = the_soa->numberOfBirds & ~(Uint32)3;
+	Uint32 i;
+
+	for(i=0; i<number_of_lanes; i+=4)
+	{
+		__m128 active = _mm_load_ps((const float*)&the_soa->isActive[i]);
+		__m128 alive = _mm_load_ps((const float*)&the_soa->isAlive[i]);
+		__m128 was_in_score_sensor = _mm_load_ps((const float*)&the_soa->isInScoreSensor[i]);
+		__m128 flap = zero;
+		__m128 old_position_y = _mm_load_ps(&the_soa->positionY[i]);
+		__m128 old_velocity_y = _mm_load_ps(&the_soa->velocityY[i]);
+		__m128 old_angle = _mm_load_ps(&the_soa->angle[i]);
+		__m128 old_angular_velocity = _mm_load_ps(&the_soa->angularVelocity[i]);
+		__m128 position_y, velocity_y, angle, angular_velocity;
+		__m128 dive_mask, clamp_mask;
+		__m128 pipe_offset_x, closest_x, distance_x_squared, closest_y, delta_y;
+		__m128 is_touching_pipe, is_in_score_sensor, is_touching_ground, scored;
+
+		if(NULL != flaps)
+		{
+			int four_flaps;
+			__m128i flap_bytes;
+			SDL_memcpy(&four_flaps, &flaps[i], sizeof(four_flaps));
+			flap_bytes = _mm_cvtsi32_si128(four_flaps);
+			flap_bytes = _mm_unpacklo_epi8(flap_bytes, zero_int);
+			flap_bytes = _mm_unpacklo_epi16(flap_bytes, zero_int);
+			flap = _mm_castsi128_ps(_mm_cmpgt_epi32(flap_bytes, zero_int));
+			flap = _mm_and_ps(_mm_and_ps(flap, alive), _mm_cmplt_ps(old_position_y, flap_ceiling_y));
+		}
+
+		velocity_y = FlappyBirdSoA_BlendSSE2(old_velocity_y, flap_velocity, flap);
+		angle = FlappyBirdSoA_BlendSSE2(old_angle, flap_angle, flap);
+		angular_velocity = FlappyBirdSoA_BlendSSE2(old_angular_velocity, flap_angular_velocity, flap);
+
+		position_y = _mm_add_ps(old_position_y, _mm_mul_ps(velocity_y, dt));
+		angle = _mm_add_ps(angle, _mm_mul_ps(angular_velocity, dt));
+
+		pipe_offset_x = _mm_load_ps(&the_soa->pipeOffsetX[i]);
+		closest_x = _mm_min_ps(zero, _mm_add_ps(pipe_offset_x, pipe_half_width));
+		closest_x = _mm_max_ps(_mm_sub_ps(pipe_offset_x, pipe_half_width), closest_x);
+		distance_x_squared = _mm_mul_ps(closest_x, closest_x);
+
+		closest_y = _mm_min_ps(position_y, _mm_load_ps(&the_soa->gapBottomY[i]));
+		delta_y = _mm_sub_ps(position_y, closest_y);
+		is_touching_pipe = _mm_cmplt_ps(_mm_add_ps(distance_x_squared, _mm_mul_ps(delta_y, delta_y)), radius_squared);
+
+		closest_y = _mm_max_ps(position_y, _mm_load_ps(&the_soa->gapTopY[i]));
+		delta_y = _mm_sub_ps(position_y, closest_y);
+		is_touching_pipe = _mm_or_ps(is_touching_pipe, _mm_cmplt_ps(_mm_add_ps(distance_x_squared, _mm_mul_ps(delta_y, delta_y)), radius_squared));
+
+		closest_x = _mm_min_ps(zero, _mm_add_ps(_mm_add_ps(pipe_offset_x, sensor_offset_x), sensor_half_width));
+		closest_x = _mm_max_ps(_mm_sub_ps(_mm_add_ps(pipe_offset_x, sensor_offset_x), sensor_half_width), closest_x);
+		closest_y = _mm_min_ps(position_y, screen_height);
+		closest_y = _mm_max_ps(zero, closest_y);
+		delta_y = _mm_sub_ps(position_y, closest_y);
+		is_in_score_sensor = _mm_cmplt_ps(_mm_add_ps(_mm_mul_ps(closest_x, closest_x), _mm_mul_ps(delta_y, delta_y)), radius_squared);
+
+		is_touching_ground = _mm_cmplt_ps(_mm_sub_ps(position_y, radius), ground_y);
+
+		velocity_y = _mm_add_ps(velocity_y, gravity_step);
+
+		position_y = FlappyBirdSoA_BlendSSE2(position_y, ground_rest_y, is_touching_ground);
+		velocity_y = FlappyBirdSoA_BlendSSE2(velocity_y, zero, _mm_and_ps(is_touching_ground, _mm_cmplt_ps(velocity_y, zero)));
+
+		dive_mask = _mm_and_ps(_mm_cmplt_ps(angle, dive_start_angle), _mm_cmpgt_ps(angle, dive_angle));
+		clamp_mask = _mm_cmple_ps(angle, dive_angle);
+		angular_velocity = FlappyBirdSoA_BlendSSE2(angular_velocity, dive_angular_velocity, dive_mask);
+		angular_velocity = FlappyBirdSoA_BlendSSE2(angular_velocity, zero, clamp_mask);
+		angle = FlappyBirdSoA_BlendSSE2(angle, dive_angle, clamp_mask);
+
+		/* A set mask is -1 as an integer, so subtracting it adds the point. */
+		scored = _mm_andnot_ps(was_in_score_sensor, _mm_and_ps(_mm_and_ps(active, alive), is_in_score_sensor));
+		_mm_store_si128((__m128i*)&the_soa->score[i], _mm_sub_epi32(_mm_load_si128((const __m128i*)&the_soa->score[i]), _mm_castps_si128(scored)));
+
+		/* Inactive lanes keep their old values. */
+		_mm_store_ps(&the_soa->positionY[i], FlappyBirdSoA_BlendSSE2(old_position_y, position_y, active));
+		_mm_store_ps(&the_soa->velocityY[i], FlappyBirdSoA_BlendSSE2(old_velocity_y, velocity_y, active));
+		_mm_store_ps(&the_soa->angle[i], FlappyBirdSoA_BlendSSE2(old_angle, angle, active));
+		_mm_store_ps(&the_soa->angularVelocity[i], FlappyBirdSoA_BlendSSE2(old_angular_velocity, angular_velocity, active));
+		_mm_store_ps((float*)&the_soa->isTouchingPipe[i], FlappyBirdSoA_BlendSSE2(_mm_load_ps((const float*)&the_soa->isTouchingPipe[i]), is_touching_pipe, active));
+		_mm_store_ps((float*)&the_soa->isTouchingGround[i], FlappyBirdSoA_BlendSSE2(_mm_load_ps((const float*)&the_soa->isTouchingGround[i]), is_touching_ground, active));
+		_mm_store_ps((float*)&the_soa->isInScoreSensor[i], FlappyBirdSoA_BlendSSE2(was_in_score_sensor, is_in_score_sensor, active));
+		_mm_store_ps((float*)&the_soa->isAlive[i], _mm_andnot_ps(_mm_and_ps(active, _mm_or_ps(is_touching_pipe, is_touching_ground)), alive));
+	}
+	return number_of_lanes;
+}
+
+FLAPPY_BIRD_SOA_TARGET_AVX2
+static Uint32 FlappyBirdSoA_StepAVX2(FlappyBirdSoA* the_soa, const Uint8* flaps, float delta_seconds)
+{
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 dt = _mm256_set1_ps(delta_seconds);
+	const __m256 gravity_step = _mm256_set1_ps((float)FLAPPY_GRAVITY_Y * delta_seconds);
+	const __m256 radius = _mm256_set1_ps(SOA_BIRD_RADIUS);
+	const __m256 radius_squared = _mm256_set1_ps(SOA_BIRD_RADIUS * SOA_BIRD_RADIUS);
+	const __m256 pipe_half_width = _mm256_set1_ps(SOA_PIPE_HALF_WIDTH);
+	const __m256 sensor_offset_x = _mm256_set1_ps(SOA_SENSOR_OFFSET_X);
+	const __m256 sensor_half_width = _mm256_set1_ps(SOA_SENSOR_HALF_WIDTH);
+	const __m256 screen_height = _mm256_set1_ps(SOA_SCREEN_HEIGHT);
+	const __m256 ground_y = _mm256_set1_ps(SOA_GROUND_Y);
+	const __m256 ground_rest_y = _mm256_set1_ps(SOA_GROUND_REST_Y);
+	const __m256 flap_ceiling_y = _mm256_set1_ps(SOA_FLAP_CEILING_Y);
+	const __m256 flap_velocity = _mm256_set1_ps(SOA_FLAP_VELOCITY);
+	const __m256 flap_angle = _mm256_set1_ps(SOA_FLAP_ANGLE);
+	const __m256 flap_angular_velocity = _mm256_set1_ps(SOA_FLAP_ANGULAR_VELOCITY);
+	const __m256 dive_start_angle = _mm256_set1_ps(SOA_DIVE_START_ANGLE);
+	const __m256 dive_angle = _mm256_set1_ps(SOA_DIVE_ANGLE);
+	const __m256 dive_angular_velocity = _mm256_set1_ps(SOA_DIVE_ANGULAR_VELOCITY);
+	const __m256i zero_int = _mm256_setzero_si256();
+	Uint32 number_of_lanes = the_soa->numberOfBirds & ~(Uint32)7;
+	Uint32 i;
+
+	for(i=0; i<number_of_lanes; i+=8)
+	{
+		__m256 active = _mm256_load_ps((const float*)&the_soa->isActive[i]);
+		__m256 alive = _mm256_load_ps((const float*)&the_soa->isAlive[i]);
+		__m256 was_in_score_sensor = _mm256_load_ps((const float*)&the_soa->isInScoreSensor[i]);
+		__m256 flap = zero;
+		__m256 old_position_y = _mm256_load_ps(&the_soa->positionY[i]);
+		__m256 old_velocity_y = _mm256_load_ps(&the_soa->velocityY[i]);
+		__m256 old_angle = _mm256_load_ps(&the_soa->angle[i]);
+		__m256 old_angular_velocity = _mm256_load_ps(&the_soa->angularVelocity[i]);
+		__m256 position_y, velocity_y, angle, angular_velocity;
+		__m256 dive_mask, clamp_mask;
+		__m256 pipe_offset_x, closest_x, distance_x_squared, closest_y, delta_y;
+		__m256 is_touching_pipe, is_in_score_sensor, is_touching_ground, scored;
+
+		if(NULL != flaps)
+		{
+			__m256i flap_words = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)&flaps[i]));
+			flap = _mm256_castsi256_ps(_mm256_cmpgt_epi32(flap_words, zero_int));
+			flap = _mm256_and_ps(_mm256_and_ps(flap, alive), _mm256_cmp_ps(old_position_y, flap_ceiling_y, _CMP_LT_OQ));
+		}
+
+		velocity_y = _mm256_blendv_ps(old_velocity_y, flap_velocity, flap);
+		angle = _mm256_blendv_ps(old_angle, flap_angle, flap);
+		angular_velocity = _mm256_blendv_ps(old_angular_velocity, flap_angular_velocity, flap);
+
+		position_y = _mm256_add_ps(old_position_y, _mm256_mul_ps(velocity_y, dt));
+		angle = _mm256_add_ps(angle, _mm256_mul_ps(angular_velocity, dt));
+
+		pipe_offset_x = _mm256_load_ps(&the_soa->pipeOffsetX[i]);
+		closest_x = _mm256_min_ps(zero, _mm256_add_ps(pipe_offset_x, pipe_half_width));
+		closest_x = _mm256_max_ps(_mm256_sub_ps(pipe_offset_x, pipe_half_width), closest_x);
+		distance_x_squared = _mm256_mul_ps(closest_x, closest_x);
+
+		closest_y = _mm256_min_ps(position_y, _mm256_load_ps(&the_soa->gapBottomY[i]));
+		delta_y = _mm256_sub_ps(position_y, closest_y);
+		is_touching_pipe = _mm256_cmp_ps(_mm256_add_ps(distance_x_squared, _mm256_mul_ps(delta_y, delta_y)), radius_squared, _CMP_LT_OQ);
+
+		closest_y = _mm256_max_ps(position_y, _mm256_load_ps(&the_soa->gapTopY[i]));
+		delta_y = _mm256_sub_ps(position_y, closest_y);
+		is_touching_pipe = _mm256_or_ps(is_touching_pipe, _mm256_cmp_ps(_mm256_add_ps(distance_x_squared, _mm256_mul_ps(delta_y, delta_y)), radius_squared, _CMP_LT_OQ));
+
+		closest_x = _mm256_min_ps(zero, _mm256_add_ps(_mm256_add_ps(pipe_offset_x, sensor_offset_x), sensor_half_width));
+		closest_x = _mm256_max_ps(_mm256_sub_ps(_mm256_add_ps(pipe_offset_x, sensor_offset_x), sensor_half_width), closest_x);
+		closest_y = _mm256_min_ps(position_y, screen_height);
+		closest_y = _mm256_max_ps(zero, closest_y);
+		delta_y = _mm256_sub_ps(position_y, closest_y);
+		is_in_score_sensor = _mm256_cmp_ps(_mm256_add_ps(_mm256_mul_ps(closest_x, closest_x), _mm256_mul_ps(delta_y, delta_y)), radius_squared, _CMP_LT_OQ);
+
+		is_touching_ground = _mm256_cmp_ps(_mm256_sub_ps(position_y, radius), ground_y, _CMP_LT_OQ);
+
+		velocity_y = _mm256_add_ps(velocity_y, gravity_step);
+
+		position_y = _mm256_blendv_ps(position_y, ground_rest_y, is_touching_ground);
+		velocity_y = _mm256_blendv_ps(velocity_y, zero, _mm256_and_ps(is_touching_ground, _mm256_cmp_ps(velocity_y, zero, _CMP_LT_OQ)));
+
+		dive_mask = _mm256_and_ps(_mm256_cmp_ps(angle, dive_start_angle, _CMP_LT_OQ), _mm256_cmp_ps(angle, dive_angle, _CMP_GT_OQ));
+		clamp_mask = _mm256_cmp_ps(angle, dive_angle, _CMP_LE_OQ);
+		angular_velocity = _mm256_blendv_ps(angular_velocity, dive_angular_velocity, dive_mask);
+		angular_velocity = _mm256_blendv_ps(angular_velocity, zero, clamp_mask);
+		angle = _mm256_blendv_ps(angle, dive_angle, clamp_mask);
+
+		scored = _mm256_andnot_ps(was_in_score_sensor, _mm256_and_ps(_mm256_and_ps(active, alive), is_in_score_sensor));
+		_mm256_store_si256((__m256i*)&the_soa->score[i], _mm256_sub_epi32(_mm256_load_si256((const __m256i*)&the_soa->score[i]), _mm256_castps_si256(scored)));
+
+		_mm256_store_ps(&the_soa->positionY[i], _mm256_blendv_ps(old_position_y, position_y, active));
+		_mm256_store_ps(&the_soa->velocityY[i], _mm256_blendv_ps(old_velocity_y, velocity_y, active));
+		_mm256_store_ps(&the_soa->angle[i], _mm256_blendv_ps(old_angle, angle, active));
+		_mm256_store_ps(&the_soa->angularVelocity[i], _mm256_blendv_ps(old_angular_velocity, angular_velocity, active));
+		_mm256_store_ps((float*)&the_soa->isTouchingPipe[i], _mm256_blendv_ps(_mm256_load_ps((const float*)&the_soa->isTouchingPipe[i]), is_touching_pipe, active));
+		_mm256_store_ps((float*)&the_soa->isTouchingGround[i], _mm256_blendv_ps(_mm256_load_ps((const float*)&the_soa->isTouchingGround[i]), is_touching_ground, active));
+		_mm256_store_ps((float*)&the_soa->isInScoreSensor[i], _mm256_blendv_ps(was_in_score_sensor, is_in_score_sensor, active));
+		_mm256_store_ps((float*)&the_soa->isAlive[i], _mm256_andnot_ps(_mm256_and_ps(active, _mm256_or_ps(is_touching_pipe, is_touching_ground)), alive));
+	}
+	return number_of_lanes;
+}
+
+#endif /* FLAPPY_BIRD_SOA_HAS_X86_SIMD */
+
+void FlappyBirdSoA_Step(FlappyBirdSoA* the_soa, const Uint8* flaps, float delta_seconds, int which_kernel)
+{
+	Uint32 number_done = 0;
+
+#if FLAPPY_BIRD_SOA_HAS_X86_SIMD
+	if(FLAPPY_BIRD_SOA_KERNEL_AUTO == which_kernel)
+	{
+		which_kernel = FLAPPY_BIRD_SOA_KERNEL_AVX2;
+	}
+	if((FLAPPY_BIRD_SOA_KERNEL_AVX2 == which_kernel) && ! SDL_HasAVX2())
+	{
+		which_kernel = FLAPPY_BIRD_SOA_KERNEL_SSE2;
+	}
+	if((FLAPPY_BIRD_SOA_KERNEL_SSE2 == which_kernel) && ! SDL_HasSSE2())
+	{
+		which_kernel = FLAPPY_BIRD_SOA_KERNEL_SCALAR;
+	}
+
+	if(FLAPPY_BIRD_SOA_KERNEL_AVX2 == which_kernel)
+	{
+		number_done = FlappyBirdSoA_StepAVX2(the_soa, flaps, delta_seconds);
+	}
+	else if(FLAPPY_BIRD_SOA_KERNEL_SSE2 == which_kernel)
+	{
+		number_done = FlappyBirdSoA_StepSSE2(the_soa, flaps, delta_seconds);
+	}
+#endif
+
+	/* The scalar path does everything on other CPUs, and the leftover lanes that don't fill a SIMD register. */
+	FlappyBirdSoA_StepScalar(the_soa, flaps, delta_seconds, number_done, the_soa->numberOfBirds);
+}
@@ -0,0 +1,142 @@
+#ifndef C_FLAPPY_BIRD_SOA_H
+#define C_FLAPPY_BIRD_SOA_H
+
+/* Set up for C function definitions, even when using C++ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef DOXYGEN_SHOULD_IGNORE_THIS
+/** @cond DOXYGEN_SHOULD_IGNORE_THIS */
+
+/* Note: For Doxygen to produce clean output, you should set the
+ * PREDEFINED option to remove C_FLAPPY_BIRD_SOA_DECLSPEC, C_FLAPPY_BIRD_SOA_CALL, and
+ * the DOXYGEN_SHOULD_IGNORE_THIS blocks.
+ * PREDEFINED = DOXYGEN_SHOULD_IGNORE_THIS=1 C_FLAPPY_BIRD_SOA_DECLSPEC= C_FLAPPY_BIRD_SOA_CALL=
+ */
+
+/** Windows needs to know explicitly which functions to export in a DLL. */
+#if defined(_WIN32)
+	#if defined(C_FLAPPY_BIRD_SOA_BUILD_LIBRARY)
+		#define C_FLAPPY_BIRD_SOA_DECLSPEC __declspec(dllexport)
+	#else
+		#define C_FLAPPY_BIRD_SOA_DECLSPEC
+	#endif
+#else
+	#if defined(C_FLAPPY_BIRD_SOA_BUILD_LIBRARY)
+		#if defined (__GNUC__) && __GNUC__ >= 4
+			#define C_FLAPPY_BIRD_SOA_DECLSPEC __attribute__((visibility("default")))
+		#else
+			#define C_FLAPPY_BIRD_SOA_DECLSPEC
+		#endif
+	#else
+		#define C_FLAPPY_BIRD_SOA_DECLSPEC
+	#endif
+#endif
+
+/* For Windows, by default, use the C calling convention */
+#if defined(_WIN32)
+	#define C_FLAPPY_BIRD_SOA_CALL __cdecl
+#else
+	#define C_FLAPPY_BIRD_SOA_CALL
+#endif
+
+/** @endcond DOXYGEN_SHOULD_IGNORE_THIS */
+#endif /* DOXYGEN_SHOULD_IGNORE_THIS */
+
+#include "SDL.h"
+
+#include "FlappyWorld.h"
+
+/**
+ * @file
+ * FlappyBirdSoA keeps the bird state of many worlds as a structure of arrays so one
+ * physics step can be done for 8 (AVX2) or 4 (SSE2) birds per instruction.
+ * A step does what Flappy_DoFlap, the native physics backend and Flappy_UpdateBirdPositionForGame do to a
+ * launched bird: apply a flap (unless the bird is above the flap ceiling), move, test the bird against
+ * its next pipe, score sensor and the ground, apply gravity, stop it on the ground, and clamp the nose dive angle.
+ * FlappyBatch uses it for its native backend worlds: LoadFromWorld, one Step for the whole batch, then StoreToWorld,
+ * which leaves the callbacks (crash, score, game over) to the world.
+ *
+ * All math is single precision and every code path performs the same IEEE operations in the
+ * same order, so the SIMD and scalar results are bit-identical. This needs SSE (not x87) scalar
+ * math and no FMA contraction, which is why FlappyBirdSoA.c is built with -ffp-contract=off
+ * (plus -msse2 -mfpmath=sse on 32-bit x86) and refuses to build with excess float precision.
+ * Since it is float and the native backend is double, a world stepped this way is reproducible
+ * (on any kernel and thread count) but not bit-identical to the same world stepped on its own.
+ */
+
+/** The arrays are aligned to this and padded to a multiple of FLAPPY_BIRD_SOA_LANE_PADDING entries. */
+#define FLAPPY_BIRD_SOA_ALIGNMENT 32
+#define FLAPPY_BIRD_SOA_LANE_PADDING 8
+
+/**
+ * Which FlappyBirdSoA_Step implementation to use.
+ */
+enum FlappyBirdSoAKernel
+{
+	FLAPPY_BIRD_SOA_KERNEL_AUTO = 0, /**< The widest one the CPU supports. */
+	FLAPPY_BIRD_SOA_KERNEL_SCALAR,
+	FLAPPY_BIRD_SOA_KERNEL_SSE2,
+	FLAPPY_BIRD_SOA_KERNEL_AVX2
+};
+
+/**
+ * The bird state of numberOfBirds worlds.
+ * Positions are in physics space (y up). pipeOffsetX is the next pipe's center x minus the bird's x,
+ * so the caller moves on to the following pipe once it falls behind the bird (LoadFromWorld does this every tick).
+ * The flags are 0 or 0xFFFFFFFF so they can be used as SIMD masks.
+ * Inactive birds (not launched yet) are left untouched. Dead birds still fall, but can't flap, score or die again.
+ */
+typedef struct FlappyBirdSoA
+{
+	Uint32 numberOfBirds;
+	float* positionY;
+	float* velocityY;
+	float* angle;
+	float* angularVelocity;
+	float* pipeOffsetX;
+	float* gapBottomY;
+	float* gapTopY;
+	Uint32* isActive;
+	Uint32* isAlive;
+	Uint32* isTouchingPipe; /**< Output: overlapping the next pipe after the last step. */
+	Uint32* isTouchingGround; /**< Output: overlapping the ground after the last step (before being stopped on it). */
+	Uint32* isInScoreSensor; /**< Overlapping the next pipe's score sensor. A point is scored when this turns on. */
+	Uint32* score;
+	/* All of the arrays above are carved out of this one allocation. */
+	void* allocation;
+} FlappyBirdSoA;
+
+/**
+ * Allocates zeroed (all dead) state for number_of_birds birds.
+ * @return A new FlappyBirdSoA or NULL on failure. Free with FlappyBirdSoA_Free.
+ */
+extern C_FLAPPY_BIRD_SOA_DECLSPEC FlappyBirdSoA* C_FLAPPY_BIRD_SOA_CALL FlappyBirdSoA_Create(Uint32 number_of_birds);
+extern C_FLAPPY_BIRD_SOA_DECLSPEC void C_FLAPPY_BIRD_SOA_CALL FlappyBirdSoA_Free(FlappyBirdSoA* the_soa);
+
+/**
+ * Copies the bird, its score and its next pipe (FlappyWorld_FindNextPipe) out of the_world into slot which_bird.
+ * The slot is inactive if the world isn't on the native backend or its bird hasn't launched.
+ */
+extern C_FLAPPY_BIRD_SOA_DECLSPEC void C_FLAPPY_BIRD_SOA_CALL FlappyBirdSoA_LoadFromWorld(FlappyBirdSoA* the_soa, Uint32 which_bird, struct FlappyWorld* the_world);
+
+/**
+ * Hands slot which_bird's last step back to the_world (FlappyWorld_SetPresteppedBird), so its next physics step
+ * uses it and fires the matching callbacks. Does nothing for an inactive slot.
+ * Call it after FlappyBirdSoA_Step, between FlappyWorld_BeginTick and FlappyWorld_FinishTick.
+ */
+extern C_FLAPPY_BIRD_SOA_DECLSPEC void C_FLAPPY_BIRD_SOA_CALL FlappyBirdSoA_StoreToWorld(FlappyBirdSoA* the_soa, Uint32 which_bird, struct FlappyWorld* the_world);
+
+/**
+ * Advances every bird by one physics step of delta_seconds.
+ * @param flaps One byte per bird, non-zero to flap at the start of this step, or NULL for no flaps.
+ * @param which_kernel A FlappyBirdSoAKernel value. Requests for an unsupported kernel fall back to the next narrower one.
+ */
+extern C_FLAPPY_BIRD_SOA_DECLSPEC void C_FLAPPY_BIRD_SOA_CALL FlappyBirdSoA_Step(FlappyBirdSoA* the_soa, const Uint8* flaps, float delta_seconds, int which_kernel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* C_FLAPPY_BIRD_SOA_H */
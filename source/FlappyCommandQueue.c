@@ -0,0 +1,156 @@
+/*
+	FlappyCommandQueue is the same bounded ring as FlappyEnvPool's queues (Dmitry Vyukov's,
+	where every cell carries a sequence number that says whose turn it is), cut down to one consumer:
+	producers still claim positions with a CAS, but the consumer owns dequeuePosition outright.
+	The timestamp is taken after the position is claimed, so the stamps come out of the ring
+	in (very nearly) the order they were taken.
+*/
+
+#include "FlappyCommandQueue.h"
+#include "FlappyBatch.h"
+
+
+struct FlappyCommandQueueCell
+{
+	SDL_atomic_t sequence;
+	FlappyCommand command;
+};
+
+struct FlappyCommandQueue
+{
+	/* The producer and consumer positions are on different cache lines so pushing doesn't slow down popping. */
+	union
+	{
+		SDL_atomic_t value;
+		char padding[FLAPPY_BATCH_CACHE_LINE_SIZE];
+	} enqueuePosition;
+	union
+	{
+		/* Only the consumer touches this, so it doesn't need to be atomic. */
+		Uint32 value;
+		char padding[FLAPPY_BATCH_CACHE_LINE_SIZE];
+	} dequeuePosition;
+	union
+	{
+		SDL_atomic_t value;
+		char padding[FLAPPY_BATCH_CACHE_LINE_SIZE];
+	} numberDropped;
+	struct FlappyCommandQueueCell* cells;
+	Uint32 mask;
+};
+
+
+struct FlappyCommandQueue* FlappyCommandQueue_Create(Uint32 minimum_capacity)
+{
+	struct FlappyCommandQueue* the_queue;
+	Uint32 capacity = 1;
+	Uint32 i;
+
+	/* A power of two so the position can be wrapped with a mask. */
+	while(capacity < minimum_capacity)
+	{
+		capacity = capacity << 1;
+	}
+
+	the_queue = (struct FlappyCommandQueue*)SDL_calloc(1, sizeof(struct FlappyCommandQueue));
+	if(NULL == the_queue)
+	{
+		return NULL;
+	}
+	the_queue->cells = (struct FlappyCommandQueueCell*)SDL_calloc(capacity, sizeof(struct FlappyCommandQueueCell));
+	if(NULL == the_queue->cells)
+	{
+		SDL_free(the_queue);
+		return NULL;
+	}
+	the_queue->mask = capacity - 1;
+	for(i=0; i<capacity; i++)
+	{
+		SDL_AtomicSet(&the_queue->cells[i].sequence, (int)i);
+	}
+	SDL_AtomicSet(&the_queue->enqueuePosition.value, 0);
+	the_queue->dequeuePosition.value = 0;
+	SDL_AtomicSet(&the_queue->numberDropped.value, 0);
+	return the_queue;
+}
+
+void FlappyCommandQueue_Free(struct FlappyCommandQueue* the_queue)
+{
+	if(NULL == the_queue)
+	{
+		return;
+	}
+	SDL_free(the_queue->cells);
+	SDL_free(the_queue);
+}
+
+SDL_bool FlappyCommandQueue_Push(struct FlappyCommandQueue* the_queue, Uint32 command_type, float the_value, Uint32 the_source)
+{
+	return FlappyCommandQueue_PushWithTimestamp(the_queue, command_type, the_value, the_source, SDL_GetPerformanceCounter());
+}
+
+SDL_bool FlappyCommandQueue_PushWithTimestamp(struct FlappyCommandQueue* the_queue, Uint32 command_type, float the_value, Uint32 the_source, Uint64 the_timestamp)
+{
+	struct FlappyCommandQueueCell* the_cell;
+	Uint32 position = (Uint32)SDL_AtomicGet(&the_queue->enqueuePosition.value);
+	for(;;)
+	{
+		Sint32 difference;
+		the_cell = &the_queue->cells[position & the_queue->mask];
+		difference = (Sint32)((Uint32)SDL_AtomicGet(&the_cell->sequence) - position);
+		if(0 == difference)
+		{
+			/* The cell is free for this position. Try to claim the position. */
+			if(SDL_AtomicCAS(&the_queue->enqueuePosition.value, (int)position, (int)(position + 1)))
+			{
+				break;
+			}
+			position = (Uint32)SDL_AtomicGet(&the_queue->enqueuePosition.value);
+		}
+		else if(difference < 0)
+		{
+			/* The consumer hasn't freed this cell from the previous lap yet, so we are full. */
+			SDL_AtomicAdd(&the_queue->numberDropped.value, 1);
+			return SDL_FALSE;
+		}
+		else
+		{
+			/* Somebody else claimed this position. */
+			position = (Uint32)SDL_AtomicGet(&the_queue->enqueuePosition.value);
+		}
+	}
+	the_cell->command.timestamp = the_timestamp;
+	the_cell->command.commandType = command_type;
+	the_cell->command.source = the_source;
+	the_cell->command.value = the_value;
+	/* Publishes the command to the consumer. */
+	SDL_AtomicSet(&the_cell->sequence, (int)(position + 1));
+	return SDL_TRUE;
+}
+
+SDL_bool FlappyCommandQueue_Pop(struct FlappyCommandQueue* the_queue, Uint64 cutoff_timestamp, FlappyCommand* out_command)
+{
+	Uint32 position = the_queue->dequeuePosition.value;
+	struct FlappyCommandQueueCell* the_cell = &the_queue->cells[position & the_queue->mask];
+
+	if((Uint32)SDL_AtomicGet(&the_cell->sequence) != (position + 1))
+	{
+		/* Nothing has been published here yet (or a producer is still filling it in). */
+		return SDL_FALSE;
+	}
+	if(the_cell->command.timestamp > cutoff_timestamp)
+	{
+		/* Pushed after this tick started, so it belongs to the next one. */
+		return SDL_FALSE;
+	}
+	*out_command = the_cell->command;
+	the_queue->dequeuePosition.value = position + 1;
+	/* Hands the cell back to the producers for the next lap around the ring. */
+	SDL_AtomicSet(&the_cell->sequence, (int)(position + the_queue->mask + 1));
+	return SDL_TRUE;
+}
+
+Uint32 FlappyCommandQueue_GetNumberDropped(struct FlappyCommandQueue* the_queue)
+{
+	return (Uint32)SDL_AtomicGet(&the_queue->numberDropped.value);
+}
@@ -0,0 +1,137 @@
+#ifndef C_FLAPPY_COMMAND_QUEUE_H
+#define C_FLAPPY_COMMAND_QUEUE_H
+
+/* Set up for C function definitions, even when using C++ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef DOXYGEN_SHOULD_IGNORE_THIS
+/** @cond DOXYGEN_SHOULD_IGNORE_THIS */
+
+/* Note: For Doxygen to produce clean output, you should set the
+ * PREDEFINED option to remove C_FLAPPY_COMMAND_QUEUE_DECLSPEC, C_FLAPPY_COMMAND_QUEUE_CALL, and
+ * the DOXYGEN_SHOULD_IGNORE_THIS blocks.
+ * PREDEFINED = DOXYGEN_SHOULD_IGNORE_THIS=1 C_FLAPPY_COMMAND_QUEUE_DECLSPEC= C_FLAPPY_COMMAND_QUEUE_CALL=
+ */
+
+/** Windows needs to know explicitly which functions to export in a DLL. */
+#if defined(_WIN32)
+	#if defined(C_FLAPPY_COMMAND_QUEUE_BUILD_LIBRARY)
+		#define C_FLAPPY_COMMAND_QUEUE_DECLSPEC __declspec(dllexport)
+	#else
+		#define C_FLAPPY_COMMAND_QUEUE_DECLSPEC
+	#endif
+#else
+	#if defined(C_FLAPPY_COMMAND_QUEUE_BUILD_LIBRARY)
+		#if defined (__GNUC__) && __GNUC__ >= 4
+			#define C_FLAPPY_COMMAND_QUEUE_DECLSPEC __attribute__((visibility("default")))
+		#else
+			#define C_FLAPPY_COMMAND_QUEUE_DECLSPEC
+		#endif
+	#else
+		#define C_FLAPPY_COMMAND_QUEUE_DECLSPEC
+	#endif
+#endif
+
+/* For Windows, by default, use the C calling convention */
+#if defined(_WIN32)
+	#define C_FLAPPY_COMMAND_QUEUE_CALL __cdecl
+#else
+	#define C_FLAPPY_COMMAND_QUEUE_CALL
+#endif
+
+/** @endcond DOXYGEN_SHOULD_IGNORE_THIS */
+#endif /* DOXYGEN_SHOULD_IGNORE_THIS */
+
+
+#include "SDL.h"
+
+/**
+ * @file
+ * FlappyCommandQueue is a bounded lock-free queue of game commands (flap, pause, reset, time scale)
+ * that any number of threads can push to (SDL events, a network bridge, a scripted bot...)
+ * and exactly one thread, the one that steps the world, pops from.
+ * Pushing never blocks and never takes a lock.
+ *
+ * Each command is stamped with SDL_GetPerformanceCounter() when it is pushed.
+ * The simulation thread drains the queue once per tick with FlappyCommandQueue_Pop,
+ * passing the time the tick started as the cutoff. Everything pushed before that goes into this tick,
+ * and anything pushed while the tick is being drained waits for the next one,
+ * so every command lands on one well-defined tick.
+ */
+
+/** What a FlappyCommand asks the world to do. */
+enum FlappyCommandType
+{
+	FLAPPY_COMMAND_PRIMARY_ACTION = 1, /**< Flap, or start/restart the game from the title/game over screen (Flappy_DoPrimaryAction). */
+	FLAPPY_COMMAND_PAUSE, /**< Flappy_PauseGame */
+	FLAPPY_COMMAND_UNPAUSE, /**< Flappy_UnpauseGame */
+	FLAPPY_COMMAND_TOGGLE_PAUSE, /**< Flappy_TogglePause */
+	FLAPPY_COMMAND_RESET, /**< Go back to the title screen (InitTitleScreen). */
+	FLAPPY_COMMAND_SET_TIME_SCALE /**< Change the game clock speed to value. */
+};
+
+/** Who pushed a command. The queue doesn't look at this; it is only there for logging and replays. */
+enum FlappyCommandSource
+{
+	FLAPPY_COMMAND_SOURCE_LOCAL_INPUT = 0, /**< SDL events on the main thread. */
+	FLAPPY_COMMAND_SOURCE_NETWORK, /**< A network bridge. */
+	FLAPPY_COMMAND_SOURCE_BOT /**< A scripted or learned player. */
+};
+
+typedef struct FlappyCommand
+{
+	Uint64 timestamp; /**< SDL_GetPerformanceCounter() when it was pushed (or when it happened, see FlappyCommandQueue_PushWithTimestamp). */
+	Uint32 commandType; /**< One of the FlappyCommandType values. */
+	Uint32 source; /**< One of the FlappyCommandSource values. */
+	float value; /**< The new speed for FLAPPY_COMMAND_SET_TIME_SCALE, otherwise unused. */
+} FlappyCommand;
+
+struct FlappyCommandQueue;
+
+/**
+ * Creates a queue that can hold at least minimum_capacity commands (rounded up to a power of two).
+ * @return The new queue, or NULL on failure.
+ */
+extern C_FLAPPY_COMMAND_QUEUE_DECLSPEC struct FlappyCommandQueue* C_FLAPPY_COMMAND_QUEUE_CALL FlappyCommandQueue_Create(Uint32 minimum_capacity);
+
+/**
+ * Frees the queue. Nobody may be pushing or popping at the time.
+ */
+extern C_FLAPPY_COMMAND_QUEUE_DECLSPEC void C_FLAPPY_COMMAND_QUEUE_CALL FlappyCommandQueue_Free(struct FlappyCommandQueue* the_queue);
+
+/**
+ * (Any thread.) Stamps a command with the current time and pushes it.
+ * @param command_type One of the FlappyCommandType values.
+ * @param the_value The time scale for FLAPPY_COMMAND_SET_TIME_SCALE, otherwise ignored.
+ * @param the_source One of the FlappyCommandSource values.
+ * @return SDL_FALSE if the queue was full (the command is dropped and counted), otherwise SDL_TRUE.
+ */
+extern C_FLAPPY_COMMAND_QUEUE_DECLSPEC SDL_bool C_FLAPPY_COMMAND_QUEUE_CALL FlappyCommandQueue_Push(struct FlappyCommandQueue* the_queue, Uint32 command_type, float the_value, Uint32 the_source);
+
+/**
+ * (Any thread.) Like FlappyCommandQueue_Push, but with the time the input actually happened,
+ * e.g. an SDL event's timestamp mapped onto SDL_GetPerformanceCounter(). Commands are still taken in push order.
+ */
+extern C_FLAPPY_COMMAND_QUEUE_DECLSPEC SDL_bool C_FLAPPY_COMMAND_QUEUE_CALL FlappyCommandQueue_PushWithTimestamp(struct FlappyCommandQueue* the_queue, Uint32 command_type, float the_value, Uint32 the_source, Uint64 the_timestamp);
+
+/**
+ * (The simulation thread only.) Takes the oldest command, if it was pushed no later than cutoff_timestamp.
+ * Call it in a loop at the start of each tick with the tick's start time until it returns SDL_FALSE.
+ * @param cutoff_timestamp An SDL_GetPerformanceCounter() value. Commands stamped after it stay queued.
+ * @param out_command Where to copy the command.
+ * @return SDL_TRUE if a command was taken.
+ */
+extern C_FLAPPY_COMMAND_QUEUE_DECLSPEC SDL_bool C_FLAPPY_COMMAND_QUEUE_CALL FlappyCommandQueue_Pop(struct FlappyCommandQueue* the_queue, Uint64 cutoff_timestamp, FlappyCommand* out_command);
+
+/**
+ * Returns how many pushes have been dropped because the queue was full.
+ */
+extern C_FLAPPY_COMMAND_QUEUE_DECLSPEC Uint32 C_FLAPPY_COMMAND_QUEUE_CALL FlappyCommandQueue_GetNumberDropped(struct FlappyCommandQueue* the_queue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* C_FLAPPY_COMMAND_QUEUE_H */
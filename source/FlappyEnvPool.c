@@ -0,0 +1,458 @@
+/*
+	FlappyEnvPool lets a learner keep stepping the worlds that are ready instead of waiting
+	for the slowest one every tick.
+	There are two queues of world ids, both the same bounded lock-free ring
+	(Dmitry Vyukov's MPMC queue, where every cell carries a sequence number that says whose turn it is):
+		- the job queue: the learner pushes, the workers pop
+		- the completion queue: the workers push, the learner pops
+	Semaphores are only used to sleep when a queue is empty, never to guard the data.
+	Since a world can only be in flight once, neither ring can ever have more entries than there are worlds.
+*/
+
+#include "FlappyEnvPool.h"
+
+
+struct FlappyEnvPoolCell
+{
+	SDL_atomic_t sequence;
+	Uint32 worldId;
+};
+
+struct FlappyEnvPoolQueue
+{
+	/* The producer and consumer positions are on different cache lines so pushing doesn't slow down popping. */
+	union
+	{
+		SDL_atomic_t value;
+		char padding[FLAPPY_BATCH_CACHE_LINE_SIZE];
+	} enqueuePosition;
+	union
+	{
+		SDL_atomic_t value;
+		char padding[FLAPPY_BATCH_CACHE_LINE_SIZE];
+	} dequeuePosition;
+	struct FlappyEnvPoolCell* cells;
+	Uint32 mask;
+};
+
+struct FlappyEnvPoolSlotData
+{
+	struct FlappyWorld* world;
+	FlappyEnvPoolResult result;
+	Uint8 pendingAction;
+	/* Only the learner thread reads or writes this. */
+	SDL_bool isInFlight;
+};
+
+/* Each world's slot gets its own cache line(s) since different workers write neighbouring results. */
+struct FlappyEnvPoolSlot
+{
+	union
+	{
+		struct FlappyEnvPoolSlotData data;
+		char padding[((sizeof(struct FlappyEnvPoolSlotData) + FLAPPY_BATCH_CACHE_LINE_SIZE - 1) / FLAPPY_BATCH_CACHE_LINE_SIZE) * FLAPPY_BATCH_CACHE_LINE_SIZE];
+	} u;
+};
+
+struct FlappyEnvPool
+{
+	Uint32 numberOfWorlds;
+	Uint32 numberOfThreads;
+	Uint32 numberInFlight;
+
+	void* slotAllocation;
+	struct FlappyEnvPoolSlot* slots;
+
+	struct FlappyEnvPoolQueue* jobQueue;
+	struct FlappyEnvPoolQueue* completionQueue;
+	SDL_sem* jobSemaphore;
+	SDL_sem* completionSemaphore;
+
+	SDL_Thread** threads;
+	SDL_atomic_t isQuitting;
+};
+
+
+static struct FlappyEnvPoolQueue* FlappyEnvPool_CreateQueue(Uint32 minimum_capacity)
+{
+	struct FlappyEnvPoolQueue* the_queue;
+	Uint32 capacity = 1;
+	Uint32 i;
+
+	/* A power of two so the position can be wrapped with a mask. */
+	while(capacity < minimum_capacity)
+	{
+		capacity = capacity << 1;
+	}
+
+	the_queue = (struct FlappyEnvPoolQueue*)SDL_calloc(1, sizeof(struct FlappyEnvPoolQueue));
+	if(NULL == the_queue)
+	{
+		return NULL;
+	}
+	the_queue->cells = (struct FlappyEnvPoolCell*)SDL_calloc(capacity, sizeof(struct FlappyEnvPoolCell));
+	if(NULL == the_queue->cells)
+	{
+		SDL_free(the_queue);
+		return NULL;
+	}
+	the_queue->mask = capacity - 1;
+	for(i=0; i<capacity; i++)
+	{
+		SDL_AtomicSet(&the_queue->cells[i].sequence, (int)i);
+	}
+	SDL_AtomicSet(&the_queue->enqueuePosition.value, 0);
+	SDL_AtomicSet(&the_queue->dequeuePosition.value, 0);
+	return the_queue;
+}
+
+static void FlappyEnvPool_FreeQueue(struct FlappyEnvPoolQueue* the_queue)
+{
+	if(NULL == the_queue)
+	{
+		return;
+	}
+	SDL_free(the_queue->cells);
+	SDL_free(the_queue);
+}
+
+static SDL_bool FlappyEnvPool_PushQueue(struct FlappyEnvPoolQueue* the_queue, Uint32 world_id)
+{
+	struct FlappyEnvPoolCell* the_cell;
+	Uint32 position = (Uint32)SDL_AtomicGet(&the_queue->enqueuePosition.value);
+	for(;;)
+	{
+		Sint32 difference;
+		the_cell = &the_queue->cells[position & the_queue->mask];
+		difference = (Sint32)((Uint32)SDL_AtomicGet(&the_cell->sequence) - position);
+		if(0 == difference)
+		{
+			/* The cell is free for this position. Try to claim the position. */
+			if(SDL_AtomicCAS(&the_queue->enqueuePosition.value, (int)position, (int)(position + 1)))
+			{
+				break;
+			}
+			position = (Uint32)SDL_AtomicGet(&the_queue->enqueuePosition.value);
+		}
+		else if(difference < 0)
+		{
+			/* The consumer hasn't freed this cell from the previous lap yet, so we are full. */
+			return SDL_FALSE;
+		}
+		else
+		{
+			/* Somebody else claimed this position. */
+			position = (Uint32)SDL_AtomicGet(&the_queue->enqueuePosition.value);
+		}
+	}
+	the_cell->worldId = world_id;
+	/* Publishes worldId (and everything the producer wrote before) to the consumer. */
+	SDL_AtomicSet(&the_cell->sequence, (int)(position + 1));
+	return SDL_TRUE;
+}
+
+static SDL_bool FlappyEnvPool_PopQueue(struct FlappyEnvPoolQueue* the_queue, Uint32* out_world_id)
+{
+	struct FlappyEnvPoolCell* the_cell;
+	Uint32 position = (Uint32)SDL_AtomicGet(&the_queue->dequeuePosition.value);
+	for(;;)
+	{
+		Sint32 difference;
+		the_cell = &the_queue->cells[position & the_queue->mask];
+		difference = (Sint32)((Uint32)SDL_AtomicGet(&the_cell->sequence) - (position + 1));
+		if(0 == difference)
+		{
+			if(SDL_AtomicCAS(&the_queue->dequeuePosition.value, (int)position, (int)(position + 1)))
+			{
+				break;
+			}
+			position = (Uint32)SDL_AtomicGet(&the_queue->dequeuePosition.value);
+		}
+		else if(difference < 0)
+		{
+			/* Nothing has been published here yet, so we are empty. */
+			return SDL_FALSE;
+		}
+		else
+		{
+			position = (Uint32)SDL_AtomicGet(&the_queue->dequeuePosition.value);
+		}
+	}
+	*out_world_id = the_cell->worldId;
+	/* Hands the cell back to the producers for the next lap around the ring. */
+	SDL_AtomicSet(&the_cell->sequence, (int)(position + the_queue->mask + 1));
+	return SDL_TRUE;
+}
+
+/* For a consumer that already holds a semaphore post for this queue, so an entry is known to be on its way.
+	With several producers, the cell at dequeuePosition can still be unpublished when the post arrives
+	(a producer claimed it and was preempted, while a later one published and posted).
+	So keep trying until that producer finishes, letting it run in the meantime.
+ */
+static Uint32 FlappyEnvPool_PopQueueAfterPost(struct FlappyEnvPoolQueue* the_queue)
+{
+	Uint32 world_id;
+	while( ! FlappyEnvPool_PopQueue(the_queue, &world_id))
+	{
+		SDL_Delay(0);
+	}
+	return world_id;
+}
+
+static void FlappyEnvPool_StepSlot(struct FlappyEnvPoolSlot* the_slot, Uint32 world_id)
+{
+	struct FlappyWorld* the_world = the_slot->u.data.world;
+	FlappyEnvPoolResult* the_result = &the_slot->u.data.result;
+	cpVect bird_position;
+	cpVect bird_velocity;
+
+	FlappyWorld_StepTick(the_world, FLAPPY_BATCH_ACTION_PRIMARY == the_slot->u.data.pendingAction);
+
+	bird_position = cpBodyGetPosition(the_world->birdModelData.birdBody);
+	bird_velocity = cpBodyGetVelocity(the_world->birdModelData.birdBody);
+	the_result->worldId = world_id;
+	the_result->currentScore = the_world->gameInstanceData.currentScore;
+	the_result->gameState = the_world->gameState;
+	the_result->isGameOver = the_world->birdModelData.isGameOver;
+	the_result->birdPositionY = (float)bird_position.y;
+	the_result->birdVelocityY = (float)bird_velocity.y;
+	FlappyWorld_WriteObservation(the_world, the_result->observation);
+}
+
+static int FlappyEnvPool_WorkerThread(void* user_data)
+{
+	struct FlappyEnvPool* the_pool = (struct FlappyEnvPool*)user_data;
+
+	for(;;)
+	{
+		Uint32 world_id;
+
+		/* One post per job, so once we get through here there is a job waiting for us (unless we are quitting). */
+		SDL_SemWait(the_pool->jobSemaphore);
+		if(SDL_AtomicGet(&the_pool->isQuitting))
+		{
+			break;
+		}
+		world_id = FlappyEnvPool_PopQueueAfterPost(the_pool->jobQueue);
+		FlappyEnvPool_StepSlot(&the_pool->slots[world_id], world_id);
+
+		FlappyEnvPool_PushQueue(the_pool->completionQueue, world_id);
+		SDL_SemPost(the_pool->completionSemaphore);
+	}
+	return 0;
+}
+
+struct FlappyEnvPool* FlappyEnvPool_Create(Uint32 number_of_worlds, Uint32 number_of_threads, Uint64 base_seed)
+{
+	struct FlappyEnvPool* the_pool;
+	char* slot_allocation;
+	Uint32 i;
+
+	if(0 == number_of_worlds)
+	{
+		return NULL;
+	}
+	if(0 == number_of_threads)
+	{
+		number_of_threads = (Uint32)SDL_GetCPUCount();
+	}
+	if(number_of_threads > number_of_worlds)
+	{
+		number_of_threads = number_of_worlds;
+	}
+	if(0 == number_of_threads)
+	{
+		number_of_threads = 1;
+	}
+
+	the_pool = (struct FlappyEnvPool*)SDL_calloc(1, sizeof(struct FlappyEnvPool));
+	if(NULL == the_pool)
+	{
+		return NULL;
+	}
+	the_pool->numberOfWorlds = number_of_worlds;
+	the_pool->numberOfThreads = number_of_threads;
+	SDL_AtomicSet(&the_pool->isQuitting, 0);
+
+	slot_allocation = (char*)SDL_calloc(1, (number_of_worlds * sizeof(struct FlappyEnvPoolSlot)) + FLAPPY_BATCH_CACHE_LINE_SIZE - 1);
+	the_pool->slotAllocation = slot_allocation;
+	if(NULL != slot_allocation)
+	{
+		the_pool->slots = (struct FlappyEnvPoolSlot*)(((uintptr_t)slot_allocation + FLAPPY_BATCH_CACHE_LINE_SIZE - 1) & ~(uintptr_t)(FLAPPY_BATCH_CACHE_LINE_SIZE - 1));
+	}
+	the_pool->jobQueue = FlappyEnvPool_CreateQueue(number_of_worlds);
+	the_pool->completionQueue = FlappyEnvPool_CreateQueue(number_of_worlds);
+	the_pool->jobSemaphore = SDL_CreateSemaphore(0);
+	the_pool->completionSemaphore = SDL_CreateSemaphore(0);
+	the_pool->threads = (SDL_Thread**)SDL_calloc(number_of_threads, sizeof(SDL_Thread*));
+	if((NULL == the_pool->slots) || (NULL == the_pool->jobQueue) || (NULL == the_pool->completionQueue)
+		|| (NULL == the_pool->jobSemaphore) || (NULL == the_pool->completionSemaphore) || (NULL == the_pool->threads)
+	)
+	{
+		FlappyEnvPool_Free(the_pool);
+		return NULL;
+	}
+
+	for(i=0; i<number_of_worlds; i++)
+	{
+		struct FlappyWorld* the_world = FlappyWorld_Create(base_seed + i);
+		if(NULL == the_world)
+		{
+			FlappyEnvPool_Free(the_pool);
+			return NULL;
+		}
+		InitTitleScreen(the_world);
+		the_pool->slots[i].u.data.world = the_world;
+	}
+
+	for(i=0; i<number_of_threads; i++)
+	{
+		the_pool->threads[i] = SDL_CreateThread(FlappyEnvPool_WorkerThread, "FlappyEnvPool", the_pool);
+		if(NULL == the_pool->threads[i])
+		{
+			FlappyEnvPool_Free(the_pool);
+			return NULL;
+		}
+	}
+
+	return the_pool;
+}
+
+void FlappyEnvPool_Free(struct FlappyEnvPool* the_pool)
+{
+	Uint32 i;
+	if(NULL == the_pool)
+	{
+		return;
+	}
+
+	if(NULL != the_pool->threads)
+	{
+		/* Let the workers finish what is in flight so nobody is inside a world when we free it. */
+		while(the_pool->numberInFlight > 0)
+		{
+			FlappyEnvPoolResult ignored_result;
+			FlappyEnvPool_Recv(the_pool, &ignored_result, 1, 1);
+		}
+
+		SDL_AtomicSet(&the_pool->isQuitting, 1);
+		for(i=0; i<the_pool->numberOfThreads; i++)
+		{
+			SDL_SemPost(the_pool->jobSemaphore);
+		}
+		for(i=0; i<the_pool->numberOfThreads; i++)
+		{
+			if(NULL != the_pool->threads[i])
+			{
+				SDL_WaitThread(the_pool->threads[i], NULL);
+			}
+		}
+		SDL_free(the_pool->threads);
+	}
+
+	if(NULL != the_pool->slots)
+	{
+		for(i=0; i<the_pool->numberOfWorlds; i++)
+		{
+			FlappyWorld_Free(the_pool->slots[i].u.data.world);
+		}
+	}
+
+	if(NULL != the_pool->completionSemaphore)
+	{
+		SDL_DestroySemaphore(the_pool->completionSemaphore);
+	}
+	if(NULL != the_pool->jobSemaphore)
+	{
+		SDL_DestroySemaphore(the_pool->jobSemaphore);
+	}
+	FlappyEnvPool_FreeQueue(the_pool->completionQueue);
+	FlappyEnvPool_FreeQueue(the_pool->jobQueue);
+	SDL_free(the_pool->slotAllocation);
+	SDL_free(the_pool);
+}
+
+Uint32 FlappyEnvPool_Send(struct FlappyEnvPool* the_pool, const Uint32* world_ids, const Uint8* actions, Uint32 number_of_ids)
+{
+	Uint32 i;
+	Uint32 number_sent = 0;
+
+	for(i=0; i<number_of_ids; i++)
+	{
+		Uint32 world_id = world_ids[i];
+		struct FlappyEnvPoolSlot* the_slot;
+
+		if(world_id >= the_pool->numberOfWorlds)
+		{
+			continue;
+		}
+		the_slot = &the_pool->slots[world_id];
+		if(the_slot->u.data.isInFlight)
+		{
+			continue;
+		}
+
+		the_slot->u.data.isInFlight = SDL_TRUE;
+		the_slot->u.data.pendingAction = (NULL == actions) ? FLAPPY_BATCH_ACTION_NONE : actions[i];
+		the_pool->numberInFlight++;
+
+		/* This can't fail: every world is in the ring at most once and the ring holds all of them. */
+		FlappyEnvPool_PushQueue(the_pool->jobQueue, world_id);
+		SDL_SemPost(the_pool->jobSemaphore);
+		number_sent++;
+	}
+	return number_sent;
+}
+
+Uint32 FlappyEnvPool_Recv(struct FlappyEnvPool* the_pool, FlappyEnvPoolResult* out_results, Uint32 min_results, Uint32 max_results)
+{
+	Uint32 number_received = 0;
+
+	if(min_results > the_pool->numberInFlight)
+	{
+		min_results = the_pool->numberInFlight;
+	}
+
+	while(number_received < max_results)
+	{
+		Uint32 world_id;
+		struct FlappyEnvPoolSlot* the_slot;
+
+		if(number_received < min_results)
+		{
+			SDL_SemWait(the_pool->completionSemaphore);
+		}
+		else if(0 != SDL_SemTryWait(the_pool->completionSemaphore))
+		{
+			break;
+		}
+
+		/* Every worker pushes before it posts, so an entry is always coming, but it may not be published yet. */
+		world_id = FlappyEnvPool_PopQueueAfterPost(the_pool->completionQueue);
+		the_slot = &the_pool->slots[world_id];
+		out_results[number_received] = the_slot->u.data.result;
+		the_slot->u.data.isInFlight = SDL_FALSE;
+		the_pool->numberInFlight--;
+		number_received++;
+	}
+	return number_received;
+}
+
+Uint32 FlappyEnvPool_GetNumberOfWorlds(struct FlappyEnvPool* the_pool)
+{
+	return the_pool->numberOfWorlds;
+}
+
+Uint32 FlappyEnvPool_GetNumberInFlight(struct FlappyEnvPool* the_pool)
+{
+	return the_pool->numberInFlight;
+}
+
+struct FlappyWorld* FlappyEnvPool_GetWorld(struct FlappyEnvPool* the_pool, Uint32 which_world)
+{
+	if(which_world >= the_pool->numberOfWorlds)
+	{
+		return NULL;
+	}
+	return the_pool->slots[which_world].u.data.world;
+}
@@ -0,0 +1,132 @@
+#ifndef C_FLAPPY_ENV_POOL_H
+#define C_FLAPPY_ENV_POOL_H
+
+/* Set up for C function definitions, even when using C++ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef DOXYGEN_SHOULD_IGNORE_THIS
+/** @cond DOXYGEN_SHOULD_IGNORE_THIS */
+
+/* Note: For Doxygen to produce clean output, you should set the
+ * PREDEFINED option to remove C_FLAPPY_ENV_POOL_DECLSPEC, C_FLAPPY_ENV_POOL_CALL, and
+ * the DOXYGEN_SHOULD_IGNORE_THIS blocks.
+ * PREDEFINED = DOXYGEN_SHOULD_IGNORE_THIS=1 C_FLAPPY_ENV_POOL_DECLSPEC= C_FLAPPY_ENV_POOL_CALL=
+ */
+
+/** Windows needs to know explicitly which functions to export in a DLL. */
+#if defined(_WIN32)
+	#if defined(C_FLAPPY_ENV_POOL_BUILD_LIBRARY)
+		#define C_FLAPPY_ENV_POOL_DECLSPEC __declspec(dllexport)
+	#else
+		#define C_FLAPPY_ENV_POOL_DECLSPEC
+	#endif
+#else
+	#if defined(C_FLAPPY_ENV_POOL_BUILD_LIBRARY)
+		#if defined (__GNUC__) && __GNUC__ >= 4
+			#define C_FLAPPY_ENV_POOL_DECLSPEC __attribute__((visibility("default")))
+		#else
+			#define C_FLAPPY_ENV_POOL_DECLSPEC
+		#endif
+	#else
+		#define C_FLAPPY_ENV_POOL_DECLSPEC
+	#endif
+#endif
+
+/* For Windows, by default, use the C calling convention */
+#if defined(_WIN32)
+	#define C_FLAPPY_ENV_POOL_CALL __cdecl
+#else
+	#define C_FLAPPY_ENV_POOL_CALL
+#endif
+
+/** @endcond DOXYGEN_SHOULD_IGNORE_THIS */
+#endif /* DOXYGEN_SHOULD_IGNORE_THIS */
+
+#include "SDL.h"
+
+#include "FlappyWorld.h"
+#include "FlappyBatch.h"
+
+/**
+ * @file
+ * FlappyEnvPool is the asynchronous sibling of FlappyBatch.
+ * FlappyEnvPool_Send() queues ticks for some worlds and returns immediately.
+ * Worker threads step them with FlappyWorld_StepTick and put the finished world ids on a
+ * lock-free completion queue, and FlappyEnvPool_Recv() hands back whichever ones are done.
+ * So a world that is resetting or sitting in a long GAMESTATE_* transition only delays itself,
+ * not everybody else.
+ *
+ * A world is "in flight" from the time it is sent until its result is received.
+ * It can't be sent again while in flight, and you must not touch it (including through
+ * FlappyEnvPool_GetWorld) during that time.
+ * Send and Recv are meant to be called from one thread (the learner).
+ */
+
+/**
+ * What FlappyEnvPool_Recv reports for each finished world.
+ * This is copied out of the world by the worker right after the tick.
+ */
+typedef struct FlappyEnvPoolResult
+{
+	Uint32 worldId; /**< Which world finished its tick. */
+	Uint32 currentScore; /**< gameInstanceData.currentScore after the tick. */
+	Sint32 gameState; /**< The world's GameState after the tick. */
+	SDL_bool isGameOver; /**< birdModelData.isGameOver after the tick. */
+	float birdPositionY; /**< The bird's physics body position (y up). */
+	float birdVelocityY; /**< The bird's vertical velocity. */
+	float observation[FLAPPY_OBSERVATION_SIZE]; /**< FlappyWorld_WriteObservation after the tick, written while the world was still in the worker's cache. */
+} FlappyEnvPoolResult;
+
+struct FlappyEnvPool;
+typedef struct FlappyEnvPool FlappyEnvPool;
+
+/**
+ * Creates number_of_worlds worlds (each put on the title screen) and number_of_threads worker threads.
+ * @param number_of_threads Pass 0 to use SDL_GetCPUCount(). Unlike FlappyBatch, the calling thread never steps worlds.
+ * @param base_seed World i is created with the seed base_seed+i.
+ * @return A new pool or NULL on failure. Free with FlappyEnvPool_Free.
+ */
+extern C_FLAPPY_ENV_POOL_DECLSPEC struct FlappyEnvPool* C_FLAPPY_ENV_POOL_CALL FlappyEnvPool_Create(Uint32 number_of_worlds, Uint32 number_of_threads, Uint64 base_seed);
+
+/**
+ * Waits for the worlds still in flight, stops the worker threads and frees the pool and all its worlds.
+ */
+extern C_FLAPPY_ENV_POOL_DECLSPEC void C_FLAPPY_ENV_POOL_CALL FlappyEnvPool_Free(struct FlappyEnvPool* the_pool);
+
+/**
+ * Queues one tick for each listed world and returns without waiting.
+ * @param world_ids The worlds to step.
+ * @param actions One FlappyBatchAction per entry in world_ids, or NULL for no actions.
+ * @param number_of_ids The length of world_ids.
+ * @return The number of worlds queued. Ids that are out of range or already in flight are skipped.
+ */
+extern C_FLAPPY_ENV_POOL_DECLSPEC Uint32 C_FLAPPY_ENV_POOL_CALL FlappyEnvPool_Send(struct FlappyEnvPool* the_pool, const Uint32* world_ids, const Uint8* actions, Uint32 number_of_ids);
+
+/**
+ * Collects results for worlds that finished their tick, in completion order.
+ * Blocks until at least min_results are available, then also takes anything else that is
+ * already done, up to max_results.
+ * @param min_results Pass 0 to never block. This is clamped to the number of worlds in flight.
+ * @return The number of results written to out_results.
+ */
+extern C_FLAPPY_ENV_POOL_DECLSPEC Uint32 C_FLAPPY_ENV_POOL_CALL FlappyEnvPool_Recv(struct FlappyEnvPool* the_pool, FlappyEnvPoolResult* out_results, Uint32 min_results, Uint32 max_results);
+
+extern C_FLAPPY_ENV_POOL_DECLSPEC Uint32 C_FLAPPY_ENV_POOL_CALL FlappyEnvPool_GetNumberOfWorlds(struct FlappyEnvPool* the_pool);
+
+/**
+ * Returns the number of worlds that were sent but whose results haven't been received yet.
+ */
+extern C_FLAPPY_ENV_POOL_DECLSPEC Uint32 C_FLAPPY_ENV_POOL_CALL FlappyEnvPool_GetNumberInFlight(struct FlappyEnvPool* the_pool);
+
+/**
+ * Returns world number which_world. The pool owns it, so don't free it. Only touch it while it is not in flight.
+ */
+extern C_FLAPPY_ENV_POOL_DECLSPEC struct FlappyWorld* C_FLAPPY_ENV_POOL_CALL FlappyEnvPool_GetWorld(struct FlappyEnvPool* the_pool, Uint32 which_world);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* C_FLAPPY_ENV_POOL_H */
@@ -0,0 +1,334 @@
+/*
+	FlappyExperienceRing keeps everything in one shared memory object:
+		[ header: layout info | head (consumer position) | tail (producer position) ][ capacity transitions ]
+	Each part of the header is a whole cache line.
+	The producer fills transitions past the tail and then moves the tail, with a release barrier first,
+	so by the time the consumer can see the new tail, it can also see the transitions.
+	The consumer reads transitions below the tail and then moves the head, also with a release barrier,
+	so the producer can't overwrite a transition that is still being read.
+	The SDL atomics are plain lock-free instructions on the memory itself, so they work across processes.
+*/
+
+#include "FlappyExperienceRing.h"
+
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(__ANDROID__)
+	#define FLAPPY_EXPERIENCE_RING_HAS_SHM 1
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#else
+	#define FLAPPY_EXPERIENCE_RING_HAS_SHM 0
+#endif
+
+/* "FLXR" */
+#define FLAPPY_EXPERIENCE_RING_MAGIC 0x52584C46u
+#define FLAPPY_EXPERIENCE_RING_TRANSITION_ALIGNMENT 16
+
+/* This is the start of the shared memory, so its layout is part of FLAPPY_EXPERIENCE_RING_VERSION. */
+struct FlappyExperienceRingShared
+{
+	union
+	{
+		struct
+		{
+			SDL_atomic_t magic;
+			Uint32 version;
+			Uint32 capacity;
+			Uint32 observationSize;
+			Uint32 transitionStride;
+		} data;
+		char padding[FLAPPY_BATCH_CACHE_LINE_SIZE];
+	} info;
+	union
+	{
+		SDL_atomic_t value;
+		char padding[FLAPPY_BATCH_CACHE_LINE_SIZE];
+	} head;
+	union
+	{
+		SDL_atomic_t value;
+		char padding[FLAPPY_BATCH_CACHE_LINE_SIZE];
+	} tail;
+};
+
+/* Each process's own end of the ring. Nothing in here is shared. */
+struct FlappyExperienceRing
+{
+	struct FlappyExperienceRingShared* shared;
+	Uint8* transitions;
+	size_t mappingSize;
+	Uint32 mask;
+	Uint32 transitionStride;
+	Uint32 observationSize;
+	SDL_bool isProducer;
+
+	/* Producer: the next position to reserve, and the head as of the last time it was read. */
+	Uint32 reservePosition;
+	Uint32 cachedHead;
+	/* Consumer: the oldest unreleased position, and the tail as of the last time it was read. */
+	Uint32 readPosition;
+	Uint32 cachedTail;
+};
+
+
+static Uint32 FlappyExperienceRing_GetTransitionStride(Uint32 observation_size)
+{
+	Uint32 the_size = (Uint32)sizeof(FlappyExperienceTransition) + observation_size * (Uint32)sizeof(float);
+	return (the_size + FLAPPY_EXPERIENCE_RING_TRANSITION_ALIGNMENT - 1) & ~(Uint32)(FLAPPY_EXPERIENCE_RING_TRANSITION_ALIGNMENT - 1);
+}
+
+static FlappyExperienceTransition* FlappyExperienceRing_GetTransitionAtPosition(struct FlappyExperienceRing* the_ring, Uint32 the_position)
+{
+	return (FlappyExperienceTransition*)(the_ring->transitions + (size_t)(the_position & the_ring->mask) * the_ring->transitionStride);
+}
+
+static struct FlappyExperienceRing* FlappyExperienceRing_CreateLocalEnd(void* the_mapping, size_t mapping_size, SDL_bool is_producer)
+{
+	struct FlappyExperienceRing* the_ring = (struct FlappyExperienceRing*)SDL_calloc(1, sizeof(struct FlappyExperienceRing));
+	if(NULL == the_ring)
+	{
+		return NULL;
+	}
+	the_ring->shared = (struct FlappyExperienceRingShared*)the_mapping;
+	the_ring->transitions = (Uint8*)the_mapping + sizeof(struct FlappyExperienceRingShared);
+	the_ring->mappingSize = mapping_size;
+	the_ring->mask = the_ring->shared->info.data.capacity - 1;
+	the_ring->transitionStride = the_ring->shared->info.data.transitionStride;
+	the_ring->observationSize = the_ring->shared->info.data.observationSize;
+	the_ring->isProducer = is_producer;
+	the_ring->reservePosition = (Uint32)SDL_AtomicGet(&the_ring->shared->tail.value);
+	the_ring->cachedHead = (Uint32)SDL_AtomicGet(&the_ring->shared->head.value);
+	the_ring->readPosition = the_ring->cachedHead;
+	the_ring->cachedTail = the_ring->reservePosition;
+	return the_ring;
+}
+
+struct FlappyExperienceRing* FlappyExperienceRing_Create(const char* ring_name, Uint32 capacity, Uint32 observation_size)
+{
+#if FLAPPY_EXPERIENCE_RING_HAS_SHM
+	struct FlappyExperienceRingShared* the_shared;
+	struct FlappyExperienceRing* the_ring;
+	Uint32 rounded_capacity = 1;
+	Uint32 transition_stride = FlappyExperienceRing_GetTransitionStride(observation_size);
+	size_t mapping_size;
+	void* the_mapping;
+	int the_fd;
+
+	if((NULL == ring_name) || (0 == capacity) || (capacity > 0x80000000u))
+	{
+		return NULL;
+	}
+	while(rounded_capacity < capacity)
+	{
+		rounded_capacity <<= 1;
+	}
+	mapping_size = sizeof(struct FlappyExperienceRingShared) + (size_t)rounded_capacity * transition_stride;
+
+	/* Start from scratch even if an old ring with this name is still around. */
+	shm_unlink(ring_name);
+	the_fd = shm_open(ring_name, O_CREAT | O_EXCL | O_RDWR, 0600);
+	if(the_fd < 0)
+	{
+		SDL_SetError("shm_open failed for %s", ring_name);
+		return NULL;
+	}
+	if(0 != ftruncate(the_fd, (off_t)mapping_size))
+	{
+		SDL_SetError("ftruncate failed for %s", ring_name);
+		close(the_fd);
+		shm_unlink(ring_name);
+		return NULL;
+	}
+	the_mapping = mmap(NULL, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, the_fd, 0);
+	/* The mapping keeps the object alive, we don't need the descriptor anymore. */
+	close(the_fd);
+	if(MAP_FAILED == the_mapping)
+	{
+		SDL_SetError("mmap failed for %s", ring_name);
+		shm_unlink(ring_name);
+		return NULL;
+	}
+
+	/* ftruncate zero-filled everything, so the head and tail already start at 0. */
+	the_shared = (struct FlappyExperienceRingShared*)the_mapping;
+	the_shared->info.data.version = FLAPPY_EXPERIENCE_RING_VERSION;
+	the_shared->info.data.capacity = rounded_capacity;
+	the_shared->info.data.observationSize = observation_size;
+	the_shared->info.data.transitionStride = transition_stride;
+	/* The magic goes in last, so a consumer that sees it also sees the rest of the header. */
+	SDL_MemoryBarrierRelease();
+	SDL_AtomicSet(&the_shared->info.data.magic, (int)FLAPPY_EXPERIENCE_RING_MAGIC);
+
+	the_ring = FlappyExperienceRing_CreateLocalEnd(the_mapping, mapping_size, SDL_TRUE);
+	if(NULL == the_ring)
+	{
+		munmap(the_mapping, mapping_size);
+		shm_unlink(ring_name);
+	}
+	return the_ring;
+#else
+	SDL_SetError("Shared memory experience rings aren't supported on this platform");
+	return NULL;
+#endif
+}
+
+struct FlappyExperienceRing* FlappyExperienceRing_Open(const char* ring_name)
+{
+#if FLAPPY_EXPERIENCE_RING_HAS_SHM
+	struct FlappyExperienceRingShared* the_shared;
+	struct FlappyExperienceRing* the_ring;
+	struct stat the_stat;
+	size_t mapping_size;
+	void* the_mapping;
+	int the_fd;
+
+	if(NULL == ring_name)
+	{
+		return NULL;
+	}
+	the_fd = shm_open(ring_name, O_RDWR, 0);
+	if(the_fd < 0)
+	{
+		SDL_SetError("shm_open failed for %s", ring_name);
+		return NULL;
+	}
+	if((0 != fstat(the_fd, &the_stat)) || ((size_t)the_stat.st_size < sizeof(struct FlappyExperienceRingShared)))
+	{
+		SDL_SetError("%s is not an experience ring", ring_name);
+		close(the_fd);
+		return NULL;
+	}
+	mapping_size = (size_t)the_stat.st_size;
+	the_mapping = mmap(NULL, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, the_fd, 0);
+	close(the_fd);
+	if(MAP_FAILED == the_mapping)
+	{
+		SDL_SetError("mmap failed for %s", ring_name);
+		return NULL;
+	}
+
+	the_shared = (struct FlappyExperienceRingShared*)the_mapping;
+	if(((Uint32)SDL_AtomicGet(&the_shared->info.data.magic) != FLAPPY_EXPERIENCE_RING_MAGIC)
+		|| (FLAPPY_EXPERIENCE_RING_VERSION != the_shared->info.data.version)
+		|| (0 == the_shared->info.data.capacity)
+		|| (0 != (the_shared->info.data.capacity & (the_shared->info.data.capacity - 1)))
+		|| (the_shared->info.data.transitionStride != FlappyExperienceRing_GetTransitionStride(the_shared->info.data.observationSize))
+		|| (mapping_size < (sizeof(struct FlappyExperienceRingShared) + (size_t)the_shared->info.data.capacity * the_shared->info.data.transitionStride))
+	)
+	{
+		SDL_SetError("%s is not a compatible experience ring", ring_name);
+		munmap(the_mapping, mapping_size);
+		return NULL;
+	}
+	SDL_MemoryBarrierAcquire();
+
+	the_ring = FlappyExperienceRing_CreateLocalEnd(the_mapping, mapping_size, SDL_FALSE);
+	if(NULL == the_ring)
+	{
+		munmap(the_mapping, mapping_size);
+	}
+	return the_ring;
+#else
+	SDL_SetError("Shared memory experience rings aren't supported on this platform");
+	return NULL;
+#endif
+}
+
+void FlappyExperienceRing_Close(struct FlappyExperienceRing* the_ring)
+{
+	if(NULL == the_ring)
+	{
+		return;
+	}
+#if FLAPPY_EXPERIENCE_RING_HAS_SHM
+	munmap(the_ring->shared, the_ring->mappingSize);
+#endif
+	SDL_free(the_ring);
+}
+
+void FlappyExperienceRing_Unlink(const char* ring_name)
+{
+#if FLAPPY_EXPERIENCE_RING_HAS_SHM
+	if(NULL != ring_name)
+	{
+		shm_unlink(ring_name);
+	}
+#endif
+}
+
+Uint32 FlappyExperienceRing_GetCapacity(struct FlappyExperienceRing* the_ring)
+{
+	return the_ring->mask + 1;
+}
+
+Uint32 FlappyExperienceRing_GetObservationSize(struct FlappyExperienceRing* the_ring)
+{
+	return the_ring->observationSize;
+}
+
+float* FlappyExperienceRing_GetObservation(FlappyExperienceTransition* the_transition)
+{
+	return (float*)(the_transition + 1);
+}
+
+FlappyExperienceTransition* FlappyExperienceRing_Reserve(struct FlappyExperienceRing* the_ring)
+{
+	FlappyExperienceTransition* the_transition;
+
+	if((the_ring->reservePosition - the_ring->cachedHead) > the_ring->mask)
+	{
+		/* Looks full. See how far the consumer has got since we last checked. */
+		the_ring->cachedHead = (Uint32)SDL_AtomicGet(&the_ring->shared->head.value);
+		if((the_ring->reservePosition - the_ring->cachedHead) > the_ring->mask)
+		{
+			return NULL;
+		}
+	}
+	the_transition = FlappyExperienceRing_GetTransitionAtPosition(the_ring, the_ring->reservePosition);
+	the_ring->reservePosition++;
+	return the_transition;
+}
+
+void FlappyExperienceRing_Commit(struct FlappyExperienceRing* the_ring)
+{
+	/* Make the transitions visible before the tail that covers them. */
+	SDL_MemoryBarrierRelease();
+	SDL_AtomicSet(&the_ring->shared->tail.value, (int)the_ring->reservePosition);
+}
+
+SDL_bool FlappyExperienceRing_Push(struct FlappyExperienceRing* the_ring, const float* the_observation, Sint32 the_action, float the_reward, SDL_bool is_done, Uint32 world_index)
+{
+	FlappyExperienceTransition* the_transition = FlappyExperienceRing_Reserve(the_ring);
+	if(NULL == the_transition)
+	{
+		return SDL_FALSE;
+	}
+	the_transition->action = the_action;
+	the_transition->reward = the_reward;
+	the_transition->isDone = is_done ? 1 : 0;
+	the_transition->worldIndex = world_index;
+	SDL_memcpy(FlappyExperienceRing_GetObservation(the_transition), the_observation, the_ring->observationSize * sizeof(float));
+	return SDL_TRUE;
+}
+
+Uint32 FlappyExperienceRing_GetReadableCount(struct FlappyExperienceRing* the_ring)
+{
+	the_ring->cachedTail = (Uint32)SDL_AtomicGet(&the_ring->shared->tail.value);
+	/* Don't let the transition reads get ahead of the tail read. */
+	SDL_MemoryBarrierAcquire();
+	return the_ring->cachedTail - the_ring->readPosition;
+}
+
+const FlappyExperienceTransition* FlappyExperienceRing_PeekAt(struct FlappyExperienceRing* the_ring, Uint32 which_one)
+{
+	return FlappyExperienceRing_GetTransitionAtPosition(the_ring, the_ring->readPosition + which_one);
+}
+
+void FlappyExperienceRing_Release(struct FlappyExperienceRing* the_ring, Uint32 number_of_transitions)
+{
+	the_ring->readPosition += number_of_transitions;
+	/* Finish reading the transitions before the producer may reuse them. */
+	SDL_MemoryBarrierRelease();
+	SDL_AtomicSet(&the_ring->shared->head.value, (int)the_ring->readPosition);
+}
@@ -0,0 +1,159 @@
+#ifndef C_FLAPPY_EXPERIENCE_RING_H
+#define C_FLAPPY_EXPERIENCE_RING_H
+
+/* Set up for C function definitions, even when using C++ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef DOXYGEN_SHOULD_IGNORE_THIS
+/** @cond DOXYGEN_SHOULD_IGNORE_THIS */
+
+/* Note: For Doxygen to produce clean output, you should set the
+ * PREDEFINED option to remove C_FLAPPY_EXPERIENCE_RING_DECLSPEC, C_FLAPPY_EXPERIENCE_RING_CALL, and
+ * the DOXYGEN_SHOULD_IGNORE_THIS blocks.
+ * PREDEFINED = DOXYGEN_SHOULD_IGNORE_THIS=1 C_FLAPPY_EXPERIENCE_RING_DECLSPEC= C_FLAPPY_EXPERIENCE_RING_CALL=
+ */
+
+/** Windows needs to know explicitly which functions to export in a DLL. */
+#if defined(_WIN32)
+	#if defined(C_FLAPPY_EXPERIENCE_RING_BUILD_LIBRARY)
+		#define C_FLAPPY_EXPERIENCE_RING_DECLSPEC __declspec(dllexport)
+	#else
+		#define C_FLAPPY_EXPERIENCE_RING_DECLSPEC
+	#endif
+#else
+	#if defined(C_FLAPPY_EXPERIENCE_RING_BUILD_LIBRARY)
+		#if defined (__GNUC__) && __GNUC__ >= 4
+			#define C_FLAPPY_EXPERIENCE_RING_DECLSPEC __attribute__((visibility("default")))
+		#else
+			#define C_FLAPPY_EXPERIENCE_RING_DECLSPEC
+		#endif
+	#else
+		#define C_FLAPPY_EXPERIENCE_RING_DECLSPEC
+	#endif
+#endif
+
+/* For Windows, by default, use the C calling convention */
+#if defined(_WIN32)
+	#define C_FLAPPY_EXPERIENCE_RING_CALL __cdecl
+#else
+	#define C_FLAPPY_EXPERIENCE_RING_CALL
+#endif
+
+/** @endcond DOXYGEN_SHOULD_IGNORE_THIS */
+#endif /* DOXYGEN_SHOULD_IGNORE_THIS */
+
+
+#include "SDL.h"
+
+#include "FlappyBatch.h"
+
+/**
+ * @file
+ * FlappyExperienceRing streams (observation, action, reward, done) transitions from one actor process
+ * to one learner process through a POSIX shared memory object, with no sockets and no serialisation.
+ * The transitions are written and read in place in the shared mapping.
+ *
+ * It is the same head/tail ring as CircularQueue, made lock-free for exactly one producer and one consumer:
+ *	- The positions are free-running 32-bit counters and the capacity is a power of two,
+ *	  so an index is position & (capacity-1) and the fill level is tail - head, even across wraparound.
+ *	- Only the producer writes the tail and only the consumer writes the head. Each one sits on its own cache line.
+ *	- The producer reserves and fills any number of transitions, then publishes them all with a single
+ *	  FlappyExperienceRing_Commit. The consumer likewise reads a batch in place and frees it with one FlappyExperienceRing_Release.
+ *	- Each side caches the other side's position and only rereads it when it seems to have run out,
+ *	  so the shared cache lines are touched about once per batch instead of once per transition.
+ *
+ * Shared memory is only available where shm_open is (not on Windows or Android). Elsewhere Create and Open fail.
+ */
+
+/** Shared memory layout version. Open refuses rings with a different one. */
+#define FLAPPY_EXPERIENCE_RING_VERSION 1
+
+/**
+ * The fixed part of one transition in the ring. It is followed directly by observationSize floats
+ * (use FlappyExperienceRing_GetObservation): the observation the action was taken in, so the first
+ * transition of an episode carries its initial state. Every transition starts 16-byte aligned.
+ */
+typedef struct FlappyExperienceTransition
+{
+	Sint32 action; /**< The action taken on this tick (e.g. a FlappyBatchAction). */
+	float reward; /**< The reward received for it. */
+	Uint32 isDone; /**< Non-zero if the episode ended on this tick. */
+	Uint32 worldIndex; /**< Which of the actor's worlds this came from. The ring doesn't use it. */
+} FlappyExperienceTransition;
+
+struct FlappyExperienceRing;
+typedef struct FlappyExperienceRing FlappyExperienceRing;
+
+/**
+ * Creates (or replaces) the shared memory object ring_name and maps it as the producer end.
+ * @param ring_name A POSIX shared memory name such as "/flappy_actor0".
+ * @param capacity The number of transitions the ring holds. Rounded up to a power of two.
+ * @param observation_size The number of floats in each observation, e.g. FLAPPY_OBSERVATION_SIZE.
+ * @return The producer end, or NULL on failure. Close with FlappyExperienceRing_Close.
+ */
+extern C_FLAPPY_EXPERIENCE_RING_DECLSPEC struct FlappyExperienceRing* C_FLAPPY_EXPERIENCE_RING_CALL FlappyExperienceRing_Create(const char* ring_name, Uint32 capacity, Uint32 observation_size);
+
+/**
+ * Maps an existing ring made by FlappyExperienceRing_Create as the consumer end.
+ * @return The consumer end, or NULL if it doesn't exist or isn't a compatible ring.
+ */
+extern C_FLAPPY_EXPERIENCE_RING_DECLSPEC struct FlappyExperienceRing* C_FLAPPY_EXPERIENCE_RING_CALL FlappyExperienceRing_Open(const char* ring_name);
+
+/**
+ * Unmaps this end. The shared memory object stays around until FlappyExperienceRing_Unlink.
+ */
+extern C_FLAPPY_EXPERIENCE_RING_DECLSPEC void C_FLAPPY_EXPERIENCE_RING_CALL FlappyExperienceRing_Close(struct FlappyExperienceRing* the_ring);
+
+/**
+ * Removes the shared memory object's name. Processes that have it mapped can keep using it.
+ */
+extern C_FLAPPY_EXPERIENCE_RING_DECLSPEC void C_FLAPPY_EXPERIENCE_RING_CALL FlappyExperienceRing_Unlink(const char* ring_name);
+
+extern C_FLAPPY_EXPERIENCE_RING_DECLSPEC Uint32 C_FLAPPY_EXPERIENCE_RING_CALL FlappyExperienceRing_GetCapacity(struct FlappyExperienceRing* the_ring);
+extern C_FLAPPY_EXPERIENCE_RING_DECLSPEC Uint32 C_FLAPPY_EXPERIENCE_RING_CALL FlappyExperienceRing_GetObservationSize(struct FlappyExperienceRing* the_ring);
+
+/**
+ * Returns the observation floats that follow the_transition.
+ */
+extern C_FLAPPY_EXPERIENCE_RING_DECLSPEC float* C_FLAPPY_EXPERIENCE_RING_CALL FlappyExperienceRing_GetObservation(FlappyExperienceTransition* the_transition);
+
+/**
+ * Producer only. Hands out the next free transition to fill in. The consumer can't see it until FlappyExperienceRing_Commit.
+ * @return The transition, or NULL if the ring is full (the consumer is behind).
+ */
+extern C_FLAPPY_EXPERIENCE_RING_DECLSPEC FlappyExperienceTransition* C_FLAPPY_EXPERIENCE_RING_CALL FlappyExperienceRing_Reserve(struct FlappyExperienceRing* the_ring);
+
+/**
+ * Producer only. Publishes every transition reserved since the last commit.
+ */
+extern C_FLAPPY_EXPERIENCE_RING_DECLSPEC void C_FLAPPY_EXPERIENCE_RING_CALL FlappyExperienceRing_Commit(struct FlappyExperienceRing* the_ring);
+
+/**
+ * Producer only. Reserves one transition and copies the arguments into it. It still needs a commit.
+ * @return SDL_FALSE if the ring is full.
+ */
+extern C_FLAPPY_EXPERIENCE_RING_DECLSPEC SDL_bool C_FLAPPY_EXPERIENCE_RING_CALL FlappyExperienceRing_Push(struct FlappyExperienceRing* the_ring, const float* the_observation, Sint32 the_action, float the_reward, SDL_bool is_done, Uint32 world_index);
+
+/**
+ * Consumer only. Returns how many committed transitions are ready to read.
+ */
+extern C_FLAPPY_EXPERIENCE_RING_DECLSPEC Uint32 C_FLAPPY_EXPERIENCE_RING_CALL FlappyExperienceRing_GetReadableCount(struct FlappyExperienceRing* the_ring);
+
+/**
+ * Consumer only. Returns the which_one'th readable transition (0 is the oldest), in place in the shared memory.
+ * which_one must be less than the last FlappyExperienceRing_GetReadableCount().
+ */
+extern C_FLAPPY_EXPERIENCE_RING_DECLSPEC const FlappyExperienceTransition* C_FLAPPY_EXPERIENCE_RING_CALL FlappyExperienceRing_PeekAt(struct FlappyExperienceRing* the_ring, Uint32 which_one);
+
+/**
+ * Consumer only. Hands the oldest number_of_transitions back to the producer. Don't touch them after this.
+ */
+extern C_FLAPPY_EXPERIENCE_RING_DECLSPEC void C_FLAPPY_EXPERIENCE_RING_CALL FlappyExperienceRing_Release(struct FlappyExperienceRing* the_ring, Uint32 number_of_transitions);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* C_FLAPPY_EXPERIENCE_RING_H */
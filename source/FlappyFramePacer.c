@@ -0,0 +1,267 @@
+/*
+	FlappyFramePacer replaces the old FPS_CAP block in main_loop, which did an SDL_Delay of the whole
+	remaining milli-seconds. SDL_Delay can only sleep whole milli-seconds and usually oversleeps a bit,
+	so the frames came out in uneven 15/17 ms beats. Here we only sleep until a little before the deadline,
+	then spin on the performance counter, which is precise.
+*/
+
+#include "FlappyFramePacer.h"
+#include "CircularQueueTyped.h"
+
+#define FLAPPY_FRAME_PACER_NANOSECONDS_PER_SECOND 1000000000ull
+
+CIRCULAR_QUEUE_TYPED_DEFINE(FlappyFramePacerHistory, FlappyFramePacerRecord)
+
+struct FlappyFramePacer
+{
+	double targetRate;
+	/* Performance counter counts per frame. A double so rates like 144 (or 59.94) don't get rounded. */
+	double countsPerFrame;
+	Uint64 counterFrequency;
+	Uint64 spinThreshold;
+
+	SDL_bool isVsyncEnabled;
+	int refreshRate;
+
+	/* Frame N of the current schedule is due at scheduleStartTime + N * countsPerFrame. */
+	SDL_bool isScheduleStarted;
+	Uint64 scheduleStartTime;
+	Uint64 scheduleFrameNumber;
+	Uint64 previousWakeTime;
+
+	Uint64 frameNumber;
+	Uint32 numberOfMissedFrames;
+	FlappyFramePacerHistory frameHistory;
+};
+
+
+static Uint64 FlappyFramePacer_CountsToNanoseconds(struct FlappyFramePacer* the_pacer, Uint64 the_counts)
+{
+	Uint64 frequency = the_pacer->counterFrequency;
+	/* Split so the_counts * 1e9 can't overflow. */
+	return (the_counts / frequency) * FLAPPY_FRAME_PACER_NANOSECONDS_PER_SECOND
+		+ ((the_counts % frequency) * FLAPPY_FRAME_PACER_NANOSECONDS_PER_SECOND) / frequency;
+}
+
+static Sint64 FlappyFramePacer_CountDifferenceToNanoseconds(struct FlappyFramePacer* the_pacer, Uint64 end_time, Uint64 start_time)
+{
+	if(end_time >= start_time)
+	{
+		return (Sint64)FlappyFramePacer_CountsToNanoseconds(the_pacer, end_time - start_time);
+	}
+	else
+	{
+		return -(Sint64)FlappyFramePacer_CountsToNanoseconds(the_pacer, start_time - end_time);
+	}
+}
+
+static void FlappyFramePacer_AddRecord(struct FlappyFramePacer* the_pacer, FlappyFramePacerRecord* the_record)
+{
+	/* Keep only the most recent frames. */
+	if(FlappyFramePacerHistory_Size(&the_pacer->frameHistory) == FlappyFramePacerHistory_MaxSize(&the_pacer->frameHistory))
+	{
+		FlappyFramePacerHistory_PopFront(&the_pacer->frameHistory);
+	}
+	FlappyFramePacerHistory_PushBack(&the_pacer->frameHistory, *the_record);
+}
+
+struct FlappyFramePacer* FlappyFramePacer_Create(double target_rate)
+{
+	struct FlappyFramePacer* the_pacer = (struct FlappyFramePacer*)SDL_calloc(1, sizeof(struct FlappyFramePacer));
+	if(NULL == the_pacer)
+	{
+		return NULL;
+	}
+	if(0 == FlappyFramePacerHistory_Init(&the_pacer->frameHistory, FLAPPY_FRAME_PACER_HISTORY_LENGTH))
+	{
+		SDL_free(the_pacer);
+		return NULL;
+	}
+	the_pacer->counterFrequency = SDL_GetPerformanceFrequency();
+	the_pacer->targetRate = 60.0;
+	the_pacer->countsPerFrame = (double)the_pacer->counterFrequency / the_pacer->targetRate;
+	FlappyFramePacer_SetTargetRate(the_pacer, target_rate);
+	FlappyFramePacer_SetSpinThreshold(the_pacer, FLAPPY_FRAME_PACER_DEFAULT_SPIN_THRESHOLD_MICROSECONDS);
+	return the_pacer;
+}
+
+void FlappyFramePacer_Free(struct FlappyFramePacer* the_pacer)
+{
+	if(NULL == the_pacer)
+	{
+		return;
+	}
+	FlappyFramePacerHistory_Destroy(&the_pacer->frameHistory);
+	SDL_free(the_pacer);
+}
+
+void FlappyFramePacer_SetTargetRate(struct FlappyFramePacer* the_pacer, double target_rate)
+{
+	if(target_rate <= 0.0)
+	{
+		return;
+	}
+	the_pacer->targetRate = target_rate;
+	the_pacer->countsPerFrame = (double)the_pacer->counterFrequency / target_rate;
+	/* The old deadlines don't mean anything at the new rate. */
+	the_pacer->isScheduleStarted = SDL_FALSE;
+}
+
+double FlappyFramePacer_GetTargetRate(struct FlappyFramePacer* the_pacer)
+{
+	return the_pacer->targetRate;
+}
+
+void FlappyFramePacer_SetVsync(struct FlappyFramePacer* the_pacer, SDL_bool is_vsync_enabled, int refresh_rate)
+{
+	the_pacer->isVsyncEnabled = is_vsync_enabled;
+	the_pacer->refreshRate = (refresh_rate > 0) ? refresh_rate : 0;
+	the_pacer->isScheduleStarted = SDL_FALSE;
+}
+
+void FlappyFramePacer_SetSpinThreshold(struct FlappyFramePacer* the_pacer, Uint32 spin_threshold_microseconds)
+{
+	the_pacer->spinThreshold = ((Uint64)spin_threshold_microseconds * the_pacer->counterFrequency) / 1000000;
+}
+
+void FlappyFramePacer_WaitForNextFrame(struct FlappyFramePacer* the_pacer)
+{
+	Uint64 now_time = SDL_GetPerformanceCounter();
+	Uint64 next_frame_number;
+	Uint64 due_time;
+	Uint64 sleep_start_time;
+	Uint64 spin_start_time;
+	Uint64 wake_time;
+	FlappyFramePacerRecord the_record;
+
+	if( ! the_pacer->isScheduleStarted)
+	{
+		the_pacer->isScheduleStarted = SDL_TRUE;
+		the_pacer->scheduleStartTime = now_time;
+		the_pacer->scheduleFrameNumber = 0;
+		the_pacer->previousWakeTime = now_time;
+		return;
+	}
+
+	SDL_zero(the_record);
+	the_record.frameNumber = the_pacer->frameNumber;
+	the_record.workTime = FlappyFramePacer_CountsToNanoseconds(the_pacer, now_time - the_pacer->previousWakeTime);
+	the_pacer->frameNumber++;
+
+	next_frame_number = the_pacer->scheduleFrameNumber + 1;
+	due_time = the_pacer->scheduleStartTime + (Uint64)((double)next_frame_number * the_pacer->countsPerFrame + 0.5);
+
+	if(the_pacer->isVsyncEnabled)
+	{
+		if((0 == the_pacer->refreshRate) || (the_pacer->targetRate >= (double)the_pacer->refreshRate - 0.5))
+		{
+			/* The last SDL_RenderPresent already waited for the vblank, and waiting any more would only make us miss the next one.
+				Just follow the display.
+			 */
+			the_record.pacingError = FlappyFramePacer_CountDifferenceToNanoseconds(the_pacer, now_time, the_pacer->previousWakeTime + (Uint64)(the_pacer->countsPerFrame + 0.5));
+			the_record.frameInterval = the_record.workTime;
+			the_pacer->scheduleStartTime = now_time;
+			the_pacer->scheduleFrameNumber = 0;
+			the_pacer->previousWakeTime = now_time;
+			FlappyFramePacer_AddRecord(the_pacer, &the_record);
+			return;
+		}
+		else
+		{
+			/* The display is faster than we want, so the present will wait for whichever vblank comes after we wake.
+				Waking half a refresh early makes that the one nearest the deadline.
+			 */
+			due_time -= (Uint64)(((double)the_pacer->counterFrequency / (double)the_pacer->refreshRate) * 0.5);
+		}
+	}
+
+	if(now_time > (due_time + (Uint64)the_pacer->countsPerFrame))
+	{
+		/* More than a whole frame late (a hitch, or the window was being dragged).
+			Start a new schedule from here instead of rushing out frames to catch up.
+		 */
+		the_record.pacingError = FlappyFramePacer_CountDifferenceToNanoseconds(the_pacer, now_time, due_time);
+		the_record.frameInterval = the_record.workTime;
+		the_record.wasMissed = SDL_TRUE;
+		the_pacer->numberOfMissedFrames++;
+		the_pacer->scheduleStartTime = now_time;
+		the_pacer->scheduleFrameNumber = 0;
+		the_pacer->previousWakeTime = now_time;
+		FlappyFramePacer_AddRecord(the_pacer, &the_record);
+		return;
+	}
+
+	/* Sleep for the whole milli-seconds that are safely before the deadline... */
+	sleep_start_time = now_time;
+	if(due_time > (now_time + the_pacer->spinThreshold))
+	{
+		Uint32 sleep_milliseconds = (Uint32)(((due_time - now_time - the_pacer->spinThreshold) * 1000) / the_pacer->counterFrequency);
+		if(sleep_milliseconds > 0)
+		{
+			SDL_Delay(sleep_milliseconds);
+		}
+	}
+	/* ...then spin for the rest. */
+	spin_start_time = SDL_GetPerformanceCounter();
+	wake_time = spin_start_time;
+	while(wake_time < due_time)
+	{
+		wake_time = SDL_GetPerformanceCounter();
+	}
+
+	the_record.sleepTime = FlappyFramePacer_CountsToNanoseconds(the_pacer, spin_start_time - sleep_start_time);
+	the_record.spinTime = FlappyFramePacer_CountsToNanoseconds(the_pacer, wake_time - spin_start_time);
+	the_record.pacingError = FlappyFramePacer_CountDifferenceToNanoseconds(the_pacer, wake_time, due_time);
+	the_record.frameInterval = FlappyFramePacer_CountsToNanoseconds(the_pacer, wake_time - the_pacer->previousWakeTime);
+	the_pacer->scheduleFrameNumber = next_frame_number;
+	the_pacer->previousWakeTime = wake_time;
+	FlappyFramePacer_AddRecord(the_pacer, &the_record);
+}
+
+Uint32 FlappyFramePacer_GetNumberOfRecords(struct FlappyFramePacer* the_pacer)
+{
+	return FlappyFramePacerHistory_Size(&the_pacer->frameHistory);
+}
+
+SDL_bool FlappyFramePacer_GetRecord(struct FlappyFramePacer* the_pacer, Uint32 which_record, FlappyFramePacerRecord* out_record)
+{
+	FlappyFramePacerRecord* the_record = FlappyFramePacerHistory_ValueAtIndex(&the_pacer->frameHistory, which_record);
+	if(NULL == the_record)
+	{
+		return SDL_FALSE;
+	}
+	*out_record = *the_record;
+	return SDL_TRUE;
+}
+
+void FlappyFramePacer_GetPacingErrorStatistics(struct FlappyFramePacer* the_pacer, Uint64* out_mean_absolute_error, Uint64* out_max_absolute_error)
+{
+	Uint32 number_of_records = FlappyFramePacerHistory_Size(&the_pacer->frameHistory);
+	Uint64 total_error = 0;
+	Uint64 max_error = 0;
+	Uint32 i;
+
+	for(i=0; i<number_of_records; i++)
+	{
+		Sint64 the_error = FlappyFramePacerHistory_AtIndex(&the_pacer->frameHistory, i)->pacingError;
+		Uint64 absolute_error = (the_error < 0) ? (Uint64)(-the_error) : (Uint64)the_error;
+		total_error += absolute_error;
+		if(absolute_error > max_error)
+		{
+			max_error = absolute_error;
+		}
+	}
+	if(NULL != out_mean_absolute_error)
+	{
+		*out_mean_absolute_error = (number_of_records > 0) ? (total_error / number_of_records) : 0;
+	}
+	if(NULL != out_max_absolute_error)
+	{
+		*out_max_absolute_error = max_error;
+	}
+}
+
+Uint32 FlappyFramePacer_GetNumberOfMissedFrames(struct FlappyFramePacer* the_pacer)
+{
+	return the_pacer->numberOfMissedFrames;
+}
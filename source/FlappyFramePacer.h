@@ -0,0 +1,151 @@
+#ifndef C_FLAPPY_FRAME_PACER_H
+#define C_FLAPPY_FRAME_PACER_H
+
+/* Set up for C function definitions, even when using C++ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef DOXYGEN_SHOULD_IGNORE_THIS
+/** @cond DOXYGEN_SHOULD_IGNORE_THIS */
+
+/* Note: For Doxygen to produce clean output, you should set the
+ * PREDEFINED option to remove C_FLAPPY_FRAME_PACER_DECLSPEC, C_FLAPPY_FRAME_PACER_CALL, and
+ * the DOXYGEN_SHOULD_IGNORE_THIS blocks.
+ * PREDEFINED = DOXYGEN_SHOULD_IGNORE_THIS=1 C_FLAPPY_FRAME_PACER_DECLSPEC= C_FLAPPY_FRAME_PACER_CALL=
+ */
+
+/** Windows needs to know explicitly which functions to export in a DLL. */
+#if defined(_WIN32)
+	#if defined(C_FLAPPY_FRAME_PACER_BUILD_LIBRARY)
+		#define C_FLAPPY_FRAME_PACER_DECLSPEC __declspec(dllexport)
+	#else
+		#define C_FLAPPY_FRAME_PACER_DECLSPEC
+	#endif
+#else
+	#if defined(C_FLAPPY_FRAME_PACER_BUILD_LIBRARY)
+		#if defined (__GNUC__) && __GNUC__ >= 4
+			#define C_FLAPPY_FRAME_PACER_DECLSPEC __attribute__((visibility("default")))
+		#else
+			#define C_FLAPPY_FRAME_PACER_DECLSPEC
+		#endif
+	#else
+		#define C_FLAPPY_FRAME_PACER_DECLSPEC
+	#endif
+#endif
+
+/* For Windows, by default, use the C calling convention */
+#if defined(_WIN32)
+	#define C_FLAPPY_FRAME_PACER_CALL __cdecl
+#else
+	#define C_FLAPPY_FRAME_PACER_CALL
+#endif
+
+/** @endcond DOXYGEN_SHOULD_IGNORE_THIS */
+#endif /* DOXYGEN_SHOULD_IGNORE_THIS */
+
+
+
+#include "SDL.h"
+
+/**
+ * @file
+ * FlappyFramePacer holds the main loop to a steady frame rate.
+ * Call FlappyFramePacer_WaitForNextFrame once every frame, after drawing and right before SDL_RenderPresent,
+ * so the frame goes on screen when it is due rather than one frame before. It sleeps with SDL_Delay until
+ * shortly before the frame is due, then spins on SDL_GetPerformanceCounter for the rest,
+ * so frames come out evenly spaced instead of in whole milli-second (15/17 ms) beats.
+ *
+ * Frame deadlines are counted from a fixed start (start + frame_number / rate), so rounding never accumulates.
+ * If a frame runs more than a whole frame late, the pacer starts counting again from now
+ * instead of rushing out frames to catch up.
+ *
+ * If the renderer presents with vsync, SDL_RenderPresent already waits for the vblank.
+ * Tell the pacer with FlappyFramePacer_SetVsync: when the target rate is at or above the refresh rate it doesn't wait at all,
+ * and when it is below (e.g. 60 on a 144 Hz display) it wakes half a refresh early so the present lands on the right vblank.
+ *
+ * Every frame's timing goes into a short history (see FlappyFramePacerRecord) so the pacing error can be measured.
+ */
+
+/** The number of frames FlappyFramePacer keeps records for. */
+#define FLAPPY_FRAME_PACER_HISTORY_LENGTH 256
+/** How long before the deadline the pacer stops sleeping and starts spinning, unless changed with FlappyFramePacer_SetSpinThreshold. */
+#define FLAPPY_FRAME_PACER_DEFAULT_SPIN_THRESHOLD_MICROSECONDS 2000
+
+/** The timing of one paced frame. All times are in nano-seconds. */
+typedef struct FlappyFramePacerRecord
+{
+	Uint64 frameNumber; /**< Counts every frame since the pacer was created. */
+	Sint64 pacingError; /**< When the wait returned minus when the frame was due. Positive is late. */
+	Uint64 frameInterval; /**< The time since the previous wait returned. */
+	Uint64 workTime; /**< The time from the previous wait returning to this wait being called (i.e. the frame's own work). */
+	Uint64 sleepTime; /**< How long was spent in SDL_Delay. */
+	Uint64 spinTime; /**< How long was spent spinning after that. */
+	SDL_bool wasMissed; /**< SDL_TRUE if the frame was more than a whole frame late and the schedule was restarted. */
+} FlappyFramePacerRecord;
+
+struct FlappyFramePacer;
+
+/**
+ * Creates a pacer.
+ * @param target_rate The frame rate to hold, in frames per second.
+ * @return The new pacer, or NULL on failure.
+ */
+extern C_FLAPPY_FRAME_PACER_DECLSPEC struct FlappyFramePacer* C_FLAPPY_FRAME_PACER_CALL FlappyFramePacer_Create(double target_rate);
+
+extern C_FLAPPY_FRAME_PACER_DECLSPEC void C_FLAPPY_FRAME_PACER_CALL FlappyFramePacer_Free(struct FlappyFramePacer* the_pacer);
+
+/**
+ * Changes the frame rate. The schedule restarts from the next frame.
+ * Rates <= 0 are ignored.
+ */
+extern C_FLAPPY_FRAME_PACER_DECLSPEC void C_FLAPPY_FRAME_PACER_CALL FlappyFramePacer_SetTargetRate(struct FlappyFramePacer* the_pacer, double target_rate);
+
+extern C_FLAPPY_FRAME_PACER_DECLSPEC double C_FLAPPY_FRAME_PACER_CALL FlappyFramePacer_GetTargetRate(struct FlappyFramePacer* the_pacer);
+
+/**
+ * Tells the pacer whether SDL_RenderPresent waits for vsync, and the display's refresh rate.
+ * @param refresh_rate In Hz. 0 if unknown, in which case vsync is assumed to be at or below the target rate.
+ */
+extern C_FLAPPY_FRAME_PACER_DECLSPEC void C_FLAPPY_FRAME_PACER_CALL FlappyFramePacer_SetVsync(struct FlappyFramePacer* the_pacer, SDL_bool is_vsync_enabled, int refresh_rate);
+
+/**
+ * Sets how long before the deadline to switch from sleeping to spinning.
+ * Higher wastes more CPU. Lower risks oversleeping on systems with coarse timers.
+ */
+extern C_FLAPPY_FRAME_PACER_DECLSPEC void C_FLAPPY_FRAME_PACER_CALL FlappyFramePacer_SetSpinThreshold(struct FlappyFramePacer* the_pacer, Uint32 spin_threshold_microseconds);
+
+/**
+ * Waits until the next frame is due and records how close it got.
+ * The first call only starts the schedule.
+ */
+extern C_FLAPPY_FRAME_PACER_DECLSPEC void C_FLAPPY_FRAME_PACER_CALL FlappyFramePacer_WaitForNextFrame(struct FlappyFramePacer* the_pacer);
+
+/**
+ * Returns how many records are in the history (at most FLAPPY_FRAME_PACER_HISTORY_LENGTH).
+ */
+extern C_FLAPPY_FRAME_PACER_DECLSPEC Uint32 C_FLAPPY_FRAME_PACER_CALL FlappyFramePacer_GetNumberOfRecords(struct FlappyFramePacer* the_pacer);
+
+/**
+ * Copies a record from the history.
+ * @param which_record 0 is the oldest, FlappyFramePacer_GetNumberOfRecords()-1 is the most recent frame.
+ * @return SDL_FALSE if which_record is out of range.
+ */
+extern C_FLAPPY_FRAME_PACER_DECLSPEC SDL_bool C_FLAPPY_FRAME_PACER_CALL FlappyFramePacer_GetRecord(struct FlappyFramePacer* the_pacer, Uint32 which_record, FlappyFramePacerRecord* out_record);
+
+/**
+ * Returns the mean and the worst absolute pacing error (in nano-seconds) over the history.
+ */
+extern C_FLAPPY_FRAME_PACER_DECLSPEC void C_FLAPPY_FRAME_PACER_CALL FlappyFramePacer_GetPacingErrorStatistics(struct FlappyFramePacer* the_pacer, Uint64* out_mean_absolute_error, Uint64* out_max_absolute_error);
+
+/**
+ * Returns the number of frames (since creation) that were more than a whole frame late.
+ */
+extern C_FLAPPY_FRAME_PACER_DECLSPEC Uint32 C_FLAPPY_FRAME_PACER_CALL FlappyFramePacer_GetNumberOfMissedFrames(struct FlappyFramePacer* the_pacer);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* C_FLAPPY_FRAME_PACER_H */
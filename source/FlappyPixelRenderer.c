@@ -0,0 +1,686 @@
+/*
+	CPU renderer for low resolution pixel observations.
+	All the resampling happens up front: each sprite is drawn once at the output resolution with 4x4 supersampling
+	(and the bird once per rotation), and every pixel ends up either fully opaque or fully transparent.
+	A frame is then one memcpy for the background, masked row blends for the pipes and the bird,
+	and one memcpy per row for the ground, read at the right offset from a strip of two ground tiles.
+	The masks have one byte per output byte (0xFF or 0x00), so blending a row is the same
+	and/andnot/or for gray and RGB and doesn't care about pixel boundaries.
+*/
+
+#include <math.h>
+
+#include "FlappyPixelRenderer.h"
+
+#if (defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)) && !defined(FLAPPY_PIXEL_RENDERER_DISABLE_SIMD)
+	#define FLAPPY_PIXEL_RENDERER_HAS_X86_SIMD 1
+	#include <emmintrin.h>
+	#if defined(__GNUC__) || defined(__clang__)
+		#define FLAPPY_PIXEL_RENDERER_TARGET_SSE2 __attribute__((target("sse2")))
+	#else
+		#define FLAPPY_PIXEL_RENDERER_TARGET_SSE2
+	#endif
+#else
+	#define FLAPPY_PIXEL_RENDERER_HAS_X86_SIMD 0
+#endif
+
+/* The pipe textures are drawn 512 pixels tall (see Flappy_RenderPipes). */
+#define PIXEL_PIPE_SPRITE_HEIGHT 512
+/* The stand-in pipe's lip at the gap end, and how far the rest of the pipe is inset from it. */
+#define PIXEL_PIPE_LIP_HEIGHT 26
+#define PIXEL_PIPE_BODY_INSET 5
+#define PIXEL_SUPERSAMPLES_PER_AXIS 4
+
+struct FlappyPixelImage
+{
+	Sint32 width;
+	Sint32 height;
+	/* width * height * bytesPerPixel bytes, tightly packed. */
+	Uint8* pixels;
+	/* Same layout as pixels. 0xFF where opaque, 0x00 where transparent. NULL if the whole image is opaque. */
+	Uint8* mask;
+};
+
+struct FlappyPixelRenderer
+{
+	Sint32 width;
+	Sint32 height;
+	Sint32 bytesPerPixel;
+	size_t pitch;
+	SDL_bool useSSE2;
+
+	/* width x (at least) height, opaque. */
+	struct FlappyPixelImage background;
+	struct FlappyPixelImage pipeBottom;
+	struct FlappyPixelImage pipeTop;
+	struct FlappyPixelImage birdRotations[FLAPPY_PIXEL_RENDERER_NUMBER_OF_BIRD_ROTATIONS];
+	/* Two ground tiles side by side (2*width wide), opaque, so any scroll offset is one contiguous row. */
+	struct FlappyPixelImage groundStrip;
+	/* The first output row covered by the ground. */
+	Sint32 groundTop;
+};
+
+/* What the sprite images are resampled from: an ARGB8888 surface or, if that's NULL, the built-in stand-in. */
+struct FlappyPixelSource
+{
+	int whichSprite;
+	SDL_Surface* surface;
+	double spriteWidth;
+	double spriteHeight;
+};
+
+
+/* Scales a screen coordinate to an output coordinate, rounding towards negative infinity. */
+static Sint32 FlappyPixelRenderer_ScalePosition(Sint32 screen_position, Sint32 output_size, Sint32 screen_size)
+{
+	Sint64 scaled = (Sint64)screen_position * output_size;
+	if(scaled < 0)
+	{
+		return (Sint32)(-((-scaled + screen_size - 1) / screen_size));
+	}
+	return (Sint32)(scaled / screen_size);
+}
+
+/* Scales a screen length to an output length, rounded, but at least 1. */
+static Sint32 FlappyPixelRenderer_ScaleSize(Sint32 screen_size_of_thing, Sint32 output_size, Sint32 screen_size)
+{
+	Sint32 scaled = (Sint32)(((Sint64)screen_size_of_thing * output_size + screen_size/2) / screen_size);
+	return (scaled < 1) ? 1 : scaled;
+}
+
+static void FlappyPixelRenderer_SetRGB(Uint8* out_rgb, Uint8 r, Uint8 g, Uint8 b)
+{
+	out_rgb[0] = r;
+	out_rgb[1] = g;
+	out_rgb[2] = b;
+}
+
+/* The stand-in sprites. px and py are in the sprite's own screen pixels (y down). Returns the alpha. */
+static Uint8 FlappyPixelRenderer_SampleStandIn(int which_sprite, double px, double py, double sprite_width, double sprite_height, Uint8* out_rgb)
+{
+	switch(which_sprite)
+	{
+		case FLAPPY_PIXEL_SPRITE_BACKGROUND:
+		{
+			double t = py / sprite_height;
+			FlappyPixelRenderer_SetRGB(out_rgb, (Uint8)(78 + t*120), (Uint8)(192 + t*50), (Uint8)(202 + t*40));
+			return 255;
+		}
+		case FLAPPY_PIXEL_SPRITE_PIPE_BOTTOM:
+		case FLAPPY_PIXEL_SPRITE_PIPE_TOP:
+		{
+			SDL_bool is_lip = (FLAPPY_PIXEL_SPRITE_PIPE_BOTTOM == which_sprite) ? (py < PIXEL_PIPE_LIP_HEIGHT) : (py >= (sprite_height - PIXEL_PIPE_LIP_HEIGHT));
+			double left = is_lip ? 0.0 : PIXEL_PIPE_BODY_INSET;
+			double right = is_lip ? sprite_width : (sprite_width - PIXEL_PIPE_BODY_INSET);
+			double t = (px - left) / (right - left);
+			if((px < left) || (px >= right))
+			{
+				return 0;
+			}
+			if((px < (left + 3)) || (px >= (right - 3)))
+			{
+				FlappyPixelRenderer_SetRGB(out_rgb, 84, 56, 71);
+			}
+			else if((t > 0.15) && (t < 0.3))
+			{
+				FlappyPixelRenderer_SetRGB(out_rgb, 155, 227, 89);
+			}
+			else if(t > 0.8)
+			{
+				FlappyPixelRenderer_SetRGB(out_rgb, 85, 128, 34);
+			}
+			else
+			{
+				FlappyPixelRenderer_SetRGB(out_rgb, 115, 191, 46);
+			}
+			return 255;
+		}
+		case FLAPPY_PIXEL_SPRITE_BIRD:
+		{
+			double u = px / sprite_width;
+			double v = py / sprite_height;
+			double body = ((u-0.45)*(u-0.45))/(0.40*0.40) + ((v-0.5)*(v-0.5))/(0.46*0.46);
+			double eye = ((u-0.68)*(u-0.68)) + ((v-0.32)*(v-0.32));
+			double wing = ((u-0.3)*(u-0.3))/(0.18*0.18) + ((v-0.58)*(v-0.58))/(0.12*0.12);
+			/* The beak sticks out to the right, so a rotated bird shows which way it faces. */
+			if((u >= 0.72) && (u < 1.0) && (v >= 0.5) && (v < 0.74))
+			{
+				FlappyPixelRenderer_SetRGB(out_rgb, 240, 100, 40);
+				return 255;
+			}
+			if(body >= 1.0)
+			{
+				return 0;
+			}
+			if(eye < (0.05*0.05))
+			{
+				FlappyPixelRenderer_SetRGB(out_rgb, 0, 0, 0);
+			}
+			else if(eye < (0.13*0.13))
+			{
+				FlappyPixelRenderer_SetRGB(out_rgb, 255, 255, 255);
+			}
+			else if(body >= 0.8)
+			{
+				FlappyPixelRenderer_SetRGB(out_rgb, 84, 56, 71);
+			}
+			else if(wing < 1.0)
+			{
+				FlappyPixelRenderer_SetRGB(out_rgb, 250, 240, 200);
+			}
+			else
+			{
+				FlappyPixelRenderer_SetRGB(out_rgb, 250, 200, 50);
+			}
+			return 255;
+		}
+		case FLAPPY_PIXEL_SPRITE_GROUND:
+		default:
+		{
+			if(py < 3)
+			{
+				FlappyPixelRenderer_SetRGB(out_rgb, 84, 56, 71);
+			}
+			else if(py < 10)
+			{
+				if(((Sint32)(px + py) / 12) % 2)
+				{
+					FlappyPixelRenderer_SetRGB(out_rgb, 115, 191, 46);
+				}
+				else
+				{
+					FlappyPixelRenderer_SetRGB(out_rgb, 155, 227, 89);
+				}
+			}
+			else
+			{
+				FlappyPixelRenderer_SetRGB(out_rgb, 222, 216, 149);
+			}
+			return 255;
+		}
+	}
+}
+
+/* Samples the source at (u, v) in [0,1) x [0,1). Anything outside is transparent. Returns the alpha. */
+static Uint8 FlappyPixelRenderer_Sample(const struct FlappyPixelSource* the_source, double u, double v, Uint8* out_rgb)
+{
+	/* The background and ground are opaque, so their edges are stretched instead of cut off. */
+	if((FLAPPY_PIXEL_SPRITE_BACKGROUND == the_source->whichSprite) || (FLAPPY_PIXEL_SPRITE_GROUND == the_source->whichSprite))
+	{
+		u = (u < 0.0) ? 0.0 : ((u > 0.999999) ? 0.999999 : u);
+		v = (v < 0.0) ? 0.0 : ((v > 0.999999) ? 0.999999 : v);
+	}
+	else if((u < 0.0) || (u >= 1.0) || (v < 0.0) || (v >= 1.0))
+	{
+		return 0;
+	}
+	if(NULL != the_source->surface)
+	{
+		SDL_Surface* the_surface = the_source->surface;
+		int texel_x = (int)(u * the_surface->w);
+		int texel_y = (int)(v * the_surface->h);
+		Uint32 the_texel = ((const Uint32*)((const Uint8*)the_surface->pixels + (size_t)texel_y * the_surface->pitch))[texel_x];
+		FlappyPixelRenderer_SetRGB(out_rgb, (Uint8)(the_texel >> 16), (Uint8)(the_texel >> 8), (Uint8)the_texel);
+		return (Uint8)(the_texel >> 24);
+	}
+	return FlappyPixelRenderer_SampleStandIn(the_source->whichSprite, u * the_source->spriteWidth, v * the_source->spriteHeight, the_source->spriteWidth, the_source->spriteHeight, out_rgb);
+}
+
+static void FlappyPixelRenderer_FreeImage(struct FlappyPixelImage* the_image)
+{
+	SDL_free(the_image->pixels);
+	SDL_free(the_image->mask);
+	SDL_zerop(the_image);
+}
+
+/*
+	Draws the source into a new image_width x image_height image.
+	The image covers a box_width x box_height area of screen pixels, centred on the sprite and rotated by the_angle
+	(radians, counterclockwise on screen, like the bird's body angle). Each output pixel averages 4x4 samples
+	and becomes opaque if at least half of them hit the sprite.
+	If is_opaque, no mask is made and the transparent pixels are left black.
+ */
+static SDL_bool FlappyPixelRenderer_BuildImage(struct FlappyPixelRenderer* the_renderer, struct FlappyPixelImage* out_image,
+	Sint32 image_width, Sint32 image_height, double box_width, double box_height, double the_angle,
+	const struct FlappyPixelSource* the_source, SDL_bool is_opaque)
+{
+	size_t image_size = (size_t)image_width * image_height * the_renderer->bytesPerPixel;
+	double cos_angle = cos(the_angle);
+	double sin_angle = sin(the_angle);
+	SDL_bool has_transparency = SDL_FALSE;
+	Sint32 i;
+	Sint32 j;
+
+	SDL_zerop(out_image);
+	out_image->width = image_width;
+	out_image->height = image_height;
+	out_image->pixels = (Uint8*)SDL_calloc(1, image_size);
+	if( ! is_opaque)
+	{
+		out_image->mask = (Uint8*)SDL_calloc(1, image_size);
+	}
+	if((NULL == out_image->pixels) || ( ! is_opaque && (NULL == out_image->mask)))
+	{
+		FlappyPixelRenderer_FreeImage(out_image);
+		return SDL_FALSE;
+	}
+
+	for(j=0; j<image_height; j++)
+	{
+		for(i=0; i<image_width; i++)
+		{
+			Uint32 sum_r = 0;
+			Uint32 sum_g = 0;
+			Uint32 sum_b = 0;
+			Uint32 number_of_hits = 0;
+			size_t byte_index = ((size_t)j * image_width + i) * the_renderer->bytesPerPixel;
+			int a;
+			int b;
+
+			for(b=0; b<PIXEL_SUPERSAMPLES_PER_AXIS; b++)
+			{
+				for(a=0; a<PIXEL_SUPERSAMPLES_PER_AXIS; a++)
+				{
+					/* Offset from the centre in screen pixels, then rotated back into the sprite. */
+					double box_x = ((i + (a + 0.5) / PIXEL_SUPERSAMPLES_PER_AXIS) / image_width - 0.5) * box_width;
+					double box_y = ((j + (b + 0.5) / PIXEL_SUPERSAMPLES_PER_AXIS) / image_height - 0.5) * box_height;
+					double sprite_x = cos_angle * box_x - sin_angle * box_y;
+					double sprite_y = sin_angle * box_x + cos_angle * box_y;
+					Uint8 the_rgb[3];
+					if(FlappyPixelRenderer_Sample(the_source, sprite_x / the_source->spriteWidth + 0.5, sprite_y / the_source->spriteHeight + 0.5, the_rgb) >= 128)
+					{
+						sum_r += the_rgb[0];
+						sum_g += the_rgb[1];
+						sum_b += the_rgb[2];
+						number_of_hits++;
+					}
+				}
+			}
+
+			if((number_of_hits * 2) < (PIXEL_SUPERSAMPLES_PER_AXIS * PIXEL_SUPERSAMPLES_PER_AXIS))
+			{
+				has_transparency = SDL_TRUE;
+				continue;
+			}
+			sum_r = (sum_r + number_of_hits/2) / number_of_hits;
+			sum_g = (sum_g + number_of_hits/2) / number_of_hits;
+			sum_b = (sum_b + number_of_hits/2) / number_of_hits;
+			if(FLAPPY_PIXEL_FORMAT_GRAY8 == the_renderer->bytesPerPixel)
+			{
+				/* BT.601 luma in 8.8 fixed point. */
+				out_image->pixels[byte_index] = (Uint8)((77*sum_r + 150*sum_g + 29*sum_b + 128) >> 8);
+			}
+			else
+			{
+				out_image->pixels[byte_index] = (Uint8)sum_r;
+				out_image->pixels[byte_index+1] = (Uint8)sum_g;
+				out_image->pixels[byte_index+2] = (Uint8)sum_b;
+			}
+			if(NULL != out_image->mask)
+			{
+				SDL_memset(&out_image->mask[byte_index], 0xFF, the_renderer->bytesPerPixel);
+			}
+		}
+	}
+
+	/* Fully opaque images can be copied instead of blended. */
+	if( ! has_transparency)
+	{
+		SDL_free(out_image->mask);
+		out_image->mask = NULL;
+	}
+	return SDL_TRUE;
+}
+
+/* Builds the image(s) for one sprite and only replaces the current ones if everything worked. */
+static SDL_bool FlappyPixelRenderer_BuildSprite(struct FlappyPixelRenderer* the_renderer, int which_sprite, SDL_Surface* argb_surface)
+{
+	struct FlappyPixelSource the_source;
+	struct FlappyPixelImage new_image;
+	Sint32 image_width;
+	Sint32 image_height;
+
+	the_source.whichSprite = which_sprite;
+	the_source.surface = argb_surface;
+
+	switch(which_sprite)
+	{
+		case FLAPPY_PIXEL_SPRITE_BACKGROUND:
+		{
+			/* The game stretches the background to a SCREEN_WIDTH square and the bottom is cut off. */
+			the_source.spriteWidth = SCREEN_WIDTH;
+			the_source.spriteHeight = SCREEN_WIDTH;
+			image_height = FlappyPixelRenderer_ScaleSize(SCREEN_WIDTH, the_renderer->height, SCREEN_HEIGHT);
+			if(image_height < the_renderer->height)
+			{
+				image_height = the_renderer->height;
+			}
+			if( ! FlappyPixelRenderer_BuildImage(the_renderer, &new_image, the_renderer->width, image_height, SCREEN_WIDTH, (double)image_height * SCREEN_HEIGHT / the_renderer->height, 0.0, &the_source, SDL_TRUE))
+			{
+				return SDL_FALSE;
+			}
+			FlappyPixelRenderer_FreeImage(&the_renderer->background);
+			the_renderer->background = new_image;
+			return SDL_TRUE;
+		}
+		case FLAPPY_PIXEL_SPRITE_PIPE_BOTTOM:
+		case FLAPPY_PIXEL_SPRITE_PIPE_TOP:
+		{
+			struct FlappyPixelImage* which_image = (FLAPPY_PIXEL_SPRITE_PIPE_BOTTOM == which_sprite) ? &the_renderer->pipeBottom : &the_renderer->pipeTop;
+			the_source.spriteWidth = PIPE_WIDTH;
+			the_source.spriteHeight = PIXEL_PIPE_SPRITE_HEIGHT;
+			image_width = FlappyPixelRenderer_ScaleSize(PIPE_WIDTH, the_renderer->width, SCREEN_WIDTH);
+			image_height = FlappyPixelRenderer_ScaleSize(PIXEL_PIPE_SPRITE_HEIGHT, the_renderer->height, SCREEN_HEIGHT);
+			if( ! FlappyPixelRenderer_BuildImage(the_renderer, &new_image, image_width, image_height, PIPE_WIDTH, PIXEL_PIPE_SPRITE_HEIGHT, 0.0, &the_source, SDL_FALSE))
+			{
+				return SDL_FALSE;
+			}
+			FlappyPixelRenderer_FreeImage(which_image);
+			*which_image = new_image;
+			return SDL_TRUE;
+		}
+		case FLAPPY_PIXEL_SPRITE_BIRD:
+		{
+			struct FlappyPixelImage new_rotations[FLAPPY_PIXEL_RENDERER_NUMBER_OF_BIRD_ROTATIONS];
+			/* Every rotation fits in a square as wide as the bird's diagonal. */
+			Sint32 box_size = (Sint32)ceil(sqrt((double)(BIRD_WIDTH*BIRD_WIDTH + BIRD_HEIGHT*BIRD_HEIGHT)));
+			int i;
+			the_source.spriteWidth = BIRD_WIDTH;
+			the_source.spriteHeight = BIRD_HEIGHT;
+			image_width = FlappyPixelRenderer_ScaleSize(box_size, the_renderer->width, SCREEN_WIDTH);
+			image_height = FlappyPixelRenderer_ScaleSize(box_size, the_renderer->height, SCREEN_HEIGHT);
+			for(i=0; i<FLAPPY_PIXEL_RENDERER_NUMBER_OF_BIRD_ROTATIONS; i++)
+			{
+				double the_angle = (2.0 * M_PI * i) / FLAPPY_PIXEL_RENDERER_NUMBER_OF_BIRD_ROTATIONS;
+				if( ! FlappyPixelRenderer_BuildImage(the_renderer, &new_rotations[i], image_width, image_height, box_size, box_size, the_angle, &the_source, SDL_FALSE))
+				{
+					while(i > 0)
+					{
+						i--;
+						FlappyPixelRenderer_FreeImage(&new_rotations[i]);
+					}
+					return SDL_FALSE;
+				}
+			}
+			for(i=0; i<FLAPPY_PIXEL_RENDERER_NUMBER_OF_BIRD_ROTATIONS; i++)
+			{
+				FlappyPixelRenderer_FreeImage(&the_renderer->birdRotations[i]);
+				the_renderer->birdRotations[i] = new_rotations[i];
+			}
+			return SDL_TRUE;
+		}
+		case FLAPPY_PIXEL_SPRITE_GROUND:
+		{
+			struct FlappyPixelImage the_tile;
+			size_t tile_pitch = (size_t)the_renderer->width * the_renderer->bytesPerPixel;
+			Sint32 j;
+			/* A tile is SCREEN_WIDTH x GROUND_HEIGHT (see InitGround), so it covers the output from groundTop down. */
+			the_source.spriteWidth = SCREEN_WIDTH;
+			the_source.spriteHeight = GROUND_HEIGHT;
+			image_height = the_renderer->height - the_renderer->groundTop;
+			if( ! FlappyPixelRenderer_BuildImage(the_renderer, &the_tile, the_renderer->width, image_height, SCREEN_WIDTH, (double)image_height * SCREEN_HEIGHT / the_renderer->height, 0.0, &the_source, SDL_TRUE))
+			{
+				return SDL_FALSE;
+			}
+			SDL_zero(new_image);
+			new_image.width = 2 * the_renderer->width;
+			new_image.height = image_height;
+			new_image.pixels = (Uint8*)SDL_malloc(2 * tile_pitch * image_height);
+			if(NULL == new_image.pixels)
+			{
+				FlappyPixelRenderer_FreeImage(&the_tile);
+				return SDL_FALSE;
+			}
+			for(j=0; j<image_height; j++)
+			{
+				SDL_memcpy(new_image.pixels + (2*j) * tile_pitch, the_tile.pixels + j * tile_pitch, tile_pitch);
+				SDL_memcpy(new_image.pixels + (2*j + 1) * tile_pitch, the_tile.pixels + j * tile_pitch, tile_pitch);
+			}
+			FlappyPixelRenderer_FreeImage(&the_tile);
+			FlappyPixelRenderer_FreeImage(&the_renderer->groundStrip);
+			the_renderer->groundStrip = new_image;
+			return SDL_TRUE;
+		}
+		default:
+		{
+			return SDL_FALSE;
+		}
+	}
+}
+
+/* dst = mask ? src : dst, byte by byte. */
+static void FlappyPixelRenderer_BlendRowScalar(Uint8* dst, const Uint8* src, const Uint8* mask, size_t number_of_bytes)
+{
+	size_t i;
+	for(i=0; i<number_of_bytes; i++)
+	{
+		dst[i] = (Uint8)((src[i] & mask[i]) | (dst[i] & ~mask[i]));
+	}
+}
+
+#if FLAPPY_PIXEL_RENDERER_HAS_X86_SIMD
+FLAPPY_PIXEL_RENDERER_TARGET_SSE2
+static void FlappyPixelRenderer_BlendRowSSE2(Uint8* dst, const Uint8* src, const Uint8* mask, size_t number_of_bytes)
+{
+	size_t i = 0;
+	for(; (i+16) <= number_of_bytes; i+=16)
+	{
+		__m128i dst_bytes = _mm_loadu_si128((const __m128i*)(dst + i));
+		__m128i src_bytes = _mm_loadu_si128((const __m128i*)(src + i));
+		__m128i mask_bytes = _mm_loadu_si128((const __m128i*)(mask + i));
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(_mm_and_si128(mask_bytes, src_bytes), _mm_andnot_si128(mask_bytes, dst_bytes)));
+	}
+	FlappyPixelRenderer_BlendRowScalar(dst + i, src + i, mask + i, number_of_bytes - i);
+}
+#endif
+
+/* Draws rows [first_row, first_row+number_of_rows) of the image with their top left at (x, y), clipped to the frame. */
+static void FlappyPixelRenderer_BlitImage(struct FlappyPixelRenderer* the_renderer, const struct FlappyPixelImage* the_image, Sint32 x, Sint32 y, Sint32 first_row, Sint32 number_of_rows, Uint8* out_pixels)
+{
+	Sint32 bytes_per_pixel = the_renderer->bytesPerPixel;
+	size_t image_pitch = (size_t)the_image->width * bytes_per_pixel;
+	Sint32 first_column = 0;
+	Sint32 end_column = the_image->width;
+	size_t row_size;
+	Sint32 j;
+
+	if(number_of_rows > (the_image->height - first_row))
+	{
+		number_of_rows = the_image->height - first_row;
+	}
+	/* Clip against the top and bottom. */
+	if(y < 0)
+	{
+		first_row -= y;
+		number_of_rows += y;
+		y = 0;
+	}
+	if((y + number_of_rows) > the_renderer->height)
+	{
+		number_of_rows = the_renderer->height - y;
+	}
+	/* And the sides. */
+	if(x < 0)
+	{
+		first_column = -x;
+	}
+	if((x + end_column) > the_renderer->width)
+	{
+		end_column = the_renderer->width - x;
+	}
+	if((number_of_rows <= 0) || (first_column >= end_column))
+	{
+		return;
+	}
+
+	row_size = (size_t)(end_column - first_column) * bytes_per_pixel;
+	for(j=0; j<number_of_rows; j++)
+	{
+		size_t image_offset = (size_t)(first_row + j) * image_pitch + (size_t)first_column * bytes_per_pixel;
+		Uint8* dst = out_pixels + (size_t)(y + j) * the_renderer->pitch + (size_t)(x + first_column) * bytes_per_pixel;
+		if(NULL == the_image->mask)
+		{
+			SDL_memcpy(dst, the_image->pixels + image_offset, row_size);
+		}
+#if FLAPPY_PIXEL_RENDERER_HAS_X86_SIMD
+		else if(the_renderer->useSSE2)
+		{
+			FlappyPixelRenderer_BlendRowSSE2(dst, the_image->pixels + image_offset, the_image->mask + image_offset, row_size);
+		}
+#endif
+		else
+		{
+			FlappyPixelRenderer_BlendRowScalar(dst, the_image->pixels + image_offset, the_image->mask + image_offset, row_size);
+		}
+	}
+}
+
+struct FlappyPixelRenderer* FlappyPixelRenderer_Create(Uint32 width, Uint32 height, int pixel_format)
+{
+	struct FlappyPixelRenderer* the_renderer;
+	int i;
+
+	if((0 == width) || (0 == height) || ((FLAPPY_PIXEL_FORMAT_GRAY8 != pixel_format) && (FLAPPY_PIXEL_FORMAT_RGB24 != pixel_format)))
+	{
+		return NULL;
+	}
+	the_renderer = (struct FlappyPixelRenderer*)SDL_calloc(1, sizeof(struct FlappyPixelRenderer));
+	if(NULL == the_renderer)
+	{
+		return NULL;
+	}
+	the_renderer->width = (Sint32)width;
+	the_renderer->height = (Sint32)height;
+	the_renderer->bytesPerPixel = pixel_format;
+	the_renderer->pitch = (size_t)width * pixel_format;
+	the_renderer->useSSE2 = SDL_HasSSE2();
+	the_renderer->groundTop = FlappyPixelRenderer_ScalePosition(SCREEN_HEIGHT - GROUND_HEIGHT, the_renderer->height, SCREEN_HEIGHT);
+
+	for(i=0; i<FLAPPY_PIXEL_SPRITE_COUNT; i++)
+	{
+		if( ! FlappyPixelRenderer_BuildSprite(the_renderer, i, NULL))
+		{
+			FlappyPixelRenderer_Free(the_renderer);
+			return NULL;
+		}
+	}
+	return the_renderer;
+}
+
+void FlappyPixelRenderer_Free(struct FlappyPixelRenderer* the_renderer)
+{
+	int i;
+	if(NULL == the_renderer)
+	{
+		return;
+	}
+	FlappyPixelRenderer_FreeImage(&the_renderer->background);
+	FlappyPixelRenderer_FreeImage(&the_renderer->pipeBottom);
+	FlappyPixelRenderer_FreeImage(&the_renderer->pipeTop);
+	for(i=0; i<FLAPPY_PIXEL_RENDERER_NUMBER_OF_BIRD_ROTATIONS; i++)
+	{
+		FlappyPixelRenderer_FreeImage(&the_renderer->birdRotations[i]);
+	}
+	FlappyPixelRenderer_FreeImage(&the_renderer->groundStrip);
+	SDL_free(the_renderer);
+}
+
+SDL_bool FlappyPixelRenderer_SetSprite(struct FlappyPixelRenderer* the_renderer, int which_sprite, SDL_Surface* the_surface)
+{
+	SDL_Surface* argb_surface;
+	SDL_bool did_succeed;
+
+	if((NULL == the_surface) || (which_sprite < 0) || (which_sprite >= FLAPPY_PIXEL_SPRITE_COUNT))
+	{
+		return SDL_FALSE;
+	}
+	/* Converting gives us pixels we can read directly (a new surface is never RLE encoded, so no locking). */
+	argb_surface = SDL_ConvertSurfaceFormat(the_surface, SDL_PIXELFORMAT_ARGB8888, 0);
+	if(NULL == argb_surface)
+	{
+		return SDL_FALSE;
+	}
+	did_succeed = FlappyPixelRenderer_BuildSprite(the_renderer, which_sprite, argb_surface);
+	SDL_FreeSurface(argb_surface);
+	return did_succeed;
+}
+
+void FlappyPixelRenderer_Render(struct FlappyPixelRenderer* the_renderer, struct FlappyWorld* the_world, Uint8* out_pixels)
+{
+	Sint32 width = the_renderer->width;
+	Sint32 height = the_renderer->height;
+	size_t pitch = the_renderer->pitch;
+	Sint32 number_of_pipes = FlappyPipeQueue_Size(&the_world->circularQueueOfPipes);
+	Sint32 ground_offset;
+	Sint32 i;
+
+	/* The background image is exactly as wide as the frame, so its first rows are the whole frame. */
+	SDL_memcpy(out_pixels, the_renderer->background.pixels, pitch * height);
+
+	/* Same placement as Flappy_RenderPipes. */
+	for(i=0; i<number_of_pipes; i++)
+	{
+		struct PipeModelData* current_pipe = *FlappyPipeQueue_AtIndex(&the_world->circularQueueOfPipes, i);
+		Sint32 pipe_x = FlappyPixelRenderer_ScalePosition(current_pipe->viewPositionX - the_world->pipeTopModelData.size.x/2, width, SCREEN_WIDTH);
+		Sint32 lower_top = FlappyPixelRenderer_ScalePosition(current_pipe->lowerViewPositionY, height, SCREEN_HEIGHT);
+		Sint32 lower_bottom = FlappyPixelRenderer_ScalePosition(current_pipe->lowerViewPositionY + current_pipe->pipeHeight, height, SCREEN_HEIGHT);
+		Sint32 upper_bottom = FlappyPixelRenderer_ScalePosition(SCREEN_HEIGHT - current_pipe->pipeHeight - PIPE_HEIGHT_SEPARATION - GROUND_HEIGHT, height, SCREEN_HEIGHT);
+
+		if((pipe_x >= width) || ((pipe_x + the_renderer->pipeBottom.width) <= 0))
+		{
+			continue;
+		}
+		FlappyPixelRenderer_BlitImage(the_renderer, &the_renderer->pipeBottom, pipe_x, lower_top, 0, lower_bottom - lower_top, out_pixels);
+		FlappyPixelRenderer_BlitImage(the_renderer, &the_renderer->pipeTop, pipe_x, upper_bottom - the_renderer->pipeTop.height, 0, the_renderer->pipeTop.height, out_pixels);
+	}
+
+	/* Same placement as Flappy_RenderBird, using the pre-rotated image closest to the body's angle. */
+	{
+		double the_angle = fmod((double)cpBodyGetAngle(the_world->birdModelData.birdBody), 2.0 * M_PI);
+		int which_rotation;
+		const struct FlappyPixelImage* the_image;
+		Sint32 center_x;
+		Sint32 center_y;
+
+		if(the_angle < 0.0)
+		{
+			the_angle += 2.0 * M_PI;
+		}
+		which_rotation = (int)floor(the_angle * FLAPPY_PIXEL_RENDERER_NUMBER_OF_BIRD_ROTATIONS / (2.0 * M_PI) + 0.5) % FLAPPY_PIXEL_RENDERER_NUMBER_OF_BIRD_ROTATIONS;
+		the_image = &the_renderer->birdRotations[which_rotation];
+		center_x = FlappyPixelRenderer_ScalePosition(the_world->birdModelData.position.x, width, SCREEN_WIDTH);
+		center_y = FlappyPixelRenderer_ScalePosition(the_world->birdModelData.position.y + the_world->birdModelData.size.y/2, height, SCREEN_HEIGHT);
+		FlappyPixelRenderer_BlitImage(the_renderer, the_image, center_x - the_image->width/2, center_y - the_image->height/2, 0, the_image->height, out_pixels);
+	}
+
+	/* Same as Flappy_RenderGround: the ground covers the bird's beak on a face-plant, so it goes last.
+		groundModelData.position.x runs from 0 down to -size.x, which is how far into the tile the screen starts.
+	 */
+	ground_offset = FlappyPixelRenderer_ScalePosition(-the_world->groundModelData.position.x, width, SCREEN_WIDTH) % width;
+	if(ground_offset < 0)
+	{
+		ground_offset += width;
+	}
+	for(i=0; i<the_renderer->groundStrip.height; i++)
+	{
+		SDL_memcpy(out_pixels + (size_t)(the_renderer->groundTop + i) * pitch,
+			the_renderer->groundStrip.pixels + (size_t)i * 2 * pitch + (size_t)ground_offset * the_renderer->bytesPerPixel,
+			pitch
+		);
+	}
+}
+
+size_t FlappyPixelRenderer_GetFrameSize(struct FlappyPixelRenderer* the_renderer)
+{
+	return the_renderer->pitch * the_renderer->height;
+}
+
+Uint32 FlappyPixelRenderer_GetWidth(struct FlappyPixelRenderer* the_renderer)
+{
+	return (Uint32)the_renderer->width;
+}
+
+Uint32 FlappyPixelRenderer_GetHeight(struct FlappyPixelRenderer* the_renderer)
+{
+	return (Uint32)the_renderer->height;
+}
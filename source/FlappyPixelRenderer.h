@@ -0,0 +1,133 @@
+#ifndef C_FLAPPY_PIXEL_RENDERER_H
+#define C_FLAPPY_PIXEL_RENDERER_H
+
+/* Set up for C function definitions, even when using C++ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef DOXYGEN_SHOULD_IGNORE_THIS
+/** @cond DOXYGEN_SHOULD_IGNORE_THIS */
+
+/* Note: For Doxygen to produce clean output, you should set the
+ * PREDEFINED option to remove C_FLAPPY_PIXEL_RENDERER_DECLSPEC, C_FLAPPY_PIXEL_RENDERER_CALL, and
+ * the DOXYGEN_SHOULD_IGNORE_THIS blocks.
+ * PREDEFINED = DOXYGEN_SHOULD_IGNORE_THIS=1 C_FLAPPY_PIXEL_RENDERER_DECLSPEC= C_FLAPPY_PIXEL_RENDERER_CALL=
+ */
+
+/** Windows needs to know explicitly which functions to export in a DLL. */
+#if defined(_WIN32)
+	#if defined(C_FLAPPY_PIXEL_RENDERER_BUILD_LIBRARY)
+		#define C_FLAPPY_PIXEL_RENDERER_DECLSPEC __declspec(dllexport)
+	#else
+		#define C_FLAPPY_PIXEL_RENDERER_DECLSPEC
+	#endif
+#else
+	#if defined(C_FLAPPY_PIXEL_RENDERER_BUILD_LIBRARY)
+		#if defined (__GNUC__) && __GNUC__ >= 4
+			#define C_FLAPPY_PIXEL_RENDERER_DECLSPEC __attribute__((visibility("default")))
+		#else
+			#define C_FLAPPY_PIXEL_RENDERER_DECLSPEC
+		#endif
+	#else
+		#define C_FLAPPY_PIXEL_RENDERER_DECLSPEC
+	#endif
+#endif
+
+/* For Windows, by default, use the C calling convention */
+#if defined(_WIN32)
+	#define C_FLAPPY_PIXEL_RENDERER_CALL __cdecl
+#else
+	#define C_FLAPPY_PIXEL_RENDERER_CALL
+#endif
+
+/** @endcond DOXYGEN_SHOULD_IGNORE_THIS */
+#endif /* DOXYGEN_SHOULD_IGNORE_THIS */
+
+
+#include "SDL.h"
+
+#include "FlappyWorld.h"
+
+/**
+ * @file
+ * FlappyPixelRenderer draws a FlappyWorld on the CPU into a small caller-owned pixel buffer
+ * (84x84 by default), for agents that learn from pixels. It needs no window, GPU or readback.
+ * Every sprite (background, pipes, bird and ground) is resampled to the output resolution once when
+ * the renderer is created, and the bird is pre-rotated, so drawing a frame is just clipped row copies.
+ * Rows with transparent pixels are blended with a per-byte mask, 16 bytes at a time where SSE2 is available.
+ * Without any sprites set, simple flat-shaded stand-ins are used, so nothing has to be loaded from disk.
+ * Only the things that matter to the game are drawn. Clouds, hills, the score and menus are left out.
+ */
+
+/** The default output size (the usual size for pixel-based agents). */
+#define FLAPPY_PIXEL_RENDERER_DEFAULT_WIDTH 84
+#define FLAPPY_PIXEL_RENDERER_DEFAULT_HEIGHT 84
+
+/** The number of pre-rotated bird sprites. The bird's angle is rounded to the closest one. */
+#define FLAPPY_PIXEL_RENDERER_NUMBER_OF_BIRD_ROTATIONS 32
+
+/**
+ * The output pixel layouts. The value is the number of bytes per pixel.
+ * Rows are tightly packed (the pitch is width * bytes per pixel).
+ */
+enum FlappyPixelFormat
+{
+	FLAPPY_PIXEL_FORMAT_GRAY8 = 1, /**< One luma byte per pixel. */
+	FLAPPY_PIXEL_FORMAT_RGB24 = 3 /**< R, G, B bytes per pixel. */
+};
+
+/**
+ * The sprites that can be replaced with FlappyPixelRenderer_SetSprite.
+ */
+enum FlappyPixelSprite
+{
+	FLAPPY_PIXEL_SPRITE_BACKGROUND = 0, /**< Stretched to SCREEN_WIDTH x SCREEN_WIDTH from the top left, like the game does. */
+	FLAPPY_PIXEL_SPRITE_PIPE_BOTTOM, /**< The lower pipe. Its top rows are the lip at the gap. */
+	FLAPPY_PIXEL_SPRITE_PIPE_TOP, /**< The upper pipe. Its bottom rows are the lip at the gap. */
+	FLAPPY_PIXEL_SPRITE_BIRD, /**< Facing right, unrotated. */
+	FLAPPY_PIXEL_SPRITE_GROUND, /**< One tile of the scrolling ground. */
+	FLAPPY_PIXEL_SPRITE_COUNT
+};
+
+struct FlappyPixelRenderer;
+typedef struct FlappyPixelRenderer FlappyPixelRenderer;
+
+/**
+ * Creates a renderer for width x height frames of the given format, with the built-in stand-in sprites.
+ * The game's 16:9 screen is scaled to fill the frame, so square frames are squashed horizontally.
+ * @param pixel_format A FlappyPixelFormat value.
+ * @return A new renderer or NULL on failure. Free with FlappyPixelRenderer_Free.
+ */
+extern C_FLAPPY_PIXEL_RENDERER_DECLSPEC struct FlappyPixelRenderer* C_FLAPPY_PIXEL_RENDERER_CALL FlappyPixelRenderer_Create(Uint32 width, Uint32 height, int pixel_format);
+
+extern C_FLAPPY_PIXEL_RENDERER_DECLSPEC void C_FLAPPY_PIXEL_RENDERER_CALL FlappyPixelRenderer_Free(struct FlappyPixelRenderer* the_renderer);
+
+/**
+ * Replaces a sprite with an image, e.g. the game's own texture loaded with IMG_Load.
+ * The image is resampled (and for the bird, rotated) to the output resolution right away, so this is slow-ish
+ * and meant to be called once after creation. The surface isn't kept. Pixels with less than half alpha are transparent.
+ * @param which_sprite A FlappyPixelSprite value.
+ * @return SDL_TRUE on success. On failure the previous sprite is kept.
+ */
+extern C_FLAPPY_PIXEL_RENDERER_DECLSPEC SDL_bool C_FLAPPY_PIXEL_RENDERER_CALL FlappyPixelRenderer_SetSprite(struct FlappyPixelRenderer* the_renderer, int which_sprite, SDL_Surface* the_surface);
+
+/**
+ * Draws the world into out_pixels, which must hold FlappyPixelRenderer_GetFrameSize() bytes.
+ * This allocates nothing and only reads the world, so one renderer per thread can draw many worlds.
+ */
+extern C_FLAPPY_PIXEL_RENDERER_DECLSPEC void C_FLAPPY_PIXEL_RENDERER_CALL FlappyPixelRenderer_Render(struct FlappyPixelRenderer* the_renderer, struct FlappyWorld* the_world, Uint8* out_pixels);
+
+/**
+ * Returns the size of one frame in bytes (width * height * bytes per pixel).
+ */
+extern C_FLAPPY_PIXEL_RENDERER_DECLSPEC size_t C_FLAPPY_PIXEL_RENDERER_CALL FlappyPixelRenderer_GetFrameSize(struct FlappyPixelRenderer* the_renderer);
+
+extern C_FLAPPY_PIXEL_RENDERER_DECLSPEC Uint32 C_FLAPPY_PIXEL_RENDERER_CALL FlappyPixelRenderer_GetWidth(struct FlappyPixelRenderer* the_renderer);
+extern C_FLAPPY_PIXEL_RENDERER_DECLSPEC Uint32 C_FLAPPY_PIXEL_RENDERER_CALL FlappyPixelRenderer_GetHeight(struct FlappyPixelRenderer* the_renderer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* C_FLAPPY_PIXEL_RENDERER_H */
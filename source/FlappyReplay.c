@@ -0,0 +1,504 @@
+/*
+	FlappyReplay stores a game as its seed plus the ticks of every primary action.
+	Everything is encoded with explicit byte order (LEB128 varints and little endian fixed fields),
+	so a replay written on one platform plays back on any other.
+*/
+
+#include "FlappyReplay.h"
+
+#define FLAPPY_REPLAY_MAGIC "FLRP"
+#define FLAPPY_REPLAY_MAGIC_LENGTH 4
+/* Room for the growing action array starts here and doubles. */
+#define FLAPPY_REPLAY_INITIAL_CAPACITY 64
+
+struct FlappyReplay
+{
+	Uint64 randomSeed;
+	int physicsBackend;
+
+	Uint32 numberOfTicks;
+	Uint32 finalScore;
+	Uint64 finalChecksum;
+
+	Uint32 numberOfActions;
+	Uint32 actionCapacity;
+	Uint32* actionTicks;
+};
+
+/* Appends bytes while tracking the size, even past the end of the buffer (so a NULL buffer just measures). */
+struct FlappyReplayWriter
+{
+	Uint8* buffer;
+	size_t capacity;
+	size_t size;
+};
+
+struct FlappyReplayReader
+{
+	const Uint8* data;
+	size_t size;
+	size_t position;
+	SDL_bool isValid;
+};
+
+
+static void FlappyReplay_WriteByte(struct FlappyReplayWriter* the_writer, Uint8 the_byte)
+{
+	if((NULL != the_writer->buffer) && (the_writer->size < the_writer->capacity))
+	{
+		the_writer->buffer[the_writer->size] = the_byte;
+	}
+	the_writer->size++;
+}
+
+static void FlappyReplay_WriteFixed64(struct FlappyReplayWriter* the_writer, Uint64 the_value)
+{
+	Uint32 i;
+	for(i=0; i<8; i++)
+	{
+		FlappyReplay_WriteByte(the_writer, (Uint8)(the_value >> (8*i)));
+	}
+}
+
+static void FlappyReplay_WriteVarint(struct FlappyReplayWriter* the_writer, Uint64 the_value)
+{
+	while(the_value >= 0x80)
+	{
+		FlappyReplay_WriteByte(the_writer, (Uint8)(the_value | 0x80));
+		the_value >>= 7;
+	}
+	FlappyReplay_WriteByte(the_writer, (Uint8)the_value);
+}
+
+static void FlappyReplay_WriteSignedVarint(struct FlappyReplayWriter* the_writer, Sint64 the_value)
+{
+	/* Zigzag, so small negative numbers stay small. */
+	FlappyReplay_WriteVarint(the_writer, ((Uint64)the_value << 1) ^ (Uint64)(the_value >> 63));
+}
+
+static Uint8 FlappyReplay_ReadByte(struct FlappyReplayReader* the_reader)
+{
+	if(the_reader->position >= the_reader->size)
+	{
+		the_reader->isValid = SDL_FALSE;
+		return 0;
+	}
+	return the_reader->data[the_reader->position++];
+}
+
+static Uint64 FlappyReplay_ReadFixed64(struct FlappyReplayReader* the_reader)
+{
+	Uint64 the_value = 0;
+	Uint32 i;
+	for(i=0; i<8; i++)
+	{
+		the_value |= (Uint64)FlappyReplay_ReadByte(the_reader) << (8*i);
+	}
+	return the_value;
+}
+
+static Uint64 FlappyReplay_ReadVarint(struct FlappyReplayReader* the_reader)
+{
+	Uint64 the_value = 0;
+	Uint32 the_shift;
+	for(the_shift=0; the_shift<64; the_shift+=7)
+	{
+		Uint8 the_byte = FlappyReplay_ReadByte(the_reader);
+		the_value |= (Uint64)(the_byte & 0x7F) << the_shift;
+		if(0 == (the_byte & 0x80))
+		{
+			return the_value;
+		}
+	}
+	/* More than 10 bytes can't be a 64-bit varint. */
+	the_reader->isValid = SDL_FALSE;
+	return 0;
+}
+
+static Sint64 FlappyReplay_ReadSignedVarint(struct FlappyReplayReader* the_reader)
+{
+	Uint64 the_value = FlappyReplay_ReadVarint(the_reader);
+	return (Sint64)(the_value >> 1) ^ -(Sint64)(the_value & 1);
+}
+
+/* The same value always hashes the same, whatever the platform's byte order. */
+static Uint64 FlappyReplay_HashFixed64(Uint64 the_hash, Uint64 the_value)
+{
+	Uint32 i;
+	for(i=0; i<8; i++)
+	{
+		the_hash ^= (Uint8)(the_value >> (8*i));
+		the_hash *= 1099511628211ULL;
+	}
+	return the_hash;
+}
+
+static Uint64 FlappyReplay_HashDouble(Uint64 the_hash, double the_value)
+{
+	Uint64 the_bits;
+	SDL_memcpy(&the_bits, &the_value, sizeof(the_bits));
+	return FlappyReplay_HashFixed64(the_hash, the_bits);
+}
+
+Uint64 FlappyReplay_ComputeWorldChecksum(struct FlappyWorld* the_world)
+{
+	cpBody* bird_body = the_world->birdModelData.birdBody;
+	cpVect bird_position = cpBodyGetPosition(bird_body);
+	cpVect bird_velocity = cpBodyGetVelocity(bird_body);
+	/* FNV-1a offset basis */
+	Uint64 the_hash = 14695981039346656037ULL;
+
+	the_hash = FlappyReplay_HashFixed64(the_hash, the_world->tickCount);
+	the_hash = FlappyReplay_HashFixed64(the_hash, the_world->gameInstanceData.currentScore);
+	the_hash = FlappyReplay_HashFixed64(the_hash, (Uint64)(Sint64)the_world->gameState);
+	the_hash = FlappyReplay_HashDouble(the_hash, bird_position.x);
+	the_hash = FlappyReplay_HashDouble(the_hash, bird_position.y);
+	the_hash = FlappyReplay_HashDouble(the_hash, bird_velocity.x);
+	the_hash = FlappyReplay_HashDouble(the_hash, bird_velocity.y);
+	the_hash = FlappyReplay_HashDouble(the_hash, cpBodyGetAngle(bird_body));
+	the_hash = FlappyReplay_HashFixed64(the_hash, the_world->randomState);
+	return the_hash;
+}
+
+struct FlappyReplay* FlappyReplay_Create(Uint64 random_seed, int physics_backend)
+{
+	struct FlappyReplay* the_replay = (struct FlappyReplay*)SDL_calloc(1, sizeof(struct FlappyReplay));
+	if(NULL == the_replay)
+	{
+		return NULL;
+	}
+	the_replay->randomSeed = random_seed;
+	the_replay->physicsBackend = physics_backend;
+	return the_replay;
+}
+
+void FlappyReplay_Free(struct FlappyReplay* the_replay)
+{
+	if(NULL == the_replay)
+	{
+		return;
+	}
+	SDL_free(the_replay->actionTicks);
+	SDL_free(the_replay);
+}
+
+static SDL_bool FlappyReplay_ReserveActions(struct FlappyReplay* the_replay, Uint32 number_of_actions)
+{
+	Uint32 new_capacity = the_replay->actionCapacity;
+	Uint32* new_ticks;
+
+	if(number_of_actions <= the_replay->actionCapacity)
+	{
+		return SDL_TRUE;
+	}
+	if(0 == new_capacity)
+	{
+		new_capacity = FLAPPY_REPLAY_INITIAL_CAPACITY;
+	}
+	while(new_capacity < number_of_actions)
+	{
+		new_capacity *= 2;
+	}
+	new_ticks = (Uint32*)SDL_realloc(the_replay->actionTicks, new_capacity * sizeof(Uint32));
+	if(NULL == new_ticks)
+	{
+		return SDL_FALSE;
+	}
+	the_replay->actionTicks = new_ticks;
+	the_replay->actionCapacity = new_capacity;
+	return SDL_TRUE;
+}
+
+void FlappyReplay_RecordAction(struct FlappyReplay* the_replay, Uint32 which_tick)
+{
+	if(the_replay->numberOfActions > 0)
+	{
+		Uint32 last_tick = the_replay->actionTicks[the_replay->numberOfActions - 1];
+		/* FlappyWorld_StepTick only does one action per tick, so a second one on the same tick couldn't be played back. */
+		if(which_tick <= last_tick)
+		{
+			return;
+		}
+	}
+	if( ! FlappyReplay_ReserveActions(the_replay, the_replay->numberOfActions + 1))
+	{
+		SDL_Log("FlappyReplay: out of memory, dropping the action on tick %u", which_tick);
+		return;
+	}
+	the_replay->actionTicks[the_replay->numberOfActions] = which_tick;
+	the_replay->numberOfActions++;
+}
+
+void FlappyReplay_Finish(struct FlappyReplay* the_replay, struct FlappyWorld* the_world)
+{
+	if(the_world->tickCount > FLAPPY_REPLAY_MAX_NUMBER_OF_TICKS)
+	{
+		SDL_Log("FlappyReplay: %u ticks is more than FlappyReplay_Decode accepts (%u), so this replay can't be played back", the_world->tickCount, (unsigned int)FLAPPY_REPLAY_MAX_NUMBER_OF_TICKS);
+	}
+	the_replay->numberOfTicks = the_world->tickCount;
+	the_replay->finalScore = the_world->gameInstanceData.currentScore;
+	the_replay->finalChecksum = FlappyReplay_ComputeWorldChecksum(the_world);
+}
+
+size_t FlappyReplay_Encode(struct FlappyReplay* the_replay, Uint8* the_buffer, size_t buffer_size)
+{
+	struct FlappyReplayWriter the_writer;
+	Uint32 previous_tick = 0;
+	Uint32 i;
+
+	/* Measure first so a too small buffer is left untouched. */
+	if(NULL != the_buffer)
+	{
+		size_t needed_size = FlappyReplay_Encode(the_replay, NULL, 0);
+		if(needed_size > buffer_size)
+		{
+			return needed_size;
+		}
+	}
+
+	the_writer.buffer = the_buffer;
+	the_writer.capacity = buffer_size;
+	the_writer.size = 0;
+
+	for(i=0; i<FLAPPY_REPLAY_MAGIC_LENGTH; i++)
+	{
+		FlappyReplay_WriteByte(&the_writer, (Uint8)FLAPPY_REPLAY_MAGIC[i]);
+	}
+	FlappyReplay_WriteByte(&the_writer, FLAPPY_REPLAY_VERSION);
+	FlappyReplay_WriteFixed64(&the_writer, the_replay->randomSeed);
+
+	/* The physics parameters, so a build with different ones refuses the replay instead of silently diverging. */
+	FlappyReplay_WriteVarint(&the_writer, FLAPPY_WORLD_TICKS_PER_SECOND);
+	FlappyReplay_WriteSignedVarint(&the_writer, FLAPPY_GRAVITY_Y);
+	FlappyReplay_WriteVarint(&the_writer, FLAPPY_FLAP_VELOCITY_Y);
+	FlappyReplay_WriteVarint(&the_writer, (Uint64)the_replay->physicsBackend);
+
+	FlappyReplay_WriteVarint(&the_writer, the_replay->numberOfTicks);
+	FlappyReplay_WriteVarint(&the_writer, the_replay->finalScore);
+	FlappyReplay_WriteFixed64(&the_writer, the_replay->finalChecksum);
+
+	FlappyReplay_WriteVarint(&the_writer, the_replay->numberOfActions);
+	for(i=0; i<the_replay->numberOfActions; i++)
+	{
+		FlappyReplay_WriteVarint(&the_writer, the_replay->actionTicks[i] - previous_tick);
+		previous_tick = the_replay->actionTicks[i];
+	}
+	return the_writer.size;
+}
+
+struct FlappyReplay* FlappyReplay_Decode(const Uint8* the_data, size_t data_size)
+{
+	struct FlappyReplayReader the_reader;
+	struct FlappyReplay* the_replay;
+	Uint64 number_of_ticks;
+	Uint64 number_of_actions;
+	Uint64 the_backend;
+	Uint32 previous_tick = 0;
+	Uint32 i;
+
+	the_reader.data = the_data;
+	the_reader.size = data_size;
+	the_reader.position = 0;
+	the_reader.isValid = SDL_TRUE;
+
+	for(i=0; i<FLAPPY_REPLAY_MAGIC_LENGTH; i++)
+	{
+		if(FlappyReplay_ReadByte(&the_reader) != (Uint8)FLAPPY_REPLAY_MAGIC[i])
+		{
+			return NULL;
+		}
+	}
+	if(FLAPPY_REPLAY_VERSION != FlappyReplay_ReadByte(&the_reader))
+	{
+		return NULL;
+	}
+
+	the_replay = FlappyReplay_Create(FlappyReplay_ReadFixed64(&the_reader), FLAPPY_PHYSICS_BACKEND_CHIPMUNK);
+	if(NULL == the_replay)
+	{
+		return NULL;
+	}
+
+	if((FLAPPY_WORLD_TICKS_PER_SECOND != FlappyReplay_ReadVarint(&the_reader))
+		|| (FLAPPY_GRAVITY_Y != FlappyReplay_ReadSignedVarint(&the_reader))
+		|| (FLAPPY_FLAP_VELOCITY_Y != FlappyReplay_ReadVarint(&the_reader))
+	)
+	{
+		FlappyReplay_Free(the_replay);
+		return NULL;
+	}
+	the_backend = FlappyReplay_ReadVarint(&the_reader);
+	if((FLAPPY_PHYSICS_BACKEND_CHIPMUNK != the_backend) && (FLAPPY_PHYSICS_BACKEND_NATIVE != the_backend))
+	{
+		FlappyReplay_Free(the_replay);
+		return NULL;
+	}
+	the_replay->physicsBackend = (int)the_backend;
+
+	/* Playing a replay costs a physics step per tick, so don't let a crafted one make us simulate for hours. */
+	number_of_ticks = FlappyReplay_ReadVarint(&the_reader);
+	if(number_of_ticks > FLAPPY_REPLAY_MAX_NUMBER_OF_TICKS)
+	{
+		FlappyReplay_Free(the_replay);
+		return NULL;
+	}
+	the_replay->numberOfTicks = (Uint32)number_of_ticks;
+	the_replay->finalScore = (Uint32)FlappyReplay_ReadVarint(&the_reader);
+	the_replay->finalChecksum = FlappyReplay_ReadFixed64(&the_reader);
+
+	/* Every action takes at least one byte, which also keeps a corrupt count from allocating too much. */
+	number_of_actions = FlappyReplay_ReadVarint(&the_reader);
+	if(( ! the_reader.isValid) || (number_of_actions > (the_reader.size - the_reader.position))
+		|| ! FlappyReplay_ReserveActions(the_replay, (Uint32)number_of_actions)
+	)
+	{
+		FlappyReplay_Free(the_replay);
+		return NULL;
+	}
+	for(i=0; i<(Uint32)number_of_actions; i++)
+	{
+		Uint64 the_delta = FlappyReplay_ReadVarint(&the_reader);
+		/* Ticks strictly increase and stay inside the recording. */
+		if((0 == the_delta) || (the_delta > (Uint64)(the_replay->numberOfTicks - previous_tick)))
+		{
+			the_reader.isValid = SDL_FALSE;
+			break;
+		}
+		previous_tick += (Uint32)the_delta;
+		the_replay->actionTicks[i] = previous_tick;
+	}
+	the_replay->numberOfActions = (Uint32)number_of_actions;
+
+	if(( ! the_reader.isValid) || (the_reader.position != the_reader.size))
+	{
+		FlappyReplay_Free(the_replay);
+		return NULL;
+	}
+	return the_replay;
+}
+
+SDL_bool FlappyReplay_SaveFile(struct FlappyReplay* the_replay, const char* file_path)
+{
+	size_t encoded_size = FlappyReplay_Encode(the_replay, NULL, 0);
+	Uint8* encoded_data = (Uint8*)SDL_malloc(encoded_size);
+	SDL_RWops* rw_ops;
+	SDL_bool is_success = SDL_FALSE;
+
+	if(NULL == encoded_data)
+	{
+		return SDL_FALSE;
+	}
+	FlappyReplay_Encode(the_replay, encoded_data, encoded_size);
+
+	rw_ops = SDL_RWFromFile(file_path, "wb");
+	if(NULL != rw_ops)
+	{
+		is_success = (1 == SDL_RWwrite(rw_ops, encoded_data, encoded_size, 1)) ? SDL_TRUE : SDL_FALSE;
+		SDL_RWclose(rw_ops);
+	}
+	if( ! is_success)
+	{
+		SDL_Log("Failed to write replay %s: %s", file_path, SDL_GetError());
+	}
+	SDL_free(encoded_data);
+	return is_success;
+}
+
+struct FlappyReplay* FlappyReplay_LoadFile(const char* file_path)
+{
+	SDL_RWops* rw_ops = SDL_RWFromFile(file_path, "rb");
+	struct FlappyReplay* the_replay = NULL;
+	Uint8* file_data;
+	Sint64 file_size;
+
+	if(NULL == rw_ops)
+	{
+		return NULL;
+	}
+	file_size = SDL_RWsize(rw_ops);
+	if(file_size <= 0)
+	{
+		SDL_RWclose(rw_ops);
+		return NULL;
+	}
+	file_data = (Uint8*)SDL_malloc((size_t)file_size);
+	if((NULL != file_data) && (1 == SDL_RWread(rw_ops, file_data, (size_t)file_size, 1)))
+	{
+		the_replay = FlappyReplay_Decode(file_data, (size_t)file_size);
+	}
+	SDL_free(file_data);
+	SDL_RWclose(rw_ops);
+	return the_replay;
+}
+
+SDL_bool FlappyReplay_Play(const struct FlappyReplay* the_replay, FlappyReplayResult* out_result)
+{
+	struct FlappyWorld* the_world = FlappyWorld_Create(the_replay->randomSeed);
+	SDL_bool is_match;
+
+	if(NULL == the_world)
+	{
+		return SDL_FALSE;
+	}
+	FlappyWorld_SetPhysicsBackend(the_world, the_replay->physicsBackend);
+	InitTitleScreen(the_world);
+
+	is_match = FlappyReplay_PlayInWorld(the_replay, the_world, out_result);
+	FlappyWorld_Free(the_world);
+	return is_match;
+}
+
+SDL_bool FlappyReplay_PlayInWorld(const struct FlappyReplay* the_replay, struct FlappyWorld* the_world, FlappyReplayResult* out_result)
+{
+	Uint32 next_action = 0;
+	Uint32 which_tick;
+	FlappyReplayResult the_result;
+
+	/* Actions are recorded against the step they come before, so the action recorded on tick N is replayed by the Nth StepTick. */
+	for(which_tick=1; which_tick<=the_replay->numberOfTicks; which_tick++)
+	{
+		SDL_bool do_primary_action = SDL_FALSE;
+		if((next_action < the_replay->numberOfActions) && (the_replay->actionTicks[next_action] == which_tick))
+		{
+			do_primary_action = SDL_TRUE;
+			next_action++;
+		}
+		FlappyWorld_StepTick(the_world, do_primary_action);
+	}
+
+	the_result.numberOfTicks = the_world->tickCount;
+	the_result.finalScore = the_world->gameInstanceData.currentScore;
+	the_result.finalChecksum = FlappyReplay_ComputeWorldChecksum(the_world);
+	the_result.isMatch = ((the_result.finalScore == the_replay->finalScore) && (the_result.finalChecksum == the_replay->finalChecksum)) ? SDL_TRUE : SDL_FALSE;
+
+	if(NULL != out_result)
+	{
+		*out_result = the_result;
+	}
+	return the_result.isMatch;
+}
+
+Uint64 FlappyReplay_GetSeed(const struct FlappyReplay* the_replay)
+{
+	return the_replay->randomSeed;
+}
+
+int FlappyReplay_GetPhysicsBackend(const struct FlappyReplay* the_replay)
+{
+	return the_replay->physicsBackend;
+}
+
+Uint32 FlappyReplay_GetNumberOfTicks(const struct FlappyReplay* the_replay)
+{
+	return the_replay->numberOfTicks;
+}
+
+Uint32 FlappyReplay_GetNumberOfActions(const struct FlappyReplay* the_replay)
+{
+	return the_replay->numberOfActions;
+}
+
+Uint32 FlappyReplay_GetFinalScore(const struct FlappyReplay* the_replay)
+{
+	return the_replay->finalScore;
+}
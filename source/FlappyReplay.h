@@ -0,0 +1,160 @@
+#ifndef C_FLAPPY_REPLAY_H
+#define C_FLAPPY_REPLAY_H
+
+/* Set up for C function definitions, even when using C++ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef DOXYGEN_SHOULD_IGNORE_THIS
+/** @cond DOXYGEN_SHOULD_IGNORE_THIS */
+
+/* Note: For Doxygen to produce clean output, you should set the
+ * PREDEFINED option to remove C_FLAPPY_REPLAY_DECLSPEC, C_FLAPPY_REPLAY_CALL, and
+ * the DOXYGEN_SHOULD_IGNORE_THIS blocks.
+ * PREDEFINED = DOXYGEN_SHOULD_IGNORE_THIS=1 C_FLAPPY_REPLAY_DECLSPEC= C_FLAPPY_REPLAY_CALL=
+ */
+
+/** Windows needs to know explicitly which functions to export in a DLL. */
+#if defined(_WIN32)
+	#if defined(C_FLAPPY_REPLAY_BUILD_LIBRARY)
+		#define C_FLAPPY_REPLAY_DECLSPEC __declspec(dllexport)
+	#else
+		#define C_FLAPPY_REPLAY_DECLSPEC
+	#endif
+#else
+	#if defined(C_FLAPPY_REPLAY_BUILD_LIBRARY)
+		#if defined (__GNUC__) && __GNUC__ >= 4
+			#define C_FLAPPY_REPLAY_DECLSPEC __attribute__((visibility("default")))
+		#else
+			#define C_FLAPPY_REPLAY_DECLSPEC
+		#endif
+	#else
+		#define C_FLAPPY_REPLAY_DECLSPEC
+	#endif
+#endif
+
+/* For Windows, by default, use the C calling convention */
+#if defined(_WIN32)
+	#define C_FLAPPY_REPLAY_CALL __cdecl
+#else
+	#define C_FLAPPY_REPLAY_CALL
+#endif
+
+/** @endcond DOXYGEN_SHOULD_IGNORE_THIS */
+#endif /* DOXYGEN_SHOULD_IGNORE_THIS */
+
+
+#include "SDL.h"
+
+#include "FlappyWorld.h"
+
+/**
+ * @file
+ * FlappyReplay records a game as the world's seed plus the ticks on which Flappy_DoPrimaryAction() happened.
+ * Since a world stepped with FlappyWorld_StepTick only depends on its seed and those inputs, that is enough
+ * to re-simulate the game exactly, headless and as fast as the CPU allows.
+ *
+ * A replay always covers a world from FlappyWorld_Create() + InitTitleScreen() up to FlappyReplay_Finish().
+ * The tick count is the number of physics steps, and an action is recorded against the step it comes before.
+ * The windowed game records with --record too. While recording it advances the world in whole FlappyWorld_StepTick calls
+ * as the wall clock passes each one, and applies input in between, so its replays re-simulate exactly as well.
+ *
+ * The encoded form is:
+ * "FLRP", a version byte, the seed (8 bytes, little endian), then varints for the tick rate, gravity (zigzag),
+ * flap velocity, physics backend, number of ticks, final score, the final checksum (8 bytes, little endian),
+ * the number of actions and finally each action's tick as a varint delta from the previous one.
+ * A typical game is a few hundred bytes.
+ */
+
+/** The encoded format version. Decoding refuses anything else. */
+#define FLAPPY_REPLAY_VERSION 2
+
+/** The longest replay decoding accepts: 8 hours of game time. Playback simulates every tick, so this bounds its cost. */
+#define FLAPPY_REPLAY_MAX_NUMBER_OF_TICKS (FLAPPY_WORLD_TICKS_PER_SECOND * 60 * 60 * 8)
+
+struct FlappyReplay;
+typedef struct FlappyReplay FlappyReplay;
+
+/**
+ * What FlappyReplay_Play found at the end of the re-simulation.
+ */
+typedef struct FlappyReplayResult
+{
+	Uint32 numberOfTicks; /**< The number of ticks simulated. */
+	Uint32 finalScore; /**< gameInstanceData.currentScore at the end. */
+	Uint64 finalChecksum; /**< FlappyReplay_ComputeWorldChecksum at the end. */
+	SDL_bool isMatch; /**< Whether the score and checksum equal the recorded ones. */
+} FlappyReplayResult;
+
+/**
+ * Creates an empty recording for a world created with random_seed and using physics_backend.
+ * Attach it with FlappyWorld_SetReplayRecorder before the first tick.
+ * @return A new replay or NULL on failure. Free with FlappyReplay_Free.
+ */
+extern C_FLAPPY_REPLAY_DECLSPEC struct FlappyReplay* C_FLAPPY_REPLAY_CALL FlappyReplay_Create(Uint64 random_seed, int physics_backend);
+extern C_FLAPPY_REPLAY_DECLSPEC void C_FLAPPY_REPLAY_CALL FlappyReplay_Free(struct FlappyReplay* the_replay);
+
+/**
+ * Appends an action on tick which_tick. The world calls this from Flappy_DoPrimaryAction.
+ * Ticks must not go backwards.
+ */
+extern C_FLAPPY_REPLAY_DECLSPEC void C_FLAPPY_REPLAY_CALL FlappyReplay_RecordAction(struct FlappyReplay* the_replay, Uint32 which_tick);
+
+/**
+ * Ends the recording at the world's current tick, remembering its score and checksum so playback can be checked.
+ */
+extern C_FLAPPY_REPLAY_DECLSPEC void C_FLAPPY_REPLAY_CALL FlappyReplay_Finish(struct FlappyReplay* the_replay, struct FlappyWorld* the_world);
+
+/**
+ * Writes the encoded replay into the_buffer.
+ * @param the_buffer Where to write. Pass NULL to just compute the size.
+ * @return The encoded size in bytes. Nothing is written if this is larger than buffer_size.
+ */
+extern C_FLAPPY_REPLAY_DECLSPEC size_t C_FLAPPY_REPLAY_CALL FlappyReplay_Encode(struct FlappyReplay* the_replay, Uint8* the_buffer, size_t buffer_size);
+
+/**
+ * Creates a replay from encoded data.
+ * @return A new replay, or NULL if the data is truncated, corrupt, from another version, longer than
+ * FLAPPY_REPLAY_MAX_NUMBER_OF_TICKS or recorded with different physics parameters than this build uses.
+ */
+extern C_FLAPPY_REPLAY_DECLSPEC struct FlappyReplay* C_FLAPPY_REPLAY_CALL FlappyReplay_Decode(const Uint8* the_data, size_t data_size);
+
+extern C_FLAPPY_REPLAY_DECLSPEC SDL_bool C_FLAPPY_REPLAY_CALL FlappyReplay_SaveFile(struct FlappyReplay* the_replay, const char* file_path);
+/** @return A new replay or NULL. See FlappyReplay_Decode. */
+extern C_FLAPPY_REPLAY_DECLSPEC struct FlappyReplay* C_FLAPPY_REPLAY_CALL FlappyReplay_LoadFile(const char* file_path);
+
+/**
+ * Re-simulates the replay in a new headless world at full speed.
+ * This only reads the replay, so one replay can be played on several threads at once.
+ * @param out_result Receives what the re-simulation ended with. May be NULL.
+ * @return SDL_TRUE if the result matches the recording.
+ */
+extern C_FLAPPY_REPLAY_DECLSPEC SDL_bool C_FLAPPY_REPLAY_CALL FlappyReplay_Play(const struct FlappyReplay* the_replay, FlappyReplayResult* out_result);
+
+/**
+ * Same as FlappyReplay_Play, but steps a world you provide so it can be reused for many replays.
+ * the_world must be in the state of a fresh FlappyWorld_Create(FlappyReplay_GetSeed()) + InitTitleScreen(),
+ * using FlappyReplay_GetPhysicsBackend(). Restoring a snapshot of a fresh world and calling
+ * FlappyWorld_SetSeed and FlappyWorld_SetPhysicsBackend gets it there.
+ */
+extern C_FLAPPY_REPLAY_DECLSPEC SDL_bool C_FLAPPY_REPLAY_CALL FlappyReplay_PlayInWorld(const struct FlappyReplay* the_replay, struct FlappyWorld* the_world, FlappyReplayResult* out_result);
+
+extern C_FLAPPY_REPLAY_DECLSPEC Uint64 C_FLAPPY_REPLAY_CALL FlappyReplay_GetSeed(const struct FlappyReplay* the_replay);
+/** @return A FlappyWorldPhysicsBackend value. */
+extern C_FLAPPY_REPLAY_DECLSPEC int C_FLAPPY_REPLAY_CALL FlappyReplay_GetPhysicsBackend(const struct FlappyReplay* the_replay);
+extern C_FLAPPY_REPLAY_DECLSPEC Uint32 C_FLAPPY_REPLAY_CALL FlappyReplay_GetNumberOfTicks(const struct FlappyReplay* the_replay);
+extern C_FLAPPY_REPLAY_DECLSPEC Uint32 C_FLAPPY_REPLAY_CALL FlappyReplay_GetNumberOfActions(const struct FlappyReplay* the_replay);
+extern C_FLAPPY_REPLAY_DECLSPEC Uint32 C_FLAPPY_REPLAY_CALL FlappyReplay_GetFinalScore(const struct FlappyReplay* the_replay);
+
+/**
+ * A 64-bit FNV-1a hash of the world's tick count, score, game state, bird body state and random state.
+ * Two runs that end with the same checksum almost certainly took the same path.
+ */
+extern C_FLAPPY_REPLAY_DECLSPEC Uint64 C_FLAPPY_REPLAY_CALL FlappyReplay_ComputeWorldChecksum(struct FlappyWorld* the_world);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* C_FLAPPY_REPLAY_H */
@@ -0,0 +1,173 @@
+/*
+	FlappyReplayVerifier spreads replays over the calling thread plus (number_of_threads-1) SDL threads.
+	Threads claim the next replay with an atomic add, so faster threads simply take more of them.
+	Replays never share anything but the counters, and the results go into separate slots of the caller's array.
+*/
+
+#include "FlappyReplayVerifier.h"
+
+struct FlappyReplayVerifierJob
+{
+	/* Exactly one of filePaths or replayData is set. */
+	const char* const* filePaths;
+	const Uint8* const* replayData;
+	const size_t* replaySizes;
+	Uint32 numberOfReplays;
+	FlappyReplayVerification* results;
+
+	SDL_atomic_t nextIndex;
+	SDL_atomic_t numberOfMatches;
+	SDL_atomic_t numberOfMismatches;
+	SDL_atomic_t numberUnreadable;
+};
+
+
+static int FlappyReplayVerifier_WorkerThread(void* user_data)
+{
+	struct FlappyReplayVerifierJob* the_job = (struct FlappyReplayVerifierJob*)user_data;
+	struct FlappyWorld* the_world = FlappyWorld_Create(0);
+	FlappyWorldSnapshot fresh_state;
+
+	if(NULL == the_world)
+	{
+		/* The other threads (or at least the calling one) pick up the work. */
+		return -1;
+	}
+	InitTitleScreen(the_world);
+	FlappyWorld_Snapshot(the_world, &fresh_state);
+
+	for(;;)
+	{
+		/* SDL_AtomicAdd returns the value before the add. */
+		Uint32 which_replay = (Uint32)SDL_AtomicAdd(&the_job->nextIndex, 1);
+		struct FlappyReplay* the_replay;
+		FlappyReplayVerification the_verification;
+		FlappyReplayResult the_result;
+
+		if(which_replay >= the_job->numberOfReplays)
+		{
+			break;
+		}
+
+		if(NULL != the_job->filePaths)
+		{
+			the_replay = FlappyReplay_LoadFile(the_job->filePaths[which_replay]);
+		}
+		else
+		{
+			the_replay = FlappyReplay_Decode(the_job->replayData[which_replay], the_job->replaySizes[which_replay]);
+		}
+
+		SDL_zero(the_verification);
+		the_verification.isVerified = SDL_TRUE;
+		if(NULL == the_replay)
+		{
+			SDL_AtomicAdd(&the_job->numberUnreadable, 1);
+		}
+		else
+		{
+			/* Back to exactly what FlappyWorld_Create(seed) + InitTitleScreen() would give. */
+			FlappyWorld_Restore(the_world, &fresh_state);
+			FlappyWorld_SetSeed(the_world, FlappyReplay_GetSeed(the_replay));
+			FlappyWorld_SetPhysicsBackend(the_world, FlappyReplay_GetPhysicsBackend(the_replay));
+
+			the_verification.isReadable = SDL_TRUE;
+			the_verification.isMatch = FlappyReplay_PlayInWorld(the_replay, the_world, &the_result);
+			the_verification.claimedScore = FlappyReplay_GetFinalScore(the_replay);
+			the_verification.simulatedScore = the_result.finalScore;
+			the_verification.numberOfTicks = the_result.numberOfTicks;
+			SDL_AtomicAdd(the_verification.isMatch ? &the_job->numberOfMatches : &the_job->numberOfMismatches, 1);
+			FlappyReplay_Free(the_replay);
+		}
+
+		if(NULL != the_job->results)
+		{
+			the_job->results[which_replay] = the_verification;
+		}
+	}
+
+	FlappyWorld_Free(the_world);
+	return 0;
+}
+
+static Uint32 FlappyReplayVerifier_Run(struct FlappyReplayVerifierJob* the_job, Uint32 number_of_threads, FlappyReplayVerifierReport* out_report)
+{
+	SDL_Thread** the_threads;
+	Uint64 start_counter = SDL_GetPerformanceCounter();
+	Uint32 number_of_failures;
+	Uint32 i;
+
+	if(0 == number_of_threads)
+	{
+		number_of_threads = (Uint32)SDL_GetCPUCount();
+	}
+	if(number_of_threads > the_job->numberOfReplays)
+	{
+		number_of_threads = the_job->numberOfReplays;
+	}
+	if(0 == number_of_threads)
+	{
+		number_of_threads = 1;
+	}
+
+	SDL_AtomicSet(&the_job->nextIndex, 0);
+	SDL_AtomicSet(&the_job->numberOfMatches, 0);
+	SDL_AtomicSet(&the_job->numberOfMismatches, 0);
+	SDL_AtomicSet(&the_job->numberUnreadable, 0);
+	/* If no thread manages to create a world, the replays nobody claimed must still read as not verified. */
+	if(NULL != the_job->results)
+	{
+		SDL_memset(the_job->results, 0, the_job->numberOfReplays * sizeof(FlappyReplayVerification));
+	}
+
+	/* If a thread can't be created, the ones we have (and the calling thread) do its share. */
+	the_threads = (SDL_Thread**)SDL_calloc(number_of_threads, sizeof(SDL_Thread*));
+	for(i=1; (NULL != the_threads) && (i<number_of_threads); i++)
+	{
+		the_threads[i] = SDL_CreateThread(FlappyReplayVerifier_WorkerThread, "FlappyReplayVerifier", the_job);
+	}
+	FlappyReplayVerifier_WorkerThread(the_job);
+	for(i=1; (NULL != the_threads) && (i<number_of_threads); i++)
+	{
+		if(NULL != the_threads[i])
+		{
+			SDL_WaitThread(the_threads[i], NULL);
+		}
+	}
+	SDL_free(the_threads);
+
+	/* Anything that didn't match is a failure, including replays no thread could get to. */
+	number_of_failures = the_job->numberOfReplays - (Uint32)SDL_AtomicGet(&the_job->numberOfMatches);
+	if(NULL != out_report)
+	{
+		out_report->numberOfReplays = the_job->numberOfReplays;
+		out_report->numberOfMatches = (Uint32)SDL_AtomicGet(&the_job->numberOfMatches);
+		out_report->numberOfMismatches = (Uint32)SDL_AtomicGet(&the_job->numberOfMismatches);
+		out_report->numberUnreadable = (Uint32)SDL_AtomicGet(&the_job->numberUnreadable);
+		out_report->numberNotVerified = number_of_failures - out_report->numberOfMismatches - out_report->numberUnreadable;
+		out_report->numberOfThreads = number_of_threads;
+		out_report->elapsedSeconds = (double)(SDL_GetPerformanceCounter() - start_counter) / (double)SDL_GetPerformanceFrequency();
+	}
+	return number_of_failures;
+}
+
+Uint32 FlappyReplayVerifier_VerifyFiles(const char* const* file_paths, Uint32 number_of_files, Uint32 number_of_threads, FlappyReplayVerification* out_results, FlappyReplayVerifierReport* out_report)
+{
+	struct FlappyReplayVerifierJob the_job;
+	SDL_zero(the_job);
+	the_job.filePaths = file_paths;
+	the_job.numberOfReplays = number_of_files;
+	the_job.results = out_results;
+	return FlappyReplayVerifier_Run(&the_job, number_of_threads, out_report);
+}
+
+Uint32 FlappyReplayVerifier_VerifyBuffers(const Uint8* const* replay_data, const size_t* replay_sizes, Uint32 number_of_replays, Uint32 number_of_threads, FlappyReplayVerification* out_results, FlappyReplayVerifierReport* out_report)
+{
+	struct FlappyReplayVerifierJob the_job;
+	SDL_zero(the_job);
+	the_job.replayData = replay_data;
+	the_job.replaySizes = replay_sizes;
+	the_job.numberOfReplays = number_of_replays;
+	the_job.results = out_results;
+	return FlappyReplayVerifier_Run(&the_job, number_of_threads, out_report);
+}
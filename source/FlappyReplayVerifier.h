@@ -0,0 +1,111 @@
+#ifndef C_FLAPPY_REPLAY_VERIFIER_H
+#define C_FLAPPY_REPLAY_VERIFIER_H
+
+/* Set up for C function definitions, even when using C++ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef DOXYGEN_SHOULD_IGNORE_THIS
+/** @cond DOXYGEN_SHOULD_IGNORE_THIS */
+
+/* Note: For Doxygen to produce clean output, you should set the
+ * PREDEFINED option to remove C_FLAPPY_REPLAY_VERIFIER_DECLSPEC, C_FLAPPY_REPLAY_VERIFIER_CALL, and
+ * the DOXYGEN_SHOULD_IGNORE_THIS blocks.
+ * PREDEFINED = DOXYGEN_SHOULD_IGNORE_THIS=1 C_FLAPPY_REPLAY_VERIFIER_DECLSPEC= C_FLAPPY_REPLAY_VERIFIER_CALL=
+ */
+
+/** Windows needs to know explicitly which functions to export in a DLL. */
+#if defined(_WIN32)
+	#if defined(C_FLAPPY_REPLAY_VERIFIER_BUILD_LIBRARY)
+		#define C_FLAPPY_REPLAY_VERIFIER_DECLSPEC __declspec(dllexport)
+	#else
+		#define C_FLAPPY_REPLAY_VERIFIER_DECLSPEC
+	#endif
+#else
+	#if defined(C_FLAPPY_REPLAY_VERIFIER_BUILD_LIBRARY)
+		#if defined (__GNUC__) && __GNUC__ >= 4
+			#define C_FLAPPY_REPLAY_VERIFIER_DECLSPEC __attribute__((visibility("default")))
+		#else
+			#define C_FLAPPY_REPLAY_VERIFIER_DECLSPEC
+		#endif
+	#else
+		#define C_FLAPPY_REPLAY_VERIFIER_DECLSPEC
+	#endif
+#endif
+
+/* For Windows, by default, use the C calling convention */
+#if defined(_WIN32)
+	#define C_FLAPPY_REPLAY_VERIFIER_CALL __cdecl
+#else
+	#define C_FLAPPY_REPLAY_VERIFIER_CALL
+#endif
+
+/** @endcond DOXYGEN_SHOULD_IGNORE_THIS */
+#endif /* DOXYGEN_SHOULD_IGNORE_THIS */
+
+
+#include "SDL.h"
+
+#include "FlappyReplay.h"
+
+/**
+ * @file
+ * FlappyReplayVerifier re-simulates many submitted replays on all cores to check their claimed scores.
+ * Each replay is played with the same deterministic headless path as FlappyReplay_Play, so points are
+ * awarded by the game's own score sensor callback (Flappy_OnScorePointCallback), exactly like in the live game.
+ * A replay only passes if both its final score and its end-of-game checksum come out the same.
+ *
+ * Every thread keeps one world for all its replays and resets it by restoring a snapshot of a fresh world,
+ * so no Chipmunk space is created or destroyed per replay.
+ */
+
+/**
+ * The outcome for one replay.
+ */
+typedef struct FlappyReplayVerification
+{
+	SDL_bool isVerified; /**< SDL_FALSE if no thread got to the replay, because none could create a world. Nothing else is set then. */
+	SDL_bool isReadable; /**< SDL_FALSE if the replay couldn't be loaded or decoded. Nothing else is set then. */
+	SDL_bool isMatch; /**< Whether the re-simulation ended with the recorded score and checksum. */
+	Uint32 claimedScore; /**< The score recorded in the replay. */
+	Uint32 simulatedScore; /**< The score the re-simulation reached. */
+	Uint32 numberOfTicks; /**< The number of ticks simulated. */
+} FlappyReplayVerification;
+
+/**
+ * Totals for one call.
+ */
+typedef struct FlappyReplayVerifierReport
+{
+	Uint32 numberOfReplays;
+	Uint32 numberOfMatches;
+	Uint32 numberOfMismatches;
+	Uint32 numberUnreadable;
+	Uint32 numberNotVerified; /**< Replays skipped because no world could be created to play them in. */
+	Uint32 numberOfThreads;
+	double elapsedSeconds;
+} FlappyReplayVerifierReport;
+
+/**
+ * Loads and verifies replay files.
+ * @param file_paths number_of_files paths to replays saved with FlappyReplay_SaveFile.
+ * @param number_of_threads The number of threads to use, including the calling thread. Pass 0 to use SDL_GetCPUCount().
+ * @param out_results Receives one entry per file, in the same order. May be NULL if you only want the report.
+ * @param out_report Receives the totals. May be NULL.
+ * @return The number of replays that didn't match, including unreadable and unverified ones, so 0 means everything checked out.
+ */
+extern C_FLAPPY_REPLAY_VERIFIER_DECLSPEC Uint32 C_FLAPPY_REPLAY_VERIFIER_CALL FlappyReplayVerifier_VerifyFiles(const char* const* file_paths, Uint32 number_of_files, Uint32 number_of_threads, FlappyReplayVerification* out_results, FlappyReplayVerifierReport* out_report);
+
+/**
+ * Same as FlappyReplayVerifier_VerifyFiles for replays that are already in memory (e.g. read from a network stream).
+ * @param replay_data number_of_replays pointers to encoded replays (see FlappyReplay_Encode).
+ * @param replay_sizes The size of each encoded replay.
+ */
+extern C_FLAPPY_REPLAY_VERIFIER_DECLSPEC Uint32 C_FLAPPY_REPLAY_VERIFIER_CALL FlappyReplayVerifier_VerifyBuffers(const Uint8* const* replay_data, const size_t* replay_sizes, Uint32 number_of_replays, Uint32 number_of_threads, FlappyReplayVerification* out_results, FlappyReplayVerifierReport* out_report);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* C_FLAPPY_REPLAY_VERIFIER_H */
@@ -0,0 +1,227 @@
+/*
+	FlappyTimerWheel is the usual hierarchical timing wheel (as in the Varghese & Lauck paper and the Linux kernel's timers),
+	with a 64 bit occupancy mask per level so Advance can skip empty slots instead of visiting every milli-second.
+
+	The invariant: a timer is in the lowest level L where its deadline and currentTime only differ in bits
+	below (L+1)*FLAPPY_TIMER_WHEEL_BITS_PER_LEVEL. So level 0 only holds timers due in currentTime's 64 ms block,
+	and a level L > 0 timer's slot is always ahead of currentTime's slot on that level.
+	When the wheel reaches the start of a level L > 0 slot, the timers in it are put back in (which drops them to a lower level).
+
+	Game time wraps after about 49.7 days, so "before" and "after" are decided by the signed difference, like SDL_TICKS_PASSED.
+	A deadline past the wrap differs from currentTime in the top bit, so it goes in a top level slot behind the current one,
+	where Advance doesn't look until the wheel has finished the lap and started again from 0.
+*/
+
+#include "FlappyTimerWheel.h"
+
+#define FLAPPY_TIMER_WHEEL_SLOT_MASK (FLAPPY_TIMER_WHEEL_SLOTS_PER_LEVEL - 1)
+
+
+static Uint32 FlappyTimerWheel_FindFirstSetBit(Uint64 the_bits)
+{
+#if defined(__GNUC__)
+	return (Uint32)__builtin_ctzll(the_bits);
+#else
+	Uint32 the_index = 0;
+	while(0 == (the_bits & 1))
+	{
+		the_bits = the_bits >> 1;
+		the_index++;
+	}
+	return the_index;
+#endif
+}
+
+static void FlappyTimerWheel_Insert(struct FlappyTimerWheel* the_wheel, struct FlappyTimer* the_timer)
+{
+	Uint32 the_deadline = the_timer->deadline;
+	Uint32 difference;
+	Uint32 the_level = 0;
+	Uint32 the_slot;
+	struct FlappyTimer** the_head;
+
+	/* Anything overdue goes in the current slot so the next Advance fires it. */
+	if((Sint32)(the_deadline - the_wheel->currentTime) < 0)
+	{
+		the_deadline = the_wheel->currentTime;
+	}
+	difference = the_deadline ^ the_wheel->currentTime;
+	while(difference >= FLAPPY_TIMER_WHEEL_SLOTS_PER_LEVEL)
+	{
+		difference = difference >> FLAPPY_TIMER_WHEEL_BITS_PER_LEVEL;
+		the_level++;
+	}
+	the_slot = (the_deadline >> (the_level * FLAPPY_TIMER_WHEEL_BITS_PER_LEVEL)) & FLAPPY_TIMER_WHEEL_SLOT_MASK;
+
+	the_head = &the_wheel->slots[the_level][the_slot];
+	the_timer->previous = NULL;
+	the_timer->next = *the_head;
+	if(NULL != *the_head)
+	{
+		(*the_head)->previous = the_timer;
+	}
+	*the_head = the_timer;
+	the_wheel->occupiedSlots[the_level] |= ((Uint64)1 << the_slot);
+
+	the_timer->level = (Uint8)the_level;
+	the_timer->slot = (Uint8)the_slot;
+	the_timer->isScheduled = SDL_TRUE;
+	the_wheel->numberScheduled++;
+}
+
+void FlappyTimerWheel_Init(struct FlappyTimerWheel* the_wheel, Uint32 start_time)
+{
+	SDL_memset(the_wheel, 0, sizeof(struct FlappyTimerWheel));
+	the_wheel->currentTime = start_time;
+}
+
+void FlappyTimerWheel_Reset(struct FlappyTimerWheel* the_wheel, Uint32 start_time)
+{
+	Uint32 the_level;
+
+	for(the_level=0; the_level<FLAPPY_TIMER_WHEEL_NUMBER_OF_LEVELS; the_level++)
+	{
+		Uint64 occupied_slots = the_wheel->occupiedSlots[the_level];
+		while(0 != occupied_slots)
+		{
+			the_wheel->slots[the_level][FlappyTimerWheel_FindFirstSetBit(occupied_slots)] = NULL;
+			/* Clear the lowest set bit. */
+			occupied_slots &= occupied_slots - 1;
+		}
+		the_wheel->occupiedSlots[the_level] = 0;
+	}
+	the_wheel->numberScheduled = 0;
+	the_wheel->currentTime = start_time;
+}
+
+void FlappyTimer_Init(struct FlappyTimer* the_timer, FlappyTimerCallback the_callback, void* user_data)
+{
+	SDL_memset(the_timer, 0, sizeof(struct FlappyTimer));
+	the_timer->callback = the_callback;
+	the_timer->userData = user_data;
+}
+
+void FlappyTimerWheel_Schedule(struct FlappyTimerWheel* the_wheel, struct FlappyTimer* the_timer, Uint32 the_deadline)
+{
+	FlappyTimerWheel_Cancel(the_wheel, the_timer);
+	the_timer->deadline = the_deadline;
+	FlappyTimerWheel_Insert(the_wheel, the_timer);
+}
+
+void FlappyTimerWheel_Cancel(struct FlappyTimerWheel* the_wheel, struct FlappyTimer* the_timer)
+{
+	if( ! the_timer->isScheduled)
+	{
+		return;
+	}
+	if(NULL != the_timer->previous)
+	{
+		the_timer->previous->next = the_timer->next;
+	}
+	else
+	{
+		the_wheel->slots[the_timer->level][the_timer->slot] = the_timer->next;
+		if(NULL == the_timer->next)
+		{
+			the_wheel->occupiedSlots[the_timer->level] &= ~((Uint64)1 << the_timer->slot);
+		}
+	}
+	if(NULL != the_timer->next)
+	{
+		the_timer->next->previous = the_timer->previous;
+	}
+	the_timer->next = NULL;
+	the_timer->previous = NULL;
+	the_timer->isScheduled = SDL_FALSE;
+	the_wheel->numberScheduled--;
+}
+
+/* Advance without the wrap: current_time must be numerically at or after currentTime. */
+static Uint32 FlappyTimerWheel_AdvanceWithinLap(struct FlappyTimerWheel* the_wheel, Uint32 current_time)
+{
+	Uint32 number_fired = 0;
+
+	while(the_wheel->numberScheduled > 0)
+	{
+		Uint32 the_level;
+		Uint32 the_slot = 0;
+		Uint32 event_time = 0;
+		SDL_bool found_slot = SDL_FALSE;
+
+		/* The first non-empty slot ahead of us on the lowest level that has one is the next thing that happens.
+			(Everything on a higher level is past the end of the lower level's current block.)
+		 */
+		for(the_level=0; the_level<FLAPPY_TIMER_WHEEL_NUMBER_OF_LEVELS; the_level++)
+		{
+			Uint32 the_shift = the_level * FLAPPY_TIMER_WHEEL_BITS_PER_LEVEL;
+			Uint32 current_slot = (the_wheel->currentTime >> the_shift) & FLAPPY_TIMER_WHEEL_SLOT_MASK;
+			/* Above level 0, the current slot is only ever occupied if we stopped right at its start last time
+				(Insert never puts anything there), so it is still due.
+			 */
+			Uint64 candidate_slots = the_wheel->occupiedSlots[the_level] & (~(Uint64)0 << current_slot);
+			if(0 != candidate_slots)
+			{
+				Uint32 block_shift = the_shift + FLAPPY_TIMER_WHEEL_BITS_PER_LEVEL;
+				Uint32 block_start = (block_shift >= 32) ? 0 : ((the_wheel->currentTime >> block_shift) << block_shift);
+				the_slot = FlappyTimerWheel_FindFirstSetBit(candidate_slots);
+				event_time = block_start + (the_slot << the_shift);
+				found_slot = SDL_TRUE;
+				break;
+			}
+		}
+		if(( ! found_slot) || (event_time > current_time))
+		{
+			break;
+		}
+
+		the_wheel->currentTime = event_time;
+		/* Take them off one at a time (instead of detaching the whole list),
+			so a callback can safely cancel or schedule other timers, including ones in this slot.
+		 */
+		while(NULL != the_wheel->slots[the_level][the_slot])
+		{
+			struct FlappyTimer* the_timer = the_wheel->slots[the_level][the_slot];
+			FlappyTimerWheel_Cancel(the_wheel, the_timer);
+			if(0 == the_level)
+			{
+				number_fired++;
+				if(NULL != the_timer->callback)
+				{
+					the_timer->callback(the_wheel, the_timer, the_timer->userData);
+				}
+			}
+			else
+			{
+				FlappyTimerWheel_Insert(the_wheel, the_timer);
+			}
+		}
+	}
+
+	/* Everything up to and including current_time has been done.
+		(At the very end of the 32-bit time range we stay put rather than wrap back to 0.)
+	 */
+	if((current_time >= the_wheel->currentTime) && (current_time != 0xFFFFFFFF))
+	{
+		the_wheel->currentTime = current_time + 1;
+	}
+	return number_fired;
+}
+
+Uint32 FlappyTimerWheel_Advance(struct FlappyTimerWheel* the_wheel, Uint32 current_time)
+{
+	Uint32 number_fired = 0;
+
+	if((Sint32)(current_time - the_wheel->currentTime) < 0)
+	{
+		/* That time has already been done. */
+		return 0;
+	}
+	if(current_time < the_wheel->currentTime)
+	{
+		/* The clock wrapped. Finish this lap, then start the next one from 0, which brings the deadlines past the wrap into view. */
+		number_fired += FlappyTimerWheel_AdvanceWithinLap(the_wheel, 0xFFFFFFFF);
+		the_wheel->currentTime = 0;
+	}
+	number_fired += FlappyTimerWheel_AdvanceWithinLap(the_wheel, current_time);
+	return number_fired;
+}
@@ -0,0 +1,147 @@
+#ifndef C_FLAPPY_TIMER_WHEEL_H
+#define C_FLAPPY_TIMER_WHEEL_H
+
+/* Set up for C function definitions, even when using C++ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef DOXYGEN_SHOULD_IGNORE_THIS
+/** @cond DOXYGEN_SHOULD_IGNORE_THIS */
+
+/* Note: For Doxygen to produce clean output, you should set the
+ * PREDEFINED option to remove C_FLAPPY_TIMER_WHEEL_DECLSPEC, C_FLAPPY_TIMER_WHEEL_CALL, and
+ * the DOXYGEN_SHOULD_IGNORE_THIS blocks.
+ * PREDEFINED = DOXYGEN_SHOULD_IGNORE_THIS=1 C_FLAPPY_TIMER_WHEEL_DECLSPEC= C_FLAPPY_TIMER_WHEEL_CALL=
+ */
+
+/** Windows needs to know explicitly which functions to export in a DLL. */
+#if defined(_WIN32)
+	#if defined(C_FLAPPY_TIMER_WHEEL_BUILD_LIBRARY)
+		#define C_FLAPPY_TIMER_WHEEL_DECLSPEC __declspec(dllexport)
+	#else
+		#define C_FLAPPY_TIMER_WHEEL_DECLSPEC
+	#endif
+#else
+	#if defined(C_FLAPPY_TIMER_WHEEL_BUILD_LIBRARY)
+		#if defined (__GNUC__) && __GNUC__ >= 4
+			#define C_FLAPPY_TIMER_WHEEL_DECLSPEC __attribute__((visibility("default")))
+		#else
+			#define C_FLAPPY_TIMER_WHEEL_DECLSPEC
+		#endif
+	#else
+		#define C_FLAPPY_TIMER_WHEEL_DECLSPEC
+	#endif
+#endif
+
+/* For Windows, by default, use the C calling convention */
+#if defined(_WIN32)
+	#define C_FLAPPY_TIMER_WHEEL_CALL __cdecl
+#else
+	#define C_FLAPPY_TIMER_WHEEL_CALL
+#endif
+
+/** @endcond DOXYGEN_SHOULD_IGNORE_THIS */
+#endif /* DOXYGEN_SHOULD_IGNORE_THIS */
+
+
+
+#include "SDL.h"
+
+/**
+ * @file
+ * FlappyTimerWheel is a hierarchical timing wheel for game time deadlines (in milli-seconds, like TimeTicker_GetTime).
+ * Instead of polling "has this phase run long enough yet?" every frame, the code that starts a phase
+ * schedules a FlappyTimer for when it should end, and FlappyTimerWheel_Advance calls it back when the time comes.
+ *
+ * There are FLAPPY_TIMER_WHEEL_NUMBER_OF_LEVELS levels of 64 slots. Level 0 slots are 1 ms wide, level 1 slots are 64 ms wide, and so on.
+ * A timer lives in the lowest level whose slot can tell its deadline apart from the current time,
+ * and moves down a level each time the wheel reaches its slot. Each level also keeps a bit mask of its non-empty slots,
+ * so advancing jumps straight to the next slot that has something in it. Advancing a wheel with nothing due
+ * is a handful of bit operations no matter how much time passed, and scheduling and cancelling are O(1).
+ *
+ * Times wrap around like SDL_GetTicks: a deadline counts as due when it is less than 2^31 ms before the current time.
+ *
+ * FlappyTimer and FlappyTimerWheel are plain structs so they can be embedded (e.g. in a FlappyWorld) without any allocation.
+ * Nothing here is thread safe.
+ */
+
+/** The number of bits of the deadline each level takes care of. */
+#define FLAPPY_TIMER_WHEEL_BITS_PER_LEVEL 6
+#define FLAPPY_TIMER_WHEEL_SLOTS_PER_LEVEL (1 << FLAPPY_TIMER_WHEEL_BITS_PER_LEVEL)
+/** Enough levels to cover all 32 bits of a deadline. */
+#define FLAPPY_TIMER_WHEEL_NUMBER_OF_LEVELS 6
+
+struct FlappyTimer;
+struct FlappyTimerWheel;
+
+/**
+ * Called by FlappyTimerWheel_Advance when a timer's deadline is reached.
+ * The timer is no longer scheduled by then, so the callback may schedule it (or any other timer) again.
+ */
+typedef void (*FlappyTimerCallback)(struct FlappyTimerWheel* the_wheel, struct FlappyTimer* the_timer, void* user_data);
+
+typedef struct FlappyTimer
+{
+	/* The slot's list. Only valid while isScheduled. */
+	struct FlappyTimer* next;
+	struct FlappyTimer* previous;
+	Uint32 deadline;
+	Uint8 level;
+	Uint8 slot;
+	SDL_bool isScheduled;
+	FlappyTimerCallback callback;
+	void* userData;
+} FlappyTimer;
+
+typedef struct FlappyTimerWheel
+{
+	/* Every time before this has been processed. */
+	Uint32 currentTime;
+	Uint32 numberScheduled;
+	/* Bit N is set if slots[level][N] is not empty. */
+	Uint64 occupiedSlots[FLAPPY_TIMER_WHEEL_NUMBER_OF_LEVELS];
+	struct FlappyTimer* slots[FLAPPY_TIMER_WHEEL_NUMBER_OF_LEVELS][FLAPPY_TIMER_WHEEL_SLOTS_PER_LEVEL];
+} FlappyTimerWheel;
+
+/**
+ * Empties the wheel (without touching any timers that were in it) and sets its time.
+ * Deadlines before start_time fire on the next FlappyTimerWheel_Advance.
+ */
+extern C_FLAPPY_TIMER_WHEEL_DECLSPEC void C_FLAPPY_TIMER_WHEEL_CALL FlappyTimerWheel_Init(struct FlappyTimerWheel* the_wheel, Uint32 start_time);
+
+/**
+ * Like FlappyTimerWheel_Init, but for a wheel that has already been initialized.
+ * Only the occupied slots are cleared, so it costs next to nothing when the wheel holds a timer or two.
+ */
+extern C_FLAPPY_TIMER_WHEEL_DECLSPEC void C_FLAPPY_TIMER_WHEEL_CALL FlappyTimerWheel_Reset(struct FlappyTimerWheel* the_wheel, Uint32 start_time);
+
+/**
+ * Sets up a timer that isn't scheduled. Call this once before the timer is first used.
+ */
+extern C_FLAPPY_TIMER_WHEEL_DECLSPEC void C_FLAPPY_TIMER_WHEEL_CALL FlappyTimer_Init(struct FlappyTimer* the_timer, FlappyTimerCallback the_callback, void* user_data);
+
+/**
+ * Schedules the timer to fire at the_deadline. If it was already scheduled, it is moved.
+ * A deadline that has already passed fires on the next FlappyTimerWheel_Advance.
+ */
+extern C_FLAPPY_TIMER_WHEEL_DECLSPEC void C_FLAPPY_TIMER_WHEEL_CALL FlappyTimerWheel_Schedule(struct FlappyTimerWheel* the_wheel, struct FlappyTimer* the_timer, Uint32 the_deadline);
+
+/**
+ * Unschedules the timer. Does nothing if it isn't scheduled.
+ */
+extern C_FLAPPY_TIMER_WHEEL_DECLSPEC void C_FLAPPY_TIMER_WHEEL_CALL FlappyTimerWheel_Cancel(struct FlappyTimerWheel* the_wheel, struct FlappyTimer* the_timer);
+
+/**
+ * Fires (in deadline order) every timer whose deadline is at or before current_time.
+ * Timers scheduled by the callbacks fire in the same call if they are also due.
+ * @return The number of timers fired.
+ */
+extern C_FLAPPY_TIMER_WHEEL_DECLSPEC Uint32 C_FLAPPY_TIMER_WHEEL_CALL FlappyTimerWheel_Advance(struct FlappyTimerWheel* the_wheel, Uint32 current_time);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* C_FLAPPY_TIMER_WHEEL_H */
@@ -0,0 +1,2128 @@
+/*
+	FlappyWorld is the simulation half of Flappy Blurrr.
+	Everything that used to be a file-scope global in main_c.c (bird, pipes, physics space, game state, game clock)
+	lives in a struct FlappyWorld so one process can host as many independent games as it wants.
+	Nothing in here may touch the renderer, fonts or audio. The app finds out about sounds to play
+	and textures to regenerate through the event callback.
+*/
+
+#include <stdlib.h>
+#include <math.h>
+
+#include "FlappyWorld.h"
+#include "FlappyReplay.h"
+
+
+static void Flappy_SendEvent(struct FlappyWorld* the_world, int which_event)
+{
+	if(NULL != the_world->eventCallback)
+	{
+		the_world->eventCallback(the_world, which_event, the_world->eventCallbackUserData);
+	}
+}
+
+int Flappy_lroundf(float x)
+{
+	return (int)(x+0.5f);
+}
+
+
+// Used to get the height of the game screen, minus the bird's Y
+Sint32 Flappy_InvertY(Sint32 y)
+{
+	return (SCREEN_HEIGHT-y);
+}
+
+
+void Flappy_PauseGame(struct FlappyWorld* the_world)
+{
+	if(the_world->gameInstanceData.isPaused)
+	{
+	}
+	else
+	{
+		TimeTicker_Stop(the_world->gameClock);
+		the_world->gameInstanceData.isPaused = SDL_TRUE;
+	}
+	
+}
+void Flappy_UnpauseGame(struct FlappyWorld* the_world)
+{
+	if(the_world->gameInstanceData.isPaused)
+	{
+		TimeTicker_Start(the_world->gameClock);
+		the_world->gameInstanceData.isPaused = SDL_FALSE;
+	}
+	else
+	{
+	}
+	
+}
+
+void Flappy_TogglePause(struct FlappyWorld* the_world)
+{
+	if(the_world->gameInstanceData.isPaused)
+	{
+		TimeTicker_Start(the_world->gameClock);
+		the_world->gameInstanceData.isPaused = SDL_FALSE;
+	}
+	else
+	{
+		TimeTicker_Stop(the_world->gameClock);
+		the_world->gameInstanceData.isPaused = SDL_TRUE;
+	}
+	
+}
+
+
+MyFloat Flappy_ComputeLinearInterpolation(MyFloat current_value, MyFloat start_value, MyFloat end_value)
+{
+	/* Use the linear interpolation formula:
+	 * X = (1-t)x0 + tx1
+	 * where x0 would be the start value
+	 * and x1 is the final value
+	 * and t is delta_time*inv_time (adjusts 0 <= time <= 1)
+	 * delta_time = current_time-start_time
+	 * inv_time = 1/ (end_time-start_time)
+	 * so t = current_time-start_time / (end_time-start_time)
+	 *
+	 */
+	if(current_value > end_value)
+	{
+		return 1.0;
+	}
+	else if(current_value < start_value)
+	{
+		return 0.0;
+	}
+	return (current_value-start_value) / (end_value-start_value);
+}
+
+static void Flappy_StepNativePhysics(struct FlappyWorld* the_world, cpFloat fixed_dt);
+static void Flappy_SchedulePhaseDeadline(struct FlappyWorld* the_world);
+
+/* step_time is the game time the step state is for. The scenery is scrolled by time (and stops where the bird died),
+	so remembering that time is enough to put everything that scrolls back where it was.
+ */
+static void Flappy_CaptureStepState(struct FlappyWorld* the_world, struct FlappyWorldStepState* out_step_state, Uint32 base_time, Uint32 step_time)
+{
+	cpVect vec_bird_position = cpBodyGetPosition(the_world->birdModelData.birdBody);
+	Uint32 scroll_time = the_world->birdModelData.isDead ? the_world->gameInstanceData.diedAtTime : step_time;
+
+	out_step_state->birdPositionY = vec_bird_position.y;
+	out_step_state->birdAngle = cpBodyGetAngle(the_world->birdModelData.birdBody);
+	out_step_state->scrollTime = (double)(Uint32)(scroll_time - base_time);
+}
+
+static void Flappy_StepPhysics(struct FlappyWorld* the_world, Uint32 delta_time, Uint32 base_time, Uint32 current_time)
+{
+	/* Exact, even when the tick lengths in milli-seconds aren't (see FLAPPY_WORLD_TICK_TIME). */
+	const cpFloat fixed_dt = 1.0 / FLAPPY_WORLD_TICKS_PER_SECOND;
+
+	// add the current dynamic timestep to the accumulator
+	// (in whole milliseconds so the step count can't drift from float rounding)
+	the_world->physicsAccumulator += delta_time;
+	
+	while(the_world->physicsAccumulator >= FLAPPY_WORLD_TICK_LENGTH(the_world->tickCount))
+	{
+		Uint32 tick_length = FLAPPY_WORLD_TICK_LENGTH(the_world->tickCount);
+		/* The game time this step starts at is however much is still left to step before current_time. */
+		Uint32 step_start_time = current_time - the_world->physicsAccumulator;
+		if(NULL != the_world->stepCallback)
+		{
+			the_world->stepCallback(the_world, step_start_time, the_world->stepCallbackUserData);
+		}
+		Flappy_CaptureStepState(the_world, &the_world->previousStepState, base_time, step_start_time);
+
+		if(FLAPPY_PHYSICS_BACKEND_NATIVE == the_world->physicsBackend)
+		{
+			Flappy_StepNativePhysics(the_world, fixed_dt);
+		}
+		else
+		{
+			cpSpaceStep(the_world->mainSpace, fixed_dt);
+		}
+		the_world->physicsAccumulator -= tick_length;
+		/* Counting here rather than in FlappyWorld_StepTick means the wall-clock loop keeps the tick count too, so it can be recorded. */
+		the_world->tickCount++;
+		/* A prestepped bird is only good for the one step it was made for (and only the native backend uses it). */
+		the_world->hasPresteppedBird = SDL_FALSE;
+
+		Flappy_CaptureStepState(the_world, &the_world->currentStepState, base_time, step_start_time + tick_length);
+	}
+}
+
+
+//#define GROUND_VELOCITY_X -SCREEN_WIDTH / 5000.0f
+// Original flappy seems to move across at about 3 seconds on 768 pixels (iPad)
+//#define GROUND_VELOCITY_X -768 / 3000.0f
+#define GROUND_VELOCITY_X -768.0 / 2800.0
+#define BIRD_VELOCITY_X -1*GROUND_VELOCITY_X
+
+//#define BUSH_VELOCITY_X -SCREEN_WIDTH / 200000.0f
+#define BUSH_VELOCITY_X -SCREEN_WIDTH / 80000.0f
+#define CLOUD_VELOCITY_X -SCREEN_WIDTH / 20000.0f
+
+/* Sprite sizes of the shipped resources.
+	The simulation uses these instead of querying the textures so a world steps exactly the same
+	with or without a renderer. The pipe width matters because it sizes the physics shapes.
+ */
+#define DEFAULT_CLOUD_TEXTURE_WIDTH 960
+#define DEFAULT_CLOUD_TEXTURE_HEIGHT 235
+#define DEFAULT_BUSH_TEXTURE_WIDTH 640
+#define DEFAULT_BUSH_TEXTURE_HEIGHT 69
+#define DEFAULT_PIPE_TEXTURE_WIDTH PIPE_PHYSICS_WIDTH
+#define DEFAULT_PIPE_TEXTURE_HEIGHT 512
+
+/* Zeroed, starts on a cache line, and is rounded up to whole cache lines so nothing else shares its last one. */
+static void* Flappy_AllocateCacheAligned(size_t the_size, void** out_allocation)
+{
+	size_t padded_size = (the_size + FLAPPY_WORLD_CACHE_LINE_SIZE - 1) & ~(size_t)(FLAPPY_WORLD_CACHE_LINE_SIZE - 1);
+	char* the_allocation = (char*)SDL_calloc(1, padded_size + FLAPPY_WORLD_CACHE_LINE_SIZE - 1);
+	*out_allocation = the_allocation;
+	if(NULL == the_allocation)
+	{
+		return NULL;
+	}
+	return (void*)(((uintptr_t)the_allocation + FLAPPY_WORLD_CACHE_LINE_SIZE - 1) & ~(uintptr_t)(FLAPPY_WORLD_CACHE_LINE_SIZE - 1));
+}
+
+static void Flappy_InitializeCloudModelData(struct FlappyWorld* the_world)
+{
+	int the_width = DEFAULT_CLOUD_TEXTURE_WIDTH;
+	int the_height = DEFAULT_CLOUD_TEXTURE_HEIGHT;
+	
+	SDL_zero(the_world->cloudModelData);
+	
+	// 960 / 5000 msec = .192
+	the_world->cloudModelData.velocity.x = CLOUD_VELOCITY_X;
+	the_world->cloudModelData.size.x = the_width;
+	the_world->cloudModelData.size.y = the_height;
+}
+
+static void Flappy_UpdateCloudPositions(struct FlappyWorld* the_world, Uint32 delta_time, Uint32 base_time, Uint32 current_time)
+{
+	Uint32 diff_time = current_time - base_time;
+	Sint32 current_position;
+	Sint32 shift_factor;
+
+//	the_world->cloudModelData.position.x = Flappy_lroundf((MyFloat)the_world->cloudModelData.position.x + the_world->cloudModelData.velocity.x * (MyFloat)delta_time);
+	current_position = Flappy_lroundf(the_world->cloudModelData.velocity.x * (MyFloat)diff_time);
+
+	shift_factor = SDL_abs(current_position) / the_world->cloudModelData.size.x;
+	the_world->cloudModelData.position.x = (the_world->cloudModelData.size.x * shift_factor) + current_position;
+	/*
+	if(the_world->cloudModelData.position.x < (0 - the_world->cloudModelData.size.x))
+	{
+		the_world->cloudModelData.position.x = the_world->cloudModelData.position.x + the_world->cloudModelData.size.x;
+	}
+	 */
+}
+
+
+
+
+static void Flappy_InitializeGroundModelData(struct FlappyWorld* the_world)
+{
+	/*
+	Uint32 the_format;
+	int the_access;
+	int the_width;
+	int the_height;
+	*/
+	
+	SDL_zero(the_world->playerModelData);
+	SDL_zero(the_world->groundModelData);
+//	SDL_QueryTexture(the_texture, &the_format, &the_access, &the_width, &the_height);
+	
+	// 960 / 5000 msec = .192
+	the_world->groundModelData.velocity.x = GROUND_VELOCITY_X;
+//	the_world->groundModelData.velocity.x = -0.1f;
+	the_world->groundModelData.size.x = SCREEN_WIDTH;
+	/* The ground height in the image is actually really tall and we don't want all of it.
+	 So we can truncate the bottom part that we don't want.
+	 We'll take 1/5 of the image.
+	 */
+	the_world->groundModelData.size.y = GROUND_HEIGHT;
+	
+
+}
+
+static void Flappy_UpdateGroundPosition(struct FlappyWorld* the_world, Uint32 delta_time, Uint32 base_time, Uint32 current_time)
+{
+	/*
+	the_world->groundModelData.position.x = Flappy_lroundf((MyFloat)the_world->groundModelData.position.x + the_world->groundModelData.velocity.x * (MyFloat)delta_time);
+	if(the_world->groundModelData.position.x < (0 - the_world->groundModelData.size.x))
+	{
+		the_world->groundModelData.position.x = the_world->groundModelData.position.x + the_world->groundModelData.size.x;
+	}
+	*/
+	
+	Uint32 diff_time = current_time - base_time;
+	Sint32 current_position;
+	Sint32 shift_factor;
+	
+	current_position = Flappy_lroundf(the_world->groundModelData.velocity.x * (MyFloat)diff_time);
+	
+	shift_factor = SDL_abs(current_position) / the_world->groundModelData.size.x;
+	the_world->groundModelData.position.x = (the_world->groundModelData.size.x * shift_factor) + current_position;
+
+	
+	the_world->playerModelData.position.x = current_position;
+	
+	
+	
+	
+	// physics
+
+	{
+		
+		//cpFloat ground_height = (1024/16 * 1.9) * 768 / 1024;
+		
+	current_position = Flappy_lroundf(the_world->birdModelData.velocity.x * (MyFloat)diff_time);
+
+	
+
+
+		cpBodySetPosition(the_world->groundPhysicsData.body, cpv(current_position + SCREEN_WIDTH/2, GROUND_HEIGHT/2.0));
+//		cpBodySetPosition(the_world->groundPhysicsData.body, cpv(current_position + SCREEN_WIDTH/2, GROUND_HEIGHT));
+//	cpBodySetPosition(the_world->groundPhysicsData.body, cpv(current_position + SCREEN_WIDTH/2, 0));
+		cpSpaceReindexShape(the_world->mainSpace, the_world->groundPhysicsData.shape);
+//		SDL_Log("current_bird pos:%f, %d\n", the_world->birdModelData.birdBody->p.x, current_position);
+	}
+}
+
+
+static void Flappy_InitializeBushModelData(struct FlappyWorld* the_world)
+{
+	int the_width = DEFAULT_BUSH_TEXTURE_WIDTH;
+	int the_height = DEFAULT_BUSH_TEXTURE_HEIGHT;
+	
+	SDL_zero(the_world->bushModelData);
+	
+	// 960 / 5000 msec = .192
+	the_world->bushModelData.velocity.x = BUSH_VELOCITY_X;
+	the_world->bushModelData.size.x = the_width;
+	the_world->bushModelData.size.y = the_height;
+}
+
+static void Flappy_UpdateBushPositions(struct FlappyWorld* the_world, Uint32 delta_time, Uint32 base_time, Uint32 current_time)
+{
+	Uint32 diff_time = current_time - base_time;
+	Sint32 current_position;
+	Sint32 shift_factor;
+	
+	//	the_world->cloudModelData.position.x = Flappy_lroundf((MyFloat)the_world->cloudModelData.position.x + the_world->cloudModelData.velocity.x * (MyFloat)delta_time);
+	current_position = Flappy_lroundf(the_world->bushModelData.velocity.x * (MyFloat)diff_time);
+	
+	shift_factor = SDL_abs(current_position) / the_world->bushModelData.size.x;
+	the_world->bushModelData.position.x = (the_world->bushModelData.size.x * shift_factor) + current_position;
+	/*
+	 if(the_world->cloudModelData.position.x < (0 - the_world->cloudModelData.size.x))
+	 {
+	 the_world->cloudModelData.position.x = the_world->cloudModelData.position.x + the_world->cloudModelData.size.x;
+	 }
+	 */
+}
+
+
+// Intializes both the top and bottom. Assumes the pipe textures are the sime width/height
+static void Flappy_InitializePipeModelData(struct FlappyWorld* the_world)
+{
+	int the_width = DEFAULT_PIPE_TEXTURE_WIDTH;
+	int the_height = DEFAULT_PIPE_TEXTURE_HEIGHT;
+	
+	Sint32 i;
+
+	SDL_zero(the_world->pipeTopModelData);
+	SDL_zero(the_world->pipeBottomModelData);
+	
+	// 960 / 5000 msec = .192
+	the_world->pipeTopModelData.velocity.x = GROUND_VELOCITY_X;
+	the_world->pipeBottomModelData.velocity.x = GROUND_VELOCITY_X;
+	//	the_world->groundModelData.velocity.x = -0.1f;
+	
+	the_world->pipeTopModelData.size.x = the_width;
+	the_world->pipeBottomModelData.size.x = the_width;
+//#define PIPE_WIDTH 170
+//#define PIPE_WIDTH 106
+//#define PIPE_WIDTH 140
+//#define PIPE_WIDTH 249
+	the_world->pipeTopModelData.size.x = PIPE_WIDTH;
+	the_world->pipeBottomModelData.size.x = PIPE_WIDTH;
+
+	/* The ground height in the image is actually really tall and we don't want all of it.
+	 So we can truncate the bottom part that we don't want.
+	 We'll take 1/5 of the image.
+	 */
+	the_world->pipeTopModelData.size.y = the_height;
+	the_world->pipeBottomModelData.size.y = the_height;
+	
+	
+	
+	the_world->arrayOfPipes = (struct PipeModelData*)Flappy_AllocateCacheAligned(MAX_NUM_PIPES * sizeof(struct PipeModelData), &the_world->pipeAllocation);
+	FlappyPipeQueue_Init(&the_world->circularQueueOfPipes, MAX_NUM_PIPES);
+	FlappyPipeQueue_Init(&the_world->queueOfAvailablePipes, MAX_NUM_PIPES);
+	for(i=0; i<MAX_NUM_PIPES; i++)
+	{
+		struct PipeModelData* current_pipe = &the_world->arrayOfPipes[i];
+		
+		current_pipe->upperPhysicsBody = cpBodyNewStatic();
+		current_pipe->upperPhysicsShape = cpBoxShapeNew(current_pipe->upperPhysicsBody, the_width, SCREEN_HEIGHT, 0.0);
+		current_pipe->lowerPhysicsBody = cpBodyNewStatic();
+		current_pipe->lowerPhysicsShape = cpBoxShapeNew(current_pipe->lowerPhysicsBody, the_width, SCREEN_HEIGHT, 0.0);
+
+		cpShapeSetCollisionType(current_pipe->upperPhysicsShape, PIPE_COLLISION_TYPE);
+		cpShapeSetCollisionType(current_pipe->lowerPhysicsShape, PIPE_COLLISION_TYPE);
+
+		
+		current_pipe->scoreSensorPhysicsBody = cpBodyNewStatic();
+//		current_pipe->scoreSensorPhysicsShape = cpBoxShapeNew(current_pipe->scoreSensorPhysicsBody, the_width/2, PIPE_HEIGHT_SEPARATION);
+		current_pipe->scoreSensorPhysicsShape = cpBoxShapeNew(current_pipe->scoreSensorPhysicsBody, the_width/2, SCREEN_HEIGHT, 0.0);
+
+
+		
+		cpShapeSetSensor(current_pipe->scoreSensorPhysicsShape, cpTrue);
+		cpShapeSetCollisionType(current_pipe->scoreSensorPhysicsShape, SCORE_SENSOR_TYPE);
+
+		
+		// don't add to space to make it a "rogue" body (intended to be controlled manually)
+		//	cpSpaceAddShape(the_world->mainSpace, the_world->groundPhysicsData.shape);
+		//cpSpaceAddShape(the_world->mainSpace, the_world->groundPhysicsData.shape);
+		
+
+		
+				
+		
+		FlappyPipeQueue_PushBack(&the_world->queueOfAvailablePipes, &the_world->arrayOfPipes[i]);
+	}
+}
+
+/* Moves the pipe's physics bodies to match its model data. Do this before its shapes are added to the space. */
+static void Flappy_PlacePipeBodies(struct PipeModelData* the_pipe)
+{
+	cpBodySetPosition(the_pipe->lowerPhysicsBody, cpv(the_pipe->realPositionX, the_pipe->lowerRealPositionY + the_pipe->pipeHeight - SCREEN_HEIGHT/2));
+//	cpBodySetPosition(the_pipe->lowerPhysicsBody, cpv(the_pipe->realPositionX - the_pipe->size.x / 2, the_pipe->lowerRealPositionY + the_pipe->pipeHeight/2));
+//	cpBodySetPosition(the_pipe->upperPhysicsBody, cpv(the_pipe->realPositionX - the_pipe->size.x / 2, the_pipe->upperRealPositionY + (SCREEN_HEIGHT - the_pipe->pipeHeight - PIPE_HEIGHT_SEPARATION - GROUND_HEIGHT)/2));
+	cpBodySetPosition(the_pipe->upperPhysicsBody, cpv(the_pipe->realPositionX, the_pipe->upperRealPositionY + (SCREEN_HEIGHT/2)));
+
+//	cpBodySetPosition(the_pipe->scoreSensorPhysicsBody, cpv(the_pipe->realPositionX + the_pipe->size.x / 4, GROUND_HEIGHT+ random_pipe_height + PIPE_HEIGHT_SEPARATION - PIPE_HEIGHT_SEPARATION/2));
+//	cpBodySetPosition(the_pipe->scoreSensorPhysicsBody, cpv(the_pipe->realPositionX, GROUND_HEIGHT+ random_pipe_height + PIPE_HEIGHT_SEPARATION - PIPE_HEIGHT_SEPARATION/2));
+	cpBodySetPosition(the_pipe->scoreSensorPhysicsBody, cpv(the_pipe->realPositionX + PIPE_WIDTH/4, SCREEN_HEIGHT/2));
+}
+
+/* Pipes that aren't in use stay in the space, parked this far below the ground where the bird can never reach them.
+	So recycling a pipe (or restoring a snapshot) only moves static bodies instead of adding and removing shapes.
+ */
+#define PARKED_PIPE_POSITION_Y (-4 * SCREEN_HEIGHT)
+
+static void Flappy_ParkPipeBodies(struct PipeModelData* the_pipe)
+{
+	cpBodySetPosition(the_pipe->lowerPhysicsBody, cpv(0, PARKED_PIPE_POSITION_Y));
+	cpBodySetPosition(the_pipe->upperPhysicsBody, cpv(0, PARKED_PIPE_POSITION_Y));
+	cpBodySetPosition(the_pipe->scoreSensorPhysicsBody, cpv(0, PARKED_PIPE_POSITION_Y));
+}
+
+/* The pipe bodies are static, so the space won't notice they moved until it is told. */
+static void Flappy_ReindexPipeShapes(struct FlappyWorld* the_world, struct PipeModelData* the_pipe)
+{
+	cpSpaceReindexShape(the_world->mainSpace, the_pipe->upperPhysicsShape);
+	cpSpaceReindexShape(the_world->mainSpace, the_pipe->lowerPhysicsShape);
+	cpSpaceReindexShape(the_world->mainSpace, the_pipe->scoreSensorPhysicsShape);
+}
+
+static void Flappy_UpdatePipePositions(struct FlappyWorld* the_world, Uint32 delta_time, Uint32 base_time, Uint32 current_time)
+{
+	/*
+	 the_world->groundModelData.position.x = Flappy_lroundf((MyFloat)the_world->groundModelData.position.x + the_world->groundModelData.velocity.x * (MyFloat)delta_time);
+	 if(the_world->groundModelData.position.x < (0 - the_world->groundModelData.size.x))
+	 {
+	 the_world->groundModelData.position.x = the_world->groundModelData.position.x + the_world->groundModelData.size.x;
+	 }
+	 */
+	
+	Uint32 diff_time = current_time - base_time;
+	Sint32 current_position;
+	Sint32 shift_factor;
+	Sint32 i;
+	Sint32 number_of_pipes;
+	struct PipeModelData** pipe_spans[2];
+	unsigned int pipe_span_counts[2];
+	Sint32 which_span;
+	
+	Sint32 new_offscreen_pipe_position_x;
+	Sint32 left_most_pipe_position_x;
+	Sint32 right_most_pipe_position_x;
+
+	struct PipeModelData* the_pipe = NULL;
+
+	
+	if(the_world->birdModelData.isPrelaunch)
+	{
+		return;
+	}
+//	else if(current_time < the_world->birdModelData.birdLaunchStartTime + PIPE_START_TIME_DELAY)
+    else if(the_world->gameState < GAMESTATE_MAIN_GAME_ACTIVE)
+	{
+		return;
+	}
+	else if(the_world->birdModelData.isDead)
+	{
+		return;
+	}
+	
+	// camera position
+//	current_position = Flappy_lroundf(the_world->pipeTopModelData.velocity.x * (MyFloat)diff_time);
+	current_position = -1 * Flappy_lroundf(the_world->pipeTopModelData.velocity.x * (MyFloat)diff_time);
+	
+//	shift_factor = SDL_abs(current_position) / the_world->pipeTopModelData.size.x;
+	shift_factor = SDL_abs(current_position) / PIPE_DISTANCE;
+	the_world->pipeTopModelData.position.x = (PIPE_DISTANCE * shift_factor) + current_position;
+	the_world->pipeBottomModelData.position.x = (PIPE_DISTANCE * shift_factor) + current_position;
+	
+	left_most_pipe_position_x = (PIPE_DISTANCE * shift_factor) + current_position;
+	
+	the_world->playerModelData.position.x = current_position;
+	
+	
+
+
+
+	/* update all pipe positions in queue */
+	/* To avoid drift/rounding-errors due to imperfect frame rate intervals,
+		I am avoiding arithmetic based on this previous position.
+		Instead, I am trying to use a formula, which will guarantee the perfect placement based on the current time.
+		But the trick we need to contend with is how to determine which pipe in the queue corresponds with the correct pipe multiple.
+		One way is to do the (bad) arthimetic with delta_time to figure out which 'slot' it is in.
+		Then recompute the real position based on that slot.
+	 
+	*/
+	/* Walk the ring as its (at most two) contiguous runs so the inner loop is a plain array walk. */
+	FlappyPipeQueue_GetSpans(&the_world->circularQueueOfPipes, &pipe_spans[0], &pipe_span_counts[0], &pipe_spans[1], &pipe_span_counts[1]);
+	for(which_span=0; which_span<2; which_span++)
+	{
+		number_of_pipes = (Sint32)pipe_span_counts[which_span];
+		for(i=0; i<number_of_pipes; i++)
+		{
+			struct PipeModelData* current_pipe = pipe_spans[which_span][i];
+
+			current_pipe->viewPositionX = current_pipe->realPositionX - current_position;
+
+			/*
+		
+			//			dst_rect.x = the_world->pipeTopModelData.position.x + PIPE_DISTANCE * i;
+		
+			Sint32 approx_position_x = Flappy_lroundf((MyFloat)current_pipe->position.x + the_world->groundModelData.velocity.x * (MyFloat)delta_time);
+
+			Sint32 slot_multiple = ((approx_position_x - current_position) / PIPE_DISTANCE ) - shift_factor;
+		
+//			current_pipe->position.x = (PIPE_DISTANCE * (shift_factor+i)) + current_position;
+			current_pipe->position.x = (PIPE_DISTANCE * (shift_factor+slot_multiple)) + current_position;
+		
+			SDL_Log("\ni:%d, approx:%d, current:%d, slot:%d, x:%d\n", i, approx_position_x, current_position, slot_multiple, current_pipe->position.x);
+			 */
+//			SDL_Log("\ni:%d, real:%d, view:%d, slot:%d\n", i, current_pipe->realPosition.x, current_pipe->viewPosition, current_pipe->intervalScalar);
+
+		}
+	}
+	
+	
+	/* If an old pipe has fallen off the screen, we need to remove it. */
+	the_pipe = (FlappyPipeQueue_Size(&the_world->circularQueueOfPipes) > 0) ? *FlappyPipeQueue_Front(&the_world->circularQueueOfPipes) : NULL;
+	
+	if((NULL != the_pipe) && ((the_pipe->realPositionX + the_pipe->size.x) < current_position))
+	{
+//		SDL_Log("removed pipe, x:%d\n", the_pipe->realPositionX);
+
+		Flappy_ParkPipeBodies(the_pipe);
+		Flappy_ReindexPipeShapes(the_world, the_pipe);
+
+		for(i=0; i<FlappyPipeQueue_Size(&the_world->circularQueueOfPipes); i++)
+		{
+			struct PipeModelData* current_pipe = *FlappyPipeQueue_AtIndex(&the_world->circularQueueOfPipes, i);
+//			SDL_Log("\n\tcheckremove1 i:%d, real:%d, view:%d, slot:%d\n", i, current_pipe->realPosition.x, current_pipe->viewPosition, current_pipe->intervalScalar);
+		}
+		FlappyPipeQueue_PopFront(&the_world->circularQueueOfPipes);
+		for(i=0; i<FlappyPipeQueue_Size(&the_world->circularQueueOfPipes); i++)
+		{
+			struct PipeModelData* current_pipe = *FlappyPipeQueue_AtIndex(&the_world->circularQueueOfPipes, i);
+//			SDL_Log("\n\tcheckremove2 i:%d, real:%d, view:%d, slot:%d\n", i, current_pipe->realPosition.x, current_pipe->viewPosition, current_pipe->intervalScalar);
+		}
+		
+		FlappyPipeQueue_PushBack(&the_world->queueOfAvailablePipes, the_pipe);
+		
+	}
+	
+	/* If a new pipe will be coming onto the screen, we need to create it. */
+	/* Check the queue to see if the pipe has already been created.
+	 It should be at the end of the queue and will have the designated x position.
+	 */
+	//shift_factor = SDL_abs(current_position) / the_world->bushModelData.size.x;
+	//the_world->bushModelData.position.x = (the_world->bushModelData.size.x * shift_factor) + current_position;
+	
+//	right_most_pipe_position_x = left_most_pipe_position_x + PIPE_DISTANCE * MAX_NUM_PIPES;
+//	right_most_pipe_position_x = (PIPE_DISTANCE * (MAX_NUM_PIPES)) + current_position;
+	right_most_pipe_position_x = (PIPE_DISTANCE * (shift_factor+MAX_NUM_PIPES-1)) + current_position;
+	//the_world->bushModelData.position.x = (the_world->bushModelData.size.x * shift_factor) + current_position;
+	
+	right_most_pipe_position_x = current_position + SCREEN_WIDTH + PIPE_WIDTH;
+	Sint32 new_pipe_interval_scalar = right_most_pipe_position_x / PIPE_DISTANCE;
+	
+	
+	the_pipe = (FlappyPipeQueue_Size(&the_world->circularQueueOfPipes) > 0) ? *FlappyPipeQueue_Back(&the_world->circularQueueOfPipes) : NULL;
+	if((NULL == the_pipe) || (the_pipe->intervalScalar != new_pipe_interval_scalar))
+	{
+		Sint32 real_x_pos = PIPE_DISTANCE * new_pipe_interval_scalar;
+		
+		
+		if((real_x_pos) >= (current_position + SCREEN_WIDTH))
+		{
+			
+			the_pipe = (FlappyPipeQueue_Size(&the_world->queueOfAvailablePipes) > 0) ? *FlappyPipeQueue_Front(&the_world->queueOfAvailablePipes) : NULL;
+			SDL_assert(NULL != the_pipe);
+			if(NULL != the_pipe)
+			{
+				/* for range [M, N] */
+				int M = MIN_PIPE_HEIGHT;
+				int N = SCREEN_HEIGHT - GROUND_HEIGHT - PIPE_HEIGHT_SEPARATION - MIN_PIPE_HEIGHT;
+				int random_pipe_height = (int)FlappyWorld_RandomRange(the_world, M, N);
+	//			int random_pipe_height = MIN_PIPE_HEIGHT;
+
+				
+				FlappyPipeQueue_PopFront(&the_world->queueOfAvailablePipes);
+				
+				the_pipe->realPositionX = PIPE_DISTANCE * new_pipe_interval_scalar;
+				the_pipe->intervalScalar = new_pipe_interval_scalar;
+				the_pipe->viewPositionX = the_pipe->realPositionX - current_position;
+				
+				the_pipe->pipeHeight = random_pipe_height;
+				the_pipe->nativeContactFlags = 0;
+				/* Remember that SDL inverts the Y. */
+
+				the_pipe->lowerRealPositionY = GROUND_HEIGHT;
+				the_pipe->upperRealPositionY = GROUND_HEIGHT + random_pipe_height + PIPE_HEIGHT_SEPARATION;
+
+
+				the_pipe->lowerViewPositionY = Flappy_InvertY(
+															  the_pipe->lowerRealPositionY
+															  
+															  )
+				- the_pipe->pipeHeight
+				
+				;
+	//														  the_pipe->size.y;
+				the_pipe->size.x = the_world->pipeBottomModelData.size.x;
+
+
+				Flappy_PlacePipeBodies(the_pipe);
+
+			//	src_rect.h = SCREEN_HEIGHT - current_pipe->pipeHeight - PIPE_HEIGHT_SEPARATION - GROUND_HEIGHT;
+
+
+				Flappy_ReindexPipeShapes(the_world, the_pipe);
+
+//				SDL_Log("added pipe, x:%d\n", the_pipe->realPositionX);
+
+				FlappyPipeQueue_PushBack(&the_world->circularQueueOfPipes, the_pipe);
+			}
+		}
+	}
+
+	
+	
+	
+	
+#if 0
+	
+	SDL_Rect src_rect = {0, 0, 106, 672};
+	
+	SDL_Rect dst_rect = {the_world->pipeTopModelData.position.x, 0, 106, 672};
+	
+	
+	/* The texture does not fill the whole width of the screen.
+	 So draw it multiple times, shifted over
+	 until we fill the entire length of the screen.
+	 */
+	Sint32 number_of_times_to_repeat_draw;
+	Sint32 remainder;
+	Sint32 i;
+	
+	number_of_times_to_repeat_draw = (SCREEN_WIDTH / PIPE_DISTANCE) + 1;
+	remainder = SCREEN_WIDTH % PIPE_DISTANCE;
+	if(remainder > 0)
+	{
+		number_of_times_to_repeat_draw = number_of_times_to_repeat_draw + 1;
+	}
+	
+	for(i=0; i<number_of_times_to_repeat_draw; i++)
+	{
+		dst_rect.x = the_world->pipeTopModelData.position.x + PIPE_DISTANCE * i;
+		if(dst_rect.x < SCREEN_WIDTH)
+		{
+			SDL_RenderCopy(renderer, g_gameTextures.pipe_bottom, &src_rect, &dst_rect);
+		}
+	}
+#endif
+	
+}
+
+
+
+static void Flappy_InitializeBirdModelData(struct FlappyWorld* the_world)
+{
+	SDL_zero(the_world->birdModelData);
+	
+	// 960 / 5000 msec = .192
+	the_world->birdModelData.velocity.x = 0;
+//	the_world->birdModelData.size.x = the_width;
+//	the_world->birdModelData.size.y = the_height;
+//	the_world->birdModelData.size.x = 92;
+//	the_world->birdModelData.size.y = 74;
+//		the_world->birdModelData.size.x = 62;
+//		the_world->birdModelData.size.y = 50;
+	the_world->birdModelData.size.x = BIRD_WIDTH;
+	the_world->birdModelData.size.y = BIRD_HEIGHT;
+	the_world->birdModelData.position.x = SCREEN_WIDTH / 3;
+	the_world->birdModelData.position.y = SCREEN_HEIGHT / 2;
+	
+	
+	the_world->birdModelData.currentFrame = 1;
+	the_world->birdModelData.animationStartTime = 0;
+	the_world->birdModelData.animationDuration = BIRD_FLAP_ANIMATION_DURATION;
+	the_world->birdModelData.isAnimatingSprite = SDL_TRUE;
+	
+	the_world->birdModelData.isPrelaunch = SDL_TRUE;
+	the_world->birdModelData.isReadyForPipe = SDL_FALSE;
+	the_world->birdModelData.birdLaunchStartTime = 0;
+
+}
+
+// y is in cartesian
+static void Flappy_UpdateBirdPositionForPrelaunch(struct FlappyWorld* the_world, Uint32 delta_time, Uint32 base_time, Uint32 current_time, Sint32 base_bird_pos_x, Sint32 base_bird_pos_y)
+{
+	Uint32 diff_time = current_time - base_time;
+	Sint32 current_position;
+	Sint32 shift_factor;
+
+	cpFloat bird_angle;
+	Sint32 pos_y;
+
+	the_world->birdModelData.velocity.x = BIRD_VELOCITY_X;
+
+	//	the_world->cloudModelData.position.x = Flappy_lroundf((MyFloat)the_world->cloudModelData.position.x + the_world->cloudModelData.velocity.x * (MyFloat)delta_time);
+	current_position = Flappy_lroundf(the_world->birdModelData.velocity.x * (MyFloat)diff_time);
+	
+	//	shift_factor = SDL_abs(current_position) / the_world->cloudModelData.size.x;
+	//	the_world->birdModelData.position.x = SCREEN_WIDTH / 3;
+	the_world->birdModelData.position.x = base_bird_pos_x;
+	
+	pos_y = Flappy_lroundf( the_world->birdModelData.size.y/4 * SDL_sinf(current_time /1000.0 * 4)) + base_bird_pos_y;
+//	pos_y = Flappy_lroundf( the_world->birdModelData.size.y/4 * SDL_sinf(current_time /1000.0 * 4)) + the_world->birdModelData.position.y - the_world->birdModelData.size.y;
+		
+	the_world->birdModelData.position.y = Flappy_InvertY(pos_y + (the_world->birdModelData.size.y / 2));
+//	the_world->birdModelData.birdBody->p.y = pos_y;
+	
+	cpBodySetPosition(the_world->birdModelData.birdBody, cpv( the_world->birdModelData.position.x, pos_y + (the_world->birdModelData.size.y / 2)));
+
+	
+	{
+		the_world->birdModelData.animationDuration = BIRD_FLAP_ANIMATION_DURATION_FOR_PRELAUNCH;
+		MyFloat linear_interp;
+		Uint32 mod_time = (current_time - the_world->birdModelData.animationStartTime) % the_world->birdModelData.animationDuration
+;
+		Uint32 texture_index;
+		
+		linear_interp = Flappy_ComputeLinearInterpolation(mod_time, the_world->birdModelData.animationStartTime, the_world->birdModelData.animationStartTime+the_world->birdModelData.animationDuration);
+		texture_index = Flappy_lroundf(linear_interp * (MyFloat)NUMBER_OF_BIRD_FRAMES);
+		if(texture_index >= NUMBER_OF_BIRD_FRAMES)
+		{
+			texture_index = 0;
+		}
+		the_world->birdModelData.currentFrame = texture_index;
+		
+	}
+	
+}
+
+static void Flappy_UpdateBirdPositionForGame(struct FlappyWorld* the_world, Uint32 delta_time, Uint32 base_time, Uint32 current_time)
+{
+	Uint32 diff_time = current_time - base_time;
+	Sint32 current_position;
+	Sint32 shift_factor;
+	cpFloat bird_angle;
+	cpVect vec_bird_position;
+	cpVect vec_bird_velocity;
+
+	the_world->birdModelData.velocity.x = BIRD_VELOCITY_X;
+	vec_bird_position = cpBodyGetPosition(the_world->birdModelData.birdBody);
+
+	
+	if(the_world->birdModelData.isDead)
+	{
+		current_position = the_world->gameInstanceData.distanceTraveled;
+	}
+	else
+	{
+		//	the_world->cloudModelData.position.x = Flappy_lroundf((MyFloat)the_world->cloudModelData.position.x + the_world->cloudModelData.velocity.x * (MyFloat)delta_time);
+		current_position = Flappy_lroundf(the_world->birdModelData.velocity.x * (MyFloat)diff_time);
+		the_world->gameInstanceData.distanceTraveled = current_position;
+		
+	}
+	
+	
+//	shift_factor = SDL_abs(current_position) / the_world->cloudModelData.size.x;
+//	the_world->birdModelData.position.x = SCREEN_WIDTH / 3;
+	
+	
+	
+	
+	
+	
+	
+	the_world->birdModelData.position.y = Flappy_InvertY(
+		Flappy_lroundf(
+			vec_bird_position.y
+		)
+												+ 		(the_world->birdModelData.size.y / 2)
+
+	);
+
+//	SDL_Log("the_world->birdModelData.birdBody->p.y=%f, the_world->birdModelData.position.y=%d", the_world->birdModelData.birdBody->p.y, the_world->birdModelData.position.y);
+	// Trick to prevent bird from being drawn too far into the ground when physics collision penetrates too far.
+	{
+		
+		int radius = cpCircleShapeGetRadius(the_world->birdModelData.birdShape);
+		// we need 2*radius because SDL draws from the edge of the sprite, not the center.
+		int ground_threshold = SCREEN_HEIGHT - GROUND_HEIGHT - (2*radius); // the_world->birdModelData.size.y
+		// should be 640
+			
+		if(the_world->birdModelData.position.y > ground_threshold)
+		{
+			the_world->birdModelData.position.y = ground_threshold;
+		}
+	}
+//	cpBodySetPosition(the_world->birdModelData.birdBody, cpv( current_position + (SCREEN_WIDTH / 3) - (the_world->birdModelData.size.x / 2), the_world->birdModelData.birdBody->p.y));
+	cpBodySetPosition(the_world->birdModelData.birdBody, cpv( current_position + (SCREEN_WIDTH / 3), vec_bird_position.y));
+	vec_bird_velocity = cpBodyGetVelocity(the_world->birdModelData.birdBody);
+	cpBodySetVelocity(the_world->birdModelData.birdBody, cpv(the_world->birdModelData.velocity.x, vec_bird_velocity.y));
+
+	bird_angle = cpBodyGetAngle(the_world->birdModelData.birdBody);
+	if((bird_angle < -M_PI_2/4) && (bird_angle > -M_PI_2))
+	{
+		cpBodySetAngularVelocity(the_world->birdModelData.birdBody, -5);
+		/* Chipmunk API says to reindex after changing the angle */
+		cpSpaceReindexShapesForBody(the_world->mainSpace, the_world->birdModelData.birdBody);
+		the_world->birdModelData.isAnimatingSprite = SDL_FALSE;
+	}
+	else if(bird_angle <= -M_PI_2)
+	{
+		cpBodySetAngularVelocity(the_world->birdModelData.birdBody, 0);
+		cpBodySetAngle(the_world->birdModelData.birdBody, -M_PI_2);
+
+		/* Chipmunk API says to reindex after changing the angle */
+		cpSpaceReindexShapesForBody(the_world->mainSpace, the_world->birdModelData.birdBody);
+
+		/* When in a nose dive, texture animation is off. */
+		the_world->birdModelData.isAnimatingSprite = SDL_FALSE;
+	}
+	else
+	{
+		the_world->birdModelData.isAnimatingSprite = SDL_TRUE;
+	}
+	
+	
+	if(the_world->birdModelData.isAnimatingSprite)
+	{
+		the_world->birdModelData.animationDuration = BIRD_FLAP_ANIMATION_DURATION;
+
+		MyFloat linear_interp;
+		Uint32 mod_time = (current_time - the_world->birdModelData.animationStartTime) % the_world->birdModelData.animationDuration;
+		Uint32 texture_index;
+		
+		linear_interp = Flappy_ComputeLinearInterpolation(mod_time, the_world->birdModelData.animationStartTime, the_world->birdModelData.animationStartTime+the_world->birdModelData.animationDuration);
+		texture_index = Flappy_lroundf(linear_interp * (MyFloat)NUMBER_OF_BIRD_FRAMES);
+		if(texture_index >= NUMBER_OF_BIRD_FRAMES)
+		{
+			texture_index = 0;
+		}
+		the_world->birdModelData.currentFrame = texture_index;
+
+	}
+	else
+	{
+		// The middle frame is the one with wings in the neutral position
+		the_world->birdModelData.currentFrame = 1;
+	}
+	
+	
+	if(SDL_TRUE == the_world->birdModelData.isReadyToPlayFallingSound)
+	{
+		Flappy_SendEvent(the_world, FLAPPY_WORLD_EVENT_FALLING);
+		the_world->birdModelData.isReadyToPlayFallingSound = SDL_FALSE;
+		the_world->birdModelData.isFalling = SDL_FALSE;
+	}
+
+	
+	
+//	SDL_Log("current_bird pos:%f\n", the_world->birdModelData.birdBody->p.x);
+}
+
+static void Flappy_UpdateBirdPosition(struct FlappyWorld* the_world, Uint32 delta_time, Uint32 base_time, Uint32 current_time)
+{
+//	if(the_world->birdModelData.isPrelaunch)
+	if((the_world->gameState >= GAMESTATE_TITLE_SCREEN) && (the_world->gameState <= GAMESTATE_FADE_OUT_TITLE_SCREEN))
+	{
+		Flappy_UpdateBirdPositionForPrelaunch(the_world, delta_time, base_time, current_time, SCREEN_WIDTH/2, (SCREEN_HEIGHT/3) + 32);
+	}
+	else if((the_world->gameState >= GAMESTATE_LOADING_NEW_GAME_AND_FADE_IN) && (the_world->gameState <= GAMESTATE_BIRD_PRELAUNCH))
+	{
+		Flappy_UpdateBirdPositionForPrelaunch(the_world, delta_time, base_time, current_time, SCREEN_WIDTH/3, SCREEN_HEIGHT/2);
+	}
+	else
+	{
+		Flappy_UpdateBirdPositionForGame(the_world, delta_time, base_time, current_time);
+
+	}
+}
+
+static Sint32 Flappy_DetermineCurrentBirdTimePosition(struct FlappyWorld* the_world, Uint32 delta_time, Uint32 base_time, Uint32 current_time)
+{
+	if(the_world->birdModelData.isDead)
+	{
+//		return the_world->gameInstanceData.distanceTraveled;
+		return the_world->gameInstanceData.diedAtTime;
+	}
+	else
+	{
+		/*
+		Uint32 diff_time = current_time - base_time;
+		Sint32 current_position;
+		
+		//	the_world->cloudModelData.position.x = Flappy_lroundf((MyFloat)the_world->cloudModelData.position.x + the_world->cloudModelData.velocity.x * (MyFloat)delta_time);
+		current_position = Flappy_lroundf(BIRD_VELOCITY_X * (MyFloat)diff_time);
+		return current_position;
+		 */
+		return current_time;
+	}
+}
+
+
+void InitNewGame(struct FlappyWorld* the_world)
+{
+	Sint32 i;
+	
+	the_world->gameInstanceData.currentScore = 0;
+	
+	the_world->gameInstanceData.distanceTraveled = 0;
+	
+	//	the_world->gameState = GAMESTATE_BIRD_PRELAUNCH;
+	the_world->gameState = GAMESTATE_LOADING_NEW_GAME_AND_FADE_IN;
+	the_world->gameStateCurrentPhaseStartTime = TimeTicker_GetTime(the_world->gameClock);
+	Flappy_SchedulePhaseDeadline(the_world);
+	
+	the_world->birdModelData.isPrelaunch = SDL_TRUE;
+	the_world->birdModelData.isReadyForPipe = SDL_FALSE;
+	the_world->birdModelData.birdLaunchStartTime = 0;
+	
+	the_world->birdModelData.isDead = SDL_FALSE;
+	the_world->birdModelData.isGameOver = SDL_FALSE;
+	the_world->birdModelData.isFalling = SDL_FALSE;
+	the_world->birdModelData.isReadyToPlayFallingSound = SDL_FALSE;
+	the_world->isBirdTouchingGround = SDL_FALSE;
+	
+	// because we change this for the title screen
+	the_world->birdModelData.position.x = SCREEN_WIDTH / 3;
+	the_world->birdModelData.position.y = SCREEN_HEIGHT / 2;
+	
+	if(cpSpaceContainsBody(the_world->mainSpace, the_world->birdModelData.birdBody))
+	{
+		cpSpaceRemoveBody(the_world->mainSpace, the_world->birdModelData.birdBody);
+		cpSpaceRemoveShape(the_world->mainSpace, the_world->birdModelData.birdShape);
+		
+	}
+	
+	cpBodySetVelocity(the_world->birdModelData.birdBody, cpv(0, 0));
+	cpBodySetPosition(the_world->groundPhysicsData.body, cpv(0 + SCREEN_WIDTH/2, GROUND_HEIGHT/2.0));
+	cpBodySetAngularVelocity(the_world->birdModelData.birdBody, 0);
+	cpBodySetAngle(the_world->birdModelData.birdBody, 0);
+	
+	
+	
+	for(i=0; i<FlappyPipeQueue_Size(&the_world->circularQueueOfPipes); i++)
+	{
+		struct PipeModelData* current_pipe = *FlappyPipeQueue_AtIndex(&the_world->circularQueueOfPipes, i);
+		Flappy_ParkPipeBodies(current_pipe);
+		Flappy_ReindexPipeShapes(the_world, current_pipe);
+		
+		FlappyPipeQueue_PushBack(&the_world->queueOfAvailablePipes, current_pipe);
+	}
+	
+	while(FlappyPipeQueue_Size(&the_world->circularQueueOfPipes)>0)
+	{
+		FlappyPipeQueue_PopFront(&the_world->circularQueueOfPipes);
+	}
+	
+	/* The app resets its score display and high score bookkeeping on this. */
+	Flappy_SendEvent(the_world, FLAPPY_WORLD_EVENT_NEW_GAME);
+}
+
+void InitTitleScreen(struct FlappyWorld* the_world)
+{
+	InitNewGame(the_world);
+	the_world->gameState = GAMESTATE_TITLE_SCREEN;
+	the_world->gameStateCurrentPhaseStartTime = TimeTicker_GetTime(the_world->gameClock);
+	Flappy_SchedulePhaseDeadline(the_world);
+	the_world->birdModelData.position.x = SCREEN_WIDTH / 2;
+	the_world->birdModelData.position.y = SCREEN_HEIGHT / 2 + 20;
+
+	
+}
+
+/* Schedules phaseTimer for when the current gameState's phase is over (or cancels it if the state doesn't time out).
+	Call this whenever gameState or its start time changes.
+ */
+static void Flappy_SchedulePhaseDeadline(struct FlappyWorld* the_world)
+{
+	Uint32 the_deadline;
+
+	/* These used to be polled every frame with a mix of > and >= checks.
+		The timer fires once the time is >= the deadline, so the > ones are due 1 ms after the duration.
+	 */
+	switch(the_world->gameState)
+	{
+		case GAMESTATE_FADE_OUT_TITLE_SCREEN:
+		case GAMESTATE_FADE_OUT_GAME_OVER:
+		{
+			the_deadline = the_world->gameStateCurrentPhaseStartTime + FADE_OUT_TIME + 1;
+			break;
+		}
+		case GAMESTATE_LOADING_NEW_GAME_AND_FADE_IN:
+		{
+			the_deadline = the_world->gameStateCurrentPhaseStartTime + FADE_IN_TIME + 1;
+			break;
+		}
+		case GAMESTATE_BIRD_LAUNCHED_BUT_BEFORE_PIPES:
+		{
+			the_deadline = the_world->gameStateCurrentPhaseStartTime + PIPE_START_TIME_DELAY;
+			break;
+		}
+		case GAMESTATE_DEAD_TO_GAME_OVER_TRANSITION:
+		{
+			the_deadline = the_world->gameStateCurrentPhaseStartTime + DELAY_UNTIL_GAME_OVER_SWOOP_START;
+			break;
+		}
+		case GAMESTATE_SWOOPING_IN_GAME_OVER:
+		{
+			the_deadline = the_world->gameOverSweepInStartTime + SWEEP_IN_GAME_OVER_DURATION + SWEEP_IN_GAME_OVER_DELAY_BEFORE_NEXT_STATE + 1;
+			break;
+		}
+		case GAMESTATE_SWOOPING_IN_MEDAL_DISPLAY:
+		{
+			the_deadline = the_world->medalSweepInStartTime + SWEEP_IN_MEDAL_PANEL_DURATION;
+			break;
+		}
+		case GAMESTATE_TALLYING_SCORE:
+		{
+			the_deadline = the_world->gameStateCurrentPhaseStartTime + TALLY_DURATION + 1;
+			break;
+		}
+		default:
+		{
+			/* This state only ends on player input or a collision. */
+			FlappyTimerWheel_Cancel(&the_world->phaseTimerWheel, &the_world->phaseTimer);
+			return;
+		}
+	}
+	the_world->phaseTimerGameState = the_world->gameState;
+	FlappyTimerWheel_Schedule(&the_world->phaseTimerWheel, &the_world->phaseTimer, the_deadline);
+}
+
+static void Flappy_OnPhaseDeadline(struct FlappyTimerWheel* the_wheel, struct FlappyTimer* the_timer, void* user_data)
+{
+	struct FlappyWorld* the_world = (struct FlappyWorld*)user_data;
+
+	/* Something else already moved the game on to a different state. */
+	if(the_world->gameState != the_world->phaseTimerGameState)
+	{
+		return;
+	}
+
+	switch(the_world->gameState)
+	{
+		case GAMESTATE_FADE_OUT_TITLE_SCREEN:
+		{
+			InitNewGame(the_world);
+			break;
+		}
+		case GAMESTATE_LOADING_NEW_GAME_AND_FADE_IN:
+		{
+			the_world->gameState = GAMESTATE_BIRD_PRELAUNCH;
+			the_world->gameStateCurrentPhaseStartTime = TimeTicker_GetTime(the_world->gameClock);
+			break;
+		}
+		case GAMESTATE_BIRD_LAUNCHED_BUT_BEFORE_PIPES:
+		{
+			the_world->gameState = GAMESTATE_MAIN_GAME_ACTIVE;
+			the_world->gameStateCurrentPhaseStartTime = TimeTicker_GetTime(the_world->gameClock);
+			break;
+		}
+		case GAMESTATE_DEAD_TO_GAME_OVER_TRANSITION:
+		{
+			the_world->gameState = GAMESTATE_SWOOPING_IN_GAME_OVER;
+			the_world->gameOverSweepInStartTime = TimeTicker_GetTime(the_world->gameClock);
+			the_world->gameStateCurrentPhaseStartTime = the_world->gameOverSweepInStartTime;
+
+			Flappy_SendEvent(the_world, FLAPPY_WORLD_EVENT_SWOOSH);
+			break;
+		}
+		case GAMESTATE_SWOOPING_IN_GAME_OVER:
+		{
+			the_world->gameState = GAMESTATE_SWOOPING_IN_MEDAL_DISPLAY;
+			Flappy_SendEvent(the_world, FLAPPY_WORLD_EVENT_SWOOSH);
+			the_world->medalSweepInStartTime = TimeTicker_GetTime(the_world->gameClock);
+			break;
+		}
+		case GAMESTATE_SWOOPING_IN_MEDAL_DISPLAY:
+		{
+			the_world->gameState = GAMESTATE_TALLYING_SCORE;
+			the_world->gameStateCurrentPhaseStartTime = TimeTicker_GetTime(the_world->gameClock);
+			break;
+		}
+		case GAMESTATE_TALLYING_SCORE:
+		{
+			the_world->gameState = GAMESTATE_GAME_OVER_WAITING_FOR_USER_ACTION;
+			the_world->gameStateCurrentPhaseStartTime = TimeTicker_GetTime(the_world->gameClock);
+//			Flappy_InitGuiButtons();
+			break;
+		}
+		case GAMESTATE_FADE_OUT_GAME_OVER:
+		{
+			InitNewGame(the_world);
+			break;
+		}
+		default:
+		{
+			break;
+		}
+	}
+	Flappy_SchedulePhaseDeadline(the_world);
+}
+
+static void Flappy_UpdateGameState(struct FlappyWorld* the_world, Uint32 delta_time, Uint32 base_time, Uint32 current_time)
+{
+	/* Only does any work when a phase is actually over. */
+	FlappyTimerWheel_Advance(&the_world->phaseTimerWheel, current_time);
+}
+
+
+void Flappy_Update(struct FlappyWorld* the_world, Uint32 delta_time, Uint32 base_time, Uint32 current_time)
+{
+	Flappy_StepPhysics(the_world, delta_time, base_time, current_time);
+	
+	/* This is either based on time, or the place it crashed */
+	Sint32 current_bird_time_position = Flappy_DetermineCurrentBirdTimePosition(the_world, delta_time, base_time, current_time);
+//	SDL_Log("current_bird_time_position:%d, current_time:%d\n", current_bird_time_position, current_time);
+	
+	Flappy_UpdateGameState(the_world, delta_time, base_time, current_time);
+
+	
+	Flappy_UpdateCloudPositions(the_world, delta_time, base_time, current_bird_time_position);
+	Flappy_UpdateGroundPosition(the_world, delta_time, base_time, current_bird_time_position);
+	Flappy_UpdateBushPositions(the_world, delta_time, base_time, current_bird_time_position);
+	Flappy_UpdateBirdPosition(the_world, delta_time, base_time, current_time);
+	
+	Flappy_UpdatePipePositions(the_world, delta_time, base_time, current_bird_time_position);
+}
+
+double FlappyWorld_GetInterpolationAlpha(struct FlappyWorld* the_world)
+{
+	double the_alpha = ((double)the_world->physicsAccumulator + (double)(TimeTicker_GetTimeNs(the_world->gameClock) % 1000000) / 1000000.0)
+		/ (double)FLAPPY_WORLD_TICK_LENGTH(the_world->tickCount);
+
+	if(the_alpha < 0.0)
+	{
+		return 0.0;
+	}
+	else if(the_alpha > 1.0)
+	{
+		return 1.0;
+	}
+	return the_alpha;
+}
+
+/* Same wrap-around as Flappy_UpdateCloudPositions and friends, just for an in-between time. */
+static Sint32 Flappy_ComputeScrollPosition(struct SceneryModelData* model_data, double scroll_time)
+{
+	Sint32 current_position = Flappy_lroundf(model_data->velocity.x * (MyFloat)scroll_time);
+	Sint32 shift_factor = SDL_abs(current_position) / model_data->size.x;
+	return (model_data->size.x * shift_factor) + current_position;
+}
+
+void FlappyWorld_GetInterpolatedRenderState(struct FlappyWorld* the_world, double alpha, FlappyWorldRenderState* out_render_state)
+{
+	const struct FlappyWorldStepState* previous_state = &the_world->previousStepState;
+	const struct FlappyWorldStepState* current_state = &the_world->currentStepState;
+	double scroll_time = previous_state->scrollTime + (current_state->scrollTime - previous_state->scrollTime) * alpha;
+
+	out_render_state->cloudPositionX = Flappy_ComputeScrollPosition(&the_world->cloudModelData, scroll_time);
+	out_render_state->bushPositionX = Flappy_ComputeScrollPosition(&the_world->bushModelData, scroll_time);
+	out_render_state->groundPositionX = Flappy_ComputeScrollPosition(&the_world->groundModelData, scroll_time);
+	out_render_state->pipeCameraPositionX = -1 * Flappy_lroundf(the_world->pipeTopModelData.velocity.x * (MyFloat)scroll_time);
+
+	if(the_world->gameState <= GAMESTATE_BIRD_PRELAUNCH)
+	{
+		/* Before launch the bobbing is computed from the frame time, not stepped, so it is already smooth. */
+		out_render_state->birdViewPositionY = the_world->birdModelData.position.y;
+		out_render_state->birdAngle = cpBodyGetAngle(the_world->birdModelData.birdBody);
+	}
+	else
+	{
+		cpFloat bird_position_y = previous_state->birdPositionY + (current_state->birdPositionY - previous_state->birdPositionY) * alpha;
+		/* Same as Flappy_UpdateBirdPositionForGame, including keeping the bird from being drawn into the ground
+			and from nose diving past straight down. The step states are captured before it clamps those.
+		 */
+		int radius = cpCircleShapeGetRadius(the_world->birdModelData.birdShape);
+		int ground_threshold = SCREEN_HEIGHT - GROUND_HEIGHT - (2*radius);
+
+		out_render_state->birdViewPositionY = Flappy_InvertY(Flappy_lroundf(bird_position_y) + (the_world->birdModelData.size.y / 2));
+		if(out_render_state->birdViewPositionY > ground_threshold)
+		{
+			out_render_state->birdViewPositionY = ground_threshold;
+		}
+		out_render_state->birdAngle = previous_state->birdAngle + (current_state->birdAngle - previous_state->birdAngle) * alpha;
+		if(out_render_state->birdAngle < -M_PI_2)
+		{
+			out_render_state->birdAngle = -M_PI_2;
+		}
+	}
+}
+
+
+void Flappy_DoFlap(struct FlappyWorld* the_world)
+{
+	if(the_world->gameInstanceData.isPaused)
+	{
+		return;
+	}
+	
+	
+	if(the_world->birdModelData.isPrelaunch)
+	{
+		the_world->birdModelData.isPrelaunch = SDL_FALSE;
+		cpSpaceAddBody(the_world->mainSpace, the_world->birdModelData.birdBody);
+		cpSpaceAddShape(the_world->mainSpace, the_world->birdModelData.birdShape);
+		the_world->birdModelData.birdLaunchStartTime = TimeTicker_GetTime(the_world->gameClock);
+        the_world->gameStateCurrentPhaseStartTime = the_world->birdModelData.birdLaunchStartTime;
+        the_world->gameState = GAMESTATE_BIRD_LAUNCHED_BUT_BEFORE_PIPES;
+        Flappy_SchedulePhaseDeadline(the_world);
+        
+        
+	}
+	if(the_world->birdModelData.isDead)
+	{
+		return;
+	}
+	
+
+	
+	/* In Flappy Bird, when the bird is above the screen,
+		there is some kind of limit imposed so you can't fly up really high.
+		This can be recreated easily by not allowing flaps when the bird is offscreen.
+		We add the size because SDL places y at the top of the sprite, not the bottom.
+		We add a fudge factor because Flappy Bird seems to give some extra space at the top.
+	 */
+	if(the_world->birdModelData.position.y + the_world->birdModelData.size.y + the_world->birdModelData.size.y >= 0)
+	{
+		//	cpBodyApplyImpulse(the_world->birdModelData.birdBody, cpv(0, 10), cpv(0,0));
+		// We only want to use velocity for the y-axis because we are already manually computing x-axis movement.
+		Flappy_SendEvent(the_world, FLAPPY_WORLD_EVENT_FLAPPED);
+//		cpBodySetVelocity((the_world->birdModelData.birdBody, cpv(the_world->birdModelData.velocity.x, 460));
+//		cpBodySetVelocity((the_world->birdModelData.birdBody, cpv(the_world->birdModelData.velocity.x, 460));
+		cpBodySetVelocity(the_world->birdModelData.birdBody, cpv(the_world->birdModelData.velocity.x, FLAPPY_FLAP_VELOCITY_Y));
+		cpBodySetAngle(the_world->birdModelData.birdBody, M_PI_4);
+		cpBodySetAngularVelocity(the_world->birdModelData.birdBody, -2);
+		/* Chipmunk API says to reindex after changing the angle */
+		cpSpaceReindexShapesForBody(the_world->mainSpace, the_world->birdModelData.birdBody);
+	}
+
+}
+
+
+/* The collision handlers are registered with the world as their userData. */
+static cpBool Flappy_OnScorePointCallback(cpArbiter* the_arbiter, cpSpace* the_space, void* user_data)
+{
+	struct FlappyWorld* the_world = (struct FlappyWorld*)user_data;
+
+	the_world->gameInstanceData.currentScore = the_world->gameInstanceData.currentScore + 1;
+	Flappy_SendEvent(the_world, FLAPPY_WORLD_EVENT_SCORED);
+	
+	return cpFalse;
+
+}
+
+
+static cpBool Flappy_OnPipeCollisionCallback(cpArbiter* the_arbiter, cpSpace* the_space, void* user_data)
+{
+	struct FlappyWorld* the_world = (struct FlappyWorld*)user_data;
+	cpShape* a;
+	cpShape* b;
+	int i;
+	
+/*
+	cpContactPointSet set = cpArbiterGetContactPointSet(the_arbiter);
+	//	SDL_Log("set.count: %d", set.count);
+	for(i=0; i<set.count; i++){
+		// get and work with the collision point normal and penetration distance:
+		//		SDL_Log("\np:%f %f",set.points[i].point.x,set.points[i].point.y);
+		//printf("\nn:%f %f",set.points[i].normal.x,set.points[i].normal.y);
+		//set.points[i].dist
+	}
+	
+	cpArbiterGetShapes(the_arbiter, &a, &b);
+	//	SDL_Log("\non player collision a,b %lx %lx", a, b);
+	//	SDL_Log("on player collision s_playerFeet %lx", s_playerFeet);
+*/
+	/*
+//	if( (b == the_world->groundPhysicsData.shape) || (a == the_world->groundPhysicsData.shape) )
+	{
+		SDL_Log("hit ground");
+		
+		ALmixer_PlayChannel(-1, g_gameSounds.crash, 0);
+		//			cpFloat ground_height = (1024/16 * 1.9) * 768 / 1024;
+		//		cpBodySetPosition(the_world->birdModelData.birdBody, cpv(the_world->birdModelData.birdBody->p.x, ground_height + the_world->groundPhysicsData.body->p.y + the_world->birdModelData.size.y/2));
+		//		cpBodySetPosition(the_world->birdModelData.birdBody, cpv(the_world->birdModelData.birdBody->p.x, ground_height + the_world->birdModelData.size.y/2));
+		// TODO: Fix graphics to cap penetration in draw, Chipmunk will correct the penetration by itself eventually
+		
+		return cpTrue;
+	}
+	*/
+//	else
+	
+	// Don't let the bird smack the bottom pipe when falling from the top pipe
+	if(!the_world->birdModelData.isDead)
+	{
+		the_world->gameInstanceData.diedAtTime = TimeTicker_GetTime(the_world->gameClock);
+//		SDL_Log("hit pipe");
+		the_world->birdModelData.isFalling = SDL_TRUE;
+		the_world->birdModelData.isDead = SDL_TRUE;
+		the_world->gameInstanceData.needsWhiteOut = SDL_TRUE;
+		
+		Flappy_SendEvent(the_world, FLAPPY_WORLD_EVENT_CRASHED);
+		return cpFalse;
+		
+	}
+	return cpFalse;
+}
+
+static cpBool Flappy_OnGroundCollisionCallback(cpArbiter* the_arbiter, cpSpace* the_space, void* user_data)
+{
+	struct FlappyWorld* the_world = (struct FlappyWorld*)user_data;
+	cpShape* a;
+	cpShape* b;
+	int i;
+	
+	/*
+	cpContactPointSet set = cpArbiterGetContactPointSet(the_arbiter);
+	//	SDL_Log("set.count: %d", set.count);
+	for(i=0; i<set.count; i++){
+		// get and work with the collision point normal and penetration distance:
+		//		SDL_Log("\np:%f %f",set.points[i].point.x,set.points[i].point.y);
+		//printf("\nn:%f %f",set.points[i].normal.x,set.points[i].normal.y);
+		//set.points[i].dist
+	}
+	
+	cpArbiterGetShapes(the_arbiter, &a, &b);
+	//	SDL_Log("\non player collision a,b %lx %lx", a, b);
+	//	SDL_Log("on player collision s_playerFeet %lx", s_playerFeet);
+	*/
+//	if( (b == the_world->groundPhysicsData.shape) || (a == the_world->groundPhysicsData.shape) )
+	{
+
+//		SDL_Log("hit ground");
+		if(! the_world->birdModelData.isDead)
+		{
+			Flappy_SendEvent(the_world, FLAPPY_WORLD_EVENT_CRASHED);
+			the_world->birdModelData.isDead = SDL_TRUE;
+			the_world->gameInstanceData.needsWhiteOut = SDL_TRUE;
+			the_world->gameInstanceData.diedAtTime = TimeTicker_GetTime(the_world->gameClock);
+		}
+		else
+		{
+//			the_world->birdModelData.isFalling = SDL_FALSE;
+		}
+		the_world->birdModelData.isGameOver = SDL_TRUE;
+
+		the_world->gameState = GAMESTATE_DEAD_TO_GAME_OVER_TRANSITION;
+		the_world->gameStateCurrentPhaseStartTime = TimeTicker_GetTime(the_world->gameClock);
+		Flappy_SchedulePhaseDeadline(the_world);
+//		the_world->medalSweepInStartTime = TimeTicker_GetTime(the_world->gameClock);
+//		the_world->gameOverSweepInStartTime = TimeTicker_GetTime(the_world->gameClock);
+		
+//		ALmixer_PlayChannel(-1, g_gameSounds.swoosh, 0);
+//			cpFloat ground_height = (1024/16 * 1.9) * 768 / 1024;
+//		cpBodySetPosition(the_world->birdModelData.birdBody, cpv(the_world->birdModelData.birdBody->p.x, ground_height + the_world->groundPhysicsData.body->p.y + the_world->birdModelData.size.y/2));
+//		cpBodySetPosition(the_world->birdModelData.birdBody, cpv(the_world->birdModelData.birdBody->p.x, ground_height + the_world->birdModelData.size.y/2));
+		// TODO: Fix graphics to cap penetration in draw, Chipmunk will correct the penetration by itself eventually
+		
+		return cpTrue;
+	}
+	/*
+	else
+	{
+		SDL_Log("hit pipe");
+//		the_world->birdModelData.isFalling = SDL_TRUE;
+		ALmixer_PlayChannel(-1, g_gameSounds.crash, 0);
+		return cpFalse;
+
+	}
+	 */
+	return cpTrue;
+}
+
+
+/* The closest point in the box to the circle's center is the center clamped to the box. */
+static SDL_bool Flappy_IsCircleOverlappingBox(cpVect center, cpFloat radius, cpFloat left, cpFloat bottom, cpFloat right, cpFloat top)
+{
+	cpFloat closest_x = (center.x < left) ? left : ((center.x > right) ? right : center.x);
+	cpFloat closest_y = (center.y < bottom) ? bottom : ((center.y > top) ? top : center.y);
+	cpFloat delta_x = center.x - closest_x;
+	cpFloat delta_y = center.y - closest_y;
+	return (delta_x*delta_x + delta_y*delta_y) < (radius*radius);
+}
+
+/* Chipmunk only calls a begin callback on the step where two shapes start touching.
+	We emulate that by remembering which shapes were touched on the previous step.
+ */
+static void Flappy_UpdateNativePipeContact(struct FlappyWorld* the_world, struct PipeModelData* the_pipe, Uint32 which_shape, SDL_bool is_touching, cpCollisionBeginFunc begin_callback)
+{
+	if(is_touching)
+	{
+		if(0 == (the_pipe->nativeContactFlags & which_shape))
+		{
+			the_pipe->nativeContactFlags |= which_shape;
+			begin_callback(NULL, the_world->mainSpace, the_world);
+		}
+	}
+	else
+	{
+		the_pipe->nativeContactFlags &= ~which_shape;
+	}
+}
+
+/* A replacement for cpSpaceStep for this game's one and only moving body:
+	a circle against static boxes (pipes, score sensors, ground).
+	The shape sizes and positions mirror what Flappy_InitializePipeModelData, Flappy_UpdatePipePositions
+	and InitPhysics give Chipmunk, but come straight from the PipeModelData.
+ */
+/* The score sensor sticks out past the pipe, so once the bird is past it, it is past the pipe too. */
+#define NATIVE_SCORE_SENSOR_RIGHT_EDGE ((PIPE_WIDTH/4) + (PIPE_PHYSICS_WIDTH/4.0))
+
+struct PipeModelData* FlappyWorld_FindNextPipe(struct FlappyWorld* the_world, cpFloat position_x)
+{
+	cpFloat radius = cpCircleShapeGetRadius(the_world->birdModelData.birdShape);
+	Sint32 i;
+
+	for(i=0; i<FlappyPipeQueue_Size(&the_world->circularQueueOfPipes); i++)
+	{
+		struct PipeModelData* current_pipe = *FlappyPipeQueue_AtIndex(&the_world->circularQueueOfPipes, i);
+		if(((cpFloat)current_pipe->realPositionX + NATIVE_SCORE_SENSOR_RIGHT_EDGE + radius) >= position_x)
+		{
+			return current_pipe;
+		}
+	}
+	return NULL;
+}
+
+void FlappyWorld_SetPresteppedBird(struct FlappyWorld* the_world, const FlappyWorldBirdStep* the_step)
+{
+	the_world->presteppedBird = *the_step;
+	the_world->hasPresteppedBird = SDL_TRUE;
+}
+
+/* Flappy_StepNativePhysics for a bird that has already been moved (by FlappyBirdSoA).
+	Only the callbacks and the contact bookkeeping are left to do.
+ */
+static void Flappy_ApplyPresteppedBird(struct FlappyWorld* the_world, cpFloat fixed_dt)
+{
+	const FlappyWorldBirdStep* the_step = &the_world->presteppedBird;
+	cpBody* bird_body = the_world->birdModelData.birdBody;
+	cpVect position = cpBodyGetPosition(bird_body);
+	cpVect velocity = cpBodyGetVelocity(bird_body);
+	/* Looked up before moving, the same as FlappyBirdSoA_LoadFromWorld did. */
+	struct PipeModelData* next_pipe = FlappyWorld_FindNextPipe(the_world, position.x);
+
+	the_world->hasPresteppedBird = SDL_FALSE;
+
+	position.x = position.x + velocity.x * fixed_dt;
+	position.y = the_step->positionY;
+	velocity.y = the_step->velocityY;
+
+	if(NULL != next_pipe)
+	{
+		Flappy_UpdateNativePipeContact(the_world, next_pipe, NATIVE_CONTACT_UPPER_PIPE | NATIVE_CONTACT_LOWER_PIPE, the_step->isTouchingPipe, Flappy_OnPipeCollisionCallback);
+		Flappy_UpdateNativePipeContact(the_world, next_pipe, NATIVE_CONTACT_SCORE_SENSOR, the_step->isInScoreSensor, Flappy_OnScorePointCallback);
+	}
+	if(the_step->isTouchingGround && ! the_world->isBirdTouchingGround)
+	{
+		Flappy_OnGroundCollisionCallback(NULL, the_world->mainSpace, the_world);
+	}
+	the_world->isBirdTouchingGround = the_step->isTouchingGround;
+
+	cpBodySetPosition(bird_body, position);
+	cpBodySetVelocity(bird_body, velocity);
+	cpBodySetAngle(bird_body, the_step->angle);
+	cpBodySetAngularVelocity(bird_body, the_step->angularVelocity);
+}
+
+static void Flappy_StepNativePhysics(struct FlappyWorld* the_world, cpFloat fixed_dt)
+{
+	cpBody* bird_body = the_world->birdModelData.birdBody;
+	cpFloat radius = cpCircleShapeGetRadius(the_world->birdModelData.birdShape);
+	cpFloat pipe_half_width = PIPE_PHYSICS_WIDTH / 2.0;
+	cpFloat sensor_half_width = PIPE_PHYSICS_WIDTH / 4.0;
+	cpVect position;
+	cpVect velocity;
+	cpFloat angle;
+	SDL_bool is_touching_ground;
+	Sint32 i;
+
+	/* Before the first flap the bird isn't in the space, so Chipmunk wouldn't move it either. */
+	if( ! cpSpaceContainsBody(the_world->mainSpace, bird_body))
+	{
+		the_world->hasPresteppedBird = SDL_FALSE;
+		return;
+	}
+	if(the_world->hasPresteppedBird)
+	{
+		Flappy_ApplyPresteppedBird(the_world, fixed_dt);
+		return;
+	}
+
+	position = cpBodyGetPosition(bird_body);
+	velocity = cpBodyGetVelocity(bird_body);
+	angle = cpBodyGetAngle(bird_body);
+
+	/* Same order as cpSpaceStep: move with the old velocity, then collide, then apply gravity, then resolve contacts. */
+	position = cpvadd(position, cpvmult(velocity, fixed_dt));
+	angle = angle + cpBodyGetAngularVelocity(bird_body) * fixed_dt;
+
+	/* Only the pipe(s) around the bird can possibly be touched. */
+	for(i=0; i<FlappyPipeQueue_Size(&the_world->circularQueueOfPipes); i++)
+	{
+		struct PipeModelData* current_pipe = *FlappyPipeQueue_AtIndex(&the_world->circularQueueOfPipes, i);
+		cpFloat pipe_x = (cpFloat)current_pipe->realPositionX;
+		cpFloat sensor_x = (cpFloat)(current_pipe->realPositionX + PIPE_WIDTH/4);
+		cpFloat lower_pipe_top = (cpFloat)(current_pipe->lowerRealPositionY + current_pipe->pipeHeight);
+		cpFloat upper_pipe_bottom = (cpFloat)current_pipe->upperRealPositionY;
+
+		if((pipe_x + (PIPE_DISTANCE/2)) < position.x)
+		{
+			/* Already behind us. */
+			current_pipe->nativeContactFlags = 0;
+			continue;
+		}
+		if((pipe_x - (PIPE_DISTANCE/2)) > position.x)
+		{
+			/* The queue is in x order, so everything from here on is too far ahead. */
+			break;
+		}
+
+		Flappy_UpdateNativePipeContact(the_world, current_pipe, NATIVE_CONTACT_UPPER_PIPE,
+			Flappy_IsCircleOverlappingBox(position, radius, pipe_x - pipe_half_width, upper_pipe_bottom, pipe_x + pipe_half_width, upper_pipe_bottom + SCREEN_HEIGHT),
+			Flappy_OnPipeCollisionCallback
+		);
+		Flappy_UpdateNativePipeContact(the_world, current_pipe, NATIVE_CONTACT_LOWER_PIPE,
+			Flappy_IsCircleOverlappingBox(position, radius, pipe_x - pipe_half_width, lower_pipe_top - SCREEN_HEIGHT, pipe_x + pipe_half_width, lower_pipe_top),
+			Flappy_OnPipeCollisionCallback
+		);
+		Flappy_UpdateNativePipeContact(the_world, current_pipe, NATIVE_CONTACT_SCORE_SENSOR,
+			Flappy_IsCircleOverlappingBox(position, radius, sensor_x - sensor_half_width, 0.0, sensor_x + sensor_half_width, SCREEN_HEIGHT),
+			Flappy_OnScorePointCallback
+		);
+	}
+
+	/* The ground box follows the bird along x, so only its top matters. */
+	is_touching_ground = (position.y - radius) < GROUND_HEIGHT;
+	if(is_touching_ground && ! the_world->isBirdTouchingGround)
+	{
+		Flappy_OnGroundCollisionCallback(NULL, the_world->mainSpace, the_world);
+	}
+	the_world->isBirdTouchingGround = is_touching_ground;
+
+	velocity = cpvadd(velocity, cpvmult(cpv(0, FLAPPY_GRAVITY_Y), fixed_dt));
+
+	/* The ground is the only solid contact (the pipe callbacks reject theirs).
+		Instead of Chipmunk's iterative solver, just stop the bird on top of it.
+	 */
+	if(is_touching_ground)
+	{
+		position.y = GROUND_HEIGHT + radius;
+		if(velocity.y < 0)
+		{
+			velocity.y = 0;
+		}
+	}
+
+	cpBodySetPosition(bird_body, position);
+	cpBodySetVelocity(bird_body, velocity);
+	cpBodySetAngle(bird_body, angle);
+}
+
+static void InitPhysics(struct FlappyWorld* the_world)
+{
+	cpFloat mass = 10.0f;
+	cpFloat moment;
+	Sint32 i;
+//	cpFloat ground_height = (1024/16 * 1.9) * 768 / 1024;
+
+	
+	the_world->mainSpace = cpSpaceNew();
+	cpSpaceSetIterations(the_world->mainSpace, 30);
+//	cpSpaceSetGravity(the_world->mainSpace, cpv(0, -1300));
+	cpSpaceSetGravity(the_world->mainSpace, cpv(0, FLAPPY_GRAVITY_Y));
+//	cpSpaceSetGravity(the_world->mainSpace, cpv(0, -1500));
+	//	cpSpaceSetGravity(s_mainSpace, cpv(0, -10));
+	//	cpSpaceSetGravity(s_mainSpace, cpv(0, 0));
+	cpSpaceSetSleepTimeThreshold(the_world->mainSpace, 0.5);
+	cpSpaceSetCollisionSlop(the_world->mainSpace, 0.5);
+	
+	
+	
+
+	moment = cpMomentForBox(mass, the_world->birdModelData.size.x, the_world->birdModelData.size.y);
+	the_world->birdModelData.birdBody = cpBodyNew(mass, moment);
+//	cpSpaceAddBody(the_world->mainSpace, the_world->birdModelData.birdBody);
+	
+//	cpBodySetPosition(the_world->birdModelData.birdBody, cpv( ((the_world->birdModelData.position.x + the_world->birdModelData.size.x) / 2.0f),
+	cpBodySetPosition(the_world->birdModelData.birdBody, cpv( the_world->birdModelData.position.x,
+											   Flappy_InvertY(
+															  Flappy_lroundf(the_world->birdModelData.position.y + (the_world->birdModelData.size.y / 2))
+															  ))
+				 );
+	
+	// We only want to use velocity for the y-axis because we are already manually computing x-axis movement.
+	cpBodySetVelocity(the_world->birdModelData.birdBody, cpv(0, 0));
+
+	
+//	the_world->birdModelData.birdShape = cpBoxShapeNew(the_world->birdModelData.birdBody, the_world->birdModelData.size.x, the_world->birdModelData.size.y);
+	the_world->birdModelData.birdShape = cpCircleShapeNew(the_world->birdModelData.birdBody, the_world->birdModelData.size.y/2, cpvzero);
+	cpShapeSetCollisionType(the_world->birdModelData.birdShape, BIRD_COLLISION_TYPE);
+//	cpSpaceAddShape(the_world->mainSpace, the_world->birdModelData.birdShape);
+//	cpShapeSetElasticity(the_world->birdModelData.birdShape, 0.0);
+//	cpShapeSetFriction(the_world->birdModelData.birdShape, 1000.0);
+	
+	
+	//the_world->groundPhysicsData.body = cpBodyNew(INFINITY, INFINITY);
+	the_world->groundPhysicsData.body = cpBodyNewStatic();
+	cpBodySetPosition(the_world->groundPhysicsData.body, cpv(0 + SCREEN_WIDTH/2, GROUND_HEIGHT/2.0));
+//	cpBodySetPosition(the_world->groundPhysicsData.body, cpv(0 + SCREEN_WIDTH/2, GROUND_HEIGHT));
+	
+//	cpBodySetVelocity((the_world->groundPhysicsData.body, cpv(BIRD_VELOCITY_X, 0));
+
+	
+	// size is somewhat arbitrary
+	// measured 1.9 cm for ground on iPad mini for 1024 pixels
+//	the_world->groundPhysicsData.shape = cpBoxShapeNew(the_world->groundPhysicsData.body, SCREEN_WIDTH, GROUND_HEIGHT);
+	the_world->groundPhysicsData.shape = cpBoxShapeNew(the_world->groundPhysicsData.body, SCREEN_WIDTH, GROUND_HEIGHT, 0.0);
+//	cpShapeSetElasticity(the_world->groundPhysicsData.shape, 0.0);
+//	cpShapeSetFriction(the_world->groundPhysicsData.shape, 1000.0);
+	cpShapeSetCollisionType(the_world->groundPhysicsData.shape, GROUND_COLLISION_TYPE);
+
+	// don't add body to space to make it a "rogue" body (intended to be controlled manually). But still must add shape to space.
+	cpSpaceAddShape(the_world->mainSpace, the_world->groundPhysicsData.shape);
+
+	/* Same for the pipes, which stay in the space for good (parked when they aren't in use, see Flappy_ParkPipeBodies). */
+	for(i=0; i<MAX_NUM_PIPES; i++)
+	{
+		struct PipeModelData* current_pipe = &the_world->arrayOfPipes[i];
+		Flappy_ParkPipeBodies(current_pipe);
+		cpSpaceAddShape(the_world->mainSpace, current_pipe->upperPhysicsShape);
+		cpSpaceAddShape(the_world->mainSpace, current_pipe->lowerPhysicsShape);
+		cpSpaceAddShape(the_world->mainSpace, current_pipe->scoreSensorPhysicsShape);
+	}
+
+	//cpShapeSetFriction(the_world->groundPhysicsData.shape, INFINITY);
+//	cpShapeSetFriction(the_world->groundPhysicsData.shape, 100000);
+
+	
+//	collisionBird = new cpSpaceAddCollisionHandlerContainer();
+//	cpSpaceAddCollisionHandler(space, 0, 0, startCollision, null, null, endCollision, collisionBird);
+	
+	{
+		cpCollisionHandler* collision_handler = cpSpaceAddCollisionHandler(the_world->mainSpace, BIRD_COLLISION_TYPE, GROUND_COLLISION_TYPE);
+		collision_handler->beginFunc = Flappy_OnGroundCollisionCallback;
+		collision_handler->userData = the_world;
+	}
+	{
+		cpCollisionHandler* collision_handler = cpSpaceAddCollisionHandler(the_world->mainSpace, BIRD_COLLISION_TYPE, PIPE_COLLISION_TYPE);
+		collision_handler->beginFunc = Flappy_OnPipeCollisionCallback;
+		collision_handler->userData = the_world;
+	}
+	{
+		cpCollisionHandler* collision_handler = cpSpaceAddCollisionHandler(the_world->mainSpace, BIRD_COLLISION_TYPE, SCORE_SENSOR_TYPE);
+		collision_handler->beginFunc = Flappy_OnScorePointCallback;
+		collision_handler->userData = the_world;
+	}
+
+
+}
+
+
+void Flappy_DoPrimaryAction(struct FlappyWorld* the_world)
+{
+	/* Every input goes through here (including the taps that start a game), so this is all a replay needs.
+		It is recorded against the physics step it comes before, which is the FlappyWorld_StepTick that replays it.
+	 */
+	if(NULL != the_world->replayRecorder)
+	{
+		FlappyReplay_RecordAction(the_world->replayRecorder, the_world->tickCount + 1);
+	}
+    if((the_world->gameState >= GAMESTATE_BIRD_PRELAUNCH) && (the_world->gameState <= GAMESTATE_MAIN_GAME_ACTIVE))
+    {
+        Flappy_DoFlap(the_world);
+    }
+    else if(GAMESTATE_GAME_OVER_WAITING_FOR_USER_ACTION == the_world->gameState)
+    {
+//        InitNewGame(the_world);
+		Flappy_SendEvent(the_world, FLAPPY_WORLD_EVENT_SWOOSH);
+		the_world->gameState = GAMESTATE_FADE_OUT_GAME_OVER;
+		the_world->gameStateCurrentPhaseStartTime = TimeTicker_GetTime(the_world->gameClock);
+		Flappy_SchedulePhaseDeadline(the_world);
+    }
+	else if(GAMESTATE_TITLE_SCREEN == the_world->gameState)
+	{
+		Flappy_SendEvent(the_world, FLAPPY_WORLD_EVENT_SWOOSH);
+		the_world->gameState = GAMESTATE_FADE_OUT_TITLE_SCREEN;
+		the_world->gameStateCurrentPhaseStartTime = TimeTicker_GetTime(the_world->gameClock);
+		Flappy_SchedulePhaseDeadline(the_world);
+	}
+    /*
+        
+	if(the_world->birdModelData.isGameOver)
+	{
+		InitNewGame(the_world);
+	}
+	else
+	{
+	}
+     */
+}
+
+/* PCG32 (XSH RR, see pcg-random.org) with the reference default stream.
+	It is only 64-bit integer math, so a seed gives the same numbers everywhere.
+*/
+#define FLAPPY_RANDOM_MULTIPLIER 6364136223846793005ULL
+#define FLAPPY_RANDOM_INCREMENT 1442695040888963407ULL
+
+static Uint32 FlappyWorld_RandomNext(struct FlappyWorld* the_world)
+{
+	Uint64 old_state = the_world->randomState;
+	Uint32 xor_shifted = (Uint32)(((old_state >> 18) ^ old_state) >> 27);
+	Uint32 rotation = (Uint32)(old_state >> 59);
+	the_world->randomState = (old_state * FLAPPY_RANDOM_MULTIPLIER) + FLAPPY_RANDOM_INCREMENT;
+	return (xor_shifted >> rotation) | (xor_shifted << ((0u - rotation) & 31));
+}
+
+void FlappyWorld_SetSeed(struct FlappyWorld* the_world, Uint64 random_seed)
+{
+	/* Same as the reference pcg32_srandom_r, so nearby seeds still give unrelated sequences. */
+	the_world->randomSeed = random_seed;
+	the_world->randomState = 0;
+	FlappyWorld_RandomNext(the_world);
+	the_world->randomState += random_seed;
+	FlappyWorld_RandomNext(the_world);
+}
+
+Uint32 FlappyWorld_RandomRange(struct FlappyWorld* the_world, Uint32 min_value, Uint32 max_value)
+{
+	/* Lemire's multiply-shift with rejection, so every value in the range is equally likely. */
+	Uint32 range_size = max_value - min_value + 1;
+	Uint64 the_product;
+	Uint32 low_bits;
+
+	if(0 == range_size)
+	{
+		/* The whole 32-bit range. */
+		return FlappyWorld_RandomNext(the_world);
+	}
+	the_product = (Uint64)FlappyWorld_RandomNext(the_world) * range_size;
+	low_bits = (Uint32)the_product;
+	if(low_bits < range_size)
+	{
+		Uint32 threshold = (0u - range_size) % range_size;
+		while(low_bits < threshold)
+		{
+			the_product = (Uint64)FlappyWorld_RandomNext(the_world) * range_size;
+			low_bits = (Uint32)the_product;
+		}
+	}
+	return min_value + (Uint32)(the_product >> 32);
+}
+
+struct FlappyWorld* FlappyWorld_Create(Uint64 random_seed)
+{
+	void* world_allocation;
+	struct FlappyWorld* the_world = (struct FlappyWorld*)Flappy_AllocateCacheAligned(sizeof(struct FlappyWorld), &world_allocation);
+	if(NULL == the_world)
+	{
+		return NULL;
+	}
+	the_world->worldAllocation = world_allocation;
+
+	/* The ticker starts out stopped and virtual, so tick-mode owners (headless, batches, env pools) never touch the wall clock.
+		The real-time loop turns off virtual mode before starting it.
+	 */
+	the_world->gameClock = TimeTicker_CreateHighResolution();
+	TimeTicker_SetVirtual(the_world->gameClock, SDL_TRUE);
+	the_world->stepBaseTime = TimeTicker_GetTime(the_world->gameClock);
+	FlappyTimerWheel_Init(&the_world->phaseTimerWheel, the_world->stepBaseTime);
+	FlappyTimer_Init(&the_world->phaseTimer, Flappy_OnPhaseDeadline, the_world);
+	FlappyWorld_SetSeed(the_world, random_seed);
+
+	Flappy_InitializeCloudModelData(the_world);
+	Flappy_InitializeBirdModelData(the_world);
+	Flappy_InitializeGroundModelData(the_world);
+	Flappy_InitializeBushModelData(the_world);
+	Flappy_InitializePipeModelData(the_world);
+
+	InitPhysics(the_world);
+
+	/* Nothing has stepped yet, so both sides of the "last step" are where we are now. */
+	Flappy_CaptureStepState(the_world, &the_world->currentStepState, the_world->stepBaseTime, the_world->stepBaseTime);
+	the_world->previousStepState = the_world->currentStepState;
+
+	return the_world;
+}
+
+void FlappyWorld_Free(struct FlappyWorld* the_world)
+{
+	Sint32 i;
+
+	if(NULL == the_world)
+	{
+		return;
+	}
+
+	/* cpSpaceFree does not free the bodies and shapes, and some of ours are never in the space anyway. */
+	cpSpaceFree(the_world->mainSpace);
+
+	for(i=0; i<MAX_NUM_PIPES; i++)
+	{
+		struct PipeModelData* current_pipe = &the_world->arrayOfPipes[i];
+		cpShapeFree(current_pipe->upperPhysicsShape);
+		cpBodyFree(current_pipe->upperPhysicsBody);
+		cpShapeFree(current_pipe->lowerPhysicsShape);
+		cpBodyFree(current_pipe->lowerPhysicsBody);
+		cpShapeFree(current_pipe->scoreSensorPhysicsShape);
+		cpBodyFree(current_pipe->scoreSensorPhysicsBody);
+	}
+	cpShapeFree(the_world->groundPhysicsData.shape);
+	cpBodyFree(the_world->groundPhysicsData.body);
+	cpShapeFree(the_world->birdModelData.birdShape);
+	cpBodyFree(the_world->birdModelData.birdBody);
+
+	FlappyPipeQueue_Destroy(&the_world->queueOfAvailablePipes);
+	FlappyPipeQueue_Destroy(&the_world->circularQueueOfPipes);
+	SDL_free(the_world->pipeAllocation);
+
+	TimeTicker_Free(the_world->gameClock);
+	SDL_free(the_world->worldAllocation);
+}
+
+void FlappyWorld_SetPhysicsBackend(struct FlappyWorld* the_world, int which_backend)
+{
+	Sint32 i;
+	the_world->physicsBackend = which_backend;
+	/* Start out with no remembered contacts so the first native step reports everything it touches. */
+	the_world->isBirdTouchingGround = SDL_FALSE;
+	for(i=0; i<MAX_NUM_PIPES; i++)
+	{
+		the_world->arrayOfPipes[i].nativeContactFlags = 0;
+	}
+}
+
+void FlappyWorld_StepTick(struct FlappyWorld* the_world, SDL_bool do_primary_action)
+{
+	FlappyWorld_BeginTick(the_world, do_primary_action);
+	FlappyWorld_FinishTick(the_world);
+}
+
+void FlappyWorld_BeginTick(struct FlappyWorld* the_world, SDL_bool do_primary_action)
+{
+	Uint32 current_time = the_world->stepBaseTime + FLAPPY_WORLD_TICK_TIME((Uint64)the_world->tickCount + 1);
+
+	/* Everything in the world that reads gameClock (phase start times, death time, etc.) sees the tick time too.
+		The tick count itself goes up with the physics step in FlappyWorld_FinishTick.
+	 */
+	TimeTicker_SetTime(the_world->gameClock, current_time);
+	if(do_primary_action)
+	{
+		Flappy_DoPrimaryAction(the_world);
+	}
+}
+
+void FlappyWorld_FinishTick(struct FlappyWorld* the_world)
+{
+	Uint32 current_time = the_world->stepBaseTime + FLAPPY_WORLD_TICK_TIME((Uint64)the_world->tickCount + 1);
+	Flappy_Update(the_world, FLAPPY_WORLD_TICK_LENGTH(the_world->tickCount), the_world->stepBaseTime, current_time);
+	/* Phases that don't run physics never consume it, so don't let it leak into a later tick. */
+	the_world->hasPresteppedBird = SDL_FALSE;
+}
+
+Uint32 FlappyWorld_GetTickCount(struct FlappyWorld* the_world)
+{
+	return the_world->tickCount;
+}
+
+void FlappyWorld_WriteObservation(struct FlappyWorld* the_world, float* out_observation)
+{
+	cpBody* bird_body = the_world->birdModelData.birdBody;
+	cpVect position = cpBodyGetPosition(bird_body);
+	cpVect velocity = cpBodyGetVelocity(bird_body);
+	Sint32 number_of_pipes = FlappyPipeQueue_Size(&the_world->circularQueueOfPipes);
+	Sint32 number_found = 0;
+	Sint32 i;
+
+	out_observation[FLAPPY_OBSERVATION_BIRD_Y] = (float)position.y;
+	out_observation[FLAPPY_OBSERVATION_BIRD_VELOCITY_Y] = (float)velocity.y;
+	out_observation[FLAPPY_OBSERVATION_BIRD_ANGLE] = (float)cpBodyGetAngle(bird_body);
+	out_observation[FLAPPY_OBSERVATION_NEXT_PIPE_DISTANCE] = (float)SCREEN_WIDTH;
+	out_observation[FLAPPY_OBSERVATION_NEXT_PIPE_GAP_TOP] = (float)SCREEN_HEIGHT;
+	out_observation[FLAPPY_OBSERVATION_NEXT_PIPE_GAP_BOTTOM] = (float)GROUND_HEIGHT;
+	out_observation[FLAPPY_OBSERVATION_SECOND_PIPE_GAP_TOP] = (float)SCREEN_HEIGHT;
+	out_observation[FLAPPY_OBSERVATION_SECOND_PIPE_GAP_BOTTOM] = (float)GROUND_HEIGHT;
+	out_observation[FLAPPY_OBSERVATION_IS_ALIVE] = the_world->birdModelData.isDead ? 0.0f : 1.0f;
+
+	/* The queue is in x order, so the first pipe whose trailing edge is still ahead of the bird is the next one. */
+	for(i=0; (i<number_of_pipes) && (number_found < 2); i++)
+	{
+		struct PipeModelData* current_pipe = *FlappyPipeQueue_AtIndex(&the_world->circularQueueOfPipes, i);
+		cpFloat pipe_x = (cpFloat)current_pipe->realPositionX;
+		if((pipe_x + (PIPE_PHYSICS_WIDTH/2)) < position.x)
+		{
+			continue;
+		}
+		if(0 == number_found)
+		{
+			out_observation[FLAPPY_OBSERVATION_NEXT_PIPE_DISTANCE] = (float)(pipe_x - position.x);
+			out_observation[FLAPPY_OBSERVATION_NEXT_PIPE_GAP_TOP] = (float)current_pipe->upperRealPositionY;
+			out_observation[FLAPPY_OBSERVATION_NEXT_PIPE_GAP_BOTTOM] = (float)(current_pipe->lowerRealPositionY + current_pipe->pipeHeight);
+		}
+		else
+		{
+			out_observation[FLAPPY_OBSERVATION_SECOND_PIPE_GAP_TOP] = (float)current_pipe->upperRealPositionY;
+			out_observation[FLAPPY_OBSERVATION_SECOND_PIPE_GAP_BOTTOM] = (float)(current_pipe->lowerRealPositionY + current_pipe->pipeHeight);
+		}
+		number_found++;
+	}
+}
+
+void FlappyWorld_WriteObservations(struct FlappyWorld* const* the_worlds, Uint32 number_of_worlds, float* out_observations)
+{
+	Uint32 i;
+	for(i=0; i<number_of_worlds; i++)
+	{
+		FlappyWorld_WriteObservation(the_worlds[i], out_observations + (size_t)i * FLAPPY_OBSERVATION_SIZE);
+	}
+}
+
+void FlappyWorld_Snapshot(struct FlappyWorld* the_world, FlappyWorldSnapshot* out_snapshot)
+{
+	cpBody* bird_body = the_world->birdModelData.birdBody;
+	Uint32 number_of_active_pipes = FlappyPipeQueue_Size(&the_world->circularQueueOfPipes);
+	Uint32 number_of_available_pipes = FlappyPipeQueue_Size(&the_world->queueOfAvailablePipes);
+	Uint32 i;
+
+	out_snapshot->bird.size = the_world->birdModelData.size;
+	out_snapshot->bird.position = the_world->birdModelData.position;
+	out_snapshot->bird.velocity = the_world->birdModelData.velocity;
+	out_snapshot->bird.isFalling = the_world->birdModelData.isFalling;
+	out_snapshot->bird.isReadyToPlayFallingSound = the_world->birdModelData.isReadyToPlayFallingSound;
+	out_snapshot->bird.isDead = the_world->birdModelData.isDead;
+	out_snapshot->bird.isGameOver = the_world->birdModelData.isGameOver;
+	out_snapshot->bird.isPrelaunch = the_world->birdModelData.isPrelaunch;
+	out_snapshot->bird.birdLaunchStartTime = the_world->birdModelData.birdLaunchStartTime;
+	out_snapshot->bird.isReadyForPipe = the_world->birdModelData.isReadyForPipe;
+	out_snapshot->bird.currentFrame = the_world->birdModelData.currentFrame;
+	out_snapshot->bird.animationStartTime = the_world->birdModelData.animationStartTime;
+	out_snapshot->bird.animationDuration = the_world->birdModelData.animationDuration;
+	out_snapshot->bird.isAnimatingSprite = the_world->birdModelData.isAnimatingSprite;
+	out_snapshot->birdBodyPosition = cpBodyGetPosition(bird_body);
+	out_snapshot->birdBodyVelocity = cpBodyGetVelocity(bird_body);
+	out_snapshot->birdBodyAngle = cpBodyGetAngle(bird_body);
+	out_snapshot->birdBodyAngularVelocity = cpBodyGetAngularVelocity(bird_body);
+	out_snapshot->isBirdInSpace = cpSpaceContainsBody(the_world->mainSpace, bird_body) ? SDL_TRUE : SDL_FALSE;
+	out_snapshot->groundBodyPosition = cpBodyGetPosition(the_world->groundPhysicsData.body);
+	out_snapshot->groundPosition = the_world->groundPhysicsData.position;
+
+	out_snapshot->gameInstanceData = the_world->gameInstanceData;
+	out_snapshot->gameState = the_world->gameState;
+	out_snapshot->gameStateCurrentPhaseStartTime = the_world->gameStateCurrentPhaseStartTime;
+	out_snapshot->gameOverSweepInStartTime = the_world->gameOverSweepInStartTime;
+	out_snapshot->medalSweepInStartTime = the_world->medalSweepInStartTime;
+
+	out_snapshot->gameClockTimeNs = TimeTicker_GetTimeNs(the_world->gameClock);
+	out_snapshot->physicsAccumulator = the_world->physicsAccumulator;
+	out_snapshot->stepBaseTime = the_world->stepBaseTime;
+	out_snapshot->tickCount = the_world->tickCount;
+	out_snapshot->randomSeed = the_world->randomSeed;
+	out_snapshot->randomState = the_world->randomState;
+	out_snapshot->isBirdTouchingGround = the_world->isBirdTouchingGround;
+
+	out_snapshot->cloudModelData = the_world->cloudModelData;
+	out_snapshot->groundModelData = the_world->groundModelData;
+	out_snapshot->bushModelData = the_world->bushModelData;
+	out_snapshot->pipeTopModelData = the_world->pipeTopModelData;
+	out_snapshot->pipeBottomModelData = the_world->pipeBottomModelData;
+	out_snapshot->playerModelData = the_world->playerModelData;
+
+	/* Pipes are saved by their index in arrayOfPipes, active ones first in queue order, then the available ones in queue order. */
+	out_snapshot->numberOfActivePipes = number_of_active_pipes;
+	for(i=0; i<number_of_active_pipes; i++)
+	{
+		struct PipeModelData* current_pipe = *FlappyPipeQueue_AtIndex(&the_world->circularQueueOfPipes, i);
+		FlappyWorldSnapshotPipe* saved_pipe = &out_snapshot->activePipes[i];
+		out_snapshot->pipeOrder[i] = (Uint8)(current_pipe - the_world->arrayOfPipes);
+		saved_pipe->intervalScalar = current_pipe->intervalScalar;
+		saved_pipe->viewPositionX = current_pipe->viewPositionX;
+		saved_pipe->realPositionX = current_pipe->realPositionX;
+		saved_pipe->upperViewPositionY = current_pipe->upperViewPositionY;
+		saved_pipe->upperRealPositionY = current_pipe->upperRealPositionY;
+		saved_pipe->lowerViewPositionY = current_pipe->lowerViewPositionY;
+		saved_pipe->lowerRealPositionY = current_pipe->lowerRealPositionY;
+		saved_pipe->pipeHeight = current_pipe->pipeHeight;
+		saved_pipe->size = current_pipe->size;
+		saved_pipe->nativeContactFlags = current_pipe->nativeContactFlags;
+	}
+	for(i=0; i<number_of_available_pipes; i++)
+	{
+		struct PipeModelData* current_pipe = *FlappyPipeQueue_AtIndex(&the_world->queueOfAvailablePipes, i);
+		out_snapshot->pipeOrder[number_of_active_pipes + i] = (Uint8)(current_pipe - the_world->arrayOfPipes);
+	}
+}
+
+void FlappyWorld_Restore(struct FlappyWorld* the_world, const FlappyWorldSnapshot* the_snapshot)
+{
+	cpBody* bird_body = the_world->birdModelData.birdBody;
+	cpShape* bird_shape = the_world->birdModelData.birdShape;
+	SDL_bool is_bird_in_space = cpSpaceContainsBody(the_world->mainSpace, bird_body) ? SDL_TRUE : SDL_FALSE;
+	Uint32 i;
+
+	/* Every pipe's shapes stay in the space, so only the bodies move below and the space is reindexed once at the end. */
+	while(FlappyPipeQueue_Size(&the_world->circularQueueOfPipes) > 0)
+	{
+		FlappyPipeQueue_PopFront(&the_world->circularQueueOfPipes);
+	}
+	while(FlappyPipeQueue_Size(&the_world->queueOfAvailablePipes) > 0)
+	{
+		FlappyPipeQueue_PopFront(&the_world->queueOfAvailablePipes);
+	}
+
+	for(i=0; i<MAX_NUM_PIPES; i++)
+	{
+		struct PipeModelData* current_pipe = &the_world->arrayOfPipes[the_snapshot->pipeOrder[i]];
+		if(i < the_snapshot->numberOfActivePipes)
+		{
+			const FlappyWorldSnapshotPipe* saved_pipe = &the_snapshot->activePipes[i];
+			current_pipe->intervalScalar = saved_pipe->intervalScalar;
+			current_pipe->viewPositionX = saved_pipe->viewPositionX;
+			current_pipe->realPositionX = saved_pipe->realPositionX;
+			current_pipe->upperViewPositionY = saved_pipe->upperViewPositionY;
+			current_pipe->upperRealPositionY = saved_pipe->upperRealPositionY;
+			current_pipe->lowerViewPositionY = saved_pipe->lowerViewPositionY;
+			current_pipe->lowerRealPositionY = saved_pipe->lowerRealPositionY;
+			current_pipe->pipeHeight = saved_pipe->pipeHeight;
+			current_pipe->size = saved_pipe->size;
+			current_pipe->nativeContactFlags = saved_pipe->nativeContactFlags;
+
+			Flappy_PlacePipeBodies(current_pipe);
+			FlappyPipeQueue_PushBack(&the_world->circularQueueOfPipes, current_pipe);
+		}
+		else
+		{
+			Flappy_ParkPipeBodies(current_pipe);
+			FlappyPipeQueue_PushBack(&the_world->queueOfAvailablePipes, current_pipe);
+		}
+	}
+
+	the_world->birdModelData.size = the_snapshot->bird.size;
+	the_world->birdModelData.position = the_snapshot->bird.position;
+	the_world->birdModelData.velocity = the_snapshot->bird.velocity;
+	the_world->birdModelData.isFalling = the_snapshot->bird.isFalling;
+	the_world->birdModelData.isReadyToPlayFallingSound = the_snapshot->bird.isReadyToPlayFallingSound;
+	the_world->birdModelData.isDead = the_snapshot->bird.isDead;
+	the_world->birdModelData.isGameOver = the_snapshot->bird.isGameOver;
+	the_world->birdModelData.isPrelaunch = the_snapshot->bird.isPrelaunch;
+	the_world->birdModelData.birdLaunchStartTime = the_snapshot->bird.birdLaunchStartTime;
+	the_world->birdModelData.isReadyForPipe = the_snapshot->bird.isReadyForPipe;
+	the_world->birdModelData.currentFrame = the_snapshot->bird.currentFrame;
+	the_world->birdModelData.animationStartTime = the_snapshot->bird.animationStartTime;
+	the_world->birdModelData.animationDuration = the_snapshot->bird.animationDuration;
+	the_world->birdModelData.isAnimatingSprite = the_snapshot->bird.isAnimatingSprite;
+
+	if(the_snapshot->isBirdInSpace && !is_bird_in_space)
+	{
+		cpSpaceAddBody(the_world->mainSpace, bird_body);
+		cpSpaceAddShape(the_world->mainSpace, bird_shape);
+	}
+	else if(!the_snapshot->isBirdInSpace && is_bird_in_space)
+	{
+		cpSpaceRemoveBody(the_world->mainSpace, bird_body);
+		cpSpaceRemoveShape(the_world->mainSpace, bird_shape);
+	}
+	cpBodySetPosition(bird_body, the_snapshot->birdBodyPosition);
+	cpBodySetVelocity(bird_body, the_snapshot->birdBodyVelocity);
+	cpBodySetAngle(bird_body, the_snapshot->birdBodyAngle);
+	cpBodySetAngularVelocity(bird_body, the_snapshot->birdBodyAngularVelocity);
+	cpBodySetPosition(the_world->groundPhysicsData.body, the_snapshot->groundBodyPosition);
+	/* The ground and pipe bodies are static, so the space won't notice they moved until it is told. */
+	cpSpaceReindexStatic(the_world->mainSpace);
+	the_world->groundPhysicsData.position = the_snapshot->groundPosition;
+
+	the_world->gameInstanceData = the_snapshot->gameInstanceData;
+	the_world->gameState = the_snapshot->gameState;
+	the_world->gameStateCurrentPhaseStartTime = the_snapshot->gameStateCurrentPhaseStartTime;
+	the_world->gameOverSweepInStartTime = the_snapshot->gameOverSweepInStartTime;
+	the_world->medalSweepInStartTime = the_snapshot->medalSweepInStartTime;
+
+	TimeTicker_SetTimeNs(the_world->gameClock, the_snapshot->gameClockTimeNs);
+	/* The snapshot doesn't have the timer, so put the current phase's deadline back on an emptied wheel at the restored time. */
+	FlappyTimerWheel_Reset(&the_world->phaseTimerWheel, TimeTicker_GetTime(the_world->gameClock));
+	FlappyTimer_Init(&the_world->phaseTimer, Flappy_OnPhaseDeadline, the_world);
+	Flappy_SchedulePhaseDeadline(the_world);
+	the_world->physicsAccumulator = the_snapshot->physicsAccumulator;
+	the_world->stepBaseTime = the_snapshot->stepBaseTime;
+	the_world->tickCount = the_snapshot->tickCount;
+	the_world->randomSeed = the_snapshot->randomSeed;
+	the_world->randomState = the_snapshot->randomState;
+	the_world->isBirdTouchingGround = the_snapshot->isBirdTouchingGround;
+	the_world->hasPresteppedBird = SDL_FALSE;
+
+	the_world->cloudModelData = the_snapshot->cloudModelData;
+	the_world->groundModelData = the_snapshot->groundModelData;
+	the_world->bushModelData = the_snapshot->bushModelData;
+	the_world->pipeTopModelData = the_snapshot->pipeTopModelData;
+	the_world->pipeBottomModelData = the_snapshot->pipeBottomModelData;
+	the_world->playerModelData = the_snapshot->playerModelData;
+
+	/* There is no step to interpolate across until the next one, so hold still at the end of the last one. */
+	Flappy_CaptureStepState(the_world, &the_world->currentStepState, the_world->stepBaseTime, TimeTicker_GetTime(the_world->gameClock) - the_snapshot->physicsAccumulator);
+	the_world->previousStepState = the_world->currentStepState;
+}
+
+void FlappyWorld_SetReplayRecorder(struct FlappyWorld* the_world, struct FlappyReplay* the_replay)
+{
+	the_world->replayRecorder = the_replay;
+}
+
+void FlappyWorld_SetEventCallback(struct FlappyWorld* the_world, FlappyWorld_EventCallback the_callback, void* user_data)
+{
+	the_world->eventCallback = the_callback;
+	the_world->eventCallbackUserData = user_data;
+}
+
+void FlappyWorld_SetStepCallback(struct FlappyWorld* the_world, FlappyWorld_StepCallback the_callback, void* user_data)
+{
+	the_world->stepCallback = the_callback;
+	the_world->stepCallbackUserData = user_data;
+}
@@ -0,0 +1,709 @@
+#ifndef C_FLAPPY_WORLD_H
+#define C_FLAPPY_WORLD_H
+
+/* Set up for C function definitions, even when using C++ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef DOXYGEN_SHOULD_IGNORE_THIS
+/** @cond DOXYGEN_SHOULD_IGNORE_THIS */
+
+/* Note: For Doxygen to produce clean output, you should set the
+ * PREDEFINED option to remove C_FLAPPY_WORLD_DECLSPEC, C_FLAPPY_WORLD_CALL, and
+ * the DOXYGEN_SHOULD_IGNORE_THIS blocks.
+ * PREDEFINED = DOXYGEN_SHOULD_IGNORE_THIS=1 C_FLAPPY_WORLD_DECLSPEC= C_FLAPPY_WORLD_CALL=
+ */
+
+/** Windows needs to know explicitly which functions to export in a DLL. */
+#if defined(_WIN32)
+	#if defined(C_FLAPPY_WORLD_BUILD_LIBRARY)
+		#define C_FLAPPY_WORLD_DECLSPEC __declspec(dllexport)
+	#else
+		#define C_FLAPPY_WORLD_DECLSPEC
+	#endif
+#else
+	#if defined(C_FLAPPY_WORLD_BUILD_LIBRARY)
+		#if defined (__GNUC__) && __GNUC__ >= 4
+			#define C_FLAPPY_WORLD_DECLSPEC __attribute__((visibility("default")))
+		#else
+			#define C_FLAPPY_WORLD_DECLSPEC
+		#endif
+	#else
+		#define C_FLAPPY_WORLD_DECLSPEC
+	#endif
+#endif
+
+/* For Windows, by default, use the C calling convention */
+#if defined(_WIN32)
+	#define C_FLAPPY_WORLD_CALL __cdecl
+#else
+	#define C_FLAPPY_WORLD_CALL
+#endif
+
+/** @endcond DOXYGEN_SHOULD_IGNORE_THIS */
+#endif /* DOXYGEN_SHOULD_IGNORE_THIS */
+
+#include "SDL.h"
+#include "chipmunk.h"
+
+#include "CircularQueueTyped.h"
+#include "TimeTicker.h"
+#include "FlappyTimerWheel.h"
+
+/**
+ * @file
+ * FlappyWorld holds the complete simulation state of one game:
+ * the bird, the pipes, the Chipmunk space, the game state machine and the game clock.
+ * Nothing in here touches the renderer, fonts or audio, so any number of worlds
+ * can live in one process. The app learns about things it needs to play sounds for
+ * or redraw through the event callback.
+ */
+
+//#define SCREEN_WIDTH 480*2
+//#define SCREEN_HEIGHT 320*2
+//#define SCREEN_WIDTH 768
+//#define SCREEN_HEIGHT 1024
+//#define SCREEN_WIDTH 1366
+//#define SCREEN_HEIGHT 768
+//#define SCREEN_WIDTH 1136
+//#define SCREEN_HEIGHT 640
+#define SCREEN_WIDTH 1280
+#define SCREEN_HEIGHT 720
+//#define SCREEN_WIDTH 1024
+//#define SCREEN_HEIGHT 768
+
+
+
+
+/* Measured from iPad mini with ruler */
+//#define GROUND_HEIGHT ((1024/16 * 1.9) * 768 / 1024) = 91.2
+#define GROUND_HEIGHT 30
+
+
+#define BIRD_WIDTH 62
+#define BIRD_HEIGHT 50
+
+#define PIPE_WIDTH ((int)(1.9*(double)BIRD_WIDTH))
+/* The pipe collision boxes are as wide as the pipe texture, which is narrower than the drawn PIPE_WIDTH. */
+#define PIPE_PHYSICS_WIDTH 100
+
+/* Distance between pipes:
+	iPad mini: 768 pixels (12cm) across screen,
+	distance between leading pipe edge to next pipe edge: 6.5cm => 416 pixels
+ */
+//#define PIPE_DISTANCE 310
+//#define PIPE_DISTANCE 380
+//const int PIPE_DISTANCE = (int)(3.2*(double)BIRD_WIDTH) + PIPE_WIDTH;
+//#define PIPE_DISTANCE (3*BIRD_WIDTH + PIPE_WIDTH + 12);
+//#define PIPE_DISTANCE 400
+#define PIPE_DISTANCE 360
+//#define PIPE_DISTANCE 418
+//#define PIPE_DISTANCE 743
+
+/* About 3.5 Flappy Birds */
+//#define PIPE_HEIGHT_SEPARATION 256
+//#define PIPE_HEIGHT_SEPARATION 192
+#define PIPE_HEIGHT_SEPARATION ((int)(3.5*(double)BIRD_HEIGHT))
+
+/* y from bottom increasing upwards
+   roughly Flappy height?
+ */
+//#define MIN_PIPE_HEIGHT 46
+#define MIN_PIPE_HEIGHT BIRD_HEIGHT
+#define NUM_PIPE_HEIGHT_QUANTA 20
+
+#define BIRD_COLLISION_TYPE 1
+#define GROUND_COLLISION_TYPE 2
+#define PIPE_COLLISION_TYPE 3
+#define SCORE_SENSOR_TYPE 4
+
+#define NUMBER_OF_BIRD_FRAMES 3
+
+#define BIRD_FLAP_ANIMATION_DURATION 150
+#define BIRD_FLAP_ANIMATION_DURATION_FOR_PRELAUNCH 1000
+#define PIPE_START_TIME_DELAY 1200
+
+#define TALLY_DURATION 750
+
+#define FADE_OUT_TIME 500
+#define FADE_IN_TIME 500
+
+#define DELAY_UNTIL_GAME_OVER_SWOOP_START 500
+#define SWEEP_IN_GAME_OVER_DURATION 200
+#define SWEEP_IN_GAME_OVER_DELAY_BEFORE_NEXT_STATE 1000
+#define SWEEP_IN_MEDAL_PANEL_DURATION 300
+
+/** Gravity in the physics space (y is up). */
+#define FLAPPY_GRAVITY_Y -1900
+/** The vertical velocity a flap sets on the bird. */
+#define FLAPPY_FLAP_VELOCITY_Y 580
+
+#define MAX_NUM_PIPES_REMAINDER SCREEN_WIDTH % PIPE_DISTANCE
+#if MAX_NUM_PIPES_REMAINDER
+	#define MAX_NUM_PIPES SCREEN_WIDTH / PIPE_DISTANCE + 2
+#else
+	#define MAX_NUM_PIPES SCREEN_WIDTH / PIPE_DISTANCE + 1
+#endif
+
+/** The fixed physics step rate. Recommended between 60 and 240; higher = more accuracy (but higher CPU load).
+ * Rendering interpolates between steps (see FlappyWorld_GetInterpolatedRenderState), so a lower rate still looks smooth.
+ * The physics always steps by exactly 1/FLAPPY_WORLD_TICKS_PER_SECOND seconds. The game clock counts whole milli-seconds,
+ * so with a rate that doesn't divide 1000 the ticks take turns being a milli-second longer (16, 17, 17 ms at 60)
+ * and still add up to exactly one second per FLAPPY_WORLD_TICKS_PER_SECOND ticks.
+ * Replays record the rate and refuse to play back on a build with a different one. */
+#ifndef FLAPPY_WORLD_TICKS_PER_SECOND
+	#define FLAPPY_WORLD_TICKS_PER_SECOND 100
+#endif
+/** The game time (in milli-seconds after stepBaseTime, wrapping like the game clock) that tick which_tick starts at. */
+#define FLAPPY_WORLD_TICK_TIME(which_tick) ((Uint32)(((Uint64)(which_tick) * 1000) / FLAPPY_WORLD_TICKS_PER_SECOND))
+/** The game time tick which_tick lasts, which is also what FlappyWorld_StepTick advances by when it steps that tick. */
+#define FLAPPY_WORLD_TICK_LENGTH(which_tick) ((Uint32)(FLAPPY_WORLD_TICK_TIME((Uint64)(which_tick) + 1) - FLAPPY_WORLD_TICK_TIME(which_tick)))
+
+/** FlappyWorld_Create starts each world (and its pipes) on a cache line of its own and pads it out to whole lines,
+ * so worlds stepped on different threads never false-share. */
+#define FLAPPY_WORLD_CACHE_LINE_SIZE 64
+
+
+typedef double MyFloat;
+typedef struct Flappy_FloatPoint
+{
+	MyFloat x;
+	MyFloat y;
+} Flappy_FloatPoint;
+
+struct SceneryModelData
+{
+	SDL_Point position;
+	SDL_Point size;
+	Flappy_FloatPoint velocity;
+};
+
+
+enum GameState
+{
+	GAMESTATE_TITLE_SCREEN = 0,
+	GAMESTATE_FADE_OUT_TITLE_SCREEN,
+	GAMESTATE_LOADING_NEW_GAME_AND_FADE_IN,
+	GAMESTATE_BIRD_PRELAUNCH,
+	GAMESTATE_BIRD_LAUNCHED_BUT_BEFORE_PIPES,
+	GAMESTATE_MAIN_GAME_ACTIVE,
+//	GAMESTATE_DIED_FROM_HITTING_GROUND,
+	GAMESTATE_DIED_FROM_HITTING_PIPE_AND_FALLING,
+//	GAMESTATE_DIED_FROM_HITTING_PIPE_AND_ON_GROUND,
+	GAMESTATE_BIRD_DEAD_ON_GROUND,
+	GAMESTATE_DEAD_TO_GAME_OVER_TRANSITION,
+	GAMESTATE_SWOOPING_IN_GAME_OVER,
+	GAMESTATE_SWOOPED_IN_GAME_OVER,
+	GAMESTATE_SWOOPING_IN_MEDAL_DISPLAY,
+//	GAMESTATE_SWOOPED_IN_MEDAL_DISPLAY,
+	GAMESTATE_TALLYING_SCORE,
+//	GAMESTATE_SWOOPING_IN_BUTTONS,
+	GAMESTATE_GAME_OVER_WAITING_FOR_USER_ACTION,
+	GAMESTATE_FADE_OUT_GAME_OVER
+};
+
+
+struct PipeModelData
+{
+	Sint32 intervalScalar;
+	Sint32 viewPositionX;
+	Sint32 realPositionX;
+
+	Sint32 upperViewPositionY;
+	Sint32 upperRealPositionY;
+	Sint32 lowerViewPositionY;
+	Sint32 lowerRealPositionY;
+
+	Sint32 pipeHeight;
+
+	SDL_Point size;
+	cpBody* upperPhysicsBody;
+	cpShape* upperPhysicsShape;
+
+	cpBody* lowerPhysicsBody;
+	cpShape* lowerPhysicsShape;
+
+	cpBody* scoreSensorPhysicsBody;
+	cpShape* scoreSensorPhysicsShape;
+
+	/* Which of this pipe's shapes the bird currently overlaps (FLAPPY_PHYSICS_BACKEND_NATIVE only). */
+	Uint32 nativeContactFlags;
+};
+
+/* Bits for PipeModelData.nativeContactFlags */
+#define NATIVE_CONTACT_UPPER_PIPE 0x1
+#define NATIVE_CONTACT_LOWER_PIPE 0x2
+#define NATIVE_CONTACT_SCORE_SENSOR 0x4
+
+/* The pipes live in arrayOfPipes (their physics bodies and snapshots refer to those slots),
+	so the queues hold pointers into it, by value and inline. */
+CIRCULAR_QUEUE_TYPED_DEFINE(FlappyPipeQueue, struct PipeModelData*)
+
+struct GameInstanceData
+{
+	Uint32 currentScore;
+	Uint32 distanceTraveled;
+	Uint32 diedAtTime;
+	Uint32 needsWhiteOut;
+	SDL_bool isPaused;
+
+//	Uint32 tallyStartTime;
+
+};
+
+struct BirdModelData
+{
+	cpBody* birdBody;
+	cpShape* birdShape;
+//	SDL_Point viewPosition;
+//	SDL_Point realPosition;
+	SDL_Point size;
+
+	SDL_Point position;
+	Flappy_FloatPoint velocity;
+	/* For when the bird smacks the pipe and needs to fall */
+	SDL_bool isFalling;
+	SDL_bool isReadyToPlayFallingSound;
+	SDL_bool isDead; /* smacks the pipe or ground */
+	SDL_bool isGameOver; /* bird is completely dead on ground after falling from pipe or smacks ground */
+
+	// TODO: Move to game state
+	SDL_bool isPrelaunch;
+	Uint32 birdLaunchStartTime;
+	SDL_bool isReadyForPipe;
+
+
+	/* Index into the bird animation frames (0 to NUMBER_OF_BIRD_FRAMES-1). The renderer maps this to a texture. */
+	Uint32 currentFrame;
+	Uint32 animationStartTime;
+	Uint32 animationDuration;
+	SDL_bool isAnimatingSprite;
+
+};
+
+struct GroundPhysicsData
+{
+	cpBody* body;
+	cpShape* shape;
+	SDL_Point position;
+
+};
+
+
+/**
+ * Things that happen inside the simulation that the app may want to react to,
+ * e.g. by playing a sound or regenerating the score texture.
+ */
+enum FlappyWorldEvent
+{
+	FLAPPY_WORLD_EVENT_NEW_GAME = 0, /**< InitNewGame() reset the world. The score is back to 0. */
+	FLAPPY_WORLD_EVENT_FLAPPED, /**< The bird flapped. */
+	FLAPPY_WORLD_EVENT_SCORED, /**< The bird passed a pipe. gameInstanceData.currentScore has the new score. */
+	FLAPPY_WORLD_EVENT_CRASHED, /**< The bird hit a pipe or the ground. */
+	FLAPPY_WORLD_EVENT_FALLING, /**< The bird started falling after hitting a pipe (see isReadyToPlayFallingSound). */
+	FLAPPY_WORLD_EVENT_SWOOSH /**< A screen transition started (fades, game over and medal panel sweeps). */
+};
+
+/**
+ * How a world moves the bird and detects hits. See FlappyWorld_SetPhysicsBackend.
+ */
+enum FlappyWorldPhysicsBackend
+{
+	FLAPPY_PHYSICS_BACKEND_CHIPMUNK = 0, /**< cpSpaceStep on the world's Chipmunk space. This is the default. */
+	FLAPPY_PHYSICS_BACKEND_NATIVE /**< Integrates the bird directly and tests it against the nearby pipes and the ground in closed form. */
+};
+
+/**
+ * The layout of the feature vector FlappyWorld_WriteObservation writes. Each entry is the index of one float.
+ * Positions and distances are in world units (pixels, y up), velocities in units per second and the angle in radians.
+ * Where there is no such pipe (yet), the pipe is reported as a full-height gap one screen width ahead.
+ */
+enum FlappyWorldObservationFeature
+{
+	FLAPPY_OBSERVATION_BIRD_Y = 0, /**< The centre of the bird above the bottom of the screen. */
+	FLAPPY_OBSERVATION_BIRD_VELOCITY_Y, /**< The bird's vertical velocity (positive is up). */
+	FLAPPY_OBSERVATION_BIRD_ANGLE, /**< The bird's rotation. */
+	FLAPPY_OBSERVATION_NEXT_PIPE_DISTANCE, /**< From the bird's centre to the centre of the next pipe it hasn't cleared. */
+	FLAPPY_OBSERVATION_NEXT_PIPE_GAP_TOP, /**< The bottom of the next pipe's upper half. */
+	FLAPPY_OBSERVATION_NEXT_PIPE_GAP_BOTTOM, /**< The top of the next pipe's lower half. */
+	FLAPPY_OBSERVATION_SECOND_PIPE_GAP_TOP, /**< Same for the pipe after that. */
+	FLAPPY_OBSERVATION_SECOND_PIPE_GAP_BOTTOM,
+	FLAPPY_OBSERVATION_IS_ALIVE, /**< 1 until the bird hits a pipe or the ground, then 0. */
+	FLAPPY_OBSERVATION_SIZE /**< The number of floats in one observation. */
+};
+
+struct FlappyWorld;
+struct FlappyReplay;
+
+/**
+ * Callback signature for FlappyWorld_SetEventCallback.
+ * This is invoked synchronously from within the world functions (mostly Flappy_Update),
+ * so it runs on whatever thread is stepping the world.
+ */
+typedef void (*FlappyWorld_EventCallback)(struct FlappyWorld* the_world, int which_event, void* user_data);
+
+/**
+ * Callback signature for FlappyWorld_SetStepCallback.
+ * This is invoked right before each fixed physics step, on whatever thread is stepping the world.
+ * @param step_start_time The game time (gameClock milliseconds) the step starts at.
+ */
+typedef void (*FlappyWorld_StepCallback)(struct FlappyWorld* the_world, Uint32 step_start_time, void* user_data);
+
+/**
+ * What rendering needs from one side of a physics step. Scenery and pipes all scroll by the same clock,
+ * so one time (in milliseconds since the update's base_time) covers all of them.
+ */
+struct FlappyWorldStepState
+{
+	cpFloat birdPositionY;
+	cpFloat birdAngle;
+	double scrollTime;
+};
+
+/**
+ * Where to draw things this frame, interpolated between the start and end of the last physics step.
+ * Positions are in the same (SDL, y down) screen coordinates as the model data.
+ */
+typedef struct FlappyWorldRenderState
+{
+	Sint32 birdViewPositionY; /**< Replaces birdModelData.position.y */
+	double birdAngle; /**< The bird's rotation in radians (counter-clockwise, like the physics body). */
+	Sint32 cloudPositionX; /**< Replaces cloudModelData.position.x */
+	Sint32 bushPositionX; /**< Replaces bushModelData.position.x */
+	Sint32 groundPositionX; /**< Replaces groundModelData.position.x */
+	Sint32 pipeCameraPositionX; /**< Subtract from a pipe's realPositionX to get its view position (replaces viewPositionX). */
+} FlappyWorldRenderState;
+
+/**
+ * One native physics step of a world's bird that was done outside the world (see FlappyBirdSoA),
+ * for FlappyWorld_SetPresteppedBird. The contacts are all against FlappyWorld_FindNextPipe's pipe and were
+ * tested after moving the bird but before stopping it on the ground, like Flappy_StepNativePhysics does.
+ */
+typedef struct FlappyWorldBirdStep
+{
+	cpFloat positionY;
+	cpFloat velocityY;
+	cpFloat angle;
+	cpFloat angularVelocity;
+	SDL_bool isTouchingPipe; /**< Overlapping the upper or lower half of the next pipe. */
+	SDL_bool isInScoreSensor; /**< Overlapping the next pipe's score sensor. */
+	SDL_bool isTouchingGround;
+} FlappyWorldBirdStep;
+
+struct FlappyWorld
+{
+	struct BirdModelData birdModelData;
+
+	struct PipeModelData* arrayOfPipes;
+	/* The cache-line-aligned world and arrayOfPipes are carved out of these. */
+	void* worldAllocation;
+	void* pipeAllocation;
+	FlappyPipeQueue circularQueueOfPipes;
+	FlappyPipeQueue queueOfAvailablePipes;
+
+	cpSpace* mainSpace;
+	struct GroundPhysicsData groundPhysicsData;
+
+	struct GameInstanceData gameInstanceData;
+	int gameState;
+	Uint32 gameStateCurrentPhaseStartTime;
+	Uint32 gameOverSweepInStartTime;
+	Uint32 medalSweepInStartTime;
+	/* Ends the current phase (fade out, tally, etc.) when its time is up, so nothing polls for it every frame.
+	 * It isn't part of FlappyWorldSnapshot. Restoring reschedules it from gameState and the start times above. */
+	struct FlappyTimerWheel phaseTimerWheel;
+	struct FlappyTimer phaseTimer;
+	/* The gameState phaseTimer was scheduled for. If something else changes the state first, the timer does nothing. */
+	int phaseTimerGameState;
+
+	struct TimeTicker* gameClock;
+	/* Leftover game time (in milliseconds) that hasn't added up to a whole physics step yet.
+	 * This is an integer so the number of steps only depends on the times passed in, never on rounding. */
+	Uint32 physicsAccumulator;
+	/* gameClock's time when the world was created. This is the base_time FlappyWorld_StepTick passes to Flappy_Update. */
+	Uint32 stepBaseTime;
+	/* The number of physics steps so far, in either mode. In tick mode every game time is derived from this. */
+	Uint32 tickCount;
+	/* The seed given to FlappyWorld_Create or FlappyWorld_SetSeed. */
+	Uint64 randomSeed;
+	/* The world's own PCG32 generator state. It picks the pipe heights. */
+	Uint64 randomState;
+	/* A FlappyWorldPhysicsBackend value. */
+	int physicsBackend;
+	/* Whether the bird overlapped the ground on the last native physics step. */
+	SDL_bool isBirdTouchingGround;
+	/* Set by FlappyWorld_SetPresteppedBird. The next native physics step uses presteppedBird instead of integrating. */
+	SDL_bool hasPresteppedBird;
+	FlappyWorldBirdStep presteppedBird;
+
+	struct SceneryModelData cloudModelData;
+	struct SceneryModelData groundModelData;
+	struct SceneryModelData bushModelData;
+	struct SceneryModelData pipeTopModelData;
+	struct SceneryModelData pipeBottomModelData;
+	struct SceneryModelData playerModelData;
+
+	FlappyWorld_EventCallback eventCallback;
+	void* eventCallbackUserData;
+	FlappyWorld_StepCallback stepCallback;
+	void* stepCallbackUserData;
+	/* If set, every Flappy_DoPrimaryAction is recorded here. Not owned by the world. */
+	struct FlappyReplay* replayRecorder;
+
+	/* The state just before and just after the last physics step, for FlappyWorld_GetInterpolatedRenderState. */
+	struct FlappyWorldStepState previousStepState;
+	struct FlappyWorldStepState currentStepState;
+};
+typedef struct FlappyWorld FlappyWorld;
+
+/**
+ * The parts of an active pipe that a FlappyWorldSnapshot keeps. Its physics bodies are placed from these on restore.
+ */
+typedef struct FlappyWorldSnapshotPipe
+{
+	Sint32 intervalScalar;
+	Sint32 viewPositionX;
+	Sint32 realPositionX;
+	Sint32 upperViewPositionY;
+	Sint32 upperRealPositionY;
+	Sint32 lowerViewPositionY;
+	Sint32 lowerRealPositionY;
+	Sint32 pipeHeight;
+	SDL_Point size;
+	Uint32 nativeContactFlags;
+} FlappyWorldSnapshotPipe;
+
+/**
+ * The parts of BirdModelData that a FlappyWorldSnapshot keeps (all of it but the physics body and shape).
+ */
+typedef struct FlappyWorldSnapshotBird
+{
+	SDL_Point size;
+	SDL_Point position;
+	Flappy_FloatPoint velocity;
+	SDL_bool isFalling;
+	SDL_bool isReadyToPlayFallingSound;
+	SDL_bool isDead;
+	SDL_bool isGameOver;
+	SDL_bool isPrelaunch;
+	Uint32 birdLaunchStartTime;
+	SDL_bool isReadyForPipe;
+	Uint32 currentFrame;
+	Uint32 animationStartTime;
+	Uint32 animationDuration;
+	SDL_bool isAnimatingSprite;
+} FlappyWorldSnapshotBird;
+
+/**
+ * Everything that changes while a world runs, as plain data with no pointers to follow.
+ * It can be copied with memcpy, kept in arrays and restored into the world it came from
+ * (or into any other world) with FlappyWorld_Restore.
+ * Settings aren't included: the physics backend, the event callback and the game clock's speed stay as they are.
+ */
+typedef struct FlappyWorldSnapshot
+{
+	FlappyWorldSnapshotBird bird;
+	cpVect birdBodyPosition;
+	cpVect birdBodyVelocity;
+	cpFloat birdBodyAngle;
+	cpFloat birdBodyAngularVelocity;
+	SDL_bool isBirdInSpace;
+	cpVect groundBodyPosition;
+	SDL_Point groundPosition;
+
+	struct GameInstanceData gameInstanceData;
+	int gameState;
+	Uint32 gameStateCurrentPhaseStartTime;
+	Uint32 gameOverSweepInStartTime;
+	Uint32 medalSweepInStartTime;
+
+	/* In nanoseconds, since the live game clock isn't always on a whole millisecond. */
+	Uint64 gameClockTimeNs;
+	Uint32 physicsAccumulator;
+	Uint32 stepBaseTime;
+	Uint32 tickCount;
+	Uint64 randomSeed;
+	Uint64 randomState;
+	SDL_bool isBirdTouchingGround;
+
+	struct SceneryModelData cloudModelData;
+	struct SceneryModelData groundModelData;
+	struct SceneryModelData bushModelData;
+	struct SceneryModelData pipeTopModelData;
+	struct SceneryModelData pipeBottomModelData;
+	struct SceneryModelData playerModelData;
+
+	Uint32 numberOfActivePipes;
+	/* Indices into arrayOfPipes: the active pipes in queue order, then the available ones. */
+	Uint8 pipeOrder[MAX_NUM_PIPES];
+	FlappyWorldSnapshotPipe activePipes[MAX_NUM_PIPES];
+} FlappyWorldSnapshot;
+
+
+/**
+ * Creates a new world with its own physics space, pipes, random number generator and (stopped) game clock.
+ * Call InitTitleScreen() or InitNewGame() before stepping it.
+ * @param random_seed Seeds the world's generator. The same seed always gives the same pipe sequence,
+ * on any thread, process or platform.
+ * @return A new world, or NULL on failure. Free with FlappyWorld_Free.
+ */
+extern C_FLAPPY_WORLD_DECLSPEC struct FlappyWorld* C_FLAPPY_WORLD_CALL FlappyWorld_Create(Uint64 random_seed);
+
+/**
+ * Frees the world, including its Chipmunk objects and game clock.
+ */
+extern C_FLAPPY_WORLD_DECLSPEC void C_FLAPPY_WORLD_CALL FlappyWorld_Free(struct FlappyWorld* the_world);
+
+/**
+ * Records every following Flappy_DoPrimaryAction (with the tick it happened on) into the_replay.
+ * The world doesn't own the replay. Pass NULL to stop recording.
+ */
+extern C_FLAPPY_WORLD_DECLSPEC void C_FLAPPY_WORLD_CALL FlappyWorld_SetReplayRecorder(struct FlappyWorld* the_world, struct FlappyReplay* the_replay);
+
+/**
+ * Restarts the world's random number generator from random_seed. Pipes that already exist are kept.
+ */
+extern C_FLAPPY_WORLD_DECLSPEC void C_FLAPPY_WORLD_CALL FlappyWorld_SetSeed(struct FlappyWorld* the_world, Uint64 random_seed);
+
+/**
+ * Returns a uniformly distributed integer in [min_value, max_value] from the world's generator.
+ */
+extern C_FLAPPY_WORLD_DECLSPEC Uint32 C_FLAPPY_WORLD_CALL FlappyWorld_RandomRange(struct FlappyWorld* the_world, Uint32 min_value, Uint32 max_value);
+
+/**
+ * Sets the function called for FlappyWorldEvent notifications. Pass NULL to disable.
+ */
+extern C_FLAPPY_WORLD_DECLSPEC void C_FLAPPY_WORLD_CALL FlappyWorld_SetEventCallback(struct FlappyWorld* the_world, FlappyWorld_EventCallback the_callback, void* user_data);
+
+/**
+ * Sets the function called before every physics step, e.g. to apply queued input on step boundaries. Pass NULL to disable.
+ */
+extern C_FLAPPY_WORLD_DECLSPEC void C_FLAPPY_WORLD_CALL FlappyWorld_SetStepCallback(struct FlappyWorld* the_world, FlappyWorld_StepCallback the_callback, void* user_data);
+
+/**
+ * Resets the world for a new game and starts its fade in (GAMESTATE_LOADING_NEW_GAME_AND_FADE_IN) at the current game time.
+ */
+extern C_FLAPPY_WORLD_DECLSPEC void C_FLAPPY_WORLD_CALL InitNewGame(struct FlappyWorld* the_world);
+/**
+ * Resets the world like InitNewGame(), but puts it on the title screen instead.
+ */
+extern C_FLAPPY_WORLD_DECLSPEC void C_FLAPPY_WORLD_CALL InitTitleScreen(struct FlappyWorld* the_world);
+
+/**
+ * Advances the simulation.
+ * @param delta_time The game time elapsed since the last update in milliseconds.
+ * @param base_time The game time the world started at.
+ * @param current_time The current game time (usually from the world's gameClock).
+ */
+extern C_FLAPPY_WORLD_DECLSPEC void C_FLAPPY_WORLD_CALL Flappy_Update(struct FlappyWorld* the_world, Uint32 delta_time, Uint32 base_time, Uint32 current_time);
+
+/**
+ * Returns how far (0 to 1) the game clock is into the next physics step, i.e. the leftover in the step accumulator
+ * (plus the gameClock's sub-milli-second part, which the accumulator doesn't count).
+ * Pass it to FlappyWorld_GetInterpolatedRenderState after Flappy_Update.
+ */
+extern C_FLAPPY_WORLD_DECLSPEC double C_FLAPPY_WORLD_CALL FlappyWorld_GetInterpolationAlpha(struct FlappyWorld* the_world);
+
+/**
+ * Computes where to draw the bird, scenery and pipes, blended between the start (alpha 0) and end (alpha 1)
+ * of the last physics step. Drawing this instead of the raw model data keeps motion smooth when the
+ * display rate doesn't match the physics rate, at the cost of showing the world up to one step late.
+ * This is only for drawing; nothing in the simulation reads it.
+ */
+extern C_FLAPPY_WORLD_DECLSPEC void C_FLAPPY_WORLD_CALL FlappyWorld_GetInterpolatedRenderState(struct FlappyWorld* the_world, double alpha, FlappyWorldRenderState* out_render_state);
+
+/**
+ * Selects how the world steps its physics. Switch between games (e.g. right after creation), not during one.
+ * The native backend keeps using the Chipmunk bodies to hold the bird and pipe state, so the rest of the
+ * game (and the renderer) can't tell the difference. It integrates gravity and flaps the same way cpSpaceStep does,
+ * and it fires the same pipe, ground and score callbacks. Only the resting contact with the ground is simplified.
+ * @param which_backend A FlappyWorldPhysicsBackend value.
+ */
+extern C_FLAPPY_WORLD_DECLSPEC void C_FLAPPY_WORLD_CALL FlappyWorld_SetPhysicsBackend(struct FlappyWorld* the_world, int which_backend);
+
+/**
+ * Advances a manually driven world (one whose gameClock is still virtual, as FlappyWorld_Create leaves it) by exactly one physics step
+ * (FLAPPY_WORLD_TICK_LENGTH of game time). This is what the headless and batch drivers use.
+ * In this tick mode the world never looks at SDL_GetTicks() or the clock speed. The game time is always
+ * stepBaseTime + FLAPPY_WORLD_TICK_TIME(tickCount) (and gameClock is set to it), so the same
+ * inputs on the same tick numbers always produce the same run, at any speed.
+ * @param do_primary_action If SDL_TRUE, does Flappy_DoPrimaryAction() at the start of the tick.
+ */
+extern C_FLAPPY_WORLD_DECLSPEC void C_FLAPPY_WORLD_CALL FlappyWorld_StepTick(struct FlappyWorld* the_world, SDL_bool do_primary_action);
+
+/**
+ * The two halves of FlappyWorld_StepTick, for drivers that step the birds of many worlds together in between
+ * (see FlappyBatch and FlappyBirdSoA). BeginTick advances the clock and does the action.
+ * FinishTick does the physics step and everything after it.
+ */
+extern C_FLAPPY_WORLD_DECLSPEC void C_FLAPPY_WORLD_CALL FlappyWorld_BeginTick(struct FlappyWorld* the_world, SDL_bool do_primary_action);
+extern C_FLAPPY_WORLD_DECLSPEC void C_FLAPPY_WORLD_CALL FlappyWorld_FinishTick(struct FlappyWorld* the_world);
+
+/**
+ * Makes the next physics step use the_step for the bird instead of integrating it,
+ * while still firing the pipe, score and ground callbacks it reports.
+ * Only the native backend honours this; any other backend steps normally and the_step is dropped.
+ */
+extern C_FLAPPY_WORLD_DECLSPEC void C_FLAPPY_WORLD_CALL FlappyWorld_SetPresteppedBird(struct FlappyWorld* the_world, const FlappyWorldBirdStep* the_step);
+
+/**
+ * Returns the first pipe whose score sensor the bird at position_x hasn't completely passed, or NULL if there is none.
+ * That is the only pipe a bird there can touch on its next step.
+ */
+extern C_FLAPPY_WORLD_DECLSPEC struct PipeModelData* C_FLAPPY_WORLD_CALL FlappyWorld_FindNextPipe(struct FlappyWorld* the_world, cpFloat position_x);
+
+/**
+ * Returns the number of physics steps the world has taken so far.
+ * In tick mode that is the number of FlappyWorld_StepTick calls.
+ */
+extern C_FLAPPY_WORLD_DECLSPEC Uint32 C_FLAPPY_WORLD_CALL FlappyWorld_GetTickCount(struct FlappyWorld* the_world);
+
+/**
+ * Writes the world's current FLAPPY_OBSERVATION_SIZE features (see FlappyWorldObservationFeature) to out_observation.
+ * This reads the bird body and the pipe queue directly and allocates nothing.
+ */
+extern C_FLAPPY_WORLD_DECLSPEC void C_FLAPPY_WORLD_CALL FlappyWorld_WriteObservation(struct FlappyWorld* the_world, float* out_observation);
+
+/**
+ * Writes the observations of number_of_worlds worlds as one contiguous row-major
+ * [number_of_worlds x FLAPPY_OBSERVATION_SIZE] array, so row i belongs to the_worlds[i].
+ * The caller owns out_observations. Nothing is allocated or staged in between.
+ */
+extern C_FLAPPY_WORLD_DECLSPEC void C_FLAPPY_WORLD_CALL FlappyWorld_WriteObservations(struct FlappyWorld* const* the_worlds, Uint32 number_of_worlds, float* out_observations);
+
+/**
+ * Saves the world's state into out_snapshot. This only copies a few hundred bytes and allocates nothing.
+ */
+extern C_FLAPPY_WORLD_DECLSPEC void C_FLAPPY_WORLD_CALL FlappyWorld_Snapshot(struct FlappyWorld* the_world, FlappyWorldSnapshot* out_snapshot);
+
+/**
+ * Puts the world back into the state saved in the_snapshot, so stepping it again continues that game.
+ * The Chipmunk space isn't rebuilt. The saved values are copied back and the bodies are moved into place.
+ * With FLAPPY_PHYSICS_BACKEND_NATIVE the continuation is bit-exact, since all of its contact state is in the snapshot.
+ * Chipmunk keeps its own contact cache which the snapshot can't hold, so with the Chipmunk backend a bird that is
+ * restored while touching a pipe or sensor sees that contact begin again.
+ */
+extern C_FLAPPY_WORLD_DECLSPEC void C_FLAPPY_WORLD_CALL FlappyWorld_Restore(struct FlappyWorld* the_world, const FlappyWorldSnapshot* the_snapshot);
+
+extern C_FLAPPY_WORLD_DECLSPEC void C_FLAPPY_WORLD_CALL Flappy_DoFlap(struct FlappyWorld* the_world);
+/**
+ * What a tap/click/space does in the current game state: flap, start a game or leave the game over screen.
+ */
+extern C_FLAPPY_WORLD_DECLSPEC void C_FLAPPY_WORLD_CALL Flappy_DoPrimaryAction(struct FlappyWorld* the_world);
+
+extern C_FLAPPY_WORLD_DECLSPEC void C_FLAPPY_WORLD_CALL Flappy_PauseGame(struct FlappyWorld* the_world);
+extern C_FLAPPY_WORLD_DECLSPEC void C_FLAPPY_WORLD_CALL Flappy_UnpauseGame(struct FlappyWorld* the_world);
+extern C_FLAPPY_WORLD_DECLSPEC void C_FLAPPY_WORLD_CALL Flappy_TogglePause(struct FlappyWorld* the_world);
+
+extern C_FLAPPY_WORLD_DECLSPEC int C_FLAPPY_WORLD_CALL Flappy_lroundf(float x);
+/** Used to get the height of the game screen, minus the bird's Y */
+extern C_FLAPPY_WORLD_DECLSPEC Sint32 C_FLAPPY_WORLD_CALL Flappy_InvertY(Sint32 y);
+/** Returns where current_value is between start_value and end_value, clamped to [0,1]. */
+extern C_FLAPPY_WORLD_DECLSPEC MyFloat C_FLAPPY_WORLD_CALL Flappy_ComputeLinearInterpolation(MyFloat current_value, MyFloat start_value, MyFloat end_value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* C_FLAPPY_WORLD_H */
@@ -0,0 +1,119 @@
+/*
+	libflappy's exported functions. These are thin wrappers over FlappyWorld.
+	Each handle keeps a snapshot of its freshly created world, so a reset is a restore and never builds a new Chipmunk space.
+	Snapshots cross the ABI as bytes and are copied through the handle's own FlappyWorldSnapshot,
+	so the caller's buffer doesn't have to be aligned.
+*/
+
+#include "LibFlappy.h"
+#include "FlappyWorld.h"
+
+SDL_COMPILE_TIME_ASSERT(lib_flappy_observation_size, LIB_FLAPPY_OBSERVATION_SIZE == FLAPPY_OBSERVATION_SIZE);
+SDL_COMPILE_TIME_ASSERT(lib_flappy_physics_chipmunk, LIB_FLAPPY_PHYSICS_CHIPMUNK == FLAPPY_PHYSICS_BACKEND_CHIPMUNK);
+SDL_COMPILE_TIME_ASSERT(lib_flappy_physics_native, LIB_FLAPPY_PHYSICS_NATIVE == FLAPPY_PHYSICS_BACKEND_NATIVE);
+
+struct LibFlappyWorld
+{
+	struct FlappyWorld* world;
+	/* The title screen right after creation. LibFlappy_Reset restores this. */
+	FlappyWorldSnapshot freshState;
+	FlappyWorldSnapshot scratchSnapshot;
+};
+
+
+uint32_t LibFlappy_GetABIVersion(void)
+{
+	return LIB_FLAPPY_ABI_VERSION;
+}
+
+LibFlappyWorld* LibFlappy_Create(uint64_t random_seed, int32_t physics_backend)
+{
+	LibFlappyWorld* the_handle;
+
+	if((LIB_FLAPPY_PHYSICS_CHIPMUNK != physics_backend) && (LIB_FLAPPY_PHYSICS_NATIVE != physics_backend))
+	{
+		return NULL;
+	}
+	the_handle = (LibFlappyWorld*)SDL_calloc(1, sizeof(LibFlappyWorld));
+	if(NULL == the_handle)
+	{
+		return NULL;
+	}
+	the_handle->world = FlappyWorld_Create(random_seed);
+	if(NULL == the_handle->world)
+	{
+		SDL_free(the_handle);
+		return NULL;
+	}
+	FlappyWorld_SetPhysicsBackend(the_handle->world, physics_backend);
+	InitTitleScreen(the_handle->world);
+	FlappyWorld_Snapshot(the_handle->world, &the_handle->freshState);
+	return the_handle;
+}
+
+void LibFlappy_Destroy(LibFlappyWorld* the_handle)
+{
+	if(NULL == the_handle)
+	{
+		return;
+	}
+	FlappyWorld_Free(the_handle->world);
+	SDL_free(the_handle);
+}
+
+void LibFlappy_Reset(LibFlappyWorld* the_handle, uint64_t random_seed)
+{
+	FlappyWorld_Restore(the_handle->world, &the_handle->freshState);
+	FlappyWorld_SetSeed(the_handle->world, random_seed);
+}
+
+void LibFlappy_Step(LibFlappyWorld* the_handle, int32_t the_action, float* out_observation)
+{
+	FlappyWorld_StepTick(the_handle->world, (LIB_FLAPPY_ACTION_FLAP == the_action) ? SDL_TRUE : SDL_FALSE);
+	if(NULL != out_observation)
+	{
+		FlappyWorld_WriteObservation(the_handle->world, out_observation);
+	}
+}
+
+void LibFlappy_Observe(LibFlappyWorld* the_handle, float* out_observation)
+{
+	FlappyWorld_WriteObservation(the_handle->world, out_observation);
+}
+
+uint32_t LibFlappy_GetScore(LibFlappyWorld* the_handle)
+{
+	return the_handle->world->gameInstanceData.currentScore;
+}
+
+uint32_t LibFlappy_GetTickCount(LibFlappyWorld* the_handle)
+{
+	return FlappyWorld_GetTickCount(the_handle->world);
+}
+
+size_t LibFlappy_GetSnapshotSize(void)
+{
+	return sizeof(FlappyWorldSnapshot);
+}
+
+int32_t LibFlappy_Snapshot(LibFlappyWorld* the_handle, void* the_buffer, size_t buffer_size)
+{
+	if(buffer_size < sizeof(FlappyWorldSnapshot))
+	{
+		return -1;
+	}
+	FlappyWorld_Snapshot(the_handle->world, &the_handle->scratchSnapshot);
+	SDL_memcpy(the_buffer, &the_handle->scratchSnapshot, sizeof(FlappyWorldSnapshot));
+	return 0;
+}
+
+int32_t LibFlappy_Restore(LibFlappyWorld* the_handle, const void* the_buffer, size_t buffer_size)
+{
+	if(buffer_size < sizeof(FlappyWorldSnapshot))
+	{
+		return -1;
+	}
+	SDL_memcpy(&the_handle->scratchSnapshot, the_buffer, sizeof(FlappyWorldSnapshot));
+	FlappyWorld_Restore(the_handle->world, &the_handle->scratchSnapshot);
+	return 0;
+}
@@ -0,0 +1,134 @@
+#ifndef C_LIB_FLAPPY_H
+#define C_LIB_FLAPPY_H
+
+/* Set up for C function definitions, even when using C++ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef DOXYGEN_SHOULD_IGNORE_THIS
+/** @cond DOXYGEN_SHOULD_IGNORE_THIS */
+
+/* Note: For Doxygen to produce clean output, you should set the
+ * PREDEFINED option to remove C_LIB_FLAPPY_DECLSPEC, C_LIB_FLAPPY_CALL, and
+ * the DOXYGEN_SHOULD_IGNORE_THIS blocks.
+ * PREDEFINED = DOXYGEN_SHOULD_IGNORE_THIS=1 C_LIB_FLAPPY_DECLSPEC= C_LIB_FLAPPY_CALL=
+ */
+
+/** Windows needs to know explicitly which functions to export in a DLL. */
+#if defined(_WIN32)
+	#if defined(C_LIB_FLAPPY_BUILD_LIBRARY)
+		#define C_LIB_FLAPPY_DECLSPEC __declspec(dllexport)
+	#else
+		#define C_LIB_FLAPPY_DECLSPEC
+	#endif
+#else
+	#if defined(C_LIB_FLAPPY_BUILD_LIBRARY)
+		#if defined (__GNUC__) && __GNUC__ >= 4
+			#define C_LIB_FLAPPY_DECLSPEC __attribute__((visibility("default")))
+		#else
+			#define C_LIB_FLAPPY_DECLSPEC
+		#endif
+	#else
+		#define C_LIB_FLAPPY_DECLSPEC
+	#endif
+#endif
+
+/* For Windows, by default, use the C calling convention */
+#if defined(_WIN32)
+	#define C_LIB_FLAPPY_CALL __cdecl
+#else
+	#define C_LIB_FLAPPY_CALL
+#endif
+
+/** @endcond DOXYGEN_SHOULD_IGNORE_THIS */
+#endif /* DOXYGEN_SHOULD_IGNORE_THIS */
+
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @file
+ * LibFlappy is the public face of libflappy, the shared library build of the simulation for training harnesses
+ * that want to link the game directly. Only the functions in this header are exported. Everything else
+ * is compiled with hidden visibility, so the compiler is free to inline across the simulation.
+ *
+ * The ABI is plain C with fixed-width types and an opaque handle. No structs cross the boundary
+ * (snapshots are opaque byte buffers), and this header doesn't need SDL or Chipmunk headers.
+ * The library only uses SDL's core (memory, threads, timers), never its video, and neither SDL_ttf nor ALmixer.
+ *
+ * Step, observe, reset, snapshot and restore never allocate.
+ * A handle may be used from any thread, but only from one thread at a time.
+ */
+
+/** Bumped whenever a function's signature or meaning changes. Compare with LibFlappy_GetABIVersion(). */
+#define LIB_FLAPPY_ABI_VERSION 1
+
+/** The number of floats LibFlappy_Observe writes. The layout is FlappyWorldObservationFeature in FlappyWorld.h:
+ * bird y, vertical velocity, angle, distance to the next pipe, gap top and bottom of the next two pipes, alive. */
+#define LIB_FLAPPY_OBSERVATION_SIZE 9
+
+/** Values for LibFlappy_Create's physics_backend (the same as FlappyWorldPhysicsBackend). */
+#define LIB_FLAPPY_PHYSICS_CHIPMUNK 0
+#define LIB_FLAPPY_PHYSICS_NATIVE 1
+
+/** Values for LibFlappy_Step's action. */
+#define LIB_FLAPPY_ACTION_NONE 0
+#define LIB_FLAPPY_ACTION_FLAP 1
+
+typedef struct LibFlappyWorld LibFlappyWorld;
+
+extern C_LIB_FLAPPY_DECLSPEC uint32_t C_LIB_FLAPPY_CALL LibFlappy_GetABIVersion(void);
+
+/**
+ * Creates a world on the title screen. The first LIB_FLAPPY_ACTION_FLAP starts a game.
+ * @return A new handle, or NULL on failure. Free with LibFlappy_Destroy.
+ */
+extern C_LIB_FLAPPY_DECLSPEC LibFlappyWorld* C_LIB_FLAPPY_CALL LibFlappy_Create(uint64_t random_seed, int32_t physics_backend);
+
+extern C_LIB_FLAPPY_DECLSPEC void C_LIB_FLAPPY_CALL LibFlappy_Destroy(LibFlappyWorld* the_handle);
+
+/**
+ * Puts the world back into the state LibFlappy_Create left it in, but with a new seed.
+ */
+extern C_LIB_FLAPPY_DECLSPEC void C_LIB_FLAPPY_CALL LibFlappy_Reset(LibFlappyWorld* the_handle, uint64_t random_seed);
+
+/**
+ * Advances the world by one physics tick, after doing the action.
+ * @param the_action LIB_FLAPPY_ACTION_NONE or LIB_FLAPPY_ACTION_FLAP.
+ * @param out_observation If not NULL, receives LIB_FLAPPY_OBSERVATION_SIZE floats describing the world after the tick.
+ */
+extern C_LIB_FLAPPY_DECLSPEC void C_LIB_FLAPPY_CALL LibFlappy_Step(LibFlappyWorld* the_handle, int32_t the_action, float* out_observation);
+
+/**
+ * Writes LIB_FLAPPY_OBSERVATION_SIZE floats describing the world's current state.
+ */
+extern C_LIB_FLAPPY_DECLSPEC void C_LIB_FLAPPY_CALL LibFlappy_Observe(LibFlappyWorld* the_handle, float* out_observation);
+
+extern C_LIB_FLAPPY_DECLSPEC uint32_t C_LIB_FLAPPY_CALL LibFlappy_GetScore(LibFlappyWorld* the_handle);
+extern C_LIB_FLAPPY_DECLSPEC uint32_t C_LIB_FLAPPY_CALL LibFlappy_GetTickCount(LibFlappyWorld* the_handle);
+
+/**
+ * Returns the number of bytes a snapshot needs. This can change between library versions,
+ * so snapshots are only meant to be restored by the same build of the library.
+ */
+extern C_LIB_FLAPPY_DECLSPEC size_t C_LIB_FLAPPY_CALL LibFlappy_GetSnapshotSize(void);
+
+/**
+ * Saves the world's state into the_buffer, which needs no particular alignment.
+ * @return 0 on success, or -1 if buffer_size is smaller than LibFlappy_GetSnapshotSize().
+ */
+extern C_LIB_FLAPPY_DECLSPEC int32_t C_LIB_FLAPPY_CALL LibFlappy_Snapshot(LibFlappyWorld* the_handle, void* the_buffer, size_t buffer_size);
+
+/**
+ * Restores a state saved by LibFlappy_Snapshot (from this or any other handle).
+ * @return 0 on success, or -1 if buffer_size is smaller than LibFlappy_GetSnapshotSize().
+ */
+extern C_LIB_FLAPPY_DECLSPEC int32_t C_LIB_FLAPPY_CALL LibFlappy_Restore(LibFlappyWorld* the_handle, const void* the_buffer, size_t buffer_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* C_LIB_FLAPPY_H */
@@ -1,5 +1,5 @@
 /*
-	This is an abstraction around SDL_GetTicks() and works like a stop watch. 
+	This is an abstraction around SDL_GetTicks() (or SDL_GetPerformanceCounter()) and works like a stop watch. 
 	Unlike SDL_GetTicks(), this can count independently of the system clock, 
 	which is useful for things like pausing the game.
 	This also has a time scale factor which can allow for things like "bullet time".
@@ -9,14 +9,68 @@
 
 #include "TimeTicker.h"
 
+#define TIME_TICKER_NANOSECONDS_PER_SECOND 1000000000ull
+#define TIME_TICKER_NANOSECONDS_PER_MILLISECOND 1000000ull
+
 struct TimeTicker
 {
 	double timeSpeed;
-	Uint32 previousTime;
-	Uint32 currentTime;
+	// The last raw reading of the clock source (SDL_GetTicks() or SDL_GetPerformanceCounter()).
+	Uint64 previousTime;
+	// Counts per second of the clock source. 1000 for SDL_GetTicks().
+	Uint64 clockFrequency;
+	// The current time is never accumulated one scaled delta at a time, because rounding every call drifts.
+	// Instead, we keep the time at the last speed change (or SetTime) and the total unscaled
+	// time since then, and scale the total once.
+	Uint64 segmentStartTime;
+	Uint64 segmentElapsedCounts;
+	Uint64 segmentAdvancedTime;
+	// In nano-seconds.
+	Uint64 currentTime;
 	SDL_bool isTickerEnabled;
+	SDL_bool isHighResolution;
+	// Virtual tickers never read the clock. They only move when Advance() is called.
+	SDL_bool isVirtual;
 };
 
+static Uint64 TimeTicker_ReadClock(struct TimeTicker* time_ticker)
+{
+	if(time_ticker->isHighResolution)
+	{
+		return SDL_GetPerformanceCounter();
+	}
+	else
+	{
+		return SDL_GetTicks();
+	}
+}
+
+// Recomputes currentTime from the current segment.
+static void TimeTicker_RecomputeTime(struct TimeTicker* time_ticker)
+{
+	Uint64 frequency = time_ticker->clockFrequency;
+	Uint64 counts = time_ticker->segmentElapsedCounts;
+	// Split into whole seconds and the remainder so counts * 1e9 can't overflow.
+	Uint64 elapsed_time = (counts / frequency) * TIME_TICKER_NANOSECONDS_PER_SECOND
+		+ ((counts % frequency) * TIME_TICKER_NANOSECONDS_PER_SECOND) / frequency
+		+ time_ticker->segmentAdvancedTime;
+
+	if(1.0 != time_ticker->timeSpeed)
+	{
+		elapsed_time = (Uint64)((elapsed_time * time_ticker->timeSpeed) + 0.5);
+	}
+	time_ticker->currentTime = time_ticker->segmentStartTime + elapsed_time;
+}
+
+// Starts a new segment at the current time (e.g. so a speed change only applies from here on).
+static void TimeTicker_BeginSegment(struct TimeTicker* time_ticker, Uint64 start_time)
+{
+	time_ticker->segmentStartTime = start_time;
+	time_ticker->segmentElapsedCounts = 0;
+	time_ticker->segmentAdvancedTime = 0;
+	time_ticker->currentTime = start_time;
+}
+
 //////////////////////////////////////////////////////////////////////
 // Construction/Destruction
 //////////////////////////////////////////////////////////////////////
@@ -24,6 +78,17 @@ struct TimeTicker
 struct TimeTicker* TimeTicker_Create()
 {
 	struct TimeTicker* time_ticker = (struct TimeTicker*)SDL_calloc(1, sizeof(struct TimeTicker));
+	time_ticker->isHighResolution = SDL_FALSE;
+	time_ticker->clockFrequency = 1000;
+	TimeTicker_Reset(time_ticker);
+	return time_ticker;
+}
+
+struct TimeTicker* TimeTicker_CreateHighResolution()
+{
+	struct TimeTicker* time_ticker = (struct TimeTicker*)SDL_calloc(1, sizeof(struct TimeTicker));
+	time_ticker->isHighResolution = SDL_TRUE;
+	time_ticker->clockFrequency = SDL_GetPerformanceFrequency();
 	TimeTicker_Reset(time_ticker);
 	return time_ticker;
 }
@@ -50,14 +115,17 @@ void TimeTicker_Start(struct TimeTicker* time_ticker)
 
 	if( ! time_ticker->isTickerEnabled)
 	{
-		// We set previousTime here to SDL_GetTicks() because
+		// We set previousTime here to the clock reading because
 		// we need a new base time to subtract from to get a 
-		// difference from the next call to SDL_GetTicks().
+		// difference from the next reading.
 		// This will tell us how much time elapsed between start and 
 		// the next call. We can't use 0 as the base because
 		// the timer may be paused at some point or the clock may not
 		// start at 0.
-		time_ticker->previousTime = SDL_GetTicks();
+		if( ! time_ticker->isVirtual)
+		{
+			time_ticker->previousTime = TimeTicker_ReadClock(time_ticker);
+		}
 		time_ticker->isTickerEnabled = SDL_TRUE;
 	}
 }
@@ -89,8 +157,8 @@ void TimeTicker_Reset(struct TimeTicker* time_ticker)
 {
 	time_ticker->isTickerEnabled = SDL_FALSE;
 	time_ticker->previousTime = 0;
-	time_ticker->currentTime = 0;
 	time_ticker->timeSpeed = 1.0;
+	TimeTicker_BeginSegment(time_ticker, 0);
 }
 
 
@@ -101,31 +169,86 @@ void TimeTicker_Reset(struct TimeTicker* time_ticker)
 // Gets the clock's current time in milli-seconds.
 Uint32 TimeTicker_GetTime(struct TimeTicker* time_ticker)
 {
-	//   Uint32 value = time_ticker->isTickerEnabled ? SDL_GetTicks() : time_stop;
-	//   return (Uint32)((value - time_offset) * timeSpeed);
+	return (Uint32)(time_ticker->currentTime / TIME_TICKER_NANOSECONDS_PER_MILLISECOND);
+}
+
+// Gets the clock's current time in nano-seconds.
+Uint64 TimeTicker_GetTimeNs(struct TimeTicker* time_ticker)
+{
 	return time_ticker->currentTime;
 }
 
 // Updates the clock.
-// Returns the new current time as a convenience.
-// Use GetTime() to get the time without updating it.
-Uint32 TimeTicker_UpdateTime(struct TimeTicker* time_ticker)
+// Returns the new current time in nano-seconds as a convenience.
+// Use GetTimeNs() to get the time without updating it.
+Uint64 TimeTicker_UpdateTimeNs(struct TimeTicker* time_ticker)
 {
 	// If the clock is on, we need to recompute the currentTime
 	// Else, we just use the pre-existing currentTime
-	if(SDL_TRUE == time_ticker->isTickerEnabled)
+	// (Virtual tickers are never on as far as the clock is concerned.)
+	if((SDL_TRUE == time_ticker->isTickerEnabled) && ( ! time_ticker->isVirtual))
 	{
-		Uint32 now_time = SDL_GetTicks();
-		// The amount of time that has passed is (now-previous) * timeSpeed
-		// Add that to the currentTime to get the new currentTime.
-		// Note the the +0.5f is for rounding when the time gets converted back to Uint32
-		time_ticker->currentTime += (Uint32)(((now_time - time_ticker->previousTime) * time_ticker->timeSpeed) + 0.5);
+		Uint64 now_time = TimeTicker_ReadClock(time_ticker);
+		if(time_ticker->isHighResolution)
+		{
+			time_ticker->segmentElapsedCounts += now_time - time_ticker->previousTime;
+		}
+		else
+		{
+			// SDL_GetTicks() is only 32-bit, so subtract in 32-bit to survive it wrapping.
+			time_ticker->segmentElapsedCounts += (Uint32)((Uint32)now_time - (Uint32)time_ticker->previousTime);
+		}
 		// Now reset the previousTime for the next time this function is called
 		time_ticker->previousTime = now_time;
+		TimeTicker_RecomputeTime(time_ticker);
 	}
 	return time_ticker->currentTime;
 }
 
+// Updates the clock.
+// Returns the new current time as a convenience.
+// Use GetTime() to get the time without updating it.
+Uint32 TimeTicker_UpdateTime(struct TimeTicker* time_ticker)
+{
+	TimeTicker_UpdateTimeNs(time_ticker);
+	return TimeTicker_GetTime(time_ticker);
+}
+
+// Advances the clock by an explicit amount of nano-seconds (scaled by the speed)
+// instead of reading the clock. This is for fixed-step loops (e.g. headless mode)
+// that want to run faster than real time. This moves the clock whether or not it is started,
+// so use it on a virtual ticker (see SetVirtual()) or a stopped one, otherwise the next UpdateTime()
+// will add the wall clock on top.
+// Returns the new current time in nano-seconds as a convenience.
+Uint64 TimeTicker_Advance(struct TimeTicker* time_ticker, Uint64 delta_time)
+{
+	time_ticker->segmentAdvancedTime += delta_time;
+	TimeTicker_RecomputeTime(time_ticker);
+	return time_ticker->currentTime;
+}
+
+// Same as Advance(), but in milli-seconds.
+// Returns the new current time as a convenience.
+Uint32 TimeTicker_AdvanceTime(struct TimeTicker* time_ticker, Uint32 delta_time)
+{
+	TimeTicker_Advance(time_ticker, (Uint64)delta_time * TIME_TICKER_NANOSECONDS_PER_MILLISECOND);
+	return TimeTicker_GetTime(time_ticker);
+}
+
+// Sets the clock's current time in milli-seconds, ignoring the speed.
+// This is for owners that keep their own exact time (e.g. an integer tick count)
+// and just want GetTime() to agree with it. Like AdvanceTime(), use it on a stopped ticker.
+void TimeTicker_SetTime(struct TimeTicker* time_ticker, Uint32 new_time)
+{
+	TimeTicker_BeginSegment(time_ticker, (Uint64)new_time * TIME_TICKER_NANOSECONDS_PER_MILLISECOND);
+}
+
+// Sets the clock's current time in nano-seconds, ignoring the speed.
+void TimeTicker_SetTimeNs(struct TimeTicker* time_ticker, Uint64 new_time)
+{
+	TimeTicker_BeginSegment(time_ticker, new_time);
+}
+
 
 
 //////////////////////////////////////////////////////////////////////
@@ -138,6 +261,8 @@ void TimeTicker_SetSpeed(struct TimeTicker* time_ticker, double new_speed)
 {
 	if(new_speed >= 0)
 	{
+		// Everything up to now was at the old speed, so start a new segment.
+		TimeTicker_BeginSegment(time_ticker, time_ticker->currentTime);
 		time_ticker->timeSpeed = new_speed;
 	}
 }
@@ -149,4 +274,31 @@ double TimeTicker_GetSpeed(struct TimeTicker* time_ticker)
 	return time_ticker->timeSpeed;
 }
 
+// A virtual ticker never reads the clock. UpdateTime() just returns the current time,
+// and only Advance()/AdvanceTime()/SetTime() move it. Start()/Stop() still work
+// (so the game can pause it the usual way) but don't pick up any wall clock time.
+void TimeTicker_SetVirtual(struct TimeTicker* time_ticker, SDL_bool is_virtual)
+{
+	if(is_virtual == time_ticker->isVirtual)
+	{
+		return;
+	}
+	if(is_virtual)
+	{
+		// Count the wall clock time up to now before we stop listening to it.
+		TimeTicker_UpdateTimeNs(time_ticker);
+	}
+	else
+	{
+		// Like Start(), we need a new base time so the time spent virtual isn't counted twice.
+		time_ticker->previousTime = TimeTicker_ReadClock(time_ticker);
+	}
+	time_ticker->isVirtual = is_virtual;
+}
+
+SDL_bool TimeTicker_IsVirtual(struct TimeTicker* time_ticker)
+{
+	return time_ticker->isVirtual;
+}
+
 
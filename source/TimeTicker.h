@@ -54,14 +54,23 @@ extern "C" {
 	#define TIME_TICKER_RENAME_PUBLIC_SYMBOL(symbol) TIME_TICKER_RENAME_PUBLIC_SYMBOL_WITH_NAMESPACE(TIME_TICKER_NAMESPACE_PREFIX, symbol)
 	
 	#define TimeTicker_Create		TIME_TICKER_RENAME_PUBLIC_SYMBOL(TimeTicker_Create)
+	#define TimeTicker_CreateHighResolution		TIME_TICKER_RENAME_PUBLIC_SYMBOL(TimeTicker_CreateHighResolution)
 	#define TimeTicker_Free			TIME_TICKER_RENAME_PUBLIC_SYMBOL(TimeTicker_Free)
 	#define TimeTicker_Start		TIME_TICKER_RENAME_PUBLIC_SYMBOL(TimeTicker_Start)
 	#define TimeTicker_Stop			TIME_TICKER_RENAME_PUBLIC_SYMBOL(TimeTicker_Stop)
 	#define TimeTicker_Reset		TIME_TICKER_RENAME_PUBLIC_SYMBOL(TimeTicker_Reset)
 	#define TimeTicker_GetTime		TIME_TICKER_RENAME_PUBLIC_SYMBOL(TimeTicker_GetTime)
 	#define TimeTicker_UpdateTime	TIME_TICKER_RENAME_PUBLIC_SYMBOL(TimeTicker_UpdateTime)
+	#define TimeTicker_AdvanceTime	TIME_TICKER_RENAME_PUBLIC_SYMBOL(TimeTicker_AdvanceTime)
+	#define TimeTicker_Advance		TIME_TICKER_RENAME_PUBLIC_SYMBOL(TimeTicker_Advance)
+	#define TimeTicker_SetTime		TIME_TICKER_RENAME_PUBLIC_SYMBOL(TimeTicker_SetTime)
+	#define TimeTicker_GetTimeNs	TIME_TICKER_RENAME_PUBLIC_SYMBOL(TimeTicker_GetTimeNs)
+	#define TimeTicker_UpdateTimeNs	TIME_TICKER_RENAME_PUBLIC_SYMBOL(TimeTicker_UpdateTimeNs)
+	#define TimeTicker_SetTimeNs	TIME_TICKER_RENAME_PUBLIC_SYMBOL(TimeTicker_SetTimeNs)
 	#define TimeTicker_SetSpeed		TIME_TICKER_RENAME_PUBLIC_SYMBOL(TimeTicker_SetSpeed)
 	#define TimeTicker_GetSpeed		TIME_TICKER_RENAME_PUBLIC_SYMBOL(TimeTicker_GetSpeed)
+	#define TimeTicker_SetVirtual	TIME_TICKER_RENAME_PUBLIC_SYMBOL(TimeTicker_SetVirtual)
+	#define TimeTicker_IsVirtual	TIME_TICKER_RENAME_PUBLIC_SYMBOL(TimeTicker_IsVirtual)
 
 #endif /* defined(TIME_TICKER_NAMESPACE_PREFIX) */
 
@@ -71,14 +80,26 @@ struct TimeTicker;
 typedef struct TimeTicker TimeTicker;
 
 extern C_TIME_TICKER_DECLSPEC struct TimeTicker* C_TIME_TICKER_CALL TimeTicker_Create(void);
+/* Same as TimeTicker_Create(), but reads SDL_GetPerformanceCounter() instead of SDL_GetTicks(), so frame deltas aren't quantised to whole milli-seconds. */
+extern C_TIME_TICKER_DECLSPEC struct TimeTicker* C_TIME_TICKER_CALL TimeTicker_CreateHighResolution(void);
 extern C_TIME_TICKER_DECLSPEC void C_TIME_TICKER_CALL TimeTicker_Free(struct TimeTicker* time_ticker);
 extern C_TIME_TICKER_DECLSPEC void C_TIME_TICKER_CALL TimeTicker_Start(struct TimeTicker* time_ticker);
 extern C_TIME_TICKER_DECLSPEC void C_TIME_TICKER_CALL TimeTicker_Stop(struct TimeTicker* time_ticker);
 extern C_TIME_TICKER_DECLSPEC void C_TIME_TICKER_CALL TimeTicker_Reset(struct TimeTicker* time_ticker);
 extern C_TIME_TICKER_DECLSPEC Uint32 C_TIME_TICKER_CALL TimeTicker_GetTime(struct TimeTicker* time_ticker);
 extern C_TIME_TICKER_DECLSPEC Uint32 C_TIME_TICKER_CALL TimeTicker_UpdateTime(struct TimeTicker* time_ticker);
+extern C_TIME_TICKER_DECLSPEC Uint32 C_TIME_TICKER_CALL TimeTicker_AdvanceTime(struct TimeTicker* time_ticker, Uint32 delta_time);
+extern C_TIME_TICKER_DECLSPEC void C_TIME_TICKER_CALL TimeTicker_SetTime(struct TimeTicker* time_ticker, Uint32 new_time);
+/* 64-bit nano-second versions of the above. These don't wrap after 49 days like the Uint32 milli-second ones do. */
+extern C_TIME_TICKER_DECLSPEC Uint64 C_TIME_TICKER_CALL TimeTicker_GetTimeNs(struct TimeTicker* time_ticker);
+extern C_TIME_TICKER_DECLSPEC Uint64 C_TIME_TICKER_CALL TimeTicker_UpdateTimeNs(struct TimeTicker* time_ticker);
+extern C_TIME_TICKER_DECLSPEC Uint64 C_TIME_TICKER_CALL TimeTicker_Advance(struct TimeTicker* time_ticker, Uint64 delta_time);
+extern C_TIME_TICKER_DECLSPEC void C_TIME_TICKER_CALL TimeTicker_SetTimeNs(struct TimeTicker* time_ticker, Uint64 new_time);
 extern C_TIME_TICKER_DECLSPEC void C_TIME_TICKER_CALL TimeTicker_SetSpeed(struct TimeTicker* time_ticker, double new_speed);
 extern C_TIME_TICKER_DECLSPEC double C_TIME_TICKER_CALL TimeTicker_GetSpeed(struct TimeTicker* time_ticker);
+/* A virtual ticker never reads the wall clock. It only moves with TimeTicker_Advance()/AdvanceTime()/SetTime(). */
+extern C_TIME_TICKER_DECLSPEC void C_TIME_TICKER_CALL TimeTicker_SetVirtual(struct TimeTicker* time_ticker, SDL_bool is_virtual);
+extern C_TIME_TICKER_DECLSPEC SDL_bool C_TIME_TICKER_CALL TimeTicker_IsVirtual(struct TimeTicker* time_ticker);
 
 #ifdef __cplusplus
 }
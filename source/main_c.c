@@ -23,6 +23,20 @@
 
 #include "CircularQueue.h"
 #include "TimeTicker.h"
+#include "FlappyWorld.h"
+#include "FlappyBatch.h"
+#include "FlappyReplay.h"
+#include "FlappyReplayVerifier.h"
+#include "FlappyPixelRenderer.h"
+#include "FlappyExperienceRing.h"
+#include "FlappyCommandQueue.h"
+#include "FlappyFramePacer.h"
+
+#if defined(_WIN32)
+	#include <windows.h>
+#else
+	#include <dirent.h>
+#endif
 
 
 #ifdef __ANDROID__
@@ -33,8 +47,6 @@
 
 #include <stdlib.h>
 
-#define NUMBER_OF_BIRD_FRAMES 3
-
 struct GameTextures
 {
 	SDL_Texture* background;
@@ -72,54 +84,34 @@ struct GameSounds
 };
 struct GameSounds g_gameSounds;
 
-typedef double MyFloat;
-typedef struct Flappy_FloatPoint
-{
-	MyFloat x;
-	MyFloat y;
-} Flappy_FloatPoint;
+/* Headless mode runs the simulation without a window, renderer, fonts, textures or audio device.
+	Anything that touches those must check this first.
+ */
+SDL_bool g_isHeadless = SDL_FALSE;
 
-struct SceneryModelData
+void Flappy_PlaySound(ALmixer_Data* the_sound)
 {
-	SDL_Point position;
-	SDL_Point size;
-	Flappy_FloatPoint velocity;
-};
-struct SceneryModelData g_cloudModelData;
-struct SceneryModelData g_groundModelData;
-struct SceneryModelData g_bushModelData;
-
-struct SceneryModelData g_pipeTopModelData;
-struct SceneryModelData g_pipeBottomModelData;
-
-struct SceneryModelData g_playerModelData;
+	if(g_isHeadless)
+	{
+		return;
+	}
+	ALmixer_PlayChannel(-1, the_sound, 0);
+}
 
+/* The world that is shown on screen and receives the player's input. */
+struct FlappyWorld* g_flappyWorld = NULL;
 
-enum GameState
-{
-	GAMESTATE_TITLE_SCREEN = 0,
-	GAMESTATE_FADE_OUT_TITLE_SCREEN,
-	GAMESTATE_LOADING_NEW_GAME_AND_FADE_IN,
-	GAMESTATE_BIRD_PRELAUNCH,
-	GAMESTATE_BIRD_LAUNCHED_BUT_BEFORE_PIPES,
-	GAMESTATE_MAIN_GAME_ACTIVE,
-//	GAMESTATE_DIED_FROM_HITTING_GROUND,
-	GAMESTATE_DIED_FROM_HITTING_PIPE_AND_FALLING,
-//	GAMESTATE_DIED_FROM_HITTING_PIPE_AND_ON_GROUND,
-	GAMESTATE_BIRD_DEAD_ON_GROUND,
-	GAMESTATE_DEAD_TO_GAME_OVER_TRANSITION,
-	GAMESTATE_SWOOPING_IN_GAME_OVER,
-	GAMESTATE_SWOOPED_IN_GAME_OVER,
-	GAMESTATE_SWOOPING_IN_MEDAL_DISPLAY,
-//	GAMESTATE_SWOOPED_IN_MEDAL_DISPLAY,
-	GAMESTATE_TALLYING_SCORE,
-//	GAMESTATE_SWOOPING_IN_BUTTONS,
-	GAMESTATE_GAME_OVER_WAITING_FOR_USER_ACTION,
-	GAMESTATE_FADE_OUT_GAME_OVER
-};
+/* Input for g_flappyWorld from any thread. It is applied before each physics step (see Flappy_OnPhysicsStep). */
+struct FlappyCommandQueue* g_commandQueue = NULL;
+#define FLAPPY_COMMAND_QUEUE_CAPACITY 256
 
-int g_gameState = GAMESTATE_TITLE_SCREEN;
-Uint32 g_gameStateCurrentPhaseStartTime = 0;
+/* Holds main_loop to an even frame rate (see Flappy_ConfigureFramePacer). */
+struct FlappyFramePacer* g_framePacer = NULL;
+/* --fps N. 0 means follow the display's refresh rate. */
+static double s_targetFramesPerSecond = 0.0;
+/* --record path in the windowed game. While recording, main_loop steps g_flappyWorld in whole ticks (see Flappy_StepRecordedWorld). */
+static struct FlappyReplay* s_windowedReplay = NULL;
+static const char* s_windowedRecordPath = NULL;
 
 
 struct HighScoreData
@@ -134,104 +126,9 @@ struct HighScoreData
 struct HighScoreData g_highScoreData;
 
 
-
-struct PipeModelData
-{
-	Sint32 intervalScalar;
-	Sint32 viewPositionX;
-	Sint32 realPositionX;
-
-	Sint32 upperViewPositionY;
-	Sint32 upperRealPositionY;
-	Sint32 lowerViewPositionY;
-	Sint32 lowerRealPositionY;
-	
-	Sint32 pipeHeight;
-
-	SDL_Point size;
-	cpBody* upperPhysicsBody;
-	cpShape* upperPhysicsShape;
-
-	cpBody* lowerPhysicsBody;
-	cpShape* lowerPhysicsShape;
-	
-	cpBody* scoreSensorPhysicsBody;
-	cpShape* scoreSensorPhysicsShape;
-	
-};
-
-struct PipeModelData* g_arrayOfPipes = NULL;
-CircularQueueVoid* g_circularQueueOfPipes = NULL;
-CircularQueueVoid* g_queueOfAvailablePipes = NULL;
-
-struct GameInstanceData
-{
-	Uint32 currentScore;
-	Uint32 distanceTraveled;
-	Uint32 diedAtTime;
-	Uint32 needsWhiteOut;
-	SDL_bool isPaused;
-	
-//	Uint32 tallyStartTime;
-	
-};
-
-struct GameInstanceData g_gameInstanceData;
-
-
-cpSpace* g_mainSpace = NULL;
-
-struct BirdModelData
-{
-	cpBody* birdBody;
-	cpShape* birdShape;
-//	SDL_Point viewPosition;
-//	SDL_Point realPosition;
-	SDL_Point size;
-	
-	SDL_Point position;
-	Flappy_FloatPoint velocity;
-	/* For when the bird smacks the pipe and needs to fall */
-	SDL_bool isFalling;
-	SDL_bool isReadyToPlayFallingSound;
-	SDL_bool isDead; /* smacks the pipe or ground */
-	SDL_bool isGameOver; /* bird is completely dead on ground after falling from pipe or smacks ground */
-
-	// TODO: Move to game state
-	SDL_bool isPrelaunch;
-	Uint32 birdLaunchStartTime;
-	SDL_bool isReadyForPipe;
-
-	
-	SDL_Texture* currentTexture;
-	Uint32 animationStartTime;
-	Uint32 animationDuration;
-	SDL_bool isAnimatingSprite;
-	
-};
-
-/*
-struct SpriteAnimationData
-{
-
-};
-*/
-struct BirdModelData g_birdModelData;
-
-struct GroundPhysicsData
-{
-	cpBody* body;
-	cpShape* shape;
-	SDL_Point position;
-
-};
-struct GroundPhysicsData g_groundPhysicsData;
-
-
 struct MedalBackgroundData
 {
 	SDL_Rect dstRect;
-	Uint32 sweepInStartTime;
 	Uint32 tallyStartTime;
 	
 };
@@ -243,7 +140,6 @@ struct GameOverDisplayData
 	SDL_Rect dstRect;
 	int textureWidth;
 	int textureHeight;
-	Uint32 sweepInStartTime;
 };
 struct GameOverDisplayData g_gameOverDisplayData;
 
@@ -276,10 +172,6 @@ struct GuiButton g_guiQuitButton;
 #endif /* FLAPPY_PROVIDE_QUIT_BUTTON */
 
 
-int Flappy_lroundf(float x)
-{
-	return (int)(x+0.5f);
-}
 
 /*
  Produces a random int x, min <= x <= max
@@ -311,76 +203,10 @@ fatalError(const char *string)
 
 
 static int NUM_HAPPY_FACES = 200;    /* number of faces to draw */
-#define MILLESECONDS_PER_FRAME 16 * 1       /* about 60 frames per second */
-//#define MILLESECONDS_PER_FRAME 16 * 2       /* about 30 frames per second */
+/* The frame rate when the display's refresh rate is unknown and --fps isn't given. */
+#define DEFAULT_FRAMES_PER_SECOND 60
 #define HAPPY_FACE_SIZE 32      /* width and height of happyface (pixels) */
 
-//#define SCREEN_WIDTH 480*2
-//#define SCREEN_HEIGHT 320*2
-//#define SCREEN_WIDTH 768
-//#define SCREEN_HEIGHT 1024
-//#define SCREEN_WIDTH 1366
-//#define SCREEN_HEIGHT 768
-//#define SCREEN_WIDTH 1136
-//#define SCREEN_HEIGHT 640
-#define SCREEN_WIDTH 1280
-#define SCREEN_HEIGHT 720
-//#define SCREEN_WIDTH 1024
-//#define SCREEN_HEIGHT 768
-
-
-
-
-/* Measured from iPad mini with ruler */
-//#define GROUND_HEIGHT ((1024/16 * 1.9) * 768 / 1024) = 91.2
-#define GROUND_HEIGHT 30
-
-
-#define BIRD_WIDTH 62
-#define BIRD_HEIGHT 50
-
-const int PIPE_WIDTH = (int)(1.9*(double)BIRD_WIDTH);
-
-/* Distance between pipes:
-	iPad mini: 768 pixels (12cm) across screen,
-	distance between leading pipe edge to next pipe edge: 6.5cm => 416 pixels
- */
-//#define PIPE_DISTANCE 310
-//#define PIPE_DISTANCE 380
-//const int PIPE_DISTANCE = (int)(3.2*(double)BIRD_WIDTH) + PIPE_WIDTH;
-//#define PIPE_DISTANCE (3*BIRD_WIDTH + PIPE_WIDTH + 12);
-//#define PIPE_DISTANCE 400
-#define PIPE_DISTANCE 360
-//#define PIPE_DISTANCE 418
-//#define PIPE_DISTANCE 743
-
-/* About 3.5 Flappy Birds */
-//#define PIPE_HEIGHT_SEPARATION 256
-//#define PIPE_HEIGHT_SEPARATION 192
-const int PIPE_HEIGHT_SEPARATION = (int)(3.5*(double)BIRD_HEIGHT);
-
-/* y from bottom increasing upwards
-   roughly Flappy height?
- */
-//#define MIN_PIPE_HEIGHT 46
-#define MIN_PIPE_HEIGHT BIRD_HEIGHT
-#define NUM_PIPE_HEIGHT_QUANTA 20
-
-#define BIRD_COLLISION_TYPE 1
-#define GROUND_COLLISION_TYPE 2
-#define PIPE_COLLISION_TYPE 3
-#define SCORE_SENSOR_TYPE 4
-
-#define BIRD_FLAP_ANIMATION_DURATION 150
-#define BIRD_FLAP_ANIMATION_DURATION_FOR_PRELAUNCH 1000
-#define PIPE_START_TIME_DELAY 1200
-
-#define TALLY_DURATION 750
-
-#define FADE_OUT_TIME 500
-#define FADE_IN_TIME 500
-
-struct TimeTicker* g_gameClock = NULL;
 
 // See
 // http://sdl.beuc.net/sdl.wiki/SDL_Average_FPS_Measurement
@@ -498,6 +324,8 @@ static float s_lastRecordedFPS = 0.0f;
 static float s_lastDrawnFPS = 0.0f;
 static SDL_Surface* s_surfaceFPS = NULL;
 static SDL_Texture* s_textureFPS = NULL;
+/* Where render() draws the moving things this frame, blended between the last two physics steps. */
+static FlappyWorldRenderState s_renderState;
 
 
 SDL_Texture* g_currentScoreTextTexture;
@@ -529,50 +357,47 @@ struct TextTextureData g_textTextureData;
 
 
 // Used to get the height of the game screen, minus the bird's Y
-Sint32 Flappy_InvertY(Sint32 y)
-{
-	return (SCREEN_HEIGHT-y);
-};
 
 
-void Flappy_PauseGame()
+
+/* Points g_framePacer at the window's display: its refresh rate (unless --fps was given), and whether presenting waits for vsync.
+	The display can change when going to/from fullscreen, so this is called again then.
+ */
+static void Flappy_ConfigureFramePacer(SDL_Window* the_window, SDL_Renderer* the_renderer)
 {
-	if(g_gameInstanceData.isPaused)
+	SDL_RendererInfo renderer_info;
+	SDL_DisplayMode display_mode;
+	int refresh_rate = 0;
+	SDL_bool is_vsync_enabled = SDL_FALSE;
+	int display_index;
+
+	if(NULL == g_framePacer)
 	{
+		return;
 	}
-	else
+	if((NULL != the_renderer) && (0 == SDL_GetRendererInfo(the_renderer, &renderer_info)))
 	{
-		TimeTicker_Stop(g_gameClock);
-		g_gameInstanceData.isPaused = SDL_TRUE;
+		is_vsync_enabled = (renderer_info.flags & SDL_RENDERER_PRESENTVSYNC) ? SDL_TRUE : SDL_FALSE;
 	}
-	
-}
-void Flappy_UnpauseGame()
-{
-	if(g_gameInstanceData.isPaused)
+	display_index = (NULL != the_window) ? SDL_GetWindowDisplayIndex(the_window) : 0;
+	if((display_index >= 0) && (0 == SDL_GetCurrentDisplayMode(display_index, &display_mode)))
 	{
-		TimeTicker_Start(g_gameClock);
-		g_gameInstanceData.isPaused = SDL_FALSE;
+		refresh_rate = display_mode.refresh_rate;
 	}
-	else
+
+	if(s_targetFramesPerSecond > 0.0)
 	{
+		FlappyFramePacer_SetTargetRate(g_framePacer, s_targetFramesPerSecond);
 	}
-	
-}
-
-void Flappy_TogglePause()
-{
-	if(g_gameInstanceData.isPaused)
+	else if(refresh_rate > 0)
 	{
-		TimeTicker_Start(g_gameClock);
-		g_gameInstanceData.isPaused = SDL_FALSE;
+		FlappyFramePacer_SetTargetRate(g_framePacer, (double)refresh_rate);
 	}
 	else
 	{
-		TimeTicker_Stop(g_gameClock);
-		g_gameInstanceData.isPaused = SDL_TRUE;
+		FlappyFramePacer_SetTargetRate(g_framePacer, DEFAULT_FRAMES_PER_SECOND);
 	}
-	
+	FlappyFramePacer_SetVsync(g_framePacer, is_vsync_enabled, refresh_rate);
 }
 
 SDL_bool TemplateHelper_ToggleFullScreen(SDL_Window* the_window, SDL_Renderer* the_renderer)
@@ -589,9 +414,11 @@ SDL_bool TemplateHelper_ToggleFullScreen(SDL_Window* the_window, SDL_Renderer* t
     if((flags & SDL_WINDOW_FULLSCREEN_DESKTOP) != 0)
     {
         SDL_RenderSetLogicalSize(the_renderer, SCREEN_WIDTH, SCREEN_HEIGHT); // TODO: pass renderer as param maybe?
+        Flappy_ConfigureFramePacer(the_window, the_renderer);
         return SDL_TRUE;
     }
     SDL_SetWindowSize(the_window, width, height);
+    Flappy_ConfigureFramePacer(the_window, the_renderer);
     return SDL_TRUE;
 }
 
@@ -898,62 +725,26 @@ SDL_bool Flappy_SaveHighScoreToStorage(Uint32 high_score)
 	
 }
 
-SDL_bool Flappy_SaveHighScoreToStorageIfNeeded()
+SDL_bool Flappy_SaveHighScoreToStorageIfNeeded(struct FlappyWorld* the_world)
 {
 	/* We write to disk, but don't change the in memory value of previousHighScore
 	 	because we need that value for the tally if the game is interrupted/resumed.
 	 */
-	if(g_gameInstanceData.currentScore > g_highScoreData.savedHighScore)
-	{
-		g_highScoreData.savedHighScore = g_gameInstanceData.currentScore;
-		return Flappy_SaveHighScoreToStorage(g_gameInstanceData.currentScore);
-	}
-	return SDL_TRUE;
-}
-
-
-
-MyFloat Flappy_ComputeLinearInterpolation(MyFloat current_value, MyFloat start_value, MyFloat end_value)
-{
-	/* Use the linear interpolation formula:
-	 * X = (1-t)x0 + tx1
-	 * where x0 would be the start value
-	 * and x1 is the final value
-	 * and t is delta_time*inv_time (adjusts 0 <= time <= 1)
-	 * delta_time = current_time-start_time
-	 * inv_time = 1/ (end_time-start_time)
-	 * so t = current_time-start_time / (end_time-start_time)
-	 *
-	 */
-	if(current_value > end_value)
+	/* Headless runs are bots, not the player, so they must not touch the saved record. */
+	if(g_isHeadless)
 	{
-		return 1.0;
+		return SDL_TRUE;
 	}
-	else if(current_value < start_value)
+	if(the_world->gameInstanceData.currentScore > g_highScoreData.savedHighScore)
 	{
-		return 0.0;
+		g_highScoreData.savedHighScore = the_world->gameInstanceData.currentScore;
+		return Flappy_SaveHighScoreToStorage(the_world->gameInstanceData.currentScore);
 	}
-	return (current_value-start_value) / (end_value-start_value);
+	return SDL_TRUE;
 }
 
-void Flappy_StepPhysics(Uint32 delta_time)
-{
-	// Recommended between 60 and 240; higher = more accuracy (but higher CPU load)
-	const MyFloat TICKS_PER_SECOND = 100.0;
-	static MyFloat _accumulator = 0.0;
 
-	MyFloat dt = (MyFloat)delta_time * 1.0/1000.0;
-	MyFloat fixed_dt = 1.0/TICKS_PER_SECOND;
-	
-	// add the current dynamic timestep to the accumulator
-	_accumulator += dt;
-	
-	while(_accumulator > fixed_dt)
-	{
-		cpSpaceStep(g_mainSpace, fixed_dt);
-		_accumulator -= fixed_dt;
-	}
-}
+
 
 
 void Flappy_RenderBackground(SDL_Renderer* the_renderer)
@@ -967,15 +758,15 @@ void Flappy_RenderBackground(SDL_Renderer* the_renderer)
 }
 
 /* Render the bush/hills */
-void Flappy_RenderHills(SDL_Renderer* the_renderer)
+void Flappy_RenderHills(struct FlappyWorld* the_world, SDL_Renderer* the_renderer)
 {
 	
-	SDL_Rect src_rect = {0, 0, g_bushModelData.size.x, g_bushModelData.size.y};
+	SDL_Rect src_rect = {0, 0, the_world->bushModelData.size.x, the_world->bushModelData.size.y};
 	/* The ground height in the image is actually really tall and we don't want all of it.
 	 So we can truncate the bottom part that we don't want.
 	 We'll take 1/5 of the image.
 	 */
-	SDL_Rect dst_rect = {g_bushModelData.position.x, Flappy_InvertY(g_groundModelData.size.y + g_bushModelData.size.y), g_bushModelData.size.x, g_bushModelData.size.y};
+	SDL_Rect dst_rect = {s_renderState.bushPositionX, Flappy_InvertY(the_world->groundModelData.size.y + the_world->bushModelData.size.y), the_world->bushModelData.size.x, the_world->bushModelData.size.y};
 	
 	
 	/* The texture does not fill the whole width of the screen.
@@ -1003,7 +794,7 @@ void Flappy_RenderHills(SDL_Renderer* the_renderer)
 	
 	for(i=0; i<number_of_times_to_repeat_draw; i++)
 	{
-		dst_rect.x = g_bushModelData.position.x + g_bushModelData.size.x * i;
+		dst_rect.x = s_renderState.bushPositionX + the_world->bushModelData.size.x * i;
 		if(dst_rect.x < SCREEN_WIDTH)
 		{
 //			SDL_RenderCopy(renderer, g_gameTextures.bush, &src_rect, &dst_rect);
@@ -1013,7 +804,7 @@ void Flappy_RenderHills(SDL_Renderer* the_renderer)
 }
 
 
-void Flappy_RenderClouds(SDL_Renderer *the_renderer)
+void Flappy_RenderClouds(struct FlappyWorld* the_world, SDL_Renderer *the_renderer)
 {
 	/* Render the clouds.
 	 * Our sprite actually contains multiple clouds, so we'll just render the whole thing.
@@ -1023,9 +814,9 @@ void Flappy_RenderClouds(SDL_Renderer *the_renderer)
 	{
 		
 		
-		SDL_Rect src_rect = {0, 0, g_cloudModelData.size.x, g_cloudModelData.size.y};
+		SDL_Rect src_rect = {0, 0, the_world->cloudModelData.size.x, the_world->cloudModelData.size.y};
 		
-		SDL_Rect dst_rect = {g_cloudModelData.position.x, 0, g_cloudModelData.size.x, g_cloudModelData.size.y};
+		SDL_Rect dst_rect = {s_renderState.cloudPositionX, 0, the_world->cloudModelData.size.x, the_world->cloudModelData.size.y};
 		
 		
 		/* The texture does not fill the whole width of the screen. 
@@ -1052,7 +843,7 @@ void Flappy_RenderClouds(SDL_Renderer *the_renderer)
 		
 		for(i=0; i<number_of_times_to_repeat_draw; i++)
 		{
-			dst_rect.x = g_cloudModelData.position.x + g_cloudModelData.size.x * i;
+			dst_rect.x = s_renderState.cloudPositionX + the_world->cloudModelData.size.x * i;
 			if(dst_rect.x < SCREEN_WIDTH)
 			{
 				//			SDL_RenderCopy(renderer, g_gameTextures.clouds, &src_rect, &dst_rect);
@@ -1064,22 +855,22 @@ void Flappy_RenderClouds(SDL_Renderer *the_renderer)
 }
 
 
-void Flappy_RenderPipes(SDL_Renderer* the_renderer)
+void Flappy_RenderPipes(struct FlappyWorld* the_world, SDL_Renderer* the_renderer)
 {
 	/*
 	Uint32 diff_time = current_time - base_time;
 	Sint32 current_position;
 	Sint32 shift_factor;
 	
-	current_position = g_playerModelData.position.x;
+	current_position = the_world->playerModelData.position.x;
 	
-	shift_factor = SDL_abs(current_position) / g_groundModelData.size.x;
-	g_groundModelData.position.x = (g_groundModelData.size.x * shift_factor) + current_position;
+	shift_factor = SDL_abs(current_position) / the_world->groundModelData.size.x;
+	the_world->groundModelData.position.x = (the_world->groundModelData.size.x * shift_factor) + current_position;
 	
 	
 	PIPE_DISTANCE
 
-	g_playerModelData.position.x
+	the_world->playerModelData.position.x
 	*/
 	
 	
@@ -1095,6 +886,7 @@ void Flappy_RenderPipes(SDL_Renderer* the_renderer)
 	 */
 	Sint32 number_of_times_to_repeat_draw;
 	Sint32 remainder;
+	Sint32 number_of_pipes = (Sint32)FlappyPipeQueue_Size(&the_world->circularQueueOfPipes);
 	Sint32 i;
 	
 	number_of_times_to_repeat_draw = (SCREEN_WIDTH / PIPE_DISTANCE) + 1;
@@ -1104,15 +896,16 @@ void Flappy_RenderPipes(SDL_Renderer* the_renderer)
 		number_of_times_to_repeat_draw = number_of_times_to_repeat_draw + 1;
 	}
 	
-	for(i=0; i<CircularQueueVoid_Size(g_circularQueueOfPipes); i++)
+	for(i=0; i<number_of_pipes; i++)
 	{
 
-//			dst_rect.x = g_pipeTopModelData.position.x + PIPE_DISTANCE * i;
-		struct PipeModelData* current_pipe = (struct PipeModelData*)CircularQueueVoid_ValueAtIndex(g_circularQueueOfPipes, i);
-		SDL_Rect src_rect = {0, 0, g_pipeTopModelData.size.x, current_pipe->pipeHeight};
-		SDL_Rect dst_rect = {g_pipeTopModelData.position.x, current_pipe->lowerViewPositionY, g_pipeTopModelData.size.x, current_pipe->pipeHeight};
+//			dst_rect.x = the_world->pipeTopModelData.position.x + PIPE_DISTANCE * i;
+		struct PipeModelData* current_pipe = *FlappyPipeQueue_AtIndex(&the_world->circularQueueOfPipes, i);
+		SDL_Rect src_rect = {0, 0, the_world->pipeTopModelData.size.x, current_pipe->pipeHeight};
+		SDL_Rect dst_rect = {the_world->pipeTopModelData.position.x, current_pipe->lowerViewPositionY, the_world->pipeTopModelData.size.x, current_pipe->pipeHeight};
 
-		dst_rect.x = current_pipe->viewPositionX -  g_pipeTopModelData.size.x/2;
+		/* Not viewPositionX, which only moves on updates. */
+		dst_rect.x = current_pipe->realPositionX - s_renderState.pipeCameraPositionX - the_world->pipeTopModelData.size.x/2;
 //			dst_rect.y = Flappy_InvertY(current_pipe->pipeHeight+GROUND_HEIGHT);
 
 		SDL_RenderCopy(the_renderer, g_gameTextures.pipe_bottom, &src_rect, &dst_rect);
@@ -1135,34 +928,34 @@ void Flappy_RenderPipes(SDL_Renderer* the_renderer)
 	}
 }
 
-void Flappy_RenderBird(SDL_Renderer* the_renderer)
+void Flappy_RenderBird(struct FlappyWorld* the_world, SDL_Renderer* the_renderer)
 {
 	/* render bird */
 
-	SDL_Rect src_rect = {0, 0, g_birdModelData.size.x, g_birdModelData.size.y};
+	SDL_Rect src_rect = {0, 0, the_world->birdModelData.size.x, the_world->birdModelData.size.y};
 	/* The ground height in the image is actually really tall and we don't want all of it.
 	 So we can truncate the bottom part that we don't want.
 	 We'll take 1/5 of the image.
 	 */
-	SDL_Rect dst_rect = {g_birdModelData.position.x - g_birdModelData.size.x/2, g_birdModelData.position.y, g_birdModelData.size.x, g_birdModelData.size.y};
+	SDL_Rect dst_rect = {the_world->birdModelData.position.x - the_world->birdModelData.size.x/2, s_renderState.birdViewPositionY, the_world->birdModelData.size.x, the_world->birdModelData.size.y};
 	
 	
 	
 	//		SDL_RenderCopy(renderer, g_gameTextures.fly1, NULL, &dst_rect);
-	SDL_RenderCopyEx(the_renderer, g_birdModelData.currentTexture, NULL, &dst_rect, -cpBodyGetAngle(g_birdModelData.birdBody)/(2.0*M_PI/360.0), NULL, SDL_FLIP_NONE);
+	SDL_RenderCopyEx(the_renderer, g_gameTextures.bird[the_world->birdModelData.currentFrame], NULL, &dst_rect, -s_renderState.birdAngle/(2.0*M_PI/360.0), NULL, SDL_FLIP_NONE);
 }
 
 /* render ground */
-void Flappy_RenderGround(SDL_Renderer* the_renderer)
+void Flappy_RenderGround(struct FlappyWorld* the_world, SDL_Renderer* the_renderer)
 {
 	
 	
-	SDL_Rect src_rect = {0, 0, g_groundModelData.size.x, g_groundModelData.size.y};
+	SDL_Rect src_rect = {0, 0, the_world->groundModelData.size.x, the_world->groundModelData.size.y};
 	/* The ground height in the image is actually really tall and we don't want all of it.
 	 So we can truncate the bottom part that we don't want.
 	 We'll take 1/5 of the image.
 	 */
-	SDL_Rect dst_rect = {g_groundModelData.position.x, Flappy_InvertY(g_groundModelData.size.y), g_groundModelData.size.x, g_groundModelData.size.y};
+	SDL_Rect dst_rect = {s_renderState.groundPositionX, Flappy_InvertY(the_world->groundModelData.size.y), the_world->groundModelData.size.x, the_world->groundModelData.size.y};
 	
 	
 	/* The texture does not fill the whole width of the screen.
@@ -1189,7 +982,7 @@ void Flappy_RenderGround(SDL_Renderer* the_renderer)
 	
 	for(i=0; i<number_of_times_to_repeat_draw; i++)
 	{
-		dst_rect.x = g_groundModelData.position.x + g_groundModelData.size.x * i;
+		dst_rect.x = s_renderState.groundPositionX + the_world->groundModelData.size.x * i;
 		if(dst_rect.x < SCREEN_WIDTH)
 		{
 			SDL_RenderCopy(the_renderer, g_gameTextures.ground, &src_rect, &dst_rect);
@@ -1199,9 +992,9 @@ void Flappy_RenderGround(SDL_Renderer* the_renderer)
 	
 }
 
-void Flappy_RenderCurrentScore(SDL_Renderer *the_renderer)
+void Flappy_RenderCurrentScore(struct FlappyWorld* the_world, SDL_Renderer *the_renderer)
 {
-	if((g_gameState >= GAMESTATE_BIRD_PRELAUNCH) && (g_gameState < GAMESTATE_SWOOPING_IN_GAME_OVER))
+	if((the_world->gameState >= GAMESTATE_BIRD_PRELAUNCH) && (the_world->gameState < GAMESTATE_SWOOPING_IN_GAME_OVER))
 	{
 		/* render current score */
 		
@@ -1253,10 +1046,10 @@ void Flappy_RenderCurrentScore(SDL_Renderer *the_renderer)
 	}
 }
 
-void Flappy_RenderGameOverText(SDL_Renderer *the_renderer)
+void Flappy_RenderGameOverText(struct FlappyWorld* the_world, SDL_Renderer *the_renderer)
 {
-	if(g_gameState >= GAMESTATE_SWOOPING_IN_GAME_OVER)
-		//		if(SDL_TRUE == g_birdModelData.isGameOver)
+	if(the_world->gameState >= GAMESTATE_SWOOPING_IN_GAME_OVER)
+		//		if(SDL_TRUE == the_world->birdModelData.isGameOver)
 	{
 
 
@@ -1265,10 +1058,10 @@ void Flappy_RenderGameOverText(SDL_Renderer *the_renderer)
 	}
 }
 
-void Flappy_RenderMedalScene(SDL_Renderer *the_renderer)
+void Flappy_RenderMedalScene(struct FlappyWorld* the_world, SDL_Renderer *the_renderer)
 {
-	if(g_gameState >= GAMESTATE_SWOOPING_IN_MEDAL_DISPLAY)
-		//		if(SDL_TRUE == g_birdModelData.isGameOver)
+	if(the_world->gameState >= GAMESTATE_SWOOPING_IN_MEDAL_DISPLAY)
+		//		if(SDL_TRUE == the_world->birdModelData.isGameOver)
 	{
 		
 		
@@ -1279,10 +1072,10 @@ void Flappy_RenderMedalScene(SDL_Renderer *the_renderer)
 	}
 }
 
-void Flappy_RenderGetReadyText(SDL_Renderer *the_renderer)
+void Flappy_RenderGetReadyText(struct FlappyWorld* the_world, SDL_Renderer *the_renderer)
 {
-	//        if(g_birdModelData.isPrelaunch)
-	if((g_gameState >= GAMESTATE_LOADING_NEW_GAME_AND_FADE_IN) && (g_gameState <= GAMESTATE_BIRD_LAUNCHED_BUT_BEFORE_PIPES))
+	//        if(the_world->birdModelData.isPrelaunch)
+	if((the_world->gameState >= GAMESTATE_LOADING_NEW_GAME_AND_FADE_IN) && (the_world->gameState <= GAMESTATE_BIRD_LAUNCHED_BUT_BEFORE_PIPES))
 	{
 		SDL_Rect dst_rect = {0, 0, 512, 256 };
 		Uint32 the_format;
@@ -1298,12 +1091,12 @@ void Flappy_RenderGetReadyText(SDL_Renderer *the_renderer)
 		dst_rect.y = SCREEN_HEIGHT / 5;
 		
 		
-		if(g_gameState == GAMESTATE_BIRD_LAUNCHED_BUT_BEFORE_PIPES)
+		if(the_world->gameState == GAMESTATE_BIRD_LAUNCHED_BUT_BEFORE_PIPES)
 		{
 			MyFloat linear_interp;
-			Uint32 current_time = TimeTicker_GetTime(g_gameClock);
+			Uint32 current_time = TimeTicker_GetTime(the_world->gameClock);
 #define GET_READY_TEXT_FADE_OUT_TIME 1000
-			linear_interp = Flappy_ComputeLinearInterpolation(current_time, g_gameStateCurrentPhaseStartTime, g_gameStateCurrentPhaseStartTime + GET_READY_TEXT_FADE_OUT_TIME);
+			linear_interp = Flappy_ComputeLinearInterpolation(current_time, the_world->gameStateCurrentPhaseStartTime, the_world->gameStateCurrentPhaseStartTime + GET_READY_TEXT_FADE_OUT_TIME);
 			Uint8 alpha = 255 - linear_interp*255;
 			
 			SDL_SetTextureAlphaMod(g_textTextureData.getReadyTextTexture, alpha);
@@ -1320,9 +1113,9 @@ void Flappy_RenderGetReadyText(SDL_Renderer *the_renderer)
 }
 
 /* Note: This draws both "FlappyBlurrr" and the tagline text below it. */
-void Flappy_RenderTitleScreenText(SDL_Renderer* the_renderer)
+void Flappy_RenderTitleScreenText(struct FlappyWorld* the_world, SDL_Renderer* the_renderer)
 {
-	if( (g_gameState >= GAMESTATE_TITLE_SCREEN) && (g_gameState <= GAMESTATE_FADE_OUT_TITLE_SCREEN) )
+	if( (the_world->gameState >= GAMESTATE_TITLE_SCREEN) && (the_world->gameState <= GAMESTATE_FADE_OUT_TITLE_SCREEN) )
 	{
 		SDL_Rect dst_rect = {0, 0, 512, 256 };
 		Uint32 the_format;
@@ -1361,10 +1154,10 @@ void Flappy_RenderTitleScreenText(SDL_Renderer* the_renderer)
 }
 
 /* Renders the play button and quit button as necessary */
-void Flappy_RenderGuiButtons(SDL_Renderer* the_renderer)
+void Flappy_RenderGuiButtons(struct FlappyWorld* the_world, SDL_Renderer* the_renderer)
 {
-	if( ((g_gameState >= GAMESTATE_GAME_OVER_WAITING_FOR_USER_ACTION) && (g_gameState <= GAMESTATE_FADE_OUT_GAME_OVER) )
-	   || ((g_gameState >= GAMESTATE_TITLE_SCREEN) && (g_gameState <= GAMESTATE_FADE_OUT_TITLE_SCREEN) )
+	if( ((the_world->gameState >= GAMESTATE_GAME_OVER_WAITING_FOR_USER_ACTION) && (the_world->gameState <= GAMESTATE_FADE_OUT_GAME_OVER) )
+	   || ((the_world->gameState >= GAMESTATE_TITLE_SCREEN) && (the_world->gameState <= GAMESTATE_FADE_OUT_TITLE_SCREEN) )
 	   )
 	{
 		SDL_Rect dst_rect;
@@ -1416,20 +1209,20 @@ void Flappy_RenderGuiButtons(SDL_Renderer* the_renderer)
 }
 
 
-void Flappy_RenderWhiteImpactFlash(SDL_Renderer* the_renderer)
+void Flappy_RenderWhiteImpactFlash(struct FlappyWorld* the_world, SDL_Renderer* the_renderer)
 
 {
-	if(g_gameInstanceData.needsWhiteOut == SDL_TRUE)
+	if(the_world->gameInstanceData.needsWhiteOut == SDL_TRUE)
 	{
-		Uint32 current_time = TimeTicker_GetTime(g_gameClock);
+		Uint32 current_time = TimeTicker_GetTime(the_world->gameClock);
 		float linear_interp;
 		SDL_Rect dst_rect = {0, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
 		
 #define WHITE_OUT_TIME 200
-		if(current_time > (g_gameInstanceData.diedAtTime + WHITE_OUT_TIME))
+		if(current_time > (the_world->gameInstanceData.diedAtTime + WHITE_OUT_TIME))
 		{
 			// FIXME: this needs to be moved/deleted. For testing only.
-			g_gameInstanceData.needsWhiteOut = SDL_FALSE;
+			the_world->gameInstanceData.needsWhiteOut = SDL_FALSE;
 			
 			
 		}
@@ -1445,7 +1238,7 @@ void Flappy_RenderWhiteImpactFlash(SDL_Renderer* the_renderer)
 			 * so t = current_time-start_time / (end_time-start_time)
 			 *
 			 */
-			linear_interp = Flappy_ComputeLinearInterpolation(current_time, g_gameInstanceData.diedAtTime, g_gameInstanceData.diedAtTime+WHITE_OUT_TIME);
+			linear_interp = Flappy_ComputeLinearInterpolation(current_time, the_world->gameInstanceData.diedAtTime, the_world->gameInstanceData.diedAtTime+WHITE_OUT_TIME);
 			Uint8 alpha = 255 - linear_interp*255;
 			SDL_SetRenderDrawBlendMode(the_renderer, SDL_BLENDMODE_BLEND);
 			SDL_SetRenderDrawColor(the_renderer, 255, 255, 255, alpha);
@@ -1457,18 +1250,18 @@ void Flappy_RenderWhiteImpactFlash(SDL_Renderer* the_renderer)
 }
 
 
-void Flappy_RenderFadeOut(SDL_Renderer* the_renderer)
+void Flappy_RenderFadeOut(struct FlappyWorld* the_world, SDL_Renderer* the_renderer)
 /* Render black fade-out */
 {
-	if((GAMESTATE_FADE_OUT_GAME_OVER == g_gameState)
-				|| (GAMESTATE_FADE_OUT_TITLE_SCREEN == g_gameState)
+	if((GAMESTATE_FADE_OUT_GAME_OVER == the_world->gameState)
+				|| (GAMESTATE_FADE_OUT_TITLE_SCREEN == the_world->gameState)
 	   )
 	{
-		Uint32 current_time = TimeTicker_GetTime(g_gameClock);
+		Uint32 current_time = TimeTicker_GetTime(the_world->gameClock);
 		float linear_interp;
 		SDL_Rect dst_rect = {0, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
 		
-		if(current_time > (g_gameStateCurrentPhaseStartTime + FADE_OUT_TIME))
+		if(current_time > (the_world->gameStateCurrentPhaseStartTime + FADE_OUT_TIME))
 		{
 			
 			SDL_SetRenderDrawBlendMode(the_renderer, SDL_BLENDMODE_BLEND);
@@ -1488,7 +1281,7 @@ void Flappy_RenderFadeOut(SDL_Renderer* the_renderer)
 			 * so t = current_time-start_time / (end_time-start_time)
 			 *
 			 */
-			linear_interp = Flappy_ComputeLinearInterpolation(current_time, g_gameStateCurrentPhaseStartTime, g_gameStateCurrentPhaseStartTime+FADE_OUT_TIME);
+			linear_interp = Flappy_ComputeLinearInterpolation(current_time, the_world->gameStateCurrentPhaseStartTime, the_world->gameStateCurrentPhaseStartTime+FADE_OUT_TIME);
 			Uint8 alpha = linear_interp*255;
 			SDL_SetRenderDrawBlendMode(the_renderer, SDL_BLENDMODE_BLEND);
 			SDL_SetRenderDrawColor(the_renderer, 0, 0, 0, alpha);
@@ -1499,17 +1292,17 @@ void Flappy_RenderFadeOut(SDL_Renderer* the_renderer)
 	}
 }
 
-void Flappy_RenderFadeIn(SDL_Renderer* the_renderer)
+void Flappy_RenderFadeIn(struct FlappyWorld* the_world, SDL_Renderer* the_renderer)
 
 /* Render black fade-in */
 {
-	if(GAMESTATE_LOADING_NEW_GAME_AND_FADE_IN == g_gameState)
+	if(GAMESTATE_LOADING_NEW_GAME_AND_FADE_IN == the_world->gameState)
 	{
-		Uint32 current_time = TimeTicker_GetTime(g_gameClock);
+		Uint32 current_time = TimeTicker_GetTime(the_world->gameClock);
 		float linear_interp;
 		SDL_Rect dst_rect = {0, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
 		
-		if(current_time > (g_gameStateCurrentPhaseStartTime + FADE_IN_TIME))
+		if(current_time > (the_world->gameStateCurrentPhaseStartTime + FADE_IN_TIME))
 		{
 			
 			SDL_SetRenderDrawBlendMode(the_renderer, SDL_BLENDMODE_BLEND);
@@ -1529,7 +1322,7 @@ void Flappy_RenderFadeIn(SDL_Renderer* the_renderer)
 			 * so t = current_time-start_time / (end_time-start_time)
 			 *
 			 */
-			linear_interp = Flappy_ComputeLinearInterpolation(current_time, g_gameStateCurrentPhaseStartTime, g_gameStateCurrentPhaseStartTime+FADE_IN_TIME);
+			linear_interp = Flappy_ComputeLinearInterpolation(current_time, the_world->gameStateCurrentPhaseStartTime, the_world->gameStateCurrentPhaseStartTime+FADE_IN_TIME);
 			Uint8 alpha = 255 - linear_interp*255;
 			SDL_SetRenderDrawBlendMode(the_renderer, SDL_BLENDMODE_BLEND);
 			SDL_SetRenderDrawColor(the_renderer, 0, 0, 0, alpha);
@@ -1569,7 +1362,7 @@ void TemplateHelper_RenderFPS(SDL_Renderer* the_renderer)
 	}
 }
 
-void render(SDL_Renderer* the_renderer)
+void render(struct FlappyWorld* the_world, SDL_Renderer* the_renderer)
 {
 	
  
@@ -1577,18 +1370,20 @@ void render(SDL_Renderer* the_renderer)
     SDL_SetRenderDrawColor(the_renderer, 0, 0, 0, 255);
     SDL_RenderClear(the_renderer);
 
+	/* The physics may step slower than we draw, so draw in between the last two steps instead of where the last one left things. */
+	FlappyWorld_GetInterpolatedRenderState(the_world, FlappyWorld_GetInterpolationAlpha(the_world), &s_renderState);
 
 	Flappy_RenderBackground(the_renderer);
-	Flappy_RenderHills(the_renderer);
-	Flappy_RenderClouds(the_renderer);
-	Flappy_RenderPipes(the_renderer);
+	Flappy_RenderHills(the_world, the_renderer);
+	Flappy_RenderClouds(the_world, the_renderer);
+	Flappy_RenderPipes(the_world, the_renderer);
 
-	Flappy_RenderBird(the_renderer);
+	Flappy_RenderBird(the_world, the_renderer);
 	
 	/* Note that when Flappy does a face-plant, its beak is obscured by the ground.
 		This means the ground gets rendered after the bird.
 	*/
-	Flappy_RenderGround(the_renderer);
+	Flappy_RenderGround(the_world, the_renderer);
 	
 
 	
@@ -1596,24 +1391,24 @@ void render(SDL_Renderer* the_renderer)
 #if 0
 	{
 		
-		SDL_Rect src_rect = {0, 0, g_birdModelData.size.x, g_birdModelData.size.y};
+		SDL_Rect src_rect = {0, 0, the_world->birdModelData.size.x, the_world->birdModelData.size.y};
 		/* The ground height in the image is actually really tall and we don't want all of it.
 		 So we can truncate the bottom part that we don't want.
 		 We'll take 1/5 of the image.
 		 */
-		SDL_Rect dst_rect = {0, g_birdModelData.position.y, g_birdModelData.size.x, g_birdModelData.size.y};
+		SDL_Rect dst_rect = {0, the_world->birdModelData.position.y, the_world->birdModelData.size.x, the_world->birdModelData.size.y};
 		
-		for(i=0; i<=SCREEN_HEIGHT; i+=g_birdModelData.size.y)
+		for(i=0; i<=SCREEN_HEIGHT; i+=the_world->birdModelData.size.y)
 		{
-			dst_rect.y = Flappy_InvertY(0 + g_birdModelData.size.y + i);
+			dst_rect.y = Flappy_InvertY(0 + the_world->birdModelData.size.y + i);
 		
 		
 			SDL_RenderCopy(renderer, g_gameTextures.bird[1], NULL, &dst_rect);
 		}
-		for(i=0; i<=SCREEN_WIDTH; i+=g_birdModelData.size.x)
+		for(i=0; i<=SCREEN_WIDTH; i+=the_world->birdModelData.size.x)
 		{
-			dst_rect.x = g_birdModelData.size.x + i;
-			dst_rect.y = Flappy_InvertY(0) - g_birdModelData.size.y;
+			dst_rect.x = the_world->birdModelData.size.x + i;
+			dst_rect.y = Flappy_InvertY(0) - the_world->birdModelData.size.y;
 
 			
 			SDL_RenderCopy(renderer, g_gameTextures.bird[1], NULL, &dst_rect);
@@ -1621,26 +1416,26 @@ void render(SDL_Renderer* the_renderer)
 	}
 #endif
 
-	Flappy_RenderCurrentScore(the_renderer);
+	Flappy_RenderCurrentScore(the_world, the_renderer);
 
-	Flappy_RenderGameOverText(the_renderer);
+	Flappy_RenderGameOverText(the_world, the_renderer);
 	
 	// TODO: This draws the final composited texture, not the render to texture part.
-	Flappy_RenderMedalScene(the_renderer);
+	Flappy_RenderMedalScene(the_world, the_renderer);
 	
 
-	Flappy_RenderGetReadyText(the_renderer);
+	Flappy_RenderGetReadyText(the_world, the_renderer);
 
 	/* Note: This draws both "FlappyBlurrr" and the tagline text below it. */
-	Flappy_RenderTitleScreenText(the_renderer);
+	Flappy_RenderTitleScreenText(the_world, the_renderer);
 
 	/* Renders the play button and quit button as necessary */
-	Flappy_RenderGuiButtons(the_renderer);
+	Flappy_RenderGuiButtons(the_world, the_renderer);
 	
-	Flappy_RenderWhiteImpactFlash(the_renderer);
+	Flappy_RenderWhiteImpactFlash(the_world, the_renderer);
 	
-	Flappy_RenderFadeOut(the_renderer);
-	Flappy_RenderFadeIn(the_renderer);
+	Flappy_RenderFadeOut(the_world, the_renderer);
+	Flappy_RenderFadeIn(the_world, the_renderer);
 
 
 	
@@ -1648,892 +1443,158 @@ void render(SDL_Renderer* the_renderer)
 	// Disable this to stop drawing fps counter
 	TemplateHelper_RenderFPS(the_renderer);
 
-    /* update screen */
-    SDL_RenderPresent(the_renderer);
-	
-}
-
-//#define GROUND_VELOCITY_X -SCREEN_WIDTH / 5000.0f
-// Original flappy seems to move across at about 3 seconds on 768 pixels (iPad)
-//#define GROUND_VELOCITY_X -768 / 3000.0f
-#define GROUND_VELOCITY_X -768.0 / 2800.0
-#define BIRD_VELOCITY_X -1*GROUND_VELOCITY_X
-
-//#define BUSH_VELOCITY_X -SCREEN_WIDTH / 200000.0f
-#define BUSH_VELOCITY_X -SCREEN_WIDTH / 80000.0f
-#define CLOUD_VELOCITY_X -SCREEN_WIDTH / 20000.0f
-
-#define MAX_NUM_PIPES_REMAINDER SCREEN_WIDTH % PIPE_DISTANCE
-#if MAX_NUM_PIPES_REMAINDER
-	#define MAX_NUM_PIPES SCREEN_WIDTH / PIPE_DISTANCE + 2
-#else
-	#define MAX_NUM_PIPES SCREEN_WIDTH / PIPE_DISTANCE + 1
-#endif
-static void Flappy_InitializeCloudModelData(SDL_Texture* the_texture)
-{
-	Uint32 the_format;
-	int the_access;
-	int the_width;
-	int the_height;
-	
-	SDL_zero(g_cloudModelData);
-	SDL_QueryTexture(the_texture, &the_format, &the_access, &the_width, &the_height);
-	
-	// 960 / 5000 msec = .192
-	g_cloudModelData.velocity.x = CLOUD_VELOCITY_X;
-	g_cloudModelData.size.x = the_width;
-	g_cloudModelData.size.y = the_height;
+	/* main_loop presents the frame once the frame pacer says it is due. */
 }
 
-static void Flappy_UpdateCloudPositions(Uint32 delta_time, Uint32 base_time, Uint32 current_time)
-{
-	Uint32 diff_time = current_time - base_time;
-	Sint32 current_position;
-	Sint32 shift_factor;
-
-//	g_cloudModelData.position.x = Flappy_lroundf((MyFloat)g_cloudModelData.position.x + g_cloudModelData.velocity.x * (MyFloat)delta_time);
-	current_position = Flappy_lroundf(g_cloudModelData.velocity.x * (MyFloat)diff_time);
-
-	shift_factor = SDL_abs(current_position) / g_cloudModelData.size.x;
-	g_cloudModelData.position.x = (g_cloudModelData.size.x * shift_factor) + current_position;
-	/*
-	if(g_cloudModelData.position.x < (0 - g_cloudModelData.size.x))
-	{
-		g_cloudModelData.position.x = g_cloudModelData.position.x + g_cloudModelData.size.x;
-	}
-	 */
-}
 
 
 
+SDL_Texture* Flappy_CreateGameOverTexture(void);
 
-static void Flappy_InitializeGroundModelData(SDL_Texture* the_texture)
+static void Flappy_InitializeGameOverDisplayData()
 {
-	/*
 	Uint32 the_format;
 	int the_access;
 	int the_width;
 	int the_height;
-	*/
+	SDL_Texture* the_texture;
 	
-	SDL_zero(g_playerModelData);
-	SDL_zero(g_groundModelData);
-//	SDL_QueryTexture(the_texture, &the_format, &the_access, &the_width, &the_height);
+	SDL_zero(g_gameOverDisplayData);
+	the_texture = Flappy_CreateGameOverTexture();
+	
+	SDL_QueryTexture(the_texture, &the_format, &the_access, &the_width, &the_height);
+	g_gameOverDisplayData.textureWidth = the_width;
+	g_gameOverDisplayData.textureHeight = the_height;
+	
+	// Midpoint of the screen, then subtract the midpoint of the texture
+	g_gameOverDisplayData.dstRect.x = (SCREEN_WIDTH/2) - (the_width/2);
+	// This isn't exactly dead center because Game Over and buttons need to be on screen
+//	g_gameOverDisplayData.dstRect.y = (SCREEN_HEIGHT/3) - (the_height/2);
+//	g_gameOverDisplayData.dstRect.y = (SCREEN_HEIGHT/3) - (the_height/2);
+	g_gameOverDisplayData.dstRect.w = the_width;
+	g_gameOverDisplayData.dstRect.h = the_height;
 	
-	// 960 / 5000 msec = .192
-	g_groundModelData.velocity.x = GROUND_VELOCITY_X;
-//	g_groundModelData.velocity.x = -0.1f;
-	g_groundModelData.size.x = SCREEN_WIDTH;
-	/* The ground height in the image is actually really tall and we don't want all of it.
-	 So we can truncate the bottom part that we don't want.
-	 We'll take 1/5 of the image.
-	 */
-	g_groundModelData.size.y = GROUND_HEIGHT;
 	
-
 }
 
-static void Flappy_UpdateGroundPosition(Uint32 delta_time, Uint32 base_time, Uint32 current_time)
+static void Flappy_UpdateGameOverDisplayData(struct FlappyWorld* the_world, Uint32 delta_time, Uint32 base_time, Uint32 current_time)
 {
-	/*
-	g_groundModelData.position.x = Flappy_lroundf((MyFloat)g_groundModelData.position.x + g_groundModelData.velocity.x * (MyFloat)delta_time);
-	if(g_groundModelData.position.x < (0 - g_groundModelData.size.x))
+	
+	if( ! the_world->birdModelData.isGameOver)
 	{
-		g_groundModelData.position.x = g_groundModelData.position.x + g_groundModelData.size.x;
+		return;
 	}
-	*/
-	
-	Uint32 diff_time = current_time - base_time;
-	Sint32 current_position;
-	Sint32 shift_factor;
 	
-	current_position = Flappy_lroundf(g_groundModelData.velocity.x * (MyFloat)diff_time);
 	
-	shift_factor = SDL_abs(current_position) / g_groundModelData.size.x;
-	g_groundModelData.position.x = (g_groundModelData.size.x * shift_factor) + current_position;
+	if(GAMESTATE_SWOOPING_IN_GAME_OVER == the_world->gameState)
+	{
+#define GAME_OVER_BOUNCE_HEIGHT 40
+		MyFloat linear_interp;
+		int displayed_score;
+		int lower_target_y = (SCREEN_HEIGHT / 4) - (g_gameOverDisplayData.textureHeight/2) - 40;
+		int upper_target_y = lower_target_y - GAME_OVER_BOUNCE_HEIGHT;
 
-	
-	g_playerModelData.position.x = current_position;
-	
-	
-	
-	
-	// physics
+		if(current_time < (the_world->gameOverSweepInStartTime + (SWEEP_IN_GAME_OVER_DURATION/2)))
+		{
+			linear_interp = Flappy_ComputeLinearInterpolation(current_time, the_world->gameOverSweepInStartTime, the_world->gameOverSweepInStartTime + (SWEEP_IN_GAME_OVER_DURATION/2));
+			// X = (1-t)x0 + tx1
+			g_gameOverDisplayData.dstRect.y = ((1.0-linear_interp) * lower_target_y) + (linear_interp * (MyFloat)(upper_target_y));
 
-	{
+		}
+		else if(current_time < (the_world->gameOverSweepInStartTime + (SWEEP_IN_GAME_OVER_DURATION)))
+		{
+			linear_interp = Flappy_ComputeLinearInterpolation(current_time, the_world->gameOverSweepInStartTime + (SWEEP_IN_GAME_OVER_DURATION/2), the_world->gameOverSweepInStartTime + (SWEEP_IN_GAME_OVER_DURATION));
+			// X = (1-t)x0 + tx1
+			g_gameOverDisplayData.dstRect.y = ((1.0-linear_interp) * upper_target_y) + (linear_interp * (MyFloat)(lower_target_y));
+					
+		}
+		else
+		{
+			g_gameOverDisplayData.dstRect.y = lower_target_y;
+		}
 		
-		//cpFloat ground_height = (1024/16 * 1.9) * 768 / 1024;
 		
-	current_position = Flappy_lroundf(g_birdModelData.velocity.x * (MyFloat)diff_time);
-
-	
-
-
-		cpBodySetPosition(g_groundPhysicsData.body, cpv(current_position + SCREEN_WIDTH/2, GROUND_HEIGHT/2.0));
-//		cpBodySetPosition(g_groundPhysicsData.body, cpv(current_position + SCREEN_WIDTH/2, GROUND_HEIGHT));
-//	cpBodySetPosition(g_groundPhysicsData.body, cpv(current_position + SCREEN_WIDTH/2, 0));
-		cpSpaceReindexShape(g_mainSpace, g_groundPhysicsData.shape);
-//		SDL_Log("current_bird pos:%f, %d\n", g_birdModelData.birdBody->p.x, current_position);
 	}
+	
 }
 
 
-static void Flappy_InitializeBushModelData(SDL_Texture* the_texture)
+static void Flappy_InitializeMedalBackgroundData(SDL_Texture* the_texture)
 {
 	Uint32 the_format;
 	int the_access;
 	int the_width;
 	int the_height;
 	
-	SDL_zero(g_bushModelData);
+	SDL_zero(g_medalBackgroundData);
 	SDL_QueryTexture(the_texture, &the_format, &the_access, &the_width, &the_height);
 	
-	// 960 / 5000 msec = .192
-	g_bushModelData.velocity.x = BUSH_VELOCITY_X;
-	g_bushModelData.size.x = the_width;
-	g_bushModelData.size.y = the_height;
-}
-
-static void Flappy_UpdateBushPositions(Uint32 delta_time, Uint32 base_time, Uint32 current_time)
-{
-	Uint32 diff_time = current_time - base_time;
-	Sint32 current_position;
-	Sint32 shift_factor;
-	
-	//	g_cloudModelData.position.x = Flappy_lroundf((MyFloat)g_cloudModelData.position.x + g_cloudModelData.velocity.x * (MyFloat)delta_time);
-	current_position = Flappy_lroundf(g_bushModelData.velocity.x * (MyFloat)diff_time);
+	// Midpoint of the screen, then subtract the midpoint of the texture
+	g_medalBackgroundData.dstRect.x = (SCREEN_WIDTH/2) - (the_width/2);
+	// This isn't exactly dead center because Game Over and buttons need to be on screen
+	g_medalBackgroundData.dstRect.y = (SCREEN_HEIGHT/2) - (the_height/2);
+	g_medalBackgroundData.dstRect.w = the_width;
 	
-	shift_factor = SDL_abs(current_position) / g_bushModelData.size.x;
-	g_bushModelData.position.x = (g_bushModelData.size.x * shift_factor) + current_position;
-	/*
-	 if(g_cloudModelData.position.x < (0 - g_cloudModelData.size.x))
-	 {
-	 g_cloudModelData.position.x = g_cloudModelData.position.x + g_cloudModelData.size.x;
-	 }
-	 */
-}
-
-
-// Intializes both the top and bottom. Assumes the pipe textures are the sime width/height so either may be passed in
-static void Flappy_InitializePipeModelData(SDL_Texture* the_texture)
-{
-	Uint32 the_format;
-	int the_access;
-	int the_width;
-	int the_height;
+	g_medalBackgroundData.dstRect.h = the_height;
 	
-	Sint32 i;
-
-	SDL_zero(g_pipeTopModelData);
-	SDL_zero(g_pipeBottomModelData);
-	SDL_QueryTexture(the_texture, &the_format, &the_access, &the_width, &the_height);
 	
-	// 960 / 5000 msec = .192
-	g_pipeTopModelData.velocity.x = GROUND_VELOCITY_X;
-	g_pipeBottomModelData.velocity.x = GROUND_VELOCITY_X;
-	//	g_groundModelData.velocity.x = -0.1f;
+	/* Create texture for render-to-texture */
+    g_gameTextures.medalSceneRenderToTexture = SDL_CreateTexture(g_mainRenderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, the_width, the_height);
+	SDL_assert(NULL != g_gameTextures.medalSceneRenderToTexture);
+	SDL_SetTextureBlendMode(g_gameTextures.medalSceneRenderToTexture, SDL_BLENDMODE_BLEND);
 	
-	g_pipeTopModelData.size.x = the_width;
-	g_pipeBottomModelData.size.x = the_width;
-//#define PIPE_WIDTH 170
-//#define PIPE_WIDTH 106
-//#define PIPE_WIDTH 140
-//#define PIPE_WIDTH 249
-	g_pipeTopModelData.size.x = PIPE_WIDTH;
-	g_pipeBottomModelData.size.x = PIPE_WIDTH;
+	g_textTextureData.scoreLabelTextTexture = NULL;
+	g_textTextureData.bestLabelTextTexture = NULL;
+	g_textTextureData.newHighScoreLabelTextTexture = NULL;
+	g_textTextureData.bestNumberTextTexture = NULL;
 
-	/* The ground height in the image is actually really tall and we don't want all of it.
-	 So we can truncate the bottom part that we don't want.
-	 We'll take 1/5 of the image.
-	 */
-	g_pipeTopModelData.size.y = the_height;
-	g_pipeBottomModelData.size.y = the_height;
 	
-	
-	
-	g_arrayOfPipes = (struct PipeModelData*)SDL_calloc(MAX_NUM_PIPES, sizeof(struct PipeModelData));
-	g_circularQueueOfPipes = CircularQueueVoid_CreateQueue(MAX_NUM_PIPES);
-	g_queueOfAvailablePipes = CircularQueueVoid_CreateQueue(MAX_NUM_PIPES);
-	for(i=0; i<MAX_NUM_PIPES; i++)
 	{
-		struct PipeModelData* current_pipe = &g_arrayOfPipes[i];
+#define MAX_MEDAL_STRING_LENGTH 16
+		char the_string[MAX_MEDAL_STRING_LENGTH];
+		SDL_Color white_text_color = { 255, 255, 255, 255 };
+		//	SDL_Color black_text_color = { 0, 0, 0, 255 };
+		SDL_Color orange_text_color = { 220, 120, 0, 255 };
+		SDL_Surface* text_surface = NULL;
 		
-		current_pipe->upperPhysicsBody = cpBodyNewStatic();
-		current_pipe->upperPhysicsShape = cpBoxShapeNew(current_pipe->upperPhysicsBody, the_width, SCREEN_HEIGHT, 0.0);
-		current_pipe->lowerPhysicsBody = cpBodyNewStatic();
-		current_pipe->lowerPhysicsShape = cpBoxShapeNew(current_pipe->lowerPhysicsBody, the_width, SCREEN_HEIGHT, 0.0);
-
-		cpShapeSetCollisionType(current_pipe->upperPhysicsShape, PIPE_COLLISION_TYPE);
-		cpShapeSetCollisionType(current_pipe->lowerPhysicsShape, PIPE_COLLISION_TYPE);
-
 		
-		current_pipe->scoreSensorPhysicsBody = cpBodyNewStatic();
-//		current_pipe->scoreSensorPhysicsShape = cpBoxShapeNew(current_pipe->scoreSensorPhysicsBody, the_width/2, PIPE_HEIGHT_SEPARATION);
-		current_pipe->scoreSensorPhysicsShape = cpBoxShapeNew(current_pipe->scoreSensorPhysicsBody, the_width/2, SCREEN_HEIGHT, 0.0);
-
+		SDL_strlcpy(the_string, "SCORE", MAX_MEDAL_STRING_LENGTH);
+		text_surface = TTF_RenderText_Blended(g_textTextureData.fontForMedalLabels, the_string, orange_text_color);
+		g_textTextureData.scoreLabelTextTexture = SDL_CreateTextureFromSurface(g_mainRenderer, text_surface);
+		SDL_FreeSurface(text_surface);
 
 		
-		cpShapeSetSensor(current_pipe->scoreSensorPhysicsShape, cpTrue);
-		cpShapeSetCollisionType(current_pipe->scoreSensorPhysicsShape, SCORE_SENSOR_TYPE);
+		SDL_strlcpy(the_string, "BEST", MAX_MEDAL_STRING_LENGTH);
+		text_surface = TTF_RenderText_Blended(g_textTextureData.fontForMedalLabels, the_string, orange_text_color);
+		g_textTextureData.bestLabelTextTexture = SDL_CreateTextureFromSurface(g_mainRenderer, text_surface);
+		SDL_FreeSurface(text_surface);
 
 		
-		// don't add to space to make it a "rogue" body (intended to be controlled manually)
-		//	cpSpaceAddShape(g_mainSpace, g_groundPhysicsData.shape);
-		//cpSpaceAddShape(g_mainSpace, g_groundPhysicsData.shape);
 		
+		SDL_strlcpy(the_string, "NEW", MAX_MEDAL_STRING_LENGTH);
+		text_surface = TTF_RenderText_Blended(g_textTextureData.fontForMedalLabels, the_string, white_text_color);
+		g_textTextureData.newHighScoreLabelTextTexture = SDL_CreateTextureFromSurface(g_mainRenderer, text_surface);
+		SDL_FreeSurface(text_surface);
 
-		
-				
-		
-		CircularQueueVoid_PushBack(g_queueOfAvailablePipes, &g_arrayOfPipes[i]);
 	}
 }
 
-static void Flappy_UpdatePipePositions(Uint32 delta_time, Uint32 base_time, Uint32 current_time)
-{
-	/*
-	 g_groundModelData.position.x = Flappy_lroundf((MyFloat)g_groundModelData.position.x + g_groundModelData.velocity.x * (MyFloat)delta_time);
-	 if(g_groundModelData.position.x < (0 - g_groundModelData.size.x))
-	 {
-	 g_groundModelData.position.x = g_groundModelData.position.x + g_groundModelData.size.x;
-	 }
-	 */
-	
-	Uint32 diff_time = current_time - base_time;
-	Sint32 current_position;
-	Sint32 shift_factor;
-	Sint32 i;
-	
-	Sint32 new_offscreen_pipe_position_x;
-	Sint32 left_most_pipe_position_x;
-	Sint32 right_most_pipe_position_x;
-
-	struct PipeModelData* the_pipe = NULL;
-
-	
-	if(g_birdModelData.isPrelaunch)
-	{
-		return;
-	}
-//	else if(current_time < g_birdModelData.birdLaunchStartTime + PIPE_START_TIME_DELAY)
-    else if(g_gameState < GAMESTATE_MAIN_GAME_ACTIVE)
-	{
-		return;
-	}
-	else if(g_birdModelData.isDead)
-	{
-		return;
-	}
-	
-	// camera position
-//	current_position = Flappy_lroundf(g_pipeTopModelData.velocity.x * (MyFloat)diff_time);
-	current_position = -1 * Flappy_lroundf(g_pipeTopModelData.velocity.x * (MyFloat)diff_time);
-	
-//	shift_factor = SDL_abs(current_position) / g_pipeTopModelData.size.x;
-	shift_factor = SDL_abs(current_position) / PIPE_DISTANCE;
-	g_pipeTopModelData.position.x = (PIPE_DISTANCE * shift_factor) + current_position;
-	g_pipeBottomModelData.position.x = (PIPE_DISTANCE * shift_factor) + current_position;
-	
-	left_most_pipe_position_x = (PIPE_DISTANCE * shift_factor) + current_position;
-	
-	g_playerModelData.position.x = current_position;
-	
-	
-
-
-
-	/* update all pipe positions in queue */
-	/* To avoid drift/rounding-errors due to imperfect frame rate intervals,
-		I am avoiding arithmetic based on this previous position.
-		Instead, I am trying to use a formula, which will guarantee the perfect placement based on the current time.
-		But the trick we need to contend with is how to determine which pipe in the queue corresponds with the correct pipe multiple.
-		One way is to do the (bad) arthimetic with delta_time to figure out which 'slot' it is in.
-		Then recompute the real position based on that slot.
-	 
-	*/
-	for(i=0; i<CircularQueueVoid_Size(g_circularQueueOfPipes); i++)
-	{
-		struct PipeModelData* current_pipe = (struct PipeModelData*)CircularQueueVoid_ValueAtIndex(g_circularQueueOfPipes, i);
-
-		current_pipe->viewPositionX = current_pipe->realPositionX - current_position;
-
-		/*
-		
-		//			dst_rect.x = g_pipeTopModelData.position.x + PIPE_DISTANCE * i;
-		
-		Sint32 approx_position_x = Flappy_lroundf((MyFloat)current_pipe->position.x + g_groundModelData.velocity.x * (MyFloat)delta_time);
-
-		Sint32 slot_multiple = ((approx_position_x - current_position) / PIPE_DISTANCE ) - shift_factor;
-		
-//		current_pipe->position.x = (PIPE_DISTANCE * (shift_factor+i)) + current_position;
-		current_pipe->position.x = (PIPE_DISTANCE * (shift_factor+slot_multiple)) + current_position;
-		
-		SDL_Log("\ni:%d, approx:%d, current:%d, slot:%d, x:%d\n", i, approx_position_x, current_position, slot_multiple, current_pipe->position.x);
-		 */
-//		SDL_Log("\ni:%d, real:%d, view:%d, slot:%d\n", i, current_pipe->realPosition.x, current_pipe->viewPosition, current_pipe->intervalScalar);
-
-	}
-	
-	
-	/* If an old pipe has fallen off the screen, we need to remove it. */
-	the_pipe = CircularQueueVoid_Front(g_circularQueueOfPipes);
-	
-	if((NULL != the_pipe) && ((the_pipe->realPositionX + the_pipe->size.x) < current_position))
-	{
-//		SDL_Log("removed pipe, x:%d\n", the_pipe->realPositionX);
-
-		cpSpaceRemoveShape(g_mainSpace, the_pipe->scoreSensorPhysicsShape);
-		cpSpaceRemoveShape(g_mainSpace, the_pipe->lowerPhysicsShape);
-		cpSpaceRemoveShape(g_mainSpace, the_pipe->upperPhysicsShape);
-
-		for(i=0; i<CircularQueueVoid_Size(g_circularQueueOfPipes); i++)
-		{
-			struct PipeModelData* current_pipe = (struct PipeModelData*)CircularQueueVoid_ValueAtIndex(g_circularQueueOfPipes, i);
-//			SDL_Log("\n\tcheckremove1 i:%d, real:%d, view:%d, slot:%d\n", i, current_pipe->realPosition.x, current_pipe->viewPosition, current_pipe->intervalScalar);
-		}
-		CircularQueueVoid_PopFront(g_circularQueueOfPipes);
-		for(i=0; i<CircularQueueVoid_Size(g_circularQueueOfPipes); i++)
-		{
-			struct PipeModelData* current_pipe = (struct PipeModelData*)CircularQueueVoid_ValueAtIndex(g_circularQueueOfPipes, i);
-//			SDL_Log("\n\tcheckremove2 i:%d, real:%d, view:%d, slot:%d\n", i, current_pipe->realPosition.x, current_pipe->viewPosition, current_pipe->intervalScalar);
-		}
-		
-		CircularQueueVoid_PushBack(g_queueOfAvailablePipes, the_pipe);
-		
-	}
-	
-	/* If a new pipe will be coming onto the screen, we need to create it. */
-	/* Check the queue to see if the pipe has already been created.
-	 It should be at the end of the queue and will have the designated x position.
-	 */
-	//shift_factor = SDL_abs(current_position) / g_bushModelData.size.x;
-	//g_bushModelData.position.x = (g_bushModelData.size.x * shift_factor) + current_position;
-	
-//	right_most_pipe_position_x = left_most_pipe_position_x + PIPE_DISTANCE * MAX_NUM_PIPES;
-//	right_most_pipe_position_x = (PIPE_DISTANCE * (MAX_NUM_PIPES)) + current_position;
-	right_most_pipe_position_x = (PIPE_DISTANCE * (shift_factor+MAX_NUM_PIPES-1)) + current_position;
-	//g_bushModelData.position.x = (g_bushModelData.size.x * shift_factor) + current_position;
-	
-	right_most_pipe_position_x = current_position + SCREEN_WIDTH + PIPE_WIDTH;
-	Sint32 new_pipe_interval_scalar = right_most_pipe_position_x / PIPE_DISTANCE;
-	
-	
-	the_pipe = (struct PipeModelData*)CircularQueueVoid_Back(g_circularQueueOfPipes);
-	if((NULL == the_pipe) || (the_pipe->intervalScalar != new_pipe_interval_scalar))
-	{
-		Sint32 real_x_pos = PIPE_DISTANCE * new_pipe_interval_scalar;
-		
-		
-		if((real_x_pos) >= (current_position + SCREEN_WIDTH))
-		{
-			
-			the_pipe = CircularQueueVoid_Front(g_queueOfAvailablePipes);
-			SDL_assert(NULL != the_pipe);
-			if(NULL != the_pipe)
-			{
-				/* 
-					http://c-faq.com/lib/randrange.html
-					for range [M, N]:
-					M + rand() / (RAND_MAX / (N - M + 1) + 1)
-				 */
-				int M = MIN_PIPE_HEIGHT;
-				int N = SCREEN_HEIGHT - GROUND_HEIGHT - PIPE_HEIGHT_SEPARATION - MIN_PIPE_HEIGHT;
-				int random_pipe_height = M + rand() / (RAND_MAX / (N - M + 1) + 1);
-	//			int random_pipe_height = MIN_PIPE_HEIGHT;
-
-				
-				CircularQueueVoid_PopFront(g_queueOfAvailablePipes);
-				
-				the_pipe->realPositionX = PIPE_DISTANCE * new_pipe_interval_scalar;
-				the_pipe->intervalScalar = new_pipe_interval_scalar;
-				the_pipe->viewPositionX = the_pipe->realPositionX - current_position;
-				
-				the_pipe->pipeHeight = random_pipe_height;
-				/* Remember that SDL inverts the Y. */
-
-				the_pipe->lowerRealPositionY = GROUND_HEIGHT;
-				the_pipe->upperRealPositionY = GROUND_HEIGHT + random_pipe_height + PIPE_HEIGHT_SEPARATION;
-
-
-				the_pipe->lowerViewPositionY = Flappy_InvertY(
-															  the_pipe->lowerRealPositionY
-															  
-															  )
-				- the_pipe->pipeHeight
-				
-				;
-	//														  the_pipe->size.y;
-				the_pipe->size.x = g_pipeBottomModelData.size.x;
-
-
-				cpBodySetPosition(the_pipe->lowerPhysicsBody, cpv(the_pipe->realPositionX, the_pipe->lowerRealPositionY + the_pipe->pipeHeight - SCREEN_HEIGHT/2));
-	//			cpBodySetPosition(the_pipe->lowerPhysicsBody, cpv(the_pipe->realPositionX - the_pipe->size.x / 2, the_pipe->lowerRealPositionY + the_pipe->pipeHeight/2));
-		//		cpBodySetPosition(the_pipe->upperPhysicsBody, cpv(the_pipe->realPositionX - the_pipe->size.x / 2, the_pipe->upperRealPositionY + (SCREEN_HEIGHT - the_pipe->pipeHeight - PIPE_HEIGHT_SEPARATION - GROUND_HEIGHT)/2));
-				cpBodySetPosition(the_pipe->upperPhysicsBody, cpv(the_pipe->realPositionX, the_pipe->upperRealPositionY + (SCREEN_HEIGHT/2)));
-
-	//			cpBodySetPosition(the_pipe->scoreSensorPhysicsBody, cpv(the_pipe->realPositionX + the_pipe->size.x / 4, GROUND_HEIGHT+ random_pipe_height + PIPE_HEIGHT_SEPARATION - PIPE_HEIGHT_SEPARATION/2));
-//				cpBodySetPosition(the_pipe->scoreSensorPhysicsBody, cpv(the_pipe->realPositionX, GROUND_HEIGHT+ random_pipe_height + PIPE_HEIGHT_SEPARATION - PIPE_HEIGHT_SEPARATION/2));
-				cpBodySetPosition(the_pipe->scoreSensorPhysicsBody, cpv(the_pipe->realPositionX + PIPE_WIDTH/4, SCREEN_HEIGHT/2));
-
-			//	src_rect.h = SCREEN_HEIGHT - current_pipe->pipeHeight - PIPE_HEIGHT_SEPARATION - GROUND_HEIGHT;
-
-
-				cpSpaceAddShape(g_mainSpace, the_pipe->upperPhysicsShape);
-				cpSpaceAddShape(g_mainSpace, the_pipe->lowerPhysicsShape);
-				cpSpaceAddShape(g_mainSpace, the_pipe->scoreSensorPhysicsShape);
-
-//				SDL_Log("added pipe, x:%d\n", the_pipe->realPositionX);
-
-				CircularQueueVoid_PushBack(g_circularQueueOfPipes, the_pipe);
-			}
-		}
-	}
-
-	
-	
-	
-	
-#if 0
-	
-	SDL_Rect src_rect = {0, 0, 106, 672};
-	
-	SDL_Rect dst_rect = {g_pipeTopModelData.position.x, 0, 106, 672};
-	
-	
-	/* The texture does not fill the whole width of the screen.
-	 So draw it multiple times, shifted over
-	 until we fill the entire length of the screen.
-	 */
-	Sint32 number_of_times_to_repeat_draw;
-	Sint32 remainder;
-	Sint32 i;
-	
-	number_of_times_to_repeat_draw = (SCREEN_WIDTH / PIPE_DISTANCE) + 1;
-	remainder = SCREEN_WIDTH % PIPE_DISTANCE;
-	if(remainder > 0)
-	{
-		number_of_times_to_repeat_draw = number_of_times_to_repeat_draw + 1;
-	}
-	
-	for(i=0; i<number_of_times_to_repeat_draw; i++)
-	{
-		dst_rect.x = g_pipeTopModelData.position.x + PIPE_DISTANCE * i;
-		if(dst_rect.x < SCREEN_WIDTH)
-		{
-			SDL_RenderCopy(renderer, g_gameTextures.pipe_bottom, &src_rect, &dst_rect);
-		}
-	}
-#endif
-	
-}
-
-
-
-// Assumes all the bird textures are the sime width/height so any of the 3 may be passed in
-static void Flappy_InitializeBirdModelData(SDL_Texture* the_texture)
-{
-	Uint32 the_format;
-	int the_access;
-	int the_width;
-	int the_height;
-	
-	SDL_zero(g_birdModelData);
-	SDL_QueryTexture(the_texture, &the_format, &the_access, &the_width, &the_height);
-	
-	// 960 / 5000 msec = .192
-	g_birdModelData.velocity.x = 0;
-//	g_birdModelData.size.x = the_width;
-//	g_birdModelData.size.y = the_height;
-//	g_birdModelData.size.x = 92;
-//	g_birdModelData.size.y = 74;
-//		g_birdModelData.size.x = 62;
-//		g_birdModelData.size.y = 50;
-	g_birdModelData.size.x = BIRD_WIDTH;
-	g_birdModelData.size.y = BIRD_HEIGHT;
-	g_birdModelData.position.x = SCREEN_WIDTH / 3;
-	g_birdModelData.position.y = SCREEN_HEIGHT / 2;
-	
-	
-	g_birdModelData.currentTexture = g_gameTextures.bird[1];
-	g_birdModelData.animationStartTime = 0;
-	g_birdModelData.animationDuration = BIRD_FLAP_ANIMATION_DURATION;
-	g_birdModelData.isAnimatingSprite = SDL_TRUE;
-	
-	g_birdModelData.isPrelaunch = SDL_TRUE;
-	g_birdModelData.isReadyForPipe = SDL_FALSE;
-	g_birdModelData.birdLaunchStartTime = 0;
-
-}
-
-// y is in cartesian
-void Flappy_UpdateBirdPositionForPrelaunch(Uint32 delta_time, Uint32 base_time, Uint32 current_time, Sint32 base_bird_pos_x, Sint32 base_bird_pos_y)
-{
-	Uint32 diff_time = current_time - base_time;
-	Sint32 current_position;
-	Sint32 shift_factor;
-
-	cpFloat bird_angle;
-	Sint32 pos_y;
-
-	g_birdModelData.velocity.x = BIRD_VELOCITY_X;
-
-	//	g_cloudModelData.position.x = Flappy_lroundf((MyFloat)g_cloudModelData.position.x + g_cloudModelData.velocity.x * (MyFloat)delta_time);
-	current_position = Flappy_lroundf(g_birdModelData.velocity.x * (MyFloat)diff_time);
-	
-	//	shift_factor = SDL_abs(current_position) / g_cloudModelData.size.x;
-	//	g_birdModelData.position.x = SCREEN_WIDTH / 3;
-	g_birdModelData.position.x = base_bird_pos_x;
-	
-	pos_y = Flappy_lroundf( g_birdModelData.size.y/4 * SDL_sinf(current_time /1000.0 * 4)) + base_bird_pos_y;
-//	pos_y = Flappy_lroundf( g_birdModelData.size.y/4 * SDL_sinf(current_time /1000.0 * 4)) + g_birdModelData.position.y - g_birdModelData.size.y;
-		
-	g_birdModelData.position.y = Flappy_InvertY(pos_y + (g_birdModelData.size.y / 2));
-//	g_birdModelData.birdBody->p.y = pos_y;
-	
-	cpBodySetPosition(g_birdModelData.birdBody, cpv( g_birdModelData.position.x, pos_y + (g_birdModelData.size.y / 2)));
-
-	
-	{
-		g_birdModelData.animationDuration = BIRD_FLAP_ANIMATION_DURATION_FOR_PRELAUNCH;
-		MyFloat linear_interp;
-		Uint32 mod_time = (current_time - g_birdModelData.animationStartTime) % g_birdModelData.animationDuration
-;
-		Uint32 texture_index;
-		
-		linear_interp = Flappy_ComputeLinearInterpolation(mod_time, g_birdModelData.animationStartTime, g_birdModelData.animationStartTime+g_birdModelData.animationDuration);
-		texture_index = Flappy_lroundf(linear_interp * (MyFloat)NUMBER_OF_BIRD_FRAMES);
-		if(texture_index >= NUMBER_OF_BIRD_FRAMES)
-		{
-			texture_index = 0;
-		}
-		g_birdModelData.currentTexture = g_gameTextures.bird[texture_index];
-		
-	}
-	
-}
-
-void Flappy_UpdateBirdPositionForGame(Uint32 delta_time, Uint32 base_time, Uint32 current_time)
-{
-	Uint32 diff_time = current_time - base_time;
-	Sint32 current_position;
-	Sint32 shift_factor;
-	cpFloat bird_angle;
-	cpVect vec_bird_position;
-	cpVect vec_bird_velocity;
-
-	g_birdModelData.velocity.x = BIRD_VELOCITY_X;
-	vec_bird_position = cpBodyGetPosition(g_birdModelData.birdBody);
-
-	
-	if(g_birdModelData.isDead)
-	{
-		current_position = g_gameInstanceData.distanceTraveled;
-	}
-	else
-	{
-		//	g_cloudModelData.position.x = Flappy_lroundf((MyFloat)g_cloudModelData.position.x + g_cloudModelData.velocity.x * (MyFloat)delta_time);
-		current_position = Flappy_lroundf(g_birdModelData.velocity.x * (MyFloat)diff_time);
-		g_gameInstanceData.distanceTraveled = current_position;
-		
-	}
-	
-	
-//	shift_factor = SDL_abs(current_position) / g_cloudModelData.size.x;
-//	g_birdModelData.position.x = SCREEN_WIDTH / 3;
-	
-	
-	
-	
-	
-	
-	
-	g_birdModelData.position.y = Flappy_InvertY(
-		Flappy_lroundf(
-			vec_bird_position.y
-		)
-												+ 		(g_birdModelData.size.y / 2)
-
-	);
-
-//	SDL_Log("g_birdModelData.birdBody->p.y=%f, g_birdModelData.position.y=%d", g_birdModelData.birdBody->p.y, g_birdModelData.position.y);
-	// Trick to prevent bird from being drawn too far into the ground when physics collision penetrates too far.
-	{
-		
-		int radius = cpCircleShapeGetRadius(g_birdModelData.birdShape);
-		// we need 2*radius because SDL draws from the edge of the sprite, not the center.
-		int ground_threshold = SCREEN_HEIGHT - GROUND_HEIGHT - (2*radius); // g_birdModelData.size.y
-		// should be 640
-			
-		if(g_birdModelData.position.y > ground_threshold)
-		{
-			g_birdModelData.position.y = ground_threshold;
-		}
-	}
-//	cpBodySetPosition(g_birdModelData.birdBody, cpv( current_position + (SCREEN_WIDTH / 3) - (g_birdModelData.size.x / 2), g_birdModelData.birdBody->p.y));
-	cpBodySetPosition(g_birdModelData.birdBody, cpv( current_position + (SCREEN_WIDTH / 3), vec_bird_position.y));
-	vec_bird_velocity = cpBodyGetVelocity(g_birdModelData.birdBody);
-	cpBodySetVelocity(g_birdModelData.birdBody, cpv(g_birdModelData.velocity.x, vec_bird_velocity.y));
-
-	bird_angle = cpBodyGetAngle(g_birdModelData.birdBody);
-	if((bird_angle < -M_PI_2/4) && (bird_angle > -M_PI_2))
-	{
-		cpBodySetAngularVelocity(g_birdModelData.birdBody, -5);
-		/* Chipmunk API says to reindex after changing the angle */
-		cpSpaceReindexShapesForBody(g_mainSpace, g_birdModelData.birdBody);
-		g_birdModelData.isAnimatingSprite = SDL_FALSE;
-	}
-	else if(bird_angle <= -M_PI_2)
-	{
-		cpBodySetAngularVelocity(g_birdModelData.birdBody, 0);
-		cpBodySetAngle(g_birdModelData.birdBody, -M_PI_2);
-
-		/* Chipmunk API says to reindex after changing the angle */
-		cpSpaceReindexShapesForBody(g_mainSpace, g_birdModelData.birdBody);
-
-		/* When in a nose dive, texture animation is off. */
-		g_birdModelData.isAnimatingSprite = SDL_FALSE;
-	}
-	else
-	{
-		g_birdModelData.isAnimatingSprite = SDL_TRUE;
-	}
-	
-	
-	if(g_birdModelData.isAnimatingSprite)
-	{
-		g_birdModelData.animationDuration = BIRD_FLAP_ANIMATION_DURATION;
-
-		MyFloat linear_interp;
-		Uint32 mod_time = (current_time - g_birdModelData.animationStartTime) % g_birdModelData.animationDuration;
-		Uint32 texture_index;
-		
-		linear_interp = Flappy_ComputeLinearInterpolation(mod_time, g_birdModelData.animationStartTime, g_birdModelData.animationStartTime+g_birdModelData.animationDuration);
-		texture_index = Flappy_lroundf(linear_interp * (MyFloat)NUMBER_OF_BIRD_FRAMES);
-		if(texture_index >= NUMBER_OF_BIRD_FRAMES)
-		{
-			texture_index = 0;
-		}
-		g_birdModelData.currentTexture = g_gameTextures.bird[texture_index];
-
-	}
-	else
-	{
-		// The middle frame is the one with wings in the neutral position
-		g_birdModelData.currentTexture = g_gameTextures.bird[1];
-	}
-	
-	
-	if(SDL_TRUE == g_birdModelData.isReadyToPlayFallingSound)
-	{
-		ALmixer_PlayChannel(-1, g_gameSounds.fall, 0);
-		g_birdModelData.isReadyToPlayFallingSound = SDL_FALSE;
-		g_birdModelData.isFalling = SDL_FALSE;
-	}
-
-	
-	
-//	SDL_Log("current_bird pos:%f\n", g_birdModelData.birdBody->p.x);
-}
-
-void Flappy_UpdateBirdPosition(Uint32 delta_time, Uint32 base_time, Uint32 current_time)
-{
-//	if(g_birdModelData.isPrelaunch)
-	if((g_gameState >= GAMESTATE_TITLE_SCREEN) && (g_gameState <= GAMESTATE_FADE_OUT_TITLE_SCREEN))
-	{
-		Flappy_UpdateBirdPositionForPrelaunch(delta_time, base_time, current_time, SCREEN_WIDTH/2, (SCREEN_HEIGHT/3) + 32);
-	}
-	else if((g_gameState >= GAMESTATE_LOADING_NEW_GAME_AND_FADE_IN) && (g_gameState <= GAMESTATE_BIRD_PRELAUNCH))
-	{
-		Flappy_UpdateBirdPositionForPrelaunch(delta_time, base_time, current_time, SCREEN_WIDTH/3, SCREEN_HEIGHT/2);
-	}
-	else
-	{
-		Flappy_UpdateBirdPositionForGame(delta_time, base_time, current_time);
-
-	}
-}
-
-Sint32 Flappy_DetermineCurrentBirdTimePosition(Uint32 delta_time, Uint32 base_time, Uint32 current_time)
-{
-	if(g_birdModelData.isDead)
-	{
-//		return g_gameInstanceData.distanceTraveled;
-		return g_gameInstanceData.diedAtTime;
-	}
-	else
-	{
-		/*
-		Uint32 diff_time = current_time - base_time;
-		Sint32 current_position;
-		
-		//	g_cloudModelData.position.x = Flappy_lroundf((MyFloat)g_cloudModelData.position.x + g_cloudModelData.velocity.x * (MyFloat)delta_time);
-		current_position = Flappy_lroundf(BIRD_VELOCITY_X * (MyFloat)diff_time);
-		return current_position;
-		 */
-		return current_time;
-	}
-}
-
-
-
-SDL_Texture* Flappy_CreateGameOverTexture(void);
-
-static void Flappy_InitializeGameOverDisplayData()
-{
-	Uint32 the_format;
-	int the_access;
-	int the_width;
-	int the_height;
-	SDL_Texture* the_texture;
-	
-	SDL_zero(g_gameOverDisplayData);
-	the_texture = Flappy_CreateGameOverTexture();
-	
-	SDL_QueryTexture(the_texture, &the_format, &the_access, &the_width, &the_height);
-	g_gameOverDisplayData.textureWidth = the_width;
-	g_gameOverDisplayData.textureHeight = the_height;
-	
-	// Midpoint of the screen, then subtract the midpoint of the texture
-	g_gameOverDisplayData.dstRect.x = (SCREEN_WIDTH/2) - (the_width/2);
-	// This isn't exactly dead center because Game Over and buttons need to be on screen
-//	g_gameOverDisplayData.dstRect.y = (SCREEN_HEIGHT/3) - (the_height/2);
-//	g_gameOverDisplayData.dstRect.y = (SCREEN_HEIGHT/3) - (the_height/2);
-	g_gameOverDisplayData.dstRect.w = the_width;
-	g_gameOverDisplayData.dstRect.h = the_height;
-	
-	
-}
-
-static void Flappy_UpdateGameOverDisplayData(Uint32 delta_time, Uint32 base_time, Uint32 current_time)
-{
-	
-	if( ! g_birdModelData.isGameOver)
-	{
-		return;
-	}
-	
-	
-	if(GAMESTATE_SWOOPING_IN_GAME_OVER == g_gameState)
-	{
-#define GAME_OVER_BOUNCE_HEIGHT 40
-		MyFloat linear_interp;
-		int displayed_score;
-		int lower_target_y = (SCREEN_HEIGHT / 4) - (g_gameOverDisplayData.textureHeight/2) - 40;
-		int upper_target_y = lower_target_y - GAME_OVER_BOUNCE_HEIGHT;
-		
-#define SWEEP_IN_GAME_OVER_DURATION 200
-#define SWEEP_IN_GAME_OVER_DELAY_BEFORE_NEXT_STATE 1000
-
-		if(current_time < (g_gameOverDisplayData.sweepInStartTime + (SWEEP_IN_GAME_OVER_DURATION/2)))
-		{
-			linear_interp = Flappy_ComputeLinearInterpolation(current_time, g_gameOverDisplayData.sweepInStartTime, g_gameOverDisplayData.sweepInStartTime + (SWEEP_IN_GAME_OVER_DURATION/2));
-			// X = (1-t)x0 + tx1
-			g_gameOverDisplayData.dstRect.y = ((1.0-linear_interp) * lower_target_y) + (linear_interp * (MyFloat)(upper_target_y));
-
-		}
-		else if(current_time < (g_gameOverDisplayData.sweepInStartTime + (SWEEP_IN_GAME_OVER_DURATION)))
-		{
-			linear_interp = Flappy_ComputeLinearInterpolation(current_time, g_gameOverDisplayData.sweepInStartTime + (SWEEP_IN_GAME_OVER_DURATION/2), g_gameOverDisplayData.sweepInStartTime + (SWEEP_IN_GAME_OVER_DURATION));
-			// X = (1-t)x0 + tx1
-			g_gameOverDisplayData.dstRect.y = ((1.0-linear_interp) * upper_target_y) + (linear_interp * (MyFloat)(lower_target_y));
-					
-		}
-		else
-		{
-			g_gameOverDisplayData.dstRect.y = lower_target_y;
-			if(current_time > (g_gameOverDisplayData.sweepInStartTime + SWEEP_IN_GAME_OVER_DURATION + SWEEP_IN_GAME_OVER_DELAY_BEFORE_NEXT_STATE))
-			{
-				g_gameState = GAMESTATE_SWOOPING_IN_MEDAL_DISPLAY;
-				ALmixer_PlayChannel(-1, g_gameSounds.swoosh, 0);
-				g_medalBackgroundData.sweepInStartTime = TimeTicker_GetTime(g_gameClock);
-			}
-
-		}
-		
-		
-	}
-	
-}
-
-
-static void Flappy_InitializeMedalBackgroundData(SDL_Texture* the_texture)
-{
-	Uint32 the_format;
-	int the_access;
-	int the_width;
-	int the_height;
-	
-	SDL_zero(g_medalBackgroundData);
-	SDL_QueryTexture(the_texture, &the_format, &the_access, &the_width, &the_height);
-	
-	// Midpoint of the screen, then subtract the midpoint of the texture
-	g_medalBackgroundData.dstRect.x = (SCREEN_WIDTH/2) - (the_width/2);
-	// This isn't exactly dead center because Game Over and buttons need to be on screen
-	g_medalBackgroundData.dstRect.y = (SCREEN_HEIGHT/2) - (the_height/2);
-	g_medalBackgroundData.dstRect.w = the_width;
-	
-	g_medalBackgroundData.dstRect.h = the_height;
-	
-	
-	/* Create texture for render-to-texture */
-    g_gameTextures.medalSceneRenderToTexture = SDL_CreateTexture(g_mainRenderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, the_width, the_height);
-	SDL_assert(NULL != g_gameTextures.medalSceneRenderToTexture);
-	SDL_SetTextureBlendMode(g_gameTextures.medalSceneRenderToTexture, SDL_BLENDMODE_BLEND);
-	
-	g_textTextureData.scoreLabelTextTexture = NULL;
-	g_textTextureData.bestLabelTextTexture = NULL;
-	g_textTextureData.newHighScoreLabelTextTexture = NULL;
-	g_textTextureData.bestNumberTextTexture = NULL;
-
-	
-	{
-#define MAX_MEDAL_STRING_LENGTH 16
-		char the_string[MAX_MEDAL_STRING_LENGTH];
-		SDL_Color white_text_color = { 255, 255, 255, 255 };
-		//	SDL_Color black_text_color = { 0, 0, 0, 255 };
-		SDL_Color orange_text_color = { 220, 120, 0, 255 };
-		SDL_Surface* text_surface = NULL;
-		
-		
-		SDL_strlcpy(the_string, "SCORE", MAX_MEDAL_STRING_LENGTH);
-		text_surface = TTF_RenderText_Blended(g_textTextureData.fontForMedalLabels, the_string, orange_text_color);
-		g_textTextureData.scoreLabelTextTexture = SDL_CreateTextureFromSurface(g_mainRenderer, text_surface);
-		SDL_FreeSurface(text_surface);
-
-		
-		SDL_strlcpy(the_string, "BEST", MAX_MEDAL_STRING_LENGTH);
-		text_surface = TTF_RenderText_Blended(g_textTextureData.fontForMedalLabels, the_string, orange_text_color);
-		g_textTextureData.bestLabelTextTexture = SDL_CreateTextureFromSurface(g_mainRenderer, text_surface);
-		SDL_FreeSurface(text_surface);
-
-		
-		
-		SDL_strlcpy(the_string, "NEW", MAX_MEDAL_STRING_LENGTH);
-		text_surface = TTF_RenderText_Blended(g_textTextureData.fontForMedalLabels, the_string, white_text_color);
-		g_textTextureData.newHighScoreLabelTextTexture = SDL_CreateTextureFromSurface(g_mainRenderer, text_surface);
-		SDL_FreeSurface(text_surface);
-
-	}
-}
-
-
-
-static void Flappy_UpdateMedalBackgroundData(Uint32 delta_time, Uint32 base_time, Uint32 current_time)
+
+
+static void Flappy_UpdateMedalBackgroundData(struct FlappyWorld* the_world, Uint32 delta_time, Uint32 base_time, Uint32 current_time)
 {
 	
-	if( ! g_birdModelData.isGameOver)
+	if( ! the_world->birdModelData.isGameOver)
 	{
 		return;
 	}
 
 	
-	if((g_gameState >= GAMESTATE_SWOOPING_IN_MEDAL_DISPLAY) && (g_gameState <= GAMESTATE_TALLYING_SCORE))
+	if((the_world->gameState >= GAMESTATE_SWOOPING_IN_MEDAL_DISPLAY) && (the_world->gameState <= GAMESTATE_TALLYING_SCORE))
 	{
 		MyFloat linear_interp;
 		int displayed_score;
-		
-#define SWEEP_IN_MEDAL_PANEL_DURATION 300
-		linear_interp = Flappy_ComputeLinearInterpolation(current_time, g_medalBackgroundData.sweepInStartTime, g_medalBackgroundData.sweepInStartTime + SWEEP_IN_MEDAL_PANEL_DURATION);
+		linear_interp = Flappy_ComputeLinearInterpolation(current_time, the_world->medalSweepInStartTime, the_world->medalSweepInStartTime + SWEEP_IN_MEDAL_PANEL_DURATION);
 
 		
 		int the_height = 250;
@@ -2543,19 +1604,18 @@ static void Flappy_UpdateMedalBackgroundData(Uint32 delta_time, Uint32 base_time
 		/*
 		if(linear_interp >= 1.0)
 		{
-			g_gameState = GAMESTATE_SWOOPED_IN_MEDAL_DISPLAY;
+			the_world->gameState = GAMESTATE_SWOOPED_IN_MEDAL_DISPLAY;
 		}
 		 */
-		if((GAMESTATE_SWOOPING_IN_MEDAL_DISPLAY == g_gameState) && (current_time >= g_medalBackgroundData.sweepInStartTime + SWEEP_IN_MEDAL_PANEL_DURATION))
-		{
-			g_gameState = GAMESTATE_TALLYING_SCORE;
-			g_gameStateCurrentPhaseStartTime = TimeTicker_GetTime(g_gameClock);
-		}
-		
-		Flappy_SaveHighScoreToStorageIfNeeded();
+		Flappy_SaveHighScoreToStorageIfNeeded(the_world);
 
 	}
 	
+	/* Everything below is render-to-texture for the medal panel. */
+	if(g_isHeadless)
+	{
+		return;
+	}
 	
 	{
 		
@@ -2623,8 +1683,8 @@ static void Flappy_UpdateMedalBackgroundData(Uint32 delta_time, Uint32 base_time
 				}
 				
 				/* Draw "NEW" label */
-				if( ((g_gameState >= GAMESTATE_GAME_OVER_WAITING_FOR_USER_ACTION) && (g_gameState <= GAMESTATE_FADE_OUT_GAME_OVER) )
-				   	&& (g_gameInstanceData.currentScore > g_highScoreData.previousHighScore)
+				if( ((the_world->gameState >= GAMESTATE_GAME_OVER_WAITING_FOR_USER_ACTION) && (the_world->gameState <= GAMESTATE_FADE_OUT_GAME_OVER) )
+				   	&& (the_world->gameInstanceData.currentScore > g_highScoreData.previousHighScore)
 				)
 				{
 					SDL_QueryTexture(g_textTextureData.newHighScoreLabelTextTexture, &the_format, &the_access, &the_width, &the_height);
@@ -2656,19 +1716,19 @@ static void Flappy_UpdateMedalBackgroundData(Uint32 delta_time, Uint32 base_time
 				
 				SDL_Texture* which_medal = NULL;
 				
-				if(g_gameInstanceData.currentScore >= PLATINUM_MEDAL_MINUIMUM)
+				if(the_world->gameInstanceData.currentScore >= PLATINUM_MEDAL_MINUIMUM)
 				{
 					which_medal = g_gameTextures.platinumMedal;
 				}
-				else if(g_gameInstanceData.currentScore >= GOLD_MEDAL_MINUIMUM)
+				else if(the_world->gameInstanceData.currentScore >= GOLD_MEDAL_MINUIMUM)
 				{
 					which_medal = g_gameTextures.goldMedal;
 				}
-				else if(g_gameInstanceData.currentScore >= SILVER_MEDAL_MINUIMUM)
+				else if(the_world->gameInstanceData.currentScore >= SILVER_MEDAL_MINUIMUM)
 				{
 					which_medal = g_gameTextures.silverMedal;
 				}
-				else if(g_gameInstanceData.currentScore >= BRONZE_MEDAL_MINUIMUM)
+				else if(the_world->gameInstanceData.currentScore >= BRONZE_MEDAL_MINUIMUM)
 				{
 					which_medal = g_gameTextures.bronzeMedal;
 				}
@@ -2696,18 +1756,18 @@ static void Flappy_UpdateMedalBackgroundData(Uint32 delta_time, Uint32 base_time
 				MyFloat linear_interp;
 				int displayed_score;
 				
-				if(g_gameState < GAMESTATE_TALLYING_SCORE)
+				if(the_world->gameState < GAMESTATE_TALLYING_SCORE)
 				{
 					displayed_score = 0;
 				}
-				else if(g_gameState == GAMESTATE_TALLYING_SCORE)
+				else if(the_world->gameState == GAMESTATE_TALLYING_SCORE)
 				{
-					linear_interp = Flappy_ComputeLinearInterpolation(current_time, g_gameStateCurrentPhaseStartTime, g_gameStateCurrentPhaseStartTime + TALLY_DURATION);
-					displayed_score = Flappy_lroundf(linear_interp * (MyFloat)g_gameInstanceData.currentScore);
+					linear_interp = Flappy_ComputeLinearInterpolation(current_time, the_world->gameStateCurrentPhaseStartTime, the_world->gameStateCurrentPhaseStartTime + TALLY_DURATION);
+					displayed_score = Flappy_lroundf(linear_interp * (MyFloat)the_world->gameInstanceData.currentScore);
 				}
 				else
 				{
-					displayed_score = g_gameInstanceData.currentScore;
+					displayed_score = the_world->gameInstanceData.currentScore;
 				}
 				
 			// Note: Could optimize to not recreate texture when there is no change.
@@ -2721,7 +1781,7 @@ static void Flappy_UpdateMedalBackgroundData(Uint32 delta_time, Uint32 base_time
 				
 
 
-//				SDL_Log("linear_interp %f, current_time=%d, diedAtTime=%d", linear_interp, current_time, g_gameInstanceData.diedAtTime);
+//				SDL_Log("linear_interp %f, current_time=%d, diedAtTime=%d", linear_interp, current_time, the_world->gameInstanceData.diedAtTime);
 
 				
 				
@@ -2779,11 +1839,11 @@ static void Flappy_UpdateMedalBackgroundData(Uint32 delta_time, Uint32 base_time
 					SDL_DestroyTexture(g_textTextureData.bestNumberTextTexture);
 				}
 				
-				if( ((g_gameState >= GAMESTATE_GAME_OVER_WAITING_FOR_USER_ACTION) && (g_gameState <= GAMESTATE_FADE_OUT_GAME_OVER) )
-				   && (g_gameInstanceData.currentScore > g_highScoreData.previousHighScore)
+				if( ((the_world->gameState >= GAMESTATE_GAME_OVER_WAITING_FOR_USER_ACTION) && (the_world->gameState <= GAMESTATE_FADE_OUT_GAME_OVER) )
+				   && (the_world->gameInstanceData.currentScore > g_highScoreData.previousHighScore)
 				   )
 				{
-					displayed_score = g_gameInstanceData.currentScore;
+					displayed_score = the_world->gameInstanceData.currentScore;
 				}
 				else
 				{
@@ -2927,6 +1987,11 @@ void Flappy_UpdateScoreTexture(Uint32 new_score)
 	SDL_Color black_text_color = { 0, 0, 0, 0 };
 	SDL_Surface* text_surface = NULL;
 	
+	if(g_isHeadless)
+	{
+		return;
+	}
+	
 	SDL_DestroyTexture(g_currentScoreTextTexture);
 	SDL_snprintf(score_string, MAX_SCORE_STRING_LENGTH, "%d", new_score);
 	text_surface = TTF_RenderText_Blended(s_retroFontForMainScore, score_string, white_text_color);
@@ -2943,187 +2008,6 @@ void Flappy_UpdateScoreTexture(Uint32 new_score)
 	
 }
 
-void InitNewGame()
-{
-	Sint32 i;
-	
-	g_gameInstanceData.currentScore = 0;
-	Flappy_UpdateScoreTexture(g_gameInstanceData.currentScore);
-	
-	g_highScoreData.previousHighScore = g_highScoreData.savedHighScore;
-	g_highScoreData.currentHighScore = 0;
-	
-	
-	g_gameInstanceData.distanceTraveled = 0;
-	
-	//	g_gameState = GAMESTATE_BIRD_PRELAUNCH;
-	g_gameState = GAMESTATE_LOADING_NEW_GAME_AND_FADE_IN;
-	
-	g_birdModelData.isPrelaunch = SDL_TRUE;
-	g_birdModelData.isReadyForPipe = SDL_FALSE;
-	g_birdModelData.birdLaunchStartTime = 0;
-	
-	g_birdModelData.isDead = SDL_FALSE;
-	g_birdModelData.isGameOver = SDL_FALSE;
-	g_birdModelData.isFalling = SDL_FALSE;
-	g_birdModelData.isReadyToPlayFallingSound = SDL_FALSE;
-	
-	// because we change this for the title screen
-	g_birdModelData.position.x = SCREEN_WIDTH / 3;
-	g_birdModelData.position.y = SCREEN_HEIGHT / 2;
-	
-	if(cpSpaceContainsBody(g_mainSpace, g_birdModelData.birdBody))
-	{
-		cpSpaceRemoveBody(g_mainSpace, g_birdModelData.birdBody);
-		cpSpaceRemoveShape(g_mainSpace, g_birdModelData.birdShape);
-		
-	}
-	
-	cpBodySetVelocity(g_birdModelData.birdBody, cpv(0, 0));
-	cpBodySetPosition(g_groundPhysicsData.body, cpv(0 + SCREEN_WIDTH/2, GROUND_HEIGHT/2.0));
-	cpBodySetAngularVelocity(g_birdModelData.birdBody, 0);
-	cpBodySetAngle(g_birdModelData.birdBody, 0);
-	
-	
-	
-	for(i=0; i<CircularQueueVoid_Size(g_circularQueueOfPipes); i++)
-	{
-		struct PipeModelData* current_pipe = (struct PipeModelData*)CircularQueueVoid_ValueAtIndex(g_circularQueueOfPipes, i);
-		cpSpaceRemoveShape(g_mainSpace, current_pipe->scoreSensorPhysicsShape);
-		cpSpaceRemoveShape(g_mainSpace, current_pipe->lowerPhysicsShape);
-		cpSpaceRemoveShape(g_mainSpace, current_pipe->upperPhysicsShape);
-		
-		CircularQueueVoid_PushBack(g_queueOfAvailablePipes, current_pipe);
-	}
-	
-	while(CircularQueueVoid_Size(g_circularQueueOfPipes)>0)
-	{
-		CircularQueueVoid_PopFront(g_circularQueueOfPipes);
-	}
-	
-	
-	
-	
-}
-
-void InitTitleScreen()
-{
-	InitNewGame();
-	g_gameState = GAMESTATE_TITLE_SCREEN;
-	g_gameStateCurrentPhaseStartTime = TimeTicker_GetTime(g_gameClock);
-	g_birdModelData.position.x = SCREEN_WIDTH / 2;
-	g_birdModelData.position.y = SCREEN_HEIGHT / 2 + 20;
-
-	
-}
-
-void Flappy_UpdateGameState(Uint32 delta_time, Uint32 base_time, Uint32 current_time)
-{
-	switch(g_gameState)
-	{
-		case GAMESTATE_FADE_OUT_TITLE_SCREEN:
-		{
-			if(current_time > (g_gameStateCurrentPhaseStartTime + FADE_OUT_TIME))
-			{
-				InitNewGame();
-				g_gameState = GAMESTATE_LOADING_NEW_GAME_AND_FADE_IN;
-				g_gameStateCurrentPhaseStartTime = TimeTicker_GetTime(g_gameClock);
-			}
-			break;
-		}
-		case GAMESTATE_LOADING_NEW_GAME_AND_FADE_IN:
-		{
-			if(current_time > (g_gameStateCurrentPhaseStartTime + FADE_IN_TIME))
-			{
-
-				g_gameState = GAMESTATE_BIRD_PRELAUNCH;
-				g_gameStateCurrentPhaseStartTime = TimeTicker_GetTime(g_gameClock);
-			}
-			break;
-		}
-		
-        case GAMESTATE_BIRD_LAUNCHED_BUT_BEFORE_PIPES:
-        {
-            if(current_time >= g_gameStateCurrentPhaseStartTime + PIPE_START_TIME_DELAY)
-            {
-                g_gameState = GAMESTATE_MAIN_GAME_ACTIVE;
-                g_gameStateCurrentPhaseStartTime = TimeTicker_GetTime(g_gameClock);
-            }
-            break;
-        }
-
-
-            
-		case GAMESTATE_DEAD_TO_GAME_OVER_TRANSITION:
-		{
-#define DELAY_UNTIL_GAME_OVER_SWOOP_START 500
-			if(current_time >= g_gameStateCurrentPhaseStartTime + DELAY_UNTIL_GAME_OVER_SWOOP_START)
-			{
-				g_gameState = GAMESTATE_SWOOPING_IN_GAME_OVER;
-				g_gameOverDisplayData.sweepInStartTime = TimeTicker_GetTime(g_gameClock);
-				g_gameStateCurrentPhaseStartTime = g_gameOverDisplayData.sweepInStartTime;
-
-				ALmixer_PlayChannel(-1, g_gameSounds.swoosh, 0);
-			}
-			break;
-		}
-			
-		case GAMESTATE_TALLYING_SCORE:
-		{
-			if(current_time > (g_gameStateCurrentPhaseStartTime + TALLY_DURATION))
-			{
-				g_gameState = GAMESTATE_GAME_OVER_WAITING_FOR_USER_ACTION;
-				g_gameStateCurrentPhaseStartTime = TimeTicker_GetTime(g_gameClock);
-//				Flappy_InitGuiButtons();
-			}
-			break;
-		}
-			
-		case GAMESTATE_FADE_OUT_GAME_OVER:
-		{
-			if(current_time > (g_gameStateCurrentPhaseStartTime + FADE_OUT_TIME))
-			{
-				InitNewGame();
-
-				g_gameState = GAMESTATE_LOADING_NEW_GAME_AND_FADE_IN;
-				g_gameStateCurrentPhaseStartTime = TimeTicker_GetTime(g_gameClock);
-			}
-			break;
-		}
-			
-		default:
-		{
-			
-		}
-	}
-}
-
-
-void Flappy_Update(Uint32 delta_time, Uint32 base_time, Uint32 current_time)
-{
-	Flappy_StepPhysics(delta_time);
-	
-	/* This is either based on time, or the place it crashed */
-	Sint32 current_bird_time_position = Flappy_DetermineCurrentBirdTimePosition(delta_time, base_time, current_time);
-//	SDL_Log("current_bird_time_position:%d, current_time:%d\n", current_bird_time_position, current_time);
-	
-	Flappy_UpdateGameState(delta_time, base_time, current_time);
-
-	
-	Flappy_UpdateCloudPositions(delta_time, base_time, current_bird_time_position);
-	Flappy_UpdateGroundPosition(delta_time, base_time, current_bird_time_position);
-	Flappy_UpdateBushPositions(delta_time, base_time, current_bird_time_position);
-	Flappy_UpdateBirdPosition(delta_time, base_time, current_time);
-	
-	Flappy_UpdatePipePositions(delta_time, base_time, current_bird_time_position);
-	
-	
-	Flappy_UpdateGameOverDisplayData(delta_time, base_time, current_time);
-
-	Flappy_UpdateMedalBackgroundData(delta_time, base_time, current_time);
-	
-
-}
 
 void Flappy_LoadSounds()
 {
@@ -3204,78 +2088,31 @@ void Flappy_LoadSounds()
 		SDL_Log("could not load %s: %s\n", resource_file_path, SDL_GetError());
 		fatalError("could not load sound");
 	}
-	g_gameSounds.crash = audio_data;
-
-	
-
-	/* load the sound */
-	/*
-		man
-		Creative Commons Attribution 3.0
-		http://www.freesound.org/people/man/sounds/14609/
-	 */
-	SDL_strlcpy(resource_file_path, base_path, MAX_FILE_STRING_LENGTH);
-	SDL_strlcat(resource_file_path, "14609__man__swosh.wav", MAX_FILE_STRING_LENGTH);
-	audio_data = ALmixer_LoadAll(resource_file_path, AL_FALSE);
-	if(NULL == audio_data)
-	{
-		SDL_Log("could not load %s: %s\n", resource_file_path, SDL_GetError());
-		fatalError("could not load sound");
-	}
-	g_gameSounds.swoosh = audio_data;
-
-	
-}
-
-void Flappy_DoFlap()
-{
-	if(g_gameInstanceData.isPaused)
-	{
-		return;
-	}
-	
-	
-	if(g_birdModelData.isPrelaunch)
-	{
-		g_birdModelData.isPrelaunch = SDL_FALSE;
-		cpSpaceAddBody(g_mainSpace, g_birdModelData.birdBody);
-		cpSpaceAddShape(g_mainSpace, g_birdModelData.birdShape);
-		g_birdModelData.birdLaunchStartTime = TimeTicker_GetTime(g_gameClock);
-        g_gameStateCurrentPhaseStartTime = g_birdModelData.birdLaunchStartTime;
-        g_gameState = GAMESTATE_BIRD_LAUNCHED_BUT_BEFORE_PIPES;
-        
-        
-	}
-	if(g_birdModelData.isDead)
-	{
-		return;
-	}
-	
+	g_gameSounds.crash = audio_data;
 
 	
-	/* In Flappy Bird, when the bird is above the screen,
-		there is some kind of limit imposed so you can't fly up really high.
-		This can be recreated easily by not allowing flaps when the bird is offscreen.
-		We add the size because SDL places y at the top of the sprite, not the bottom.
-		We add a fudge factor because Flappy Bird seems to give some extra space at the top.
+
+	/* load the sound */
+	/*
+		man
+		Creative Commons Attribution 3.0
+		http://www.freesound.org/people/man/sounds/14609/
 	 */
-	if(g_birdModelData.position.y + g_birdModelData.size.y + g_birdModelData.size.y >= 0)
+	SDL_strlcpy(resource_file_path, base_path, MAX_FILE_STRING_LENGTH);
+	SDL_strlcat(resource_file_path, "14609__man__swosh.wav", MAX_FILE_STRING_LENGTH);
+	audio_data = ALmixer_LoadAll(resource_file_path, AL_FALSE);
+	if(NULL == audio_data)
 	{
-		//	cpBodyApplyImpulse(g_birdModelData.birdBody, cpv(0, 10), cpv(0,0));
-		// We only want to use velocity for the y-axis because we are already manually computing x-axis movement.
-		ALmixer_PlayChannel(-1, g_gameSounds.flap, 0);
-//		cpBodySetVelocity((g_birdModelData.birdBody, cpv(g_birdModelData.velocity.x, 460));
-//		cpBodySetVelocity((g_birdModelData.birdBody, cpv(g_birdModelData.velocity.x, 460));
-		cpBodySetVelocity(g_birdModelData.birdBody, cpv(g_birdModelData.velocity.x, 580));
-		cpBodySetAngle(g_birdModelData.birdBody, M_PI_4);
-		cpBodySetAngularVelocity(g_birdModelData.birdBody, -2);
-		/* Chipmunk API says to reindex after changing the angle */
-		cpSpaceReindexShapesForBody(g_mainSpace, g_birdModelData.birdBody);
+		SDL_Log("could not load %s: %s\n", resource_file_path, SDL_GetError());
+		fatalError("could not load sound");
 	}
+	g_gameSounds.swoosh = audio_data;
 
+	
 }
 
 
+
 /*
  loads the happyface graphic into a texture
  */
@@ -3314,7 +2151,6 @@ initializeTexture(SDL_Renderer* the_renderer)
 	}
 	SDL_SetTextureBlendMode(the_texture, SDL_BLENDMODE_BLEND);
 //	SDL_SetTextureAlphaMod(the_texture, .6 * 255);
-	Flappy_InitializeCloudModelData(the_texture);
 	g_gameTextures.clouds = the_texture;
 	
 	/* load the image */
@@ -3357,8 +2193,6 @@ initializeTexture(SDL_Renderer* the_renderer)
 //	SDL_SetTextureAlphaMod(the_texture, .6 * 255);
 	g_gameTextures.bird[0] = the_texture;
 	
-	// Assumes all the bird textures are the sime width/height so any of the 3 may be passed in
-	Flappy_InitializeBirdModelData(g_gameTextures.bird[1]);
 	
 	
 
@@ -3372,7 +2206,6 @@ initializeTexture(SDL_Renderer* the_renderer)
 	}
 //	SDL_SetTextureBlendMode(the_texture, SDL_BLENDMODE_BLEND);
 //	SDL_SetTextureAlphaMod(the_texture, .6 * 255);
-	Flappy_InitializeGroundModelData(the_texture);
 	g_gameTextures.ground = the_texture;
 	
 	
@@ -3386,7 +2219,6 @@ initializeTexture(SDL_Renderer* the_renderer)
 	}
 	SDL_SetTextureBlendMode(the_texture, SDL_BLENDMODE_BLEND);
 	//	SDL_SetTextureAlphaMod(the_texture, .6 * 255);
-	Flappy_InitializeBushModelData(the_texture);
 	g_gameTextures.bush = the_texture;
 
 	
@@ -3415,8 +2247,6 @@ initializeTexture(SDL_Renderer* the_renderer)
 //	SDL_SetTextureAlphaMod(the_texture, .6 * 255);
 	g_gameTextures.pipe_top = the_texture;
 	
-	// Intializes both the top and bottom. Assumes the pipe textures are the sime width/height so either may be passed in
-	Flappy_InitializePipeModelData(g_gameTextures.pipe_bottom);
 	
 	
 	/* load the image */
@@ -4315,281 +3145,218 @@ static int report (lua_State *L, int status) {
 
 void Flappy_SoundFinishedCallback(ALint which_channel, ALuint al_source, ALmixer_Data* almixer_data, ALboolean finished_naturally, void* user_data)
 {
+	struct FlappyWorld* the_world = (struct FlappyWorld*)user_data;
 	if(almixer_data == g_gameSounds.crash)
 	{
-		if(g_birdModelData.isFalling)
+		if(the_world->birdModelData.isFalling)
 		{
-			g_birdModelData.isReadyToPlayFallingSound = SDL_TRUE;
+			the_world->birdModelData.isReadyToPlayFallingSound = SDL_TRUE;
 		}
 	}
 }
 
-cpBool Flappy_OnScorePointCallback(cpArbiter* the_arbiter, cpSpace* the_space, void* user_data)
-{
-
-	
-	ALmixer_PlayChannel(-1, g_gameSounds.coin, 0);
-
-	
-	
-	g_gameInstanceData.currentScore = g_gameInstanceData.currentScore + 1;
-	Flappy_UpdateScoreTexture(g_gameInstanceData.currentScore);
-	
-
-	
-	return cpFalse;
 
+/* The world doesn't know about textures or sounds. It tells us what happened and we present it. */
+static void Flappy_HandleWorldEvent(struct FlappyWorld* the_world, int which_event, void* user_data)
+{
+	switch(which_event)
+	{
+		case FLAPPY_WORLD_EVENT_NEW_GAME:
+			Flappy_UpdateScoreTexture(the_world->gameInstanceData.currentScore);
+			g_highScoreData.previousHighScore = g_highScoreData.savedHighScore;
+			g_highScoreData.currentHighScore = 0;
+			break;
+		case FLAPPY_WORLD_EVENT_FLAPPED:
+			Flappy_PlaySound(g_gameSounds.flap);
+			break;
+		case FLAPPY_WORLD_EVENT_SCORED:
+			Flappy_PlaySound(g_gameSounds.coin);
+			Flappy_UpdateScoreTexture(the_world->gameInstanceData.currentScore);
+			break;
+		case FLAPPY_WORLD_EVENT_CRASHED:
+			Flappy_PlaySound(g_gameSounds.crash);
+			break;
+		case FLAPPY_WORLD_EVENT_FALLING:
+			Flappy_PlaySound(g_gameSounds.fall);
+			break;
+		case FLAPPY_WORLD_EVENT_SWOOSH:
+			Flappy_PlaySound(g_gameSounds.swoosh);
+			break;
+		default:
+			break;
+	}
 }
 
 
-cpBool Flappy_OnPipeCollisionCallback(cpArbiter* the_arbiter, cpSpace* the_space, void* user_data)
+void Flappy_SetGameTimeScale(struct FlappyWorld* the_world, MyFloat new_value)
 {
-	cpShape* a;
-	cpShape* b;
-	int i;
-	
-/*
-	cpContactPointSet set = cpArbiterGetContactPointSet(the_arbiter);
-	//	SDL_Log("set.count: %d", set.count);
-	for(i=0; i<set.count; i++){
-		// get and work with the collision point normal and penetration distance:
-		//		SDL_Log("\np:%f %f",set.points[i].point.x,set.points[i].point.y);
-		//printf("\nn:%f %f",set.points[i].normal.x,set.points[i].normal.y);
-		//set.points[i].dist
-	}
-	
-	cpArbiterGetShapes(the_arbiter, &a, &b);
-	//	SDL_Log("\non player collision a,b %lx %lx", a, b);
-	//	SDL_Log("on player collision s_playerFeet %lx", s_playerFeet);
-*/
-	/*
-//	if( (b == g_groundPhysicsData.shape) || (a == g_groundPhysicsData.shape) )
-	{
-		SDL_Log("hit ground");
-		
-		ALmixer_PlayChannel(-1, g_gameSounds.crash, 0);
-		//			cpFloat ground_height = (1024/16 * 1.9) * 768 / 1024;
-		//		cpBodySetPosition(g_birdModelData.birdBody, cpv(g_birdModelData.birdBody->p.x, ground_height + g_groundPhysicsData.body->p.y + g_birdModelData.size.y/2));
-		//		cpBodySetPosition(g_birdModelData.birdBody, cpv(g_birdModelData.birdBody->p.x, ground_height + g_birdModelData.size.y/2));
-		// TODO: Fix graphics to cap penetration in draw, Chipmunk will correct the penetration by itself eventually
-		
-		return cpTrue;
-	}
-	*/
-//	else
-	
-	// Don't let the bird smack the bottom pipe when falling from the top pipe
-	if(!g_birdModelData.isDead)
+	Sint32 channel;
+	Sint32 total_channels = ALmixer_CountTotalChannels();
+	TimeTicker_SetSpeed(the_world->gameClock, new_value);
+	for(channel=0; channel<total_channels; channel++)
 	{
-		g_gameInstanceData.diedAtTime = TimeTicker_GetTime(g_gameClock);
-//		SDL_Log("hit pipe");
-		g_birdModelData.isFalling = SDL_TRUE;
-		g_birdModelData.isDead = SDL_TRUE;
-		g_gameInstanceData.needsWhiteOut = SDL_TRUE;
-		
-		ALmixer_PlayChannel(-1, g_gameSounds.crash, 0);
-		return cpFalse;
-		
+		ALuint al_source = ALmixer_GetSource(channel);
+		alSourcef(al_source, AL_PITCH, new_value);
 	}
-	return cpFalse;
 }
 
-cpBool Flappy_OnGroundCollisionCallback(cpArbiter* the_arbiter, cpSpace* the_space, void* user_data)
+
+/* Ends the windowed recording and saves it. */
+static void Flappy_FinishWindowedRecording(struct FlappyWorld* the_world)
 {
-	cpShape* a;
-	cpShape* b;
-	int i;
-	
-	/*
-	cpContactPointSet set = cpArbiterGetContactPointSet(the_arbiter);
-	//	SDL_Log("set.count: %d", set.count);
-	for(i=0; i<set.count; i++){
-		// get and work with the collision point normal and penetration distance:
-		//		SDL_Log("\np:%f %f",set.points[i].point.x,set.points[i].point.y);
-		//printf("\nn:%f %f",set.points[i].normal.x,set.points[i].normal.y);
-		//set.points[i].dist
-	}
-	
-	cpArbiterGetShapes(the_arbiter, &a, &b);
-	//	SDL_Log("\non player collision a,b %lx %lx", a, b);
-	//	SDL_Log("on player collision s_playerFeet %lx", s_playerFeet);
-	*/
-//	if( (b == g_groundPhysicsData.shape) || (a == g_groundPhysicsData.shape) )
+	if(NULL == s_windowedReplay)
 	{
-
-//		SDL_Log("hit ground");
-		if(! g_birdModelData.isDead)
-		{
-			ALmixer_PlayChannel(-1, g_gameSounds.crash, 0);
-			g_birdModelData.isDead = SDL_TRUE;
-			g_gameInstanceData.needsWhiteOut = SDL_TRUE;
-			g_gameInstanceData.diedAtTime = TimeTicker_GetTime(g_gameClock);
-		}
-		else
-		{
-//			g_birdModelData.isFalling = SDL_FALSE;
-		}
-		g_birdModelData.isGameOver = SDL_TRUE;
-
-		g_gameState = GAMESTATE_DEAD_TO_GAME_OVER_TRANSITION;
-		g_gameStateCurrentPhaseStartTime = TimeTicker_GetTime(g_gameClock);
-//		g_medalBackgroundData.sweepInStartTime = TimeTicker_GetTime(g_gameClock);
-//		g_gameOverDisplayData.sweepInStartTime = TimeTicker_GetTime(g_gameClock);
-		
-//		ALmixer_PlayChannel(-1, g_gameSounds.swoosh, 0);
-//			cpFloat ground_height = (1024/16 * 1.9) * 768 / 1024;
-//		cpBodySetPosition(g_birdModelData.birdBody, cpv(g_birdModelData.birdBody->p.x, ground_height + g_groundPhysicsData.body->p.y + g_birdModelData.size.y/2));
-//		cpBodySetPosition(g_birdModelData.birdBody, cpv(g_birdModelData.birdBody->p.x, ground_height + g_birdModelData.size.y/2));
-		// TODO: Fix graphics to cap penetration in draw, Chipmunk will correct the penetration by itself eventually
-		
-		return cpTrue;
+		return;
+	}
+	FlappyWorld_SetReplayRecorder(the_world, NULL);
+	FlappyReplay_Finish(s_windowedReplay, the_world);
+	if(FlappyReplay_SaveFile(s_windowedReplay, s_windowedRecordPath))
+	{
+		SDL_Log("Recorded %u actions over %u ticks into %s",
+			FlappyReplay_GetNumberOfActions(s_windowedReplay), FlappyReplay_GetNumberOfTicks(s_windowedReplay), s_windowedRecordPath
+		);
 	}
-	/*
 	else
 	{
-		SDL_Log("hit pipe");
-//		g_birdModelData.isFalling = SDL_TRUE;
-		ALmixer_PlayChannel(-1, g_gameSounds.crash, 0);
-		return cpFalse;
-
+		SDL_Log("Could not save the replay to %s", s_windowedRecordPath);
 	}
-	 */
-	return cpTrue;
+	FlappyReplay_Free(s_windowedReplay);
+	s_windowedReplay = NULL;
 }
 
-
-void InitPhysics()
+/* Steps the world through every tick the game clock has passed, the same way FlappyWorld_StepTick does in tick mode,
+	so a recording of it replays exactly. frame_time_ns is the game clock's time for this frame.
+ */
+static void Flappy_StepRecordedWorld(struct FlappyWorld* the_world, Uint64 frame_time_ns)
 {
-	cpFloat mass = 10.0f;
-	cpFloat moment;
-//	cpFloat ground_height = (1024/16 * 1.9) * 768 / 1024;
-
-	
-	g_mainSpace = cpSpaceNew();
-	cpSpaceSetIterations(g_mainSpace, 30);
-//	cpSpaceSetGravity(g_mainSpace, cpv(0, -1300));
-	cpSpaceSetGravity(g_mainSpace, cpv(0, -1900));
-//	cpSpaceSetGravity(g_mainSpace, cpv(0, -1500));
-	//	cpSpaceSetGravity(s_mainSpace, cpv(0, -10));
-	//	cpSpaceSetGravity(s_mainSpace, cpv(0, 0));
-	cpSpaceSetSleepTimeThreshold(g_mainSpace, 0.5);
-	cpSpaceSetCollisionSlop(g_mainSpace, 0.5);
-	
-	
-	
-
-	moment = cpMomentForBox(mass, g_birdModelData.size.x, g_birdModelData.size.y);
-	g_birdModelData.birdBody = cpBodyNew(mass, moment);
-//	cpSpaceAddBody(g_mainSpace, g_birdModelData.birdBody);
-	
-//	cpBodySetPosition(g_birdModelData.birdBody, cpv( ((g_birdModelData.position.x + g_birdModelData.size.x) / 2.0f),
-	cpBodySetPosition(g_birdModelData.birdBody, cpv( g_birdModelData.position.x,
-											   Flappy_InvertY(
-															  Flappy_lroundf(g_birdModelData.position.y + (g_birdModelData.size.y / 2))
-															  ))
-				 );
-	
-	// We only want to use velocity for the y-axis because we are already manually computing x-axis movement.
-	cpBodySetVelocity(g_birdModelData.birdBody, cpv(0, 0));
-
-	
-//	g_birdModelData.birdShape = cpBoxShapeNew(g_birdModelData.birdBody, g_birdModelData.size.x, g_birdModelData.size.y);
-	g_birdModelData.birdShape = cpCircleShapeNew(g_birdModelData.birdBody, g_birdModelData.size.y/2, cpvzero);
-	cpShapeSetCollisionType(g_birdModelData.birdShape, BIRD_COLLISION_TYPE);
-//	cpSpaceAddShape(g_mainSpace, g_birdModelData.birdShape);
-//	cpShapeSetElasticity(g_birdModelData.birdShape, 0.0);
-//	cpShapeSetFriction(g_birdModelData.birdShape, 1000.0);
-	
-	
-	//g_groundPhysicsData.body = cpBodyNew(INFINITY, INFINITY);
-	g_groundPhysicsData.body = cpBodyNewStatic();
-	cpBodySetPosition(g_groundPhysicsData.body, cpv(0 + SCREEN_WIDTH/2, GROUND_HEIGHT/2.0));
-//	cpBodySetPosition(g_groundPhysicsData.body, cpv(0 + SCREEN_WIDTH/2, GROUND_HEIGHT));
-	
-//	cpBodySetVelocity((g_groundPhysicsData.body, cpv(BIRD_VELOCITY_X, 0));
-
-	
-	// size is somewhat arbitrary
-	// measured 1.9 cm for ground on iPad mini for 1024 pixels
-//	g_groundPhysicsData.shape = cpBoxShapeNew(g_groundPhysicsData.body, SCREEN_WIDTH, GROUND_HEIGHT);
-	g_groundPhysicsData.shape = cpBoxShapeNew(g_groundPhysicsData.body, SCREEN_WIDTH, GROUND_HEIGHT, 0.0);
-//	cpShapeSetElasticity(g_groundPhysicsData.shape, 0.0);
-//	cpShapeSetFriction(g_groundPhysicsData.shape, 1000.0);
-	cpShapeSetCollisionType(g_groundPhysicsData.shape, GROUND_COLLISION_TYPE);
-
-	// don't add body to space to make it a "rogue" body (intended to be controlled manually). But still must add shape to space.
-	cpSpaceAddShape(g_mainSpace, g_groundPhysicsData.shape);
+	Uint32 frame_time = (Uint32)(frame_time_ns / 1000000);
 
-	//cpShapeSetFriction(g_groundPhysicsData.shape, INFINITY);
-//	cpShapeSetFriction(g_groundPhysicsData.shape, 100000);
-
-	
-//	collisionBird = new cpSpaceAddCollisionHandlerContainer();
-//	cpSpaceAddCollisionHandler(space, 0, 0, startCollision, null, null, endCollision, collisionBird);
-	
+	/* The accumulator only holds the leftover for render() between frames. Ticks always start without one. */
+	the_world->physicsAccumulator = 0;
+	while((Uint32)(frame_time - the_world->stepBaseTime) >= FLAPPY_WORLD_TICK_TIME((Uint64)the_world->tickCount + 1))
 	{
-		cpCollisionHandler* collision_handler = cpSpaceAddCollisionHandler(g_mainSpace, BIRD_COLLISION_TYPE, GROUND_COLLISION_TYPE);
-		collision_handler->beginFunc = Flappy_OnGroundCollisionCallback;
+		FlappyWorld_StepTick(the_world, SDL_FALSE);
 	}
+	/* StepTick left the clock on the last tick's time, so put it back on the frame's. */
+	TimeTicker_SetTimeNs(the_world->gameClock, frame_time_ns);
+	the_world->physicsAccumulator = (Uint32)(frame_time - the_world->stepBaseTime) - FLAPPY_WORLD_TICK_TIME(the_world->tickCount);
+}
+
+void Flappy_ApplyCommand(struct FlappyWorld* the_world, Uint32 command_type, float the_value)
+{
+	switch(command_type)
 	{
-		cpCollisionHandler* collision_handler = cpSpaceAddCollisionHandler(g_mainSpace, BIRD_COLLISION_TYPE, PIPE_COLLISION_TYPE);
-		collision_handler->beginFunc = Flappy_OnPipeCollisionCallback;
+		case FLAPPY_COMMAND_PRIMARY_ACTION:
+			Flappy_DoPrimaryAction(the_world);
+			break;
+		case FLAPPY_COMMAND_PAUSE:
+			Flappy_PauseGame(the_world);
+			break;
+		case FLAPPY_COMMAND_UNPAUSE:
+			Flappy_UnpauseGame(the_world);
+			break;
+		case FLAPPY_COMMAND_TOGGLE_PAUSE:
+			Flappy_TogglePause(the_world);
+			break;
+		case FLAPPY_COMMAND_RESET:
+			/* A replay has no way to say the game was reset, so the recording stops here. */
+			Flappy_FinishWindowedRecording(the_world);
+			InitTitleScreen(the_world);
+			break;
+		case FLAPPY_COMMAND_SET_TIME_SCALE:
+			Flappy_SetGameTimeScale(the_world, the_value);
+			break;
+		default:
+			break;
 	}
+}
+
+/* The input handlers below run on the main thread, which is also the one that steps the world,
+	but they still go through g_commandQueue so local input is ordered with (and applied on the same tick rules as)
+	commands pushed by other threads.
+*/
+/* The wall clock and game clock readings main_loop took at the start of this frame. */
+static Uint64 s_frameStartCounter = 0;
+static Uint32 s_frameStartTicks = 0;
+static Uint32 s_frameStartGameTime = 0;
+/* The timestamp (SDL_GetTicks) of the SDL event being handled. */
+static Uint32 s_currentEventTimestamp = 0;
+
+/* Maps s_currentEventTimestamp onto the performance counter, so a local input is stamped with when it happened
+	(sometime during the last frame) rather than when main_loop got around to polling it.
+ */
+static Uint64 Flappy_GetCurrentEventCounter(void)
+{
+	Uint64 counts_ago;
+	if((Sint32)(s_currentEventTimestamp - s_frameStartTicks) > 0)
 	{
-		cpCollisionHandler* collision_handler = cpSpaceAddCollisionHandler(g_mainSpace, BIRD_COLLISION_TYPE, SCORE_SENSOR_TYPE);
-		collision_handler->beginFunc = Flappy_OnScorePointCallback;
+		/* It came in after the frame started, so it is too late for this frame's steps anyway. */
+		return SDL_GetPerformanceCounter();
 	}
+	counts_ago = ((Uint64)(s_frameStartTicks - s_currentEventTimestamp) * SDL_GetPerformanceFrequency()) / 1000;
+	return (counts_ago < s_frameStartCounter) ? (s_frameStartCounter - counts_ago) : 0;
+}
 
-
+static void Flappy_QueueCommand(struct FlappyWorld* the_world, Uint32 command_type, float the_value)
+{
+	if((NULL == g_commandQueue) || (SDL_FALSE == FlappyCommandQueue_PushWithTimestamp(g_commandQueue, command_type, the_value, FLAPPY_COMMAND_SOURCE_LOCAL_INPUT, Flappy_GetCurrentEventCounter())))
+	{
+		/* We are on the simulation thread, so rather than lose the input, apply it right away. */
+		Flappy_ApplyCommand(the_world, command_type, the_value);
+	}
 }
 
-void Flappy_SetGameTimeScale(MyFloat new_value)
+/* Applies everything that was queued before this tick started. Anything pushed later waits for the next tick. */
+static void Flappy_ApplyQueuedCommands(struct FlappyWorld* the_world, Uint64 tick_start_counter)
 {
-	Sint32 channel;
-	Sint32 total_channels = ALmixer_CountTotalChannels();
-	TimeTicker_SetSpeed(g_gameClock, new_value);
-	for(channel=0; channel<total_channels; channel++)
+	FlappyCommand the_command;
+	if(NULL == g_commandQueue)
 	{
-		ALuint al_source = ALmixer_GetSource(channel);
-		alSourcef(al_source, AL_PITCH, new_value);
+		return;
+	}
+	while(FlappyCommandQueue_Pop(g_commandQueue, tick_start_counter, &the_command))
+	{
+		Flappy_ApplyCommand(the_world, the_command.commandType, the_command.value);
 	}
 }
 
-void Flappy_DoPrimaryAction()
+/* g_flappyWorld's step callback. A frame steps through game time that has already passed, so each step
+	is mapped back onto the wall clock and takes exactly the input that was pushed before it started.
+ */
+static void Flappy_OnPhysicsStep(struct FlappyWorld* the_world, Uint32 step_start_time, void* user_data)
 {
-    if((g_gameState >= GAMESTATE_BIRD_PRELAUNCH) && (g_gameState <= GAMESTATE_MAIN_GAME_ACTIVE))
-    {
-        Flappy_DoFlap();
-    }
-    else if(GAMESTATE_GAME_OVER_WAITING_FOR_USER_ACTION == g_gameState)
-    {
-//        InitNewGame();
-		ALmixer_PlayChannel(-1, g_gameSounds.swoosh, 0);
-		g_gameState = GAMESTATE_FADE_OUT_GAME_OVER;
-		g_gameStateCurrentPhaseStartTime = TimeTicker_GetTime(g_gameClock);
-    }
-	else if(GAMESTATE_TITLE_SCREEN == g_gameState)
+	double time_speed = TimeTicker_GetSpeed(the_world->gameClock);
+	Uint64 counts_ago = 0;
+	(void)user_data;
+
+	if(time_speed > 0.0)
 	{
-		ALmixer_PlayChannel(-1, g_gameSounds.swoosh, 0);
-		g_gameState = GAMESTATE_FADE_OUT_TITLE_SCREEN;
-		g_gameStateCurrentPhaseStartTime = TimeTicker_GetTime(g_gameClock);
+		counts_ago = (Uint64)((double)(Uint32)(s_frameStartGameTime - step_start_time) * (double)SDL_GetPerformanceFrequency() / (1000.0 * time_speed));
 	}
-    /*
-        
-	if(g_birdModelData.isGameOver)
+	Flappy_ApplyQueuedCommands(the_world, (counts_ago < s_frameStartCounter) ? (s_frameStartCounter - counts_ago) : 0);
+}
+
+/* Drains the queue while the game is paused. While recording, input goes in at the next tick's time like FlappyWorld_StepTick does it. */
+static void Flappy_ApplyPausedCommands(struct FlappyWorld* the_world)
+{
+	SDL_bool is_recording = (NULL != s_windowedReplay);
+	Uint64 frame_time_ns = TimeTicker_GetTimeNs(the_world->gameClock);
+
+	if(is_recording)
 	{
-		InitNewGame();
+		TimeTicker_SetTime(the_world->gameClock, the_world->stepBaseTime + FLAPPY_WORLD_TICK_TIME((Uint64)the_world->tickCount + 1));
 	}
-	else
+	Flappy_ApplyQueuedCommands(the_world, SDL_GetPerformanceCounter());
+	if(is_recording)
 	{
+		TimeTicker_SetTimeNs(the_world->gameClock, frame_time_ns);
 	}
-     */
 }
 
-void Flappy_DoMouseDown(SDL_MouseButtonEvent the_event)
+void Flappy_DoMouseDown(struct FlappyWorld* the_world, SDL_MouseButtonEvent the_event)
 {
-    if((GAMESTATE_GAME_OVER_WAITING_FOR_USER_ACTION == g_gameState)
-	   || (GAMESTATE_TITLE_SCREEN == g_gameState)
+    if((GAMESTATE_GAME_OVER_WAITING_FOR_USER_ACTION == the_world->gameState)
+	   || (GAMESTATE_TITLE_SCREEN == the_world->gameState)
 	)
     {
         SDL_Rect point_rect = { the_event.x, the_event.y, 1, 1 };
@@ -4606,14 +3373,14 @@ void Flappy_DoMouseDown(SDL_MouseButtonEvent the_event)
     }
     else
     {
-        Flappy_DoPrimaryAction();
+        Flappy_QueueCommand(the_world, FLAPPY_COMMAND_PRIMARY_ACTION, 0.0f);
     }
 }
 
-void Flappy_DoMouseMoved(SDL_MouseMotionEvent the_event)
+void Flappy_DoMouseMoved(struct FlappyWorld* the_world, SDL_MouseMotionEvent the_event)
 {
-    if((GAMESTATE_GAME_OVER_WAITING_FOR_USER_ACTION == g_gameState)
-	   || (GAMESTATE_TITLE_SCREEN == g_gameState)
+    if((GAMESTATE_GAME_OVER_WAITING_FOR_USER_ACTION == the_world->gameState)
+	   || (GAMESTATE_TITLE_SCREEN == the_world->gameState)
 	)
 	{
         SDL_Rect point_rect = { the_event.x, the_event.y, 1, 1 };
@@ -4647,17 +3414,17 @@ void Flappy_DoMouseMoved(SDL_MouseMotionEvent the_event)
     }
 }
 
-void Flappy_DoMouseUp(SDL_MouseButtonEvent the_event)
+void Flappy_DoMouseUp(struct FlappyWorld* the_world, SDL_MouseButtonEvent the_event)
 {
-    if((GAMESTATE_GAME_OVER_WAITING_FOR_USER_ACTION == g_gameState)
-		|| (GAMESTATE_TITLE_SCREEN == g_gameState)
+    if((GAMESTATE_GAME_OVER_WAITING_FOR_USER_ACTION == the_world->gameState)
+		|| (GAMESTATE_TITLE_SCREEN == the_world->gameState)
 	)
     {
         SDL_Rect point_rect = { the_event.x, the_event.y, 1, 1 };
         if(SDL_TRUE == g_guiPlayButton.isPressed)
         {
             g_guiPlayButton.isPressed = SDL_FALSE;
-            Flappy_DoPrimaryAction();
+            Flappy_QueueCommand(the_world, FLAPPY_COMMAND_PRIMARY_ACTION, 0.0f);
         }
 #if FLAPPY_PROVIDE_QUIT_BUTTON
         else if(SDL_TRUE == g_guiQuitButton.isPressed)
@@ -4680,10 +3447,10 @@ void Flappy_DoMouseUp(SDL_MouseButtonEvent the_event)
 
 
 
-void Flappy_DoLeftAction()
+void Flappy_DoLeftAction(struct FlappyWorld* the_world)
 {
-    if((GAMESTATE_GAME_OVER_WAITING_FOR_USER_ACTION == g_gameState)
-	   || (GAMESTATE_TITLE_SCREEN == g_gameState)
+    if((GAMESTATE_GAME_OVER_WAITING_FOR_USER_ACTION == the_world->gameState)
+	   || (GAMESTATE_TITLE_SCREEN == the_world->gameState)
 	)
     {
 #if FLAPPY_PROVIDE_QUIT_BUTTON
@@ -4696,10 +3463,10 @@ void Flappy_DoLeftAction()
     }
 }
 
-void Flappy_DoRightAction()
+void Flappy_DoRightAction(struct FlappyWorld* the_world)
 {
-    if((GAMESTATE_GAME_OVER_WAITING_FOR_USER_ACTION == g_gameState)
-	   || (GAMESTATE_TITLE_SCREEN == g_gameState)
+    if((GAMESTATE_GAME_OVER_WAITING_FOR_USER_ACTION == the_world->gameState)
+	   || (GAMESTATE_TITLE_SCREEN == the_world->gameState)
 	)
     {
 #if FLAPPY_PROVIDE_QUIT_BUTTON
@@ -4713,17 +3480,17 @@ void Flappy_DoRightAction()
 }
 
 
-void Flappy_DoReturnKeyDownAction()
+void Flappy_DoReturnKeyDownAction(struct FlappyWorld* the_world)
 {
-	if((GAMESTATE_GAME_OVER_WAITING_FOR_USER_ACTION == g_gameState)
-	   || (GAMESTATE_TITLE_SCREEN == g_gameState)
+	if((GAMESTATE_GAME_OVER_WAITING_FOR_USER_ACTION == the_world->gameState)
+	   || (GAMESTATE_TITLE_SCREEN == the_world->gameState)
 	)
 	{
 		if(SDL_TRUE == g_guiPlayButton.isSelected)
 		{
 			/* Warning: The mouse, gamepad, and keyboard will fight over this state if users want to break it */
 			g_guiPlayButton.isPressed = SDL_TRUE;
-			Flappy_DoPrimaryAction();
+			Flappy_QueueCommand(the_world, FLAPPY_COMMAND_PRIMARY_ACTION, 0.0f);
 		}
 #if FLAPPY_PROVIDE_QUIT_BUTTON
 		else if(SDL_TRUE == g_guiQuitButton.isSelected)
@@ -4740,15 +3507,15 @@ void Flappy_DoReturnKeyDownAction()
 	}
     else
     {
-        Flappy_DoPrimaryAction();
+        Flappy_QueueCommand(the_world, FLAPPY_COMMAND_PRIMARY_ACTION, 0.0f);
     }
 }
 
 
-void Flappy_DoReturnKeyUpAction()
+void Flappy_DoReturnKeyUpAction(struct FlappyWorld* the_world)
 {
-	if( ((g_gameState >= GAMESTATE_GAME_OVER_WAITING_FOR_USER_ACTION) && (g_gameState <= GAMESTATE_FADE_OUT_GAME_OVER) )
-	   || ((g_gameState >= GAMESTATE_TITLE_SCREEN) && (g_gameState <= GAMESTATE_FADE_OUT_TITLE_SCREEN) )
+	if( ((the_world->gameState >= GAMESTATE_GAME_OVER_WAITING_FOR_USER_ACTION) && (the_world->gameState <= GAMESTATE_FADE_OUT_GAME_OVER) )
+	   || ((the_world->gameState >= GAMESTATE_TITLE_SCREEN) && (the_world->gameState <= GAMESTATE_FADE_OUT_TITLE_SCREEN) )
 	)
 	{
 		if(SDL_TRUE == g_guiPlayButton.isSelected)
@@ -4769,17 +3536,17 @@ void Flappy_DoReturnKeyUpAction()
 }
 
 
-void Flappy_DoUpKeyAction()
+void Flappy_DoUpKeyAction(struct FlappyWorld* the_world)
 {
-    if((GAMESTATE_GAME_OVER_WAITING_FOR_USER_ACTION == g_gameState)
-		|| (GAMESTATE_TITLE_SCREEN == g_gameState)
+    if((GAMESTATE_GAME_OVER_WAITING_FOR_USER_ACTION == the_world->gameState)
+		|| (GAMESTATE_TITLE_SCREEN == the_world->gameState)
 	)
     {
 
     }
     else
     {
-        Flappy_DoPrimaryAction();
+        Flappy_QueueCommand(the_world, FLAPPY_COMMAND_PRIMARY_ACTION, 0.0f);
     }
 }
 
@@ -4787,13 +3554,14 @@ void Flappy_DoUpKeyAction()
 
 static int TemplateHelper_HandleAppEvents(void* user_data, SDL_Event* the_event)
 {
+	struct FlappyWorld* the_world = (struct FlappyWorld*)user_data;
     switch(the_event->type)
     {
 		case SDL_APP_TERMINATING:
 			/* Terminate the app.
 			 Shut everything down before returning from this function.
 			 */
-			Flappy_SaveHighScoreToStorageIfNeeded();
+			Flappy_SaveHighScoreToStorageIfNeeded(the_world);
 			
 			return 0;
 		case SDL_APP_LOWMEMORY:
@@ -4805,9 +3573,9 @@ static int TemplateHelper_HandleAppEvents(void* user_data, SDL_Event* the_event)
 			/* Prepare your app to go into the background.  Stop loops, etc.
 			 This gets called when the user hits the home button, or gets a call.
 			 */
-			Flappy_SaveHighScoreToStorageIfNeeded();
+			Flappy_SaveHighScoreToStorageIfNeeded(the_world);
 			
-			Flappy_PauseGame();
+			Flappy_PauseGame(the_world);
 			return 0;
 		case SDL_APP_DIDENTERBACKGROUND:
 			/* This will get called if the user accepted whatever sent your app to the background.
@@ -4825,7 +3593,7 @@ static int TemplateHelper_HandleAppEvents(void* user_data, SDL_Event* the_event)
 			/* Restart your loops here.
 			 Your app is interactive and getting CPU again.
 			 */
-			Flappy_UnpauseGame();
+			Flappy_UnpauseGame(the_world);
 			return 0;
 		default:
 			/* No special processing, add it to the event queue */
@@ -4839,24 +3607,24 @@ void main_loop()
 {
 	Uint32 last_frame_time;
 	Uint32 current_frame_time;
-	Uint32 startFrame;
 	Uint32 delta_time;
 	Uint32 endFrame;
-	Sint32 delay;
 	SDL_Event event;
 	int the_result;
 	Uint32 base_time = g_baseTime;
 	SDL_Renderer* renderer = g_mainRenderer;
 	SDL_bool app_done = g_appDone;
+	struct FlappyWorld* the_world = g_flappyWorld;
 	
 	/* We use TimeTicker for game time stuff, where time (the game) can be paused, or reset for a new game. */
-//	base_time = TimeTicker_UpdateTime(g_gameClock);
+//	base_time = TimeTicker_UpdateTime(the_world->gameClock);
 	
 	
-	last_frame_time = TimeTicker_GetTime(g_gameClock);
-	current_frame_time = TimeTicker_UpdateTime(g_gameClock);
-	
-	startFrame = SDL_GetTicks();
+	last_frame_time = TimeTicker_GetTime(the_world->gameClock);
+	current_frame_time = TimeTicker_UpdateTime(the_world->gameClock);
+	s_frameStartCounter = SDL_GetPerformanceCounter();
+	s_frameStartTicks = SDL_GetTicks();
+	s_frameStartGameTime = current_frame_time;
 	
 	
 	delta_time = current_frame_time - last_frame_time;
@@ -4871,24 +3639,25 @@ void main_loop()
 		the_result = SDL_PollEvent(&event);
 		if(the_result > 0)
 		{
+			s_currentEventTimestamp = event.common.timestamp;
 			switch (event.type)
 			{
 					
 				case SDL_MOUSEMOTION:
 					//	SDL_Log("SDL_MOUSEMOTION, %d", the_result);
-					Flappy_DoMouseMoved(event.motion);
+					Flappy_DoMouseMoved(the_world, event.motion);
 					
 					break;
 				case SDL_MOUSEBUTTONDOWN:
 					//	SDL_Log("SDL_MOUSEBUTTONDOWN, %d", the_result);
 					
-					//						Flappy_DoPrimaryAction();
-					Flappy_DoMouseDown(event.button);
+					//						Flappy_DoPrimaryAction(the_world);
+					Flappy_DoMouseDown(the_world, event.button);
 					break;
 				case SDL_MOUSEBUTTONUP:
 					//	SDL_Log("SDL_MOUSEBUTTONDOWN, %d", the_result);
-					Flappy_DoMouseUp(event.button);
-					//						Flappy_DoPrimaryAction();
+					Flappy_DoMouseUp(the_world, event.button);
+					//						Flappy_DoPrimaryAction(the_world);
 					break;
 				case SDL_KEYDOWN:
 					//						SDL_Log("SDL_KEYDOWN, %d", the_result);
@@ -4900,20 +3669,20 @@ void main_loop()
 					}
 					else if(SDLK_SPACE == event.key.keysym.sym)
 					{
-						Flappy_DoReturnKeyDownAction();
+						Flappy_DoReturnKeyDownAction(the_world);
 						
 					}
 					else if(SDLK_UP == event.key.keysym.sym)
 					{
-						Flappy_DoUpKeyAction();
+						Flappy_DoUpKeyAction(the_world);
 					}
 					else if(SDLK_LEFT == event.key.keysym.sym)
 					{
-						Flappy_DoLeftAction();
+						Flappy_DoLeftAction(the_world);
 					}
 					else if(SDLK_RIGHT == event.key.keysym.sym)
 					{
-						Flappy_DoRightAction();
+						Flappy_DoRightAction(the_world);
 					}
 					
 					else if(SDLK_RETURN == event.key.keysym.sym)
@@ -4933,16 +3702,16 @@ void main_loop()
 #endif
 						else
 						{
-							Flappy_DoReturnKeyDownAction();
+							Flappy_DoReturnKeyDownAction(the_world);
 						}
 					}
 					else if(SDLK_RETURN2 == event.key.keysym.sym)
 					{
-						Flappy_DoReturnKeyDownAction();
+						Flappy_DoReturnKeyDownAction(the_world);
 					}
 					else if(SDLK_p == event.key.keysym.sym)
 					{
-						Flappy_TogglePause();
+						Flappy_QueueCommand(the_world, FLAPPY_COMMAND_TOGGLE_PAUSE, 0.0f);
 					}
 					
 					/* CMD-F (Mac) or Ctrl-F (everybody else) to toggle fullscreen */
@@ -4961,7 +3730,7 @@ void main_loop()
 #endif
 						else
 						{
-							Flappy_DoPrimaryAction();
+							Flappy_QueueCommand(the_world, FLAPPY_COMMAND_PRIMARY_ACTION, 0.0f);
 						}
 					}
 					
@@ -4982,38 +3751,38 @@ void main_loop()
 					
 					else if(SDLK_0 == event.key.keysym.sym)
 					{
-						Flappy_SetGameTimeScale(0.5);
+						Flappy_QueueCommand(the_world, FLAPPY_COMMAND_SET_TIME_SCALE, 0.5f);
 					}
 					else if(SDLK_1 == event.key.keysym.sym)
 					{
-						Flappy_SetGameTimeScale(1.0);
+						Flappy_QueueCommand(the_world, FLAPPY_COMMAND_SET_TIME_SCALE, 1.0f);
 						
 					}
 					else if(SDLK_2 == event.key.keysym.sym)
 					{
-						Flappy_SetGameTimeScale(2.0);
+						Flappy_QueueCommand(the_world, FLAPPY_COMMAND_SET_TIME_SCALE, 2.0f);
 						
 					}
 					else if(SDLK_LSHIFT == event.key.keysym.sym)
 					{
-						Flappy_SetGameTimeScale(0.5);
+						Flappy_QueueCommand(the_world, FLAPPY_COMMAND_SET_TIME_SCALE, 0.5f);
 						
 					}
 					else if(SDLK_RSHIFT == event.key.keysym.sym)
 					{
-						Flappy_SetGameTimeScale(2.0);
+						Flappy_QueueCommand(the_world, FLAPPY_COMMAND_SET_TIME_SCALE, 2.0f);
 						
 					}
 					break;
 				case SDL_KEYUP:
 					if(SDLK_LSHIFT == event.key.keysym.sym)
 					{
-						Flappy_SetGameTimeScale(1.0);
+						Flappy_QueueCommand(the_world, FLAPPY_COMMAND_SET_TIME_SCALE, 1.0f);
 						
 					}
 					else if(SDLK_RSHIFT == event.key.keysym.sym)
 					{
-						Flappy_SetGameTimeScale(1.0);
+						Flappy_QueueCommand(the_world, FLAPPY_COMMAND_SET_TIME_SCALE, 1.0f);
 					}
 					else if(SDLK_RETURN == event.key.keysym.sym)
 					{
@@ -5030,51 +3799,51 @@ void main_loop()
 #endif
 						else
 						{
-							Flappy_DoReturnKeyUpAction();
+							Flappy_DoReturnKeyUpAction(the_world);
 						}
 					}
 					else if(SDLK_RETURN2 == event.key.keysym.sym)
 					{
-						Flappy_DoReturnKeyUpAction();
+						Flappy_DoReturnKeyUpAction(the_world);
 					}
 					else if(SDLK_SPACE == event.key.keysym.sym)
 					{
-						Flappy_DoReturnKeyUpAction();
+						Flappy_DoReturnKeyUpAction(the_world);
 						
 					}
 					break;
 				case SDL_CONTROLLERBUTTONDOWN:
 					if(SDL_CONTROLLER_BUTTON_A == event.cbutton.button)
 					{
-						Flappy_DoReturnKeyDownAction();
+						Flappy_DoReturnKeyDownAction(the_world);
 					}
 					else if(SDL_CONTROLLER_BUTTON_LEFTSHOULDER == event.cbutton.button)
 					{
-						Flappy_SetGameTimeScale(0.5);
+						Flappy_QueueCommand(the_world, FLAPPY_COMMAND_SET_TIME_SCALE, 0.5f);
 					}
 					else if(SDL_CONTROLLER_BUTTON_RIGHTSHOULDER == event.cbutton.button)
 					{
-						Flappy_SetGameTimeScale(2.0);
+						Flappy_QueueCommand(the_world, FLAPPY_COMMAND_SET_TIME_SCALE, 2.0f);
 					}
 					else if(SDL_CONTROLLER_BUTTON_START == event.cbutton.button)
 					{
-						Flappy_TogglePause();
+						Flappy_QueueCommand(the_world, FLAPPY_COMMAND_TOGGLE_PAUSE, 0.0f);
 					}
 					
 					break;
 				case SDL_CONTROLLERBUTTONUP:
 					if(SDL_CONTROLLER_BUTTON_LEFTSHOULDER == event.cbutton.button)
 					{
-						Flappy_SetGameTimeScale(1.0);
+						Flappy_QueueCommand(the_world, FLAPPY_COMMAND_SET_TIME_SCALE, 1.0f);
 					}
 					if(SDL_CONTROLLER_BUTTON_RIGHTSHOULDER == event.cbutton.button)
 					{
-						Flappy_SetGameTimeScale(1.0);
+						Flappy_QueueCommand(the_world, FLAPPY_COMMAND_SET_TIME_SCALE, 1.0f);
 					}
 					
 					if(SDL_CONTROLLER_BUTTON_A == event.cbutton.button)
 					{
-						Flappy_DoReturnKeyUpAction();
+						Flappy_DoReturnKeyUpAction(the_world);
 					}
 					break;
 					
@@ -5090,121 +3859,655 @@ void main_loop()
 					
 				case SDL_CONTROLLERAXISMOTION:
 				{
-					const Sint16 DEAD_ZONE = 15000;  /* !!! FIXME: real deadzone */
-					
-					/* horizontal axis */
-					if(SDL_CONTROLLER_AXIS_LEFTX == event.caxis.axis)
-					{
-						//SDL_Log("event.caxis.value %d", event.caxis.value);
-						if(event.caxis.value < -DEAD_ZONE)
-						{
-							Flappy_DoLeftAction();
-						}
-						else if(event.caxis.value > DEAD_ZONE)
-						{
-							Flappy_DoRightAction();
-						}
-					}
-					break;
+					const Sint16 DEAD_ZONE = 15000;  /* !!! FIXME: real deadzone */
+					
+					/* horizontal axis */
+					if(SDL_CONTROLLER_AXIS_LEFTX == event.caxis.axis)
+					{
+						//SDL_Log("event.caxis.value %d", event.caxis.value);
+						if(event.caxis.value < -DEAD_ZONE)
+						{
+							Flappy_DoLeftAction(the_world);
+						}
+						else if(event.caxis.value > DEAD_ZONE)
+						{
+							Flappy_DoRightAction(the_world);
+						}
+					}
+					break;
+				}
+				case SDL_WINDOWEVENT:
+					switch(event.window.event)
+				{
+					case SDL_WINDOWEVENT_HIDDEN:
+					case SDL_WINDOWEVENT_MINIMIZED:
+						//								Flappy_PauseGame(the_world);
+						break;
+					case SDL_WINDOWEVENT_RESIZED:
+						SDL_RenderSetLogicalSize(g_mainRenderer, SCREEN_WIDTH, SCREEN_HEIGHT);
+
+					default:
+						break;
+				}
+					break;
+					
+				case SDL_QUIT:
+				case SDL_APP_TERMINATING:
+					//						SDL_Log("SDL_QUIT, %d", the_result);
+					app_done = 1;
+					break;
+				default:
+					break;
+			}
+		}
+	} while(the_result > 0);
+	
+#endif
+	/* Queued input is applied by Flappy_OnPhysicsStep. In a recording, the steps are inside FlappyWorld_StepTick,
+		after it moved the clock to the tick's time, so the input goes in exactly as the replay will do it.
+	 */
+	if(NULL != s_windowedReplay)
+	{
+		Flappy_StepRecordedWorld(the_world, TimeTicker_GetTimeNs(the_world->gameClock));
+	}
+	else
+	{
+		Flappy_Update(the_world, delta_time, base_time, current_frame_time);
+	}
+	/* A paused world takes no steps, so nothing else would take the unpause off the queue. */
+	if(the_world->gameInstanceData.isPaused)
+	{
+		Flappy_ApplyPausedCommands(the_world);
+	}
+	Flappy_UpdateGameOverDisplayData(the_world, delta_time, base_time, current_frame_time);
+	Flappy_UpdateMedalBackgroundData(the_world, delta_time, base_time, current_frame_time);
+	render(the_world, renderer);
+	
+	g_appDone = app_done;
+	
+	endFrame = SDL_GetTicks();
+	TemplateHelper_UpdateFps();
+	if( (g_myFPSPrintTimer +  3000) < (endFrame))
+	{
+		s_lastRecordedFPS = g_framesPerSecond;
+		//			SDL_Log("%f\n", framespersecond);
+		
+		g_myFPSPrintTimer = endFrame;
+	}
+	/* Sleep (then spin for the last bit) until the next frame is due, then show it. */
+	if(NULL != g_framePacer)
+	{
+		FlappyFramePacer_WaitForNextFrame(g_framePacer);
+	}
+	/* update screen */
+	SDL_RenderPresent(renderer);
+}
+
+/* Headless mode steps the simulation from a manual tick loop as fast as the CPU allows.
+	Each tick advances the game clock by a fixed amount (one physics step), so no time is spent
+	waiting on SDL_GetTicks() or the frame pacer.
+ */
+#define HEADLESS_DEFAULT_NUMBER_OF_TICKS 1000000
+
+#ifndef FLAPPY_HEADLESS_BUILD
+	#define FLAPPY_HEADLESS_BUILD 0
+#endif
+
+/* --native-physics makes headless worlds skip Chipmunk (see FlappyWorld_SetPhysicsBackend). */
+static int s_headlessPhysicsBackend = FLAPPY_PHYSICS_BACKEND_CHIPMUNK;
+/* --seed N makes headless runs repeatable. Otherwise it comes from time(). */
+static Uint64 s_headlessSeed = 0;
+/* --record path saves the --headless run (or the windowed game) as a FlappyReplay. */
+static const char* s_headlessRecordPath = NULL;
+/* --publish name streams the --headless run's transitions into the shared memory FlappyExperienceRing of that name. */
+static const char* s_headlessExperienceRingName = NULL;
+#define HEADLESS_EXPERIENCE_RING_CAPACITY 65536
+#define HEADLESS_EXPERIENCE_COMMIT_BATCH 64
+
+/* Planners fork the world thousands of times per decision, so report what a snapshot and a restore cost. */
+#define HEADLESS_NUMBER_OF_SNAPSHOT_REPETITIONS 100000
+static void Flappy_MeasureSnapshotCost(struct FlappyWorld* the_world)
+{
+	FlappyWorldSnapshot the_snapshot;
+	Uint64 start_counter;
+	double snapshot_seconds;
+	double restore_seconds;
+	Uint32 i;
+
+	start_counter = SDL_GetPerformanceCounter();
+	for(i=0; i<HEADLESS_NUMBER_OF_SNAPSHOT_REPETITIONS; i++)
+	{
+		FlappyWorld_Snapshot(the_world, &the_snapshot);
+	}
+	snapshot_seconds = (double)(SDL_GetPerformanceCounter() - start_counter) / (double)SDL_GetPerformanceFrequency();
+
+	start_counter = SDL_GetPerformanceCounter();
+	for(i=0; i<HEADLESS_NUMBER_OF_SNAPSHOT_REPETITIONS; i++)
+	{
+		FlappyWorld_Restore(the_world, &the_snapshot);
+	}
+	restore_seconds = (double)(SDL_GetPerformanceCounter() - start_counter) / (double)SDL_GetPerformanceFrequency();
+
+	SDL_Log("headless: snapshot is %u bytes, %f ns per snapshot, %f ns per restore",
+		(unsigned int)sizeof(FlappyWorldSnapshot),
+		snapshot_seconds * 1.0e9 / HEADLESS_NUMBER_OF_SNAPSHOT_REPETITIONS,
+		restore_seconds * 1.0e9 / HEADLESS_NUMBER_OF_SNAPSHOT_REPETITIONS
+	);
+}
+
+#define HEADLESS_NUMBER_OF_PIXEL_FRAMES 20000
+
+/* Logs how fast FlappyPixelRenderer draws the world at the default observation size. */
+static void Flappy_MeasurePixelRenderCost(struct FlappyWorld* the_world)
+{
+	struct FlappyPixelRenderer* pixel_renderer;
+	Uint8* the_pixels;
+	Uint64 start_counter;
+	double elapsed_seconds;
+	Uint32 i;
+
+	pixel_renderer = FlappyPixelRenderer_Create(FLAPPY_PIXEL_RENDERER_DEFAULT_WIDTH, FLAPPY_PIXEL_RENDERER_DEFAULT_HEIGHT, FLAPPY_PIXEL_FORMAT_GRAY8);
+	if(NULL == pixel_renderer)
+	{
+		return;
+	}
+	the_pixels = (Uint8*)SDL_malloc(FlappyPixelRenderer_GetFrameSize(pixel_renderer));
+	if(NULL == the_pixels)
+	{
+		FlappyPixelRenderer_Free(pixel_renderer);
+		return;
+	}
+
+	start_counter = SDL_GetPerformanceCounter();
+	for(i=0; i<HEADLESS_NUMBER_OF_PIXEL_FRAMES; i++)
+	{
+		FlappyPixelRenderer_Render(pixel_renderer, the_world, the_pixels);
+	}
+	elapsed_seconds = (double)(SDL_GetPerformanceCounter() - start_counter) / (double)SDL_GetPerformanceFrequency();
+
+	SDL_Log("headless: %ux%u gray pixel observations at %f frames per second",
+		FlappyPixelRenderer_GetWidth(pixel_renderer), FlappyPixelRenderer_GetHeight(pixel_renderer),
+		(elapsed_seconds > 0.0) ? (HEADLESS_NUMBER_OF_PIXEL_FRAMES / elapsed_seconds) : 0.0
+	);
+
+	SDL_free(the_pixels);
+	FlappyPixelRenderer_Free(pixel_renderer);
+}
+
+/* A trivial built-in player so a headless run exercises the whole game (including game over and restarts)
+	without any input devices. It flaps whenever the bird drops below the middle of the next pipe gap.
+	Returns SDL_TRUE if it wants to do the primary action this tick.
+ */
+static SDL_bool Flappy_HeadlessAutopilot(struct FlappyWorld* the_world)
+{
+	cpVect bird_position;
+	cpVect bird_velocity;
+	cpFloat target_y = SCREEN_HEIGHT / 2;
+	Sint32 i;
+
+	if((GAMESTATE_TITLE_SCREEN == the_world->gameState)
+		|| (GAMESTATE_BIRD_PRELAUNCH == the_world->gameState)
+		|| (GAMESTATE_GAME_OVER_WAITING_FOR_USER_ACTION == the_world->gameState)
+	)
+	{
+		return SDL_TRUE;
+	}
+	if((the_world->gameState < GAMESTATE_BIRD_LAUNCHED_BUT_BEFORE_PIPES) || (the_world->gameState > GAMESTATE_MAIN_GAME_ACTIVE))
+	{
+		return SDL_FALSE;
+	}
+
+	bird_position = cpBodyGetPosition(the_world->birdModelData.birdBody);
+	bird_velocity = cpBodyGetVelocity(the_world->birdModelData.birdBody);
+
+	/* The next pipe is the first one whose trailing edge is still ahead of the bird. */
+	for(i=0; i<FlappyPipeQueue_Size(&the_world->circularQueueOfPipes); i++)
+	{
+		struct PipeModelData* current_pipe = *FlappyPipeQueue_AtIndex(&the_world->circularQueueOfPipes, i);
+		if((current_pipe->realPositionX + (PIPE_WIDTH / 2)) >= (bird_position.x - (BIRD_HEIGHT / 2)))
+		{
+			target_y = current_pipe->lowerRealPositionY + current_pipe->pipeHeight + (PIPE_HEIGHT_SEPARATION / 2);
+			break;
+		}
+	}
+
+	if((bird_position.y < (target_y - (BIRD_HEIGHT / 2))) && (bird_velocity.y < 0))
+	{
+		return SDL_TRUE;
+	}
+	return SDL_FALSE;
+}
+
+static int Flappy_RunHeadless(Uint32 number_of_ticks)
+{
+	Uint32 i;
+	Uint32 base_time;
+	Uint32 current_time;
+	Uint32 number_of_games = 0;
+	Uint32 best_score = 0;
+	Uint64 start_counter;
+	double elapsed_seconds;
+	struct FlappyWorld* the_world;
+	struct FlappyReplay* the_replay = NULL;
+	struct FlappyExperienceRing* the_ring = NULL;
+	Uint32 number_pending = 0;
+	Uint32 number_published = 0;
+	Uint32 number_dropped = 0;
+
+	g_isHeadless = SDL_TRUE;
+
+	/* No video, audio, fonts or images. We only want the timer for our own benchmark numbers. */
+	if(SDL_Init(SDL_INIT_TIMER) < 0)
+	{
+		SDL_Log("Could not initialize SDL");
+	}
+
+	/* The world's game clock stays virtual, so it never reads the wall clock. We advance it manually once per tick.
+		No event callback is installed because there is nothing to play or draw.
+	 */
+	the_world = FlappyWorld_Create(s_headlessSeed);
+	FlappyWorld_SetPhysicsBackend(the_world, s_headlessPhysicsBackend);
+	InitTitleScreen(the_world);
+	if(NULL != s_headlessRecordPath)
+	{
+		the_replay = FlappyReplay_Create(s_headlessSeed, s_headlessPhysicsBackend);
+		FlappyWorld_SetReplayRecorder(the_world, the_replay);
+	}
+	if(NULL != s_headlessExperienceRingName)
+	{
+		the_ring = FlappyExperienceRing_Create(s_headlessExperienceRingName, HEADLESS_EXPERIENCE_RING_CAPACITY, FLAPPY_OBSERVATION_SIZE);
+		if(NULL == the_ring)
+		{
+			SDL_Log("headless: could not create experience ring %s: %s", s_headlessExperienceRingName, SDL_GetError());
+		}
+	}
+
+	base_time = TimeTicker_GetTime(the_world->gameClock);
+	start_counter = SDL_GetPerformanceCounter();
+
+	for(i=0; i<number_of_ticks; i++)
+	{
+		if(GAMESTATE_GAME_OVER_WAITING_FOR_USER_ACTION == the_world->gameState)
+		{
+			number_of_games++;
+			if(the_world->gameInstanceData.currentScore > best_score)
+			{
+				best_score = the_world->gameInstanceData.currentScore;
+			}
+		}
+
+		if(NULL == the_ring)
+		{
+			FlappyWorld_StepTick(the_world, Flappy_HeadlessAutopilot(the_world));
+		}
+		else
+		{
+			/* Only ticks where the bird is in play are transitions. Dying ends the episode with a reward of -1. */
+			SDL_bool is_in_play = (the_world->gameState >= GAMESTATE_BIRD_PRELAUNCH) && (the_world->gameState <= GAMESTATE_MAIN_GAME_ACTIVE) && ! the_world->birdModelData.isDead;
+			Uint32 score_before = the_world->gameInstanceData.currentScore;
+			SDL_bool did_flap = Flappy_HeadlessAutopilot(the_world);
+			FlappyExperienceTransition* the_transition = NULL;
+
+			/* The observation is the state the action was taken in, so it is written before the step (which also publishes each episode's first state). */
+			if(is_in_play)
+			{
+				/* The learner may fall behind. Rather than stall the actor, those transitions are dropped. */
+				the_transition = FlappyExperienceRing_Reserve(the_ring);
+				if(NULL == the_transition)
+				{
+					number_dropped++;
 				}
-				case SDL_WINDOWEVENT:
-					switch(event.window.event)
+				else
 				{
-					case SDL_WINDOWEVENT_HIDDEN:
-					case SDL_WINDOWEVENT_MINIMIZED:
-						//								Flappy_PauseGame();
-						break;
-					case SDL_WINDOWEVENT_RESIZED:
-						SDL_RenderSetLogicalSize(g_mainRenderer, SCREEN_WIDTH, SCREEN_HEIGHT);
+					FlappyWorld_WriteObservation(the_world, FlappyExperienceRing_GetObservation(the_transition));
+				}
+			}
 
-					default:
-						break;
+			FlappyWorld_StepTick(the_world, did_flap);
+			if(is_in_play)
+			{
+				if(NULL != the_transition)
+				{
+					the_transition->action = did_flap ? FLAPPY_BATCH_ACTION_PRIMARY : FLAPPY_BATCH_ACTION_NONE;
+					the_transition->reward = (float)(the_world->gameInstanceData.currentScore - score_before) - (the_world->birdModelData.isDead ? 1.0f : 0.0f);
+					the_transition->isDone = the_world->birdModelData.isDead ? 1 : 0;
+					the_transition->worldIndex = 0;
+					number_pending++;
+				}
+				if((number_pending >= HEADLESS_EXPERIENCE_COMMIT_BATCH) || the_world->birdModelData.isDead)
+				{
+					FlappyExperienceRing_Commit(the_ring);
+					number_published += number_pending;
+					number_pending = 0;
 				}
-					break;
-					
-				case SDL_QUIT:
-				case SDL_APP_TERMINATING:
-					//						SDL_Log("SDL_QUIT, %d", the_result);
-					app_done = 1;
-					break;
-				default:
-					break;
 			}
 		}
-	} while(the_result > 0);
-	
-#endif
-	Flappy_Update(delta_time, base_time, current_frame_time);
-	render(renderer);
-	
-	g_appDone = app_done;
-	
-	endFrame = SDL_GetTicks();
-	TemplateHelper_UpdateFps();
-	if( (g_myFPSPrintTimer +  3000) < (endFrame))
+	}
+	current_time = TimeTicker_GetTime(the_world->gameClock);
+
+	elapsed_seconds = (double)(SDL_GetPerformanceCounter() - start_counter) / (double)SDL_GetPerformanceFrequency();
+	SDL_Log("headless: %u ticks (%u ms of game time) in %f seconds, %f ticks per second",
+		number_of_ticks, current_time - base_time, elapsed_seconds, (elapsed_seconds > 0.0) ? ((double)number_of_ticks / elapsed_seconds) : 0.0
+	);
+	SDL_Log("headless: %u games finished, best score %u, seed %llu", number_of_games, best_score, (unsigned long long)s_headlessSeed);
+
+	if(NULL != the_ring)
 	{
-		s_lastRecordedFPS = g_framesPerSecond;
-		//			SDL_Log("%f\n", framespersecond);
-		
-		g_myFPSPrintTimer = endFrame;
+		FlappyExperienceRing_Commit(the_ring);
+		number_published += number_pending;
+		SDL_Log("headless: published %u transitions to %s, dropped %u while the ring was full",
+			number_published, s_headlessExperienceRingName, number_dropped
+		);
+		/* The learner keeps its own mapping. It unlinks the name when it's done. */
+		FlappyExperienceRing_Close(the_ring);
 	}
-#define FPS_CAP
-#ifdef FPS_CAP
-#define SAFE_SLEEP_INTERVAL 10
-	/* figure out how much time we have left, and then sleep */
-	delay = MILLESECONDS_PER_FRAME - (Sint32)(endFrame - startFrame);
-	if (delay <= 0)
+
+	if(NULL != the_replay)
 	{
-		delay = 0;
+		/* Finish before measuring the snapshots, since restoring doesn't count as playing. */
+		FlappyWorld_SetReplayRecorder(the_world, NULL);
+		FlappyReplay_Finish(the_replay, the_world);
+		if(FlappyReplay_SaveFile(the_replay, s_headlessRecordPath))
+		{
+			SDL_Log("headless: recorded %u actions over %u ticks into %s (%u bytes)",
+				FlappyReplay_GetNumberOfActions(the_replay), FlappyReplay_GetNumberOfTicks(the_replay),
+				s_headlessRecordPath, (unsigned int)FlappyReplay_Encode(the_replay, NULL, 0)
+			);
+		}
+		FlappyReplay_Free(the_replay);
 	}
-	/*
-		else if(delay < SAFE_SLEEP_INTERVAL)
+
+	Flappy_MeasureSnapshotCost(the_world);
+	Flappy_MeasurePixelRenderCost(the_world);
+
+	FlappyWorld_Free(the_world);
+	SDL_Quit();
+	return 0;
+}
+
+/* Re-simulates a recorded replay headlessly at full speed and checks it ends the same way. */
+static int Flappy_PlayReplayHeadless(const char* file_path)
+{
+	struct FlappyReplay* the_replay;
+	FlappyReplayResult the_result;
+	Uint64 start_counter;
+	double elapsed_seconds;
+	SDL_bool is_match;
+
+	g_isHeadless = SDL_TRUE;
+
+	if(SDL_Init(SDL_INIT_TIMER) < 0)
+	{
+		SDL_Log("Could not initialize SDL");
+	}
+
+	the_replay = FlappyReplay_LoadFile(file_path);
+	if(NULL == the_replay)
+	{
+		SDL_Log("Could not load replay %s", file_path);
+		SDL_Quit();
+		return 1;
+	}
+
+	start_counter = SDL_GetPerformanceCounter();
+	is_match = FlappyReplay_Play(the_replay, &the_result);
+	elapsed_seconds = (double)(SDL_GetPerformanceCounter() - start_counter) / (double)SDL_GetPerformanceFrequency();
+
+	SDL_Log("replay: %u ticks, %u actions, seed %llu played in %f seconds",
+		the_result.numberOfTicks, FlappyReplay_GetNumberOfActions(the_replay), (unsigned long long)FlappyReplay_GetSeed(the_replay), elapsed_seconds
+	);
+	SDL_Log("replay: final score %u (recorded %u), %s",
+		the_result.finalScore, FlappyReplay_GetFinalScore(the_replay), is_match ? "matches the recording" : "DOES NOT match the recording"
+	);
+
+	FlappyReplay_Free(the_replay);
+	SDL_Quit();
+	return is_match ? 0 : 1;
+}
+
+/* --verify collects replay paths into batches this big and verifies each batch on all cores,
+	so a long stream of paths is processed as it arrives instead of all at the end.
+ */
+#define HEADLESS_VERIFY_BATCH_SIZE 4096
+#define HEADLESS_VERIFY_MAX_PATH_LENGTH 1024
+
+struct HeadlessVerifyState
+{
+	char* pathStorage;
+	const char** filePaths;
+	FlappyReplayVerification* results;
+	Uint32 numberPending;
+
+	Uint32 numberOfReplays;
+	Uint32 numberOfMatches;
+	Uint32 numberOfMismatches;
+	Uint32 numberUnreadable;
+	Uint32 numberNotVerified;
+	double elapsedSeconds;
+};
+
+static void Flappy_VerifyPendingReplays(struct HeadlessVerifyState* the_state)
+{
+	FlappyReplayVerifierReport the_report;
+	Uint32 i;
+
+	if(0 == the_state->numberPending)
+	{
+		return;
+	}
+	FlappyReplayVerifier_VerifyFiles(the_state->filePaths, the_state->numberPending, 0, the_state->results, &the_report);
+
+	for(i=0; i<the_state->numberPending; i++)
+	{
+		FlappyReplayVerification* the_result = &the_state->results[i];
+		if( ! the_result->isVerified)
 		{
-	 while((MILLESECONDS_PER_FRAME - (Sint32)(endFrame - startFrame)) >= 0)
-	 {
-	 //				SDL_Delay(0);
-	 endFrame = SDL_GetTicks();
-	 
-	 }
+			SDL_Log("verify: NOT VERIFIED %s", the_state->filePaths[i]);
 		}
-	 */
-	/*
-		else if (delay > MILLESECONDS_PER_FRAME) {
-	 delay = MILLESECONDS_PER_FRAME;
-	 //			SDL_Delay(delay);
-	 while((MILLESECONDS_PER_FRAME - (Sint32)(endFrame - startFrame)) >= 0)
-	 {
-	 // SDL_Delay(0);
-	 endFrame = SDL_GetTicks();
-	 
-	 }
-	 
-	 }
-	 */
-	else
+		else if( ! the_result->isReadable)
+		{
+			SDL_Log("verify: UNREADABLE %s", the_state->filePaths[i]);
+		}
+		else if( ! the_result->isMatch)
+		{
+			SDL_Log("verify: MISMATCH %s claimed score %u, re-simulated score %u after %u ticks",
+				the_state->filePaths[i], the_result->claimedScore, the_result->simulatedScore, the_result->numberOfTicks
+			);
+		}
+	}
+
+	the_state->numberOfReplays += the_report.numberOfReplays;
+	the_state->numberOfMatches += the_report.numberOfMatches;
+	the_state->numberOfMismatches += the_report.numberOfMismatches;
+	the_state->numberUnreadable += the_report.numberUnreadable;
+	the_state->numberNotVerified += the_report.numberNotVerified;
+	the_state->elapsedSeconds += the_report.elapsedSeconds;
+	the_state->numberPending = 0;
+}
+
+static void Flappy_AddReplayToVerify(struct HeadlessVerifyState* the_state, const char* file_path)
+{
+	char* the_slot = &the_state->pathStorage[the_state->numberPending * HEADLESS_VERIFY_MAX_PATH_LENGTH];
+	SDL_strlcpy(the_slot, file_path, HEADLESS_VERIFY_MAX_PATH_LENGTH);
+	the_state->filePaths[the_state->numberPending] = the_slot;
+	the_state->numberPending++;
+	if(HEADLESS_VERIFY_BATCH_SIZE == the_state->numberPending)
 	{
-		//	SDL_Log("%d\n", delay);
-		Uint32 remainder;
-		Uint32 safe_sleep;
-		safe_sleep = (delay / SAFE_SLEEP_INTERVAL) * SAFE_SLEEP_INTERVAL;
-		//			remainder = delay % SAFE_SLEEP_INTERVAL;
-		
-#if 0
-		SDL_Delay(safe_sleep);
-		endFrame = SDL_GetTicks();
-		while((MILLESECONDS_PER_FRAME - (Sint32)(endFrame - startFrame)) >= 0)
+		Flappy_VerifyPendingReplays(the_state);
+	}
+}
+
+static void Flappy_AddReplayDirectoryToVerify(struct HeadlessVerifyState* the_state, const char* directory_path)
+{
+	char file_path[HEADLESS_VERIFY_MAX_PATH_LENGTH];
+#if defined(_WIN32)
+	WIN32_FIND_DATAA find_data;
+	HANDLE find_handle;
+
+	SDL_snprintf(file_path, HEADLESS_VERIFY_MAX_PATH_LENGTH, "%s\\*", directory_path);
+	find_handle = FindFirstFileA(file_path, &find_data);
+	if(INVALID_HANDLE_VALUE == find_handle)
+	{
+		SDL_Log("verify: could not open directory %s", directory_path);
+		return;
+	}
+	do
+	{
+		if(0 == (find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
 		{
-			//				SDL_Delay(0);
-			endFrame = SDL_GetTicks();
-			
+			SDL_snprintf(file_path, HEADLESS_VERIFY_MAX_PATH_LENGTH, "%s\\%s", directory_path, find_data.cFileName);
+			Flappy_AddReplayToVerify(the_state, file_path);
 		}
+	} while(FindNextFileA(find_handle, &find_data));
+	FindClose(find_handle);
 #else
-		SDL_Delay(delay);
-		
+	DIR* the_directory = opendir(directory_path);
+	struct dirent* the_entry;
+
+	if(NULL == the_directory)
+	{
+		SDL_Log("verify: could not open directory %s", directory_path);
+		return;
+	}
+	while(NULL != (the_entry = readdir(the_directory)))
+	{
+		/* Skips ".", ".." and hidden files. */
+		if('.' == the_entry->d_name[0])
+		{
+			continue;
+		}
+		SDL_snprintf(file_path, HEADLESS_VERIFY_MAX_PATH_LENGTH, "%s/%s", directory_path, the_entry->d_name);
+		Flappy_AddReplayToVerify(the_state, file_path);
+	}
+	closedir(the_directory);
 #endif
-		
+}
+
+/* Re-simulates every replay in a directory (or every path read from stdin when the source is "-") and reports the ones that don't check out. */
+static int Flappy_VerifyReplaysHeadless(const char* replay_source)
+{
+	struct HeadlessVerifyState the_state;
+	double replays_per_minute;
+
+	g_isHeadless = SDL_TRUE;
+
+	if(SDL_Init(SDL_INIT_TIMER) < 0)
+	{
+		SDL_Log("Could not initialize SDL");
+	}
+
+	SDL_zero(the_state);
+	the_state.pathStorage = (char*)SDL_malloc(HEADLESS_VERIFY_BATCH_SIZE * HEADLESS_VERIFY_MAX_PATH_LENGTH);
+	the_state.filePaths = (const char**)SDL_calloc(HEADLESS_VERIFY_BATCH_SIZE, sizeof(const char*));
+	the_state.results = (FlappyReplayVerification*)SDL_calloc(HEADLESS_VERIFY_BATCH_SIZE, sizeof(FlappyReplayVerification));
+	if((NULL == the_state.pathStorage) || (NULL == the_state.filePaths) || (NULL == the_state.results))
+	{
+		SDL_Log("verify: out of memory");
+		SDL_free(the_state.results);
+		SDL_free(the_state.filePaths);
+		SDL_free(the_state.pathStorage);
+		SDL_Quit();
+		return 1;
+	}
+
+	if(0 == SDL_strcmp(replay_source, "-"))
+	{
+		char file_path[HEADLESS_VERIFY_MAX_PATH_LENGTH];
+		while(NULL != fgets(file_path, HEADLESS_VERIFY_MAX_PATH_LENGTH, stdin))
+		{
+			size_t path_length = SDL_strlen(file_path);
+			while((path_length > 0) && (('\n' == file_path[path_length-1]) || ('\r' == file_path[path_length-1])))
+			{
+				path_length--;
+				file_path[path_length] = '\0';
+			}
+			if(path_length > 0)
+			{
+				Flappy_AddReplayToVerify(&the_state, file_path);
+			}
+		}
+	}
+	else
+	{
+		Flappy_AddReplayDirectoryToVerify(&the_state, replay_source);
+	}
+	Flappy_VerifyPendingReplays(&the_state);
+
+	replays_per_minute = (the_state.elapsedSeconds > 0.0) ? ((double)the_state.numberOfReplays * 60.0 / the_state.elapsedSeconds) : 0.0;
+	SDL_Log("verify: %u replays, %u match, %u mismatched, %u unreadable, %u not verified in %f seconds (%f replays per minute)",
+		the_state.numberOfReplays, the_state.numberOfMatches, the_state.numberOfMismatches, the_state.numberUnreadable, the_state.numberNotVerified,
+		the_state.elapsedSeconds, replays_per_minute
+	);
+
+	SDL_free(the_state.results);
+	SDL_free(the_state.filePaths);
+	SDL_free(the_state.pathStorage);
+	SDL_Quit();
+	return (the_state.numberOfMatches == the_state.numberOfReplays) ? 0 : 1;
+}
+
+/* Same as Flappy_RunHeadless, but steps number_of_worlds independent worlds per tick with FlappyBatch. */
+static int Flappy_RunHeadlessBatch(Uint32 number_of_worlds, Uint32 number_of_ticks)
+{
+	Uint32 i;
+	Uint32 which_world;
+	Uint32 number_of_games = 0;
+	Uint32 best_score = 0;
+	Uint64 start_counter;
+	double elapsed_seconds;
+	struct FlappyBatch* the_batch;
+	Uint8* the_actions;
+
+	g_isHeadless = SDL_TRUE;
+
+	if(SDL_Init(SDL_INIT_TIMER) < 0)
+	{
+		SDL_Log("Could not initialize SDL");
+	}
+
+	the_batch = FlappyBatch_Create(number_of_worlds, 0, s_headlessSeed);
+	the_actions = (Uint8*)SDL_calloc(number_of_worlds, sizeof(Uint8));
+	if((NULL == the_batch) || (NULL == the_actions))
+	{
+		SDL_Log("Could not create a batch of %u worlds", number_of_worlds);
+		FlappyBatch_Free(the_batch);
+		SDL_free(the_actions);
+		SDL_Quit();
+		return 1;
+	}
+	FlappyBatch_SetPhysicsBackend(the_batch, s_headlessPhysicsBackend);
+
+	start_counter = SDL_GetPerformanceCounter();
+
+	for(i=0; i<number_of_ticks; i++)
+	{
+		for(which_world=0; which_world<number_of_worlds; which_world++)
+		{
+			struct FlappyWorld* the_world = FlappyBatch_GetWorld(the_batch, which_world);
+			if(GAMESTATE_GAME_OVER_WAITING_FOR_USER_ACTION == the_world->gameState)
+			{
+				number_of_games++;
+				if(the_world->gameInstanceData.currentScore > best_score)
+				{
+					best_score = the_world->gameInstanceData.currentScore;
+				}
+			}
+			the_actions[which_world] = Flappy_HeadlessAutopilot(the_world) ? FLAPPY_BATCH_ACTION_PRIMARY : FLAPPY_BATCH_ACTION_NONE;
+		}
+		FlappyBatch_Step(the_batch, the_actions);
 	}
-#endif /* FPS_CAP */
+
+	elapsed_seconds = (double)(SDL_GetPerformanceCounter() - start_counter) / (double)SDL_GetPerformanceFrequency();
+	SDL_Log("headless batch: %u worlds x %u ticks on %u threads in %f seconds, %f world ticks per second",
+		number_of_worlds, number_of_ticks, FlappyBatch_GetNumberOfThreads(the_batch), elapsed_seconds,
+		(elapsed_seconds > 0.0) ? (((double)number_of_worlds * (double)number_of_ticks) / elapsed_seconds) : 0.0
+	);
+	SDL_Log("headless batch: %u games finished, best score %u, base seed %llu", number_of_games, best_score, (unsigned long long)s_headlessSeed);
+
+	SDL_free(the_actions);
+	FlappyBatch_Free(the_batch);
+	SDL_Quit();
+	return 0;
 }
 
 int main(int argc, char* argv[])
@@ -5214,6 +4517,75 @@ int main(int argc, char* argv[])
 
 	g_myFPSPrintTimer = 0;
 	
+	{
+		/* --headless [number_of_ticks] runs the simulation without a window, renderer or audio. */
+		int i;
+		for(i=1; i<argc; i++)
+		{
+			if(0 == SDL_strcmp(argv[i], "--native-physics"))
+			{
+				s_headlessPhysicsBackend = FLAPPY_PHYSICS_BACKEND_NATIVE;
+			}
+		}
+		s_headlessSeed = (Uint64)time(NULL);
+		for(i=1; i<argc-1; i++)
+		{
+			if(0 == SDL_strcmp(argv[i], "--seed"))
+			{
+				s_headlessSeed = (Uint64)SDL_strtoull(argv[i+1], NULL, 10);
+			}
+			else if(0 == SDL_strcmp(argv[i], "--record"))
+			{
+				s_headlessRecordPath = argv[i+1];
+			}
+			else if(0 == SDL_strcmp(argv[i], "--publish"))
+			{
+				s_headlessExperienceRingName = argv[i+1];
+			}
+			/* --fps N paces the game at N frames per second instead of the display's refresh rate. */
+			else if(0 == SDL_strcmp(argv[i], "--fps"))
+			{
+				s_targetFramesPerSecond = SDL_strtod(argv[i+1], NULL);
+			}
+		}
+		for(i=1; i<argc; i++)
+		{
+			if(0 == SDL_strcmp(argv[i], "--headless"))
+			{
+				Uint32 number_of_ticks = HEADLESS_DEFAULT_NUMBER_OF_TICKS;
+				if((i+1 < argc) && (argv[i+1][0] != '-'))
+				{
+					number_of_ticks = (Uint32)SDL_strtoul(argv[i+1], NULL, 10);
+				}
+				return Flappy_RunHeadless(number_of_ticks);
+			}
+			/* --verify directory re-simulates every replay in the directory on all cores. --verify - reads the paths from stdin. */
+			else if((0 == SDL_strcmp(argv[i], "--verify")) && (i+1 < argc))
+			{
+				return Flappy_VerifyReplaysHeadless(argv[i+1]);
+			}
+			/* --play path re-simulates a replay saved with --record. */
+			else if((0 == SDL_strcmp(argv[i], "--play")) && (i+1 < argc))
+			{
+				return Flappy_PlayReplayHeadless(argv[i+1]);
+			}
+			/* --headless-batch number_of_worlds [number_of_ticks] does the same for many worlds at once on all cores. */
+			else if((0 == SDL_strcmp(argv[i], "--headless-batch")) && (i+1 < argc))
+			{
+				Uint32 number_of_worlds = (Uint32)SDL_strtoul(argv[i+1], NULL, 10);
+				Uint32 number_of_ticks = HEADLESS_DEFAULT_NUMBER_OF_TICKS / 100;
+				if((i+2 < argc) && (argv[i+2][0] != '-'))
+				{
+					number_of_ticks = (Uint32)SDL_strtoul(argv[i+2], NULL, 10);
+				}
+				return Flappy_RunHeadlessBatch(number_of_worlds, number_of_ticks);
+			}
+		}
+#if FLAPPY_HEADLESS_BUILD
+		return Flappy_RunHeadless(HEADLESS_DEFAULT_NUMBER_OF_TICKS);
+#endif
+	}
+	
 	
     /* initialize SDL */
 	if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_GAMECONTROLLER) < 0)
@@ -5244,7 +4616,13 @@ int main(int argc, char* argv[])
 
 
 #if 1
-	SDL_SetEventFilter(TemplateHelper_HandleAppEvents, NULL);
+	/* Seed the pipe heights with the time (unless --seed says otherwise) so every session should be unique. */
+	g_flappyWorld = FlappyWorld_Create(s_headlessSeed);
+	FlappyWorld_SetEventCallback(g_flappyWorld, Flappy_HandleWorldEvent, NULL);
+	FlappyWorld_SetStepCallback(g_flappyWorld, Flappy_OnPhysicsStep, NULL);
+	g_commandQueue = FlappyCommandQueue_Create(FLAPPY_COMMAND_QUEUE_CAPACITY);
+
+	SDL_SetEventFilter(TemplateHelper_HandleAppEvents, g_flappyWorld);
 
 	
 	// This will prefer OpenGL as a backend. You may skip this if you don't care and SDL will pick its default.
@@ -5300,6 +4678,9 @@ int main(int argc, char* argv[])
 
 	g_mainRenderer = renderer;
 
+	g_framePacer = FlappyFramePacer_Create(DEFAULT_FRAMES_PER_SECOND);
+	Flappy_ConfigureFramePacer(window, renderer);
+
 	SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "nearest");  // going for an 8-bit retro blocky look, nearest is better than linear
 //	SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "linear");  // make the scaled rendering look smoother.
 //	SDL_SetHint(SDL_HINT_RENDER_LOGICAL_SIZE_MODE, "overscan");
@@ -5308,26 +4689,25 @@ int main(int argc, char* argv[])
 
 	Flappy_InitGameControllerDataMap();
 	
-	/* We use rand() for pipe heights. Seed srand with results from time() so ever game should be unique. */
-	srand(time(NULL));
-	
-	g_gameClock = TimeTicker_Create();
-	
-	
 	initializeFont();
 
 	initializeTexture(renderer);
 
  //       SDL_Log("initializeTexture passed");
 	Flappy_LoadSounds();
-	ALmixer_SetPlaybackFinishedCallback(Flappy_SoundFinishedCallback, NULL);
-	
-	InitPhysics();
+	ALmixer_SetPlaybackFinishedCallback(Flappy_SoundFinishedCallback, g_flappyWorld);
 	
 	g_highScoreData.savedHighScore = Flappy_LoadSavedHighScoreFromStorage();
 	
-//	InitNewGame();
-	InitTitleScreen();
+//	InitNewGame(g_flappyWorld);
+	InitTitleScreen(g_flappyWorld);
+	if(NULL != s_headlessRecordPath)
+	{
+		/* Recording has to start from the fresh title screen, which is where FlappyReplay_Play starts too. */
+		s_windowedReplay = FlappyReplay_Create(g_flappyWorld->randomSeed, g_flappyWorld->physicsBackend);
+		s_windowedRecordPath = s_headlessRecordPath;
+		FlappyWorld_SetReplayRecorder(g_flappyWorld, s_windowedReplay);
+	}
 	
 #endif
 	
@@ -5359,11 +4739,13 @@ int main(int argc, char* argv[])
 	
 	g_appDone = 0;
 //	base_time = SDL_GetTicks();
-	TimeTicker_Start(g_gameClock);
+	/* Worlds are created with a virtual clock for tick mode. The real-time game follows the wall clock. */
+	TimeTicker_SetVirtual(g_flappyWorld->gameClock, SDL_FALSE);
+	TimeTicker_Start(g_flappyWorld->gameClock);
 
 	
 	/* We use TimeTicker for game time stuff, where time (the game) can be paused, or reset for a new game. */
-	g_baseTime = TimeTicker_UpdateTime(g_gameClock);
+	g_baseTime = TimeTicker_UpdateTime(g_flappyWorld->gameClock);
 	
 	while ( !g_appDone )
 	{
@@ -5375,8 +4757,21 @@ int main(int argc, char* argv[])
 	/* Disable the callback in case SDL tries to invoke it before quit */
 	SDL_SetEventFilter(NULL, NULL);
 	
-	Flappy_SaveHighScoreToStorageIfNeeded();
+	if(NULL != s_windowedReplay)
+	{
+		/* Input taken while paused is recorded against the next tick, so play that tick out before finishing. */
+		g_flappyWorld->physicsAccumulator = 0;
+		FlappyWorld_StepTick(g_flappyWorld, SDL_FALSE);
+	}
+	Flappy_FinishWindowedRecording(g_flappyWorld);
+	Flappy_SaveHighScoreToStorageIfNeeded(g_flappyWorld);
 
+	FlappyCommandQueue_Free(g_commandQueue);
+	g_commandQueue = NULL;
+	FlappyFramePacer_Free(g_framePacer);
+	g_framePacer = NULL;
+	FlappyWorld_Free(g_flappyWorld);
+	g_flappyWorld = NULL;
 
 	SDL_DestroyTexture(s_textureFPS);
 	SDL_FreeSurface(s_surfaceFPS);